@@ -145,7 +145,8 @@ bool AbstractCommand::shouldProcess() const
       return true;
     }
 
-    if (socketRecvBuffer_ && !socketRecvBuffer_->bufferEmpty()) {
+    if (socketRecvBuffer_ && (!socketRecvBuffer_->bufferEmpty() ||
+                              socketRecvBuffer_->hasPendingData())) {
       return true;
     }
 
@@ -765,22 +766,51 @@ std::string AbstractCommand::resolveHostname(std::vector<std::string>& addrs,
     return hostname;
   }
 
-  e_->findAllCachedIPAddresses(std::back_inserter(addrs), hostname, port);
-  if (!addrs.empty()) {
-    auto ipaddr = addrs.front();
-    A2_LOG_INFO(fmt(MSG_DNS_CACHE_HIT, getCuid(), hostname.c_str(),
-                    strjoin(std::begin(addrs), std::end(addrs), ", ").c_str()));
-    return ipaddr;
+  bool resolving = false;
+#ifdef ENABLE_ASYNC_DNS
+  // The cache has been looked up when the name resolution started.
+  resolving = asyncNameResolverMan_->started();
+#endif // ENABLE_ASYNC_DNS
+  if (!resolving) {
+    switch (e_->getDNSCache()->lookup(addrs, hostname, port)) {
+    case 1: {
+      auto ipaddr = addrs.front();
+      A2_LOG_INFO(
+          fmt(MSG_DNS_CACHE_HIT, getCuid(), hostname.c_str(),
+              strjoin(std::begin(addrs), std::end(addrs), ", ").c_str()));
+      return ipaddr;
+    }
+    case -1:
+      A2_LOG_INFO(
+          fmt(MSG_DNS_NEGATIVE_CACHE_HIT, getCuid(), hostname.c_str()));
+      if (!isProxyRequest(req_->getProtocol(), getOption())) {
+        e_->getRequestGroupMan()
+            ->getOrCreateServerStat(req_->getHost(), req_->getProtocol())
+            ->setError();
+      }
+      throw DL_ABORT_EX2(fmt(MSG_NAME_RESOLUTION_FAILED, getCuid(),
+                             hostname.c_str(), "Domain name not found"),
+                         error_code::NAME_RESOLVE_ERROR);
+    default:
+      break;
+    }
   }
 
   std::string ipaddr;
+  // TTL reported by the resolver, in seconds.  0 if it is unknown.
+  int ttl = 0;
 #ifdef ENABLE_ASYNC_DNS
   if (getOption()->getAsBool(PREF_ASYNC_DNS)) {
     if (!asyncNameResolverMan_->started()) {
       asyncNameResolverMan_->startAsync(hostname, e_, this);
     }
     switch (asyncNameResolverMan_->getStatus()) {
-    case -1:
+    case -1: {
+      auto negativeTTL = getOption()->getAsInt(PREF_DNS_NEGATIVE_CACHE_TTL);
+      if (negativeTTL > 0 && asyncNameResolverMan_->isNotFound()) {
+        e_->getDNSCache()->putNegative(hostname, port,
+                                       std::chrono::seconds(negativeTTL));
+      }
       if (!isProxyRequest(req_->getProtocol(), getOption())) {
         e_->getRequestGroupMan()
             ->getOrCreateServerStat(req_->getHost(), req_->getProtocol())
@@ -790,6 +820,7 @@ std::string AbstractCommand::resolveHostname(std::vector<std::string>& addrs,
                              hostname.c_str(),
                              asyncNameResolverMan_->getLastError().c_str()),
                          error_code::NAME_RESOLVE_ERROR);
+    }
     case 0:
       return A2STR::NIL;
 
@@ -800,6 +831,7 @@ std::string AbstractCommand::resolveHostname(std::vector<std::string>& addrs,
                                hostname.c_str(), "No address returned"),
                            error_code::NAME_RESOLVE_ERROR);
       }
+      ttl = asyncNameResolverMan_->getTTL();
       break;
     }
   }
@@ -815,8 +847,11 @@ std::string AbstractCommand::resolveHostname(std::vector<std::string>& addrs,
   }
   A2_LOG_INFO(fmt(MSG_NAME_RESOLUTION_COMPLETE, getCuid(), hostname.c_str(),
                   strjoin(std::begin(addrs), std::end(addrs), ", ").c_str()));
+  if (ttl == 0) {
+    ttl = getOption()->getAsInt(PREF_DNS_CACHE_TTL);
+  }
   for (const auto& addr : addrs) {
-    e_->cacheIPAddress(hostname, addr, port);
+    e_->cacheIPAddress(hostname, addr, port, std::chrono::seconds(ttl));
   }
   ipaddr = e_->findCachedIPAddress(hostname, port);
   return ipaddr;
@@ -930,6 +965,7 @@ const std::shared_ptr<PieceStorage>& AbstractCommand::getPieceStorage() const
 void AbstractCommand::checkSocketRecvBuffer()
 {
   if (socketRecvBuffer_->bufferEmpty() &&
+      !socketRecvBuffer_->hasPendingData() &&
       socket_->getRecvBufferedLength() == 0) {
     return;
   }
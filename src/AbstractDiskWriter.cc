@@ -590,6 +590,22 @@ void AbstractDiskWriter::dropCache(int64_t len, int64_t offset)
 #endif // HAVE_POSIX_FADVISE
 }
 
+void AbstractDiskWriter::readahead(int64_t len, int64_t offset)
+{
+#ifdef HAVE_POSIX_FADVISE
+  posix_fadvise(fd_, offset, len, POSIX_FADV_WILLNEED);
+#endif // HAVE_POSIX_FADVISE
+}
+
+int AbstractDiskWriter::getFd() const
+{
+#ifdef __MINGW32__
+  return -1;
+#else  // !__MINGW32__
+  return fd_;
+#endif // !__MINGW32__
+}
+
 void AbstractDiskWriter::flushOSBuffers()
 {
   if (fd_ == A2_BAD_FD) {
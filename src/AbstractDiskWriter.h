@@ -101,6 +101,10 @@ public:
 
   virtual void dropCache(int64_t len, int64_t offset) CXX11_OVERRIDE;
 
+  virtual void readahead(int64_t len, int64_t offset) CXX11_OVERRIDE;
+
+  virtual int getFd() const CXX11_OVERRIDE;
+
   virtual void flushOSBuffers() CXX11_OVERRIDE;
 };
 
@@ -33,6 +33,9 @@
  */
 /* copyright --> */
 #include "AbstractSingleDiskAdaptor.h"
+
+#include <algorithm>
+
 #include "File.h"
 #include "AdaptiveFileAllocationIterator.h"
 #include "DiskWriter.h"
@@ -94,6 +97,22 @@ ssize_t AbstractSingleDiskAdaptor::readDataDropCache(unsigned char* data,
   return rv;
 }
 
+void AbstractSingleDiskAdaptor::readahead(int64_t len, int64_t offset)
+{
+  diskWriter_->readahead(len, offset);
+}
+
+size_t AbstractSingleDiskAdaptor::getFileRange(int& fd, int64_t& fileOffset,
+                                               size_t len, int64_t offset)
+{
+  fd = diskWriter_->getFd();
+  if (fd == -1 || offset >= totalLength_) {
+    return 0;
+  }
+  fileOffset = offset;
+  return std::min(static_cast<int64_t>(len), totalLength_ - offset);
+}
+
 void AbstractSingleDiskAdaptor::writeCache(const WrDiskCacheEntry* entry)
 {
   for (auto& d : entry->getDataSet()) {
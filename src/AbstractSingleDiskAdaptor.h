@@ -70,6 +70,11 @@ public:
   virtual ssize_t readDataDropCache(unsigned char* data, size_t len,
                                     int64_t offset) CXX11_OVERRIDE;
 
+  virtual void readahead(int64_t len, int64_t offset) CXX11_OVERRIDE;
+
+  virtual size_t getFileRange(int& fd, int64_t& fileOffset, size_t len,
+                              int64_t offset) CXX11_OVERRIDE;
+
   virtual void writeCache(const WrDiskCacheEntry* entry) CXX11_OVERRIDE;
 
   virtual void flushOSBuffers() CXX11_OVERRIDE;
@@ -35,6 +35,7 @@
 #include "AsyncNameResolver.h"
 
 #include <cstring>
+#include <memory>
 
 #include "A2STR.h"
 #include "LogFactory.h"
@@ -48,6 +49,7 @@ void callback(void* arg, int status, int timeouts, struct hostent* host)
   AsyncNameResolver* resolverPtr = reinterpret_cast<AsyncNameResolver*>(arg);
   if (status != ARES_SUCCESS) {
     resolverPtr->error_ = ares_strerror(status);
+    resolverPtr->notFound_ = status == ARES_ENOTFOUND;
     resolverPtr->status_ = AsyncNameResolver::STATUS_ERROR;
     return;
   }
@@ -66,13 +68,57 @@ void callback(void* arg, int status, int timeouts, struct hostent* host)
   }
 }
 
+#ifdef HAVE_ARES_GETADDRINFO
+void addrinfoCallback(void* arg, int status, int timeouts,
+                      struct ares_addrinfo* res)
+{
+  AsyncNameResolver* resolverPtr = reinterpret_cast<AsyncNameResolver*>(arg);
+  if (status != ARES_SUCCESS) {
+    resolverPtr->error_ = ares_strerror(status);
+    resolverPtr->notFound_ = status == ARES_ENOTFOUND;
+    resolverPtr->status_ = AsyncNameResolver::STATUS_ERROR;
+    return;
+  }
+  std::unique_ptr<ares_addrinfo, decltype(&ares_freeaddrinfo)> resDeleter(
+      res, ares_freeaddrinfo);
+  for (auto node = res->nodes; node; node = node->ai_next) {
+    const void* addr;
+    if (node->ai_family == AF_INET) {
+      addr = &reinterpret_cast<sockaddr_in*>(node->ai_addr)->sin_addr;
+    }
+    else if (node->ai_family == AF_INET6) {
+      addr = &reinterpret_cast<sockaddr_in6*>(node->ai_addr)->sin6_addr;
+    }
+    else {
+      continue;
+    }
+    char addrstring[NI_MAXHOST];
+    if (inetNtop(node->ai_family, addr, addrstring, sizeof(addrstring)) != 0) {
+      continue;
+    }
+    resolverPtr->resolvedAddresses_.push_back(addrstring);
+    if (node->ai_ttl > 0 &&
+        (resolverPtr->ttl_ == 0 || node->ai_ttl < resolverPtr->ttl_)) {
+      resolverPtr->ttl_ = node->ai_ttl;
+    }
+  }
+  if (resolverPtr->resolvedAddresses_.empty()) {
+    resolverPtr->error_ = "no address returned or address conversion failed";
+    resolverPtr->status_ = AsyncNameResolver::STATUS_ERROR;
+  }
+  else {
+    resolverPtr->status_ = AsyncNameResolver::STATUS_SUCCESS;
+  }
+}
+#endif // HAVE_ARES_GETADDRINFO
+
 AsyncNameResolver::AsyncNameResolver(int family
 #ifdef HAVE_ARES_ADDR_NODE
                                      ,
                                      ares_addr_node* servers
 #endif // HAVE_ARES_ADDR_NODE
                                      )
-    : status_(STATUS_READY), family_(family)
+    : status_(STATUS_READY), family_(family), ttl_(0), notFound_(false)
 {
   // TODO evaluate return value
   ares_init(&channel_);
@@ -92,7 +138,16 @@ void AsyncNameResolver::resolve(const std::string& name)
 {
   hostname_ = name;
   status_ = STATUS_QUERYING;
+#ifdef HAVE_ARES_GETADDRINFO
+  // Unlike ares_gethostbyname, ares_getaddrinfo reports TTL.
+  ares_addrinfo_hints hints{};
+  hints.ai_family = family_;
+  hints.ai_socktype = SOCK_STREAM;
+  ares_getaddrinfo(channel_, name.c_str(), nullptr, &hints, addrinfoCallback,
+                   this);
+#else  // !HAVE_ARES_GETADDRINFO
   ares_gethostbyname(channel_, name.c_str(), family_, callback, this);
+#endif // !HAVE_ARES_GETADDRINFO
 }
 
 int AsyncNameResolver::getFds(fd_set* rfdsPtr, fd_set* wfdsPtr) const
@@ -129,6 +184,8 @@ void AsyncNameResolver::reset()
 {
   hostname_ = A2STR::NIL;
   resolvedAddresses_.clear();
+  ttl_ = 0;
+  notFound_ = false;
   status_ = STATUS_READY;
   ares_destroy(channel_);
   // TODO evaluate return value
@@ -111,6 +111,36 @@ void AsyncNameResolverMan::getResolvedAddress(
   return;
 }
 
+int AsyncNameResolverMan::getTTL() const
+{
+  int ttl = 0;
+  for (size_t i = 0; i < numResolver_; ++i) {
+    if (asyncNameResolver_[i]->getStatus() ==
+        AsyncNameResolver::STATUS_SUCCESS) {
+      int t = asyncNameResolver_[i]->getTTL();
+      if (t > 0 && (ttl == 0 || t < ttl)) {
+        ttl = t;
+      }
+    }
+  }
+  return ttl;
+}
+
+bool AsyncNameResolverMan::isNotFound() const
+{
+  if (numResolver_ == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < numResolver_; ++i) {
+    if (asyncNameResolver_[i]->getStatus() !=
+            AsyncNameResolver::STATUS_ERROR ||
+        !asyncNameResolver_[i]->isNotFound()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void AsyncNameResolverMan::setNameResolverCheck(DownloadEngine* e,
                                                 Command* command)
 {
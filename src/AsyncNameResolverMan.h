@@ -65,6 +65,12 @@ public:
                   Command* command);
   // Appends resolved addresses to |res|.
   void getResolvedAddress(std::vector<std::string>& res) const;
+  // Returns the minimum TTL of resolved addresses in seconds, or 0 if
+  // it is unknown.
+  int getTTL() const;
+  // Returns true if all resolvers failed because the hostname does
+  // not exist.
+  bool isNotFound() const;
   // Adds resolvers to DownloadEngine to check event notification.
   void setNameResolverCheck(DownloadEngine* e, Command* command);
   // Removes resolvers from DownloadEngine.
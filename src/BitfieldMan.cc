@@ -156,18 +156,15 @@ bool BitfieldMan::hasMissingPiece(const unsigned char* peerBitfield,
   if (bitfieldLength_ != length) {
     return false;
   }
-  bool retval = false;
-  for (size_t i = 0; i < bitfieldLength_; ++i) {
-    unsigned char temp = peerBitfield[i] & ~bitfield_[i];
-    if (filterEnabled_) {
-      temp &= filterBitfield_[i];
-    }
-    if (temp & 0xffu) {
-      retval = true;
-      break;
-    }
+  if (filterEnabled_) {
+    return bitfield::nextSetBit(array(peerBitfield) & ~array(bitfield_) &
+                                    array(filterBitfield_),
+                                blocks_, 0) < blocks_;
+  }
+  else {
+    return bitfield::nextSetBit(array(peerBitfield) & ~array(bitfield_),
+                                blocks_, 0) < blocks_;
   }
-  return retval;
 }
 
 bool BitfieldMan::getFirstMissingUnusedIndex(size_t& index) const
@@ -215,15 +212,7 @@ namespace {
 template <typename Array>
 size_t getStartIndex(size_t index, const Array& bitfield, size_t blocks)
 {
-  while (index < blocks && bitfield::test(bitfield, blocks, index)) {
-    ++index;
-  }
-  if (blocks <= index) {
-    return blocks;
-  }
-  else {
-    return index;
-  }
+  return bitfield::nextUnsetBit(bitfield, blocks, index);
 }
 } // namespace
 
@@ -231,10 +220,7 @@ namespace {
 template <typename Array>
 size_t getEndIndex(size_t index, const Array& bitfield, size_t blocks)
 {
-  while (index < blocks && !bitfield::test(bitfield, blocks, index)) {
-    ++index;
-  }
-  return index;
+  return bitfield::nextSetBit(bitfield, blocks, index);
 }
 } // namespace
 
@@ -389,34 +375,33 @@ bool getInorderMissingUnusedIndex(size_t& index, size_t startIndex,
     index = startIndex;
     return true;
   }
+  // The number of free blocks needed to satisfy minSplitSize.
+  size_t minSplitBlocks = 1;
+  if (minSplitSize > blockLength) {
+    minSplitBlocks = (minSplitSize + blockLength - 1) / blockLength;
+  }
+  // Bits in useBitfield are also set in bitfield, so unset bits in
+  // bitfield are free blocks.
   for (size_t i = startIndex + 1; i < lastIndex;) {
-    if (!bitfield::test(bitfield, blocks, i) &&
-        !bitfield::test(useBitfield, blocks, i)) {
-      // If previous piece has already been retrieved, we can download
-      // from this index.
-      if (!bitfield::test(useBitfield, blocks, i - 1) &&
-          bitfield::test(bitfield, blocks, i - 1)) {
-        index = i;
-        return true;
-      }
-      // Check free space of minSplitSize.  When checking this, we use
-      // blocks instead of lastIndex.
-      size_t j;
-      for (j = i; j < blocks; ++j) {
-        if (bitfield::test(bitfield, blocks, j) ||
-            bitfield::test(useBitfield, blocks, j)) {
-          break;
-        }
-        if (static_cast<int64_t>(j - i + 1) * blockLength >= minSplitSize) {
-          index = j;
-          return true;
-        }
-      }
-      i = j + 1;
+    i = bitfield::nextUnsetBit(bitfield, blocks, i);
+    if (i >= lastIndex) {
+      break;
     }
-    else {
-      ++i;
+    // If previous piece has already been retrieved, we can download
+    // from this index.
+    if (!bitfield::test(useBitfield, blocks, i - 1) &&
+        bitfield::test(bitfield, blocks, i - 1)) {
+      index = i;
+      return true;
+    }
+    // Check free space of minSplitSize.  When checking this, we use
+    // blocks instead of lastIndex.
+    size_t j = bitfield::nextSetBit(bitfield, blocks, i);
+    if (j - i >= minSplitBlocks) {
+      index = i + minSplitBlocks - 1;
+      return true;
     }
+    i = j + 1;
   }
   return false;
 }
@@ -538,9 +523,8 @@ size_t BitfieldMan::countMissingBlock() const { return cachedNumMissingBlock_; }
 size_t BitfieldMan::countMissingBlockNow() const
 {
   if (filterEnabled_) {
-    return bitfield::countSetBit(filterBitfield_, blocks_) -
-           bitfield::countSetBitSlow(array(bitfield_) & array(filterBitfield_),
-                                     blocks_);
+    return bitfield::countSetBitSlow(
+        ~array(bitfield_) & array(filterBitfield_), blocks_);
   }
   else {
     return blocks_ - bitfield::countSetBit(bitfield_, blocks_);
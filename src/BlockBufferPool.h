@@ -0,0 +1,100 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2019 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_BLOCK_BUFFER_POOL_H
+#define D_BLOCK_BUFFER_POOL_H
+
+#include "common.h"
+
+#include <vector>
+#include <memory>
+
+namespace aria2 {
+
+class BlockBufferPool;
+
+// Returns the buffer to BlockBufferPool it was obtained from.
+struct BlockBufferReleaser {
+  BlockBufferPool* pool;
+  void operator()(unsigned char* buf) const;
+};
+
+// Buffer obtained from BlockBufferPool.  The buffer is returned to
+// the pool when this object is destroyed.
+typedef std::unique_ptr<unsigned char[], BlockBufferReleaser> BlockBuffer;
+
+// Pool of fixed size buffers used to hold block data of BitTorrent
+// piece messages.  Released buffers are kept in the free list, up to
+// maxFreeBuffers, and handed out again by acquire().  This avoids
+// allocating and freeing memory for every block sent or received.
+// This class is not thread-safe.
+class BlockBufferPool {
+public:
+  BlockBufferPool(size_t bufferSize, size_t maxFreeBuffers);
+
+  ~BlockBufferPool();
+
+  // Don't allow copying
+  BlockBufferPool(const BlockBufferPool&) = delete;
+  BlockBufferPool& operator=(const BlockBufferPool&) = delete;
+
+  // Returns buffer of getBufferSize() bytes.  The contents of buffer
+  // are undefined.
+  BlockBuffer acquire();
+
+  // Returns buf to this pool.  buf must be the one obtained from
+  // acquire() of this object.
+  void release(unsigned char* buf);
+
+  size_t getBufferSize() const { return bufferSize_; }
+
+  size_t getNumFreeBuffers() const { return freeBuffers_.size(); }
+
+  // Returns the number of acquire() calls served from the free list.
+  uint64_t getHits() const { return hits_; }
+
+  // Returns the number of acquire() calls which allocated new buffer.
+  uint64_t getMisses() const { return misses_; }
+
+private:
+  size_t bufferSize_;
+  size_t maxFreeBuffers_;
+  std::vector<unsigned char*> freeBuffers_;
+  uint64_t hits_;
+  uint64_t misses_;
+};
+
+} // namespace aria2
+
+#endif // D_BLOCK_BUFFER_POOL_H
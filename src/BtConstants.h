@@ -53,6 +53,10 @@ constexpr size_t DEFAULT_MAX_OUTSTANDING_REQUEST = 6;
 // Upper Bound of the number of outstanding request
 constexpr size_t UB_MAX_OUTSTANDING_REQUEST = 256;
 
+// The minimum request round trip time of a peer is forgotten after
+// this period, so that it follows route changes.
+constexpr auto REQUEST_RTT_WINDOW = 10_s;
+
 constexpr size_t METADATA_PIECE_SIZE = 16_k;
 
 constexpr const char LPD_MULTICAST_ADDR[] = "239.192.152.143";
@@ -61,6 +61,12 @@
 #include "WrDiskCacheEntry.h"
 #include "DownloadFailureException.h"
 #include "BtRejectMessage.h"
+#include "PieceHashCheckPool.h"
+#include "BlockBufferPool.h"
+#include "DownloadEngine.h"
+#include "BtRegistry.h"
+#include "BtRuntime.h"
+#include "RequestGroup.h"
 
 namespace aria2 {
 
@@ -73,7 +79,9 @@ BtPieceMessage::BtPieceMessage(size_t index, int32_t begin, int32_t blockLength)
       blockLength_(blockLength),
       data_(nullptr),
       downloadContext_(nullptr),
-      peerStorage_(nullptr)
+      peerStorage_(nullptr),
+      pieceHashCheckPool_(nullptr),
+      blockBufferPool_(nullptr)
 {
   setUploading(true);
 }
@@ -103,6 +111,8 @@ void BtPieceMessage::doReceivedAction()
   downloadContext_->updateDownload(blockLength_);
   if (slot) {
     getPeer()->snubbing(false);
+    getPeer()->updateRequestRtt(
+        slot->getDispatchedTime().difference(global::wallclock()));
     std::shared_ptr<Piece> piece = getPieceStorage()->getPiece(index_);
     int64_t offset =
         static_cast<int64_t>(index_) * downloadContext_->getPieceLength() +
@@ -118,10 +128,19 @@ void BtPieceMessage::doReceivedAction()
     if (piece->getWrDiskCacheEntry()) {
       // Write Disk Cache enabled. Unfortunately, it incurs extra data
       // copy.
-      auto dataCopy = new unsigned char[blockLength_];
-      memcpy(dataCopy, data_ + 9, blockLength_);
-      piece->updateWrCache(getPieceStorage()->getWrDiskCache(), dataCopy, 0,
-                           blockLength_, blockLength_, offset);
+      if (blockBufferPool_ && static_cast<size_t>(blockLength_) <=
+                                  blockBufferPool_->getBufferSize()) {
+        auto dataCopy = blockBufferPool_->acquire();
+        memcpy(dataCopy.get(), data_ + 9, blockLength_);
+        piece->updateWrCache(getPieceStorage()->getWrDiskCache(),
+                             std::move(dataCopy), blockLength_, offset);
+      }
+      else {
+        auto dataCopy = new unsigned char[blockLength_];
+        memcpy(dataCopy, data_ + 9, blockLength_);
+        piece->updateWrCache(getPieceStorage()->getWrDiskCache(), dataCopy, 0,
+                             blockLength_, blockLength_, offset);
+      }
     }
     else {
       getPieceStorage()->getDiskAdaptor()->writeData(data_ + 9, blockLength_,
@@ -134,7 +153,10 @@ void BtPieceMessage::doReceivedAction()
     piece->updateHash(begin_, data_ + 9, blockLength_);
     getBtMessageDispatcher()->removeOutstandingRequest(slot);
     if (piece->pieceComplete()) {
-      if (checkPieceHash(piece)) {
+      if (shouldCheckPieceHashAsync(piece)) {
+        submitPieceHashCheck(piece);
+      }
+      else if (checkPieceHash(piece)) {
         onNewPiece(piece);
       }
       else {
@@ -215,6 +237,38 @@ void BtPieceMessage::send()
 void BtPieceMessage::pushPieceData(int64_t offset, int32_t length) const
 {
   assert(length <= static_cast<int32_t>(MAX_BLOCK_LENGTH));
+  if (getPeerConnection()->isSendfileAvailable()) {
+    // Only the message header is copied.  Piece data is sent directly
+    // from file when send buffer reaches it.
+    auto header = std::vector<unsigned char>(MESSAGE_HEADER_LENGTH);
+    createMessageHeader(header.data());
+    const auto& peer = getPeer();
+    getPeerConnection()->pushBytes(std::move(header));
+    getPeerConnection()->pushFileRange(
+        getPieceStorage()->getDiskAdaptor(), offset, length,
+        make_unique<PieceSendUpdate>(downloadContext_, peer, 0));
+    peer->updateUploadSpeed(length);
+    downloadContext_->updateUploadSpeed(length);
+    return;
+  }
+  if (blockBufferPool_ && length + MESSAGE_HEADER_LENGTH <=
+                              blockBufferPool_->getBufferSize()) {
+    auto buf = blockBufferPool_->acquire();
+    createMessageHeader(buf.get());
+    ssize_t r = getPieceStorage()->getDiskAdaptor()->readData(
+        buf.get() + MESSAGE_HEADER_LENGTH, length, offset);
+    if (r != length) {
+      throw DL_ABORT_EX(EX_DATA_READ);
+    }
+    const auto& peer = getPeer();
+    getPeerConnection()->pushBlockBuffer(
+        std::move(buf), length + MESSAGE_HEADER_LENGTH,
+        make_unique<PieceSendUpdate>(downloadContext_, peer,
+                                     MESSAGE_HEADER_LENGTH));
+    peer->updateUploadSpeed(length);
+    downloadContext_->updateUploadSpeed(length);
+    return;
+  }
   auto buf = std::vector<unsigned char>(length + MESSAGE_HEADER_LENGTH);
   createMessageHeader(buf.data());
   ssize_t r;
@@ -262,36 +316,138 @@ bool BtPieceMessage::checkPieceHash(const std::shared_ptr<Piece>& piece)
   }
 }
 
-void BtPieceMessage::onNewPiece(const std::shared_ptr<Piece>& piece)
+namespace {
+void completeNewPiece(cuid_t cuid, const std::shared_ptr<Piece>& piece,
+                      PieceStorage* pieceStorage)
 {
   if (piece->getWrDiskCacheEntry()) {
     // We flush cached data whenever an whole piece is retrieved.
-    piece->flushWrCache(getPieceStorage()->getWrDiskCache());
+    piece->flushWrCache(pieceStorage->getWrDiskCache());
     if (piece->getWrDiskCacheEntry()->getError() !=
         WrDiskCacheEntry::CACHE_ERR_SUCCESS) {
-      piece->clearAllBlock(getPieceStorage()->getWrDiskCache());
+      piece->clearAllBlock(pieceStorage->getWrDiskCache());
       throw DOWNLOAD_FAILURE_EXCEPTION2(
           fmt("Write disk cache flush failure index=%lu",
               static_cast<unsigned long>(piece->getIndex())),
           piece->getWrDiskCacheEntry()->getErrorCode());
     }
   }
-  A2_LOG_INFO(fmt(MSG_GOT_NEW_PIECE, getCuid(),
+  A2_LOG_INFO(fmt(MSG_GOT_NEW_PIECE, cuid,
                   static_cast<unsigned long>(piece->getIndex())));
-  getPieceStorage()->completePiece(piece);
-  getPieceStorage()->advertisePiece(getCuid(), piece->getIndex(),
-                                    global::wallclock());
+  pieceStorage->completePiece(piece);
+  pieceStorage->advertisePiece(cuid, piece->getIndex(), global::wallclock());
 }
+} // namespace
 
-void BtPieceMessage::onWrongPiece(const std::shared_ptr<Piece>& piece)
+namespace {
+void discardWrongPiece(cuid_t cuid, const std::shared_ptr<Piece>& piece,
+                       PieceStorage* pieceStorage)
 {
-  A2_LOG_INFO(fmt(MSG_GOT_WRONG_PIECE, getCuid(),
+  A2_LOG_INFO(fmt(MSG_GOT_WRONG_PIECE, cuid,
                   static_cast<unsigned long>(piece->getIndex())));
-  piece->clearAllBlock(getPieceStorage()->getWrDiskCache());
+  piece->clearAllBlock(pieceStorage->getWrDiskCache());
   piece->destroyHashContext();
+}
+} // namespace
+
+void BtPieceMessage::onNewPiece(const std::shared_ptr<Piece>& piece)
+{
+  completeNewPiece(getCuid(), piece, getPieceStorage());
+}
+
+void BtPieceMessage::onWrongPiece(const std::shared_ptr<Piece>& piece)
+{
+  discardWrongPiece(getCuid(), piece, getPieceStorage());
   getBtRequestFactory()->removeTargetPiece(piece);
 }
 
+namespace {
+class BtPieceHashCheckJob : public PieceHashCheckJob {
+public:
+  BtPieceHashCheckJob(std::string hashType, std::string expectedDigest,
+                      std::vector<unsigned char> data, a2_gid_t gid,
+                      cuid_t cuid, std::shared_ptr<Piece> piece,
+                      std::shared_ptr<Peer> peer)
+      : PieceHashCheckJob(std::move(hashType), std::move(expectedDigest),
+                          std::move(data)),
+        gid_(gid),
+        cuid_(cuid),
+        piece_(std::move(piece)),
+        peer_(std::move(peer))
+  {
+  }
+
+  virtual void onHashChecked(DownloadEngine* e) CXX11_OVERRIDE
+  {
+    // The download might be stopped or removed while the hash was
+    // being computed.  In that case, the piece is no longer ours.
+    auto btObject = e->getBtRegistry()->get(gid_);
+    if (!btObject || btObject->btRuntime->isHalt()) {
+      A2_LOG_DEBUG(fmt("Discarded hash check result index=%lu",
+                       static_cast<unsigned long>(piece_->getIndex())));
+      return;
+    }
+    auto pieceStorage = btObject->pieceStorage.get();
+    if (isMatched()) {
+      try {
+        completeNewPiece(cuid_, piece_, pieceStorage);
+      }
+      catch (DownloadFailureException& ex) {
+        A2_LOG_ERROR_EX(EX_DOWNLOAD_ABORTED, ex);
+        auto group = btObject->downloadContext->getOwnerRequestGroup();
+        group->setLastErrorCode(ex.getErrorCode(), ex.what());
+        group->setHaltRequested(true);
+        e->setRefreshInterval(std::chrono::milliseconds(0));
+      }
+      return;
+    }
+    discardWrongPiece(cuid_, piece_, pieceStorage);
+    // BtRequestFactory has already dropped this piece from its target
+    // pieces when it was completed.  Just release it.
+    pieceStorage->cancelPiece(piece_, cuid_);
+    btObject->peerStorage->addBadPeer(peer_->getIPAddress());
+    if (peer_->isActive() && peer_->usedBy() == cuid_) {
+      peer_->badPieceReceived(true);
+    }
+  }
+
+private:
+  a2_gid_t gid_;
+  cuid_t cuid_;
+  std::shared_ptr<Piece> piece_;
+  std::shared_ptr<Peer> peer_;
+};
+} // namespace
+
+bool BtPieceMessage::shouldCheckPieceHashAsync(
+    const std::shared_ptr<Piece>& piece) const
+{
+  // If hash was computed incrementally, what remains is just to
+  // finalize it.
+  return pieceHashCheckPool_ &&
+         (getPieceStorage()->isEndGame() || !piece->isHashCalculated());
+}
+
+void BtPieceMessage::submitPieceHashCheck(const std::shared_ptr<Piece>& piece)
+{
+  A2_LOG_DEBUG(fmt("Submitting hash check index=%lu",
+                   static_cast<unsigned long>(piece->getIndex())));
+  std::vector<unsigned char> data;
+  try {
+    data = piece->getDataWithWrCache(downloadContext_->getPieceLength(),
+                                     getPieceStorage()->getDiskAdaptor());
+  }
+  catch (RecoverableException& e) {
+    piece->clearAllBlock(getPieceStorage()->getWrDiskCache());
+    throw;
+  }
+  pieceHashCheckPool_->submit(make_unique<BtPieceHashCheckJob>(
+      downloadContext_->getPieceHashType(),
+      downloadContext_->getPieceHash(piece->getIndex()), std::move(data),
+      downloadContext_->getOwnerRequestGroup()->getGID(), getCuid(), piece,
+      getPeer()));
+}
+
 void BtPieceMessage::onChokingEvent(const BtChokingEvent& event)
 {
   if (!isInvalidate() && !getPeer()->isInAmAllowedIndexSet(index_)) {
@@ -332,4 +488,14 @@ void BtPieceMessage::setPeerStorage(PeerStorage* peerStorage)
   peerStorage_ = peerStorage;
 }
 
+void BtPieceMessage::setPieceHashCheckPool(PieceHashCheckPool* pool)
+{
+  pieceHashCheckPool_ = pool;
+}
+
+void BtPieceMessage::setBlockBufferPool(BlockBufferPool* pool)
+{
+  blockBufferPool_ = pool;
+}
+
 } // namespace aria2
@@ -42,6 +42,8 @@ namespace aria2 {
 class Piece;
 class DownloadContext;
 class PeerStorage;
+class PieceHashCheckPool;
+class BlockBufferPool;
 
 class BtPieceMessage : public AbstractBtMessage {
 private:
@@ -51,9 +53,17 @@ private:
   const unsigned char* data_;
   DownloadContext* downloadContext_;
   PeerStorage* peerStorage_;
+  PieceHashCheckPool* pieceHashCheckPool_;
+  BlockBufferPool* blockBufferPool_;
 
   bool checkPieceHash(const std::shared_ptr<Piece>& piece);
 
+  // Returns true if the hash of piece should be computed by
+  // pieceHashCheckPool_ rather than in place.
+  bool shouldCheckPieceHashAsync(const std::shared_ptr<Piece>& piece) const;
+
+  void submitPieceHashCheck(const std::shared_ptr<Piece>& piece);
+
   void onNewPiece(const std::shared_ptr<Piece>& piece);
 
   void onWrongPiece(const std::shared_ptr<Piece>& piece);
@@ -91,6 +101,12 @@ public:
 
   void setPeerStorage(PeerStorage* peerStorage);
 
+  void setPieceHashCheckPool(PieceHashCheckPool* pool);
+
+  // Buffers for block data are taken from pool if block fits in its
+  // buffer.  pool can be null.
+  void setBlockBufferPool(BlockBufferPool* pool);
+
   static std::unique_ptr<BtPieceMessage> create(const unsigned char* data,
                                                 size_t dataLength);
 
@@ -54,11 +54,12 @@ CheckIntegrityCommand::CheckIntegrityCommand(cuid_t cuid,
                                              CheckIntegrityEntry* entry)
     : RealtimeCommand{cuid, requestGroup, e}, entry_{entry}
 {
+  entry_->setPieceHashCheckPool(e->getPieceHashCheckPool());
 }
 
 CheckIntegrityCommand::~CheckIntegrityCommand()
 {
-  getDownloadEngine()->getCheckIntegrityMan()->dropPickedEntry();
+  getDownloadEngine()->getCheckIntegrityMan()->dropPickedEntry(entry_);
 }
 
 bool CheckIntegrityCommand::executeInternal()
@@ -92,6 +93,11 @@ bool CheckIntegrityCommand::executeInternal()
     return true;
   }
   else {
+    if (entry_->waitingForResult()) {
+      // Don't run until the result of a hash check job arrives.
+      // The job wakes up the engine when it finishes.
+      setStatus(Command::STATUS_INACTIVE);
+    }
     getDownloadEngine()->addCommand(std::unique_ptr<Command>(this));
     return false;
   }
@@ -76,6 +76,18 @@ int64_t CheckIntegrityEntry::getCurrentLength()
 
 bool CheckIntegrityEntry::finished() { return validator_->finished(); }
 
+bool CheckIntegrityEntry::waitingForResult() const
+{
+  return validator_ && validator_->waitingForResult();
+}
+
+void CheckIntegrityEntry::setPieceHashCheckPool(PieceHashCheckPool* pool)
+{
+  if (validator_) {
+    validator_->setPieceHashCheckPool(pool);
+  }
+}
+
 void CheckIntegrityEntry::cutTrailingGarbage()
 {
   getRequestGroup()->getPieceStorage()->getDiskAdaptor()->cutTrailingGarbage();
@@ -47,6 +47,7 @@ namespace aria2 {
 class IteratableValidator;
 class DownloadEngine;
 class FileAllocationEntry;
+class PieceHashCheckPool;
 
 class CheckIntegrityEntry : public RequestGroupEntry,
                             public ProgressAwareEntry {
@@ -75,10 +76,17 @@ public:
 
   virtual bool finished() CXX11_OVERRIDE;
 
+  // Returns true if validateChunk() makes no progress until a hash
+  // check job finishes.
+  bool waitingForResult() const;
+
   virtual bool isValidationReady() = 0;
 
   virtual void initValidator() = 0;
 
+  // Must be called after initValidator().
+  void setPieceHashCheckPool(PieceHashCheckPool* pool);
+
   virtual void
   onDownloadFinished(std::vector<std::unique_ptr<Command>>& commands,
                      DownloadEngine* e) = 0;
@@ -347,7 +347,7 @@ void ConsoleStatCalc::calculateStat(const DownloadEngine* e)
   }
 
   {
-    auto& entry = e->getFileAllocationMan()->getPickedEntry();
+    auto entry = e->getFileAllocationMan()->getPickedEntry();
     if (entry) {
       o << " [FileAlloc:#"
         << GroupId::toAbbrevHex(entry->getRequestGroup()->getGID()) << " "
@@ -366,8 +366,8 @@ void ConsoleStatCalc::calculateStat(const DownloadEngine* e)
     }
   }
   {
-    auto& entry = e->getCheckIntegrityMan()->getPickedEntry();
-    if (entry) {
+    auto& entries = e->getCheckIntegrityMan()->getPickedEntries();
+    for (auto& entry : entries) {
       o << " [Checksum:#"
         << GroupId::toAbbrevHex(entry->getRequestGroup()->getGID()) << " "
         << sizeFormatter(entry->getCurrentLength()) << "B/"
@@ -379,9 +379,9 @@ void ConsoleStatCalc::calculateStat(const DownloadEngine* e)
         o << "--";
       }
       o << "%)]";
-      if (e->getCheckIntegrityMan()->hasNext()) {
-        o << "(+" << e->getCheckIntegrityMan()->countEntryInQueue() << ")";
-      }
+    }
+    if (!entries.empty() && e->getCheckIntegrityMan()->hasNext()) {
+      o << "(+" << e->getCheckIntegrityMan()->countEntryInQueue() << ")";
     }
   }
   if (isTTY_) {
@@ -71,7 +71,7 @@ std::string DHTAbstractMessage::getBencodedMessage()
 bool DHTAbstractMessage::send()
 {
   std::string message = getBencodedMessage();
-  ssize_t r = connection_->sendMessage(
+  ssize_t r = connection_->queueMessage(
       reinterpret_cast<const unsigned char*>(message.c_str()), message.size(),
       getRemoteNode()->getIPAddress(), getRemoteNode()->getPort());
   assert(r >= 0);
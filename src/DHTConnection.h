@@ -41,6 +41,8 @@
 
 namespace aria2 {
 
+struct Datagram;
+
 class DHTConnection {
 public:
   virtual ~DHTConnection() = default;
@@ -48,8 +50,21 @@ public:
   virtual ssize_t receiveMessage(unsigned char* data, size_t len,
                                  std::string& host, uint16_t& port) = 0;
 
+  // Receives at most n datagrams at once.  Returns the number of
+  // datagrams received.
+  virtual size_t receiveMessages(Datagram* dgrams, size_t n) = 0;
+
   virtual ssize_t sendMessage(const unsigned char* data, size_t len,
                               const std::string& host, uint16_t port) = 0;
+
+  // Queues a datagram to be sent by flush().  Returns len, or 0 if the
+  // queue is full and cannot be flushed without blocking.
+  virtual ssize_t queueMessage(const unsigned char* data, size_t len,
+                               const std::string& host, uint16_t port) = 0;
+
+  // Sends queued datagrams.  Datagrams which cannot be sent without
+  // blocking are kept in the queue.
+  virtual void flush() = 0;
 };
 
 } // namespace aria2
@@ -44,11 +44,15 @@
 #include "SocketCore.h"
 #include "SimpleRandomizer.h"
 #include "fmt.h"
+#include "DHTConstants.h"
 
 namespace aria2 {
 
 DHTConnectionImpl::DHTConnectionImpl(int family)
-    : socket_(std::make_shared<SocketCore>(SOCK_DGRAM)), family_(family)
+    : socket_(std::make_shared<SocketCore>(SOCK_DGRAM)),
+      family_(family),
+      outbox_(DHT_DATAGRAM_BATCH_SIZE),
+      numQueued_(0)
 {
 }
 
@@ -102,10 +106,61 @@ ssize_t DHTConnectionImpl::receiveMessage(unsigned char* data, size_t len,
   return length;
 }
 
+size_t DHTConnectionImpl::receiveMessages(Datagram* dgrams, size_t n)
+{
+  return socket_->readDataFromBatch(dgrams, n);
+}
+
 ssize_t DHTConnectionImpl::sendMessage(const unsigned char* data, size_t len,
                                        const std::string& host, uint16_t port)
 {
   return socket_->writeData(data, len, host, port);
 }
 
+ssize_t DHTConnectionImpl::queueMessage(const unsigned char* data, size_t len,
+                                        const std::string& host,
+                                        uint16_t port)
+{
+  if (numQueued_ == outbox_.size()) {
+    flush();
+    if (numQueued_ == outbox_.size()) {
+      return 0;
+    }
+  }
+  auto& dgram = outbox_[numQueued_++];
+  dgram.buf.assign(data, data + len);
+  dgram.len = len;
+  dgram.endpoint.addr = host;
+  dgram.endpoint.family = family_;
+  dgram.endpoint.port = port;
+  return len;
+}
+
+void DHTConnectionImpl::flush()
+{
+  size_t i = 0;
+  while (i < numQueued_) {
+    try {
+      auto r = socket_->writeDataBatch(outbox_.data() + i, numQueued_ - i);
+      if (r == 0) {
+        break;
+      }
+      i += r;
+    }
+    catch (RecoverableException& e) {
+      // UDP gives no delivery guarantee anyway.  A dropped query just
+      // times out in DHTMessageTracker.
+      A2_LOG_INFO_EX(fmt("Failed to send UDP datagram to %s:%u",
+                         outbox_[i].endpoint.addr.c_str(),
+                         outbox_[i].endpoint.port),
+                     e);
+      ++i;
+    }
+  }
+  for (size_t j = i; j < numQueued_; ++j) {
+    std::swap(outbox_[j - i], outbox_[j]);
+  }
+  numQueued_ -= i;
+}
+
 } // namespace aria2
@@ -38,19 +38,25 @@
 #include "DHTConnection.h"
 
 #include <memory>
+#include <vector>
 
 #include "SegList.h"
+#include "SocketCore.h"
 
 namespace aria2 {
 
-class SocketCore;
-
 class DHTConnectionImpl : public DHTConnection {
 private:
   std::shared_ptr<SocketCore> socket_;
 
   int family_;
 
+  // Datagrams queued by queueMessage().  Only the first numQueued_
+  // elements are used; the rest are kept to reuse their buffers.
+  std::vector<Datagram> outbox_;
+
+  size_t numQueued_;
+
 public:
   DHTConnectionImpl(int family);
 
@@ -81,10 +87,20 @@ public:
                                  std::string& host,
                                  uint16_t& port) CXX11_OVERRIDE;
 
+  virtual size_t receiveMessages(Datagram* dgrams, size_t n) CXX11_OVERRIDE;
+
   virtual ssize_t sendMessage(const unsigned char* data, size_t len,
                               const std::string& host,
                               uint16_t port) CXX11_OVERRIDE;
 
+  virtual ssize_t queueMessage(const unsigned char* data, size_t len,
+                               const std::string& host,
+                               uint16_t port) CXX11_OVERRIDE;
+
+  virtual void flush() CXX11_OVERRIDE;
+
+  size_t countQueuedMessage() const { return numQueued_; }
+
   const std::shared_ptr<SocketCore>& getSocket() const { return socket_; }
 };
 
@@ -66,6 +66,19 @@ constexpr auto DHT_PEER_ANNOUNCE_CHECK_INTERVAL = 5_min;
 
 constexpr auto DHT_TOKEN_UPDATE_INTERVAL = 10_min;
 
+// Maximum number of UDP datagrams received or sent by one system
+// call.
+constexpr size_t DHT_DATAGRAM_BATCH_SIZE = 16;
+
+// Size of the buffer for each received UDP datagram.  DHT messages
+// and UDP tracker responses are far smaller than this.
+constexpr size_t DHT_DATAGRAM_BUFFER_SIZE = 16_k;
+
+// Maximum number of UDP datagrams processed in one execution of
+// DHTInteractionCommand, so that a flood of DHT traffic does not
+// stall other commands.
+constexpr size_t DHT_MAX_DATAGRAMS_PER_TICK = 1024;
+
 } // namespace aria2
 
 #endif // D_DHT_CONSTANTS_H
@@ -55,6 +55,7 @@
 #include "fmt.h"
 #include "wallclock.h"
 #include "TrackerWatcherCommand.h"
+#include "DHTConstants.h"
 
 namespace aria2 {
 
@@ -65,8 +66,12 @@ DHTInteractionCommand::DHTInteractionCommand(cuid_t cuid, DownloadEngine* e)
       e_{e},
       dispatcher_{nullptr},
       receiver_{nullptr},
-      taskQueue_{nullptr}
+      taskQueue_{nullptr},
+      inbox_(DHT_DATAGRAM_BATCH_SIZE)
 {
+  for (auto& dgram : inbox_) {
+    dgram.buf.resize(DHT_DATAGRAM_BUFFER_SIZE);
+  }
   setStatusRealtime();
 }
 
@@ -109,35 +114,17 @@ bool DHTInteractionCommand::execute()
 
   taskQueue_->executeTask();
 
-  std::string remoteAddr;
-  uint16_t remotePort;
-  std::array<unsigned char, 64_k> data;
   try {
-    while (1) {
-      ssize_t length = connection_->receiveMessage(data.data(), data.size(),
-                                                   remoteAddr, remotePort);
-      if (length <= 0) {
+    // Datagrams left in the socket buffer are processed in the next
+    // execution.
+    for (size_t total = 0; total < DHT_MAX_DATAGRAMS_PER_TICK;) {
+      auto n = connection_->receiveMessages(inbox_.data(), inbox_.size());
+      if (n == 0) {
         break;
       }
-      if (data[0] == 'd') {
-        // udp tracker response does not start with 'd', so assume
-        // this message belongs to DHT. nothrow.
-        receiver_->receiveMessage(remoteAddr, remotePort, data.data(), length);
-      }
-      else {
-        // this may be udp tracker response. nothrow.
-        std::shared_ptr<UDPTrackerRequest> req;
-        if (udpTrackerClient_->receiveReply(req, data.data(), length,
-                                            remoteAddr, remotePort,
-                                            global::wallclock()) == 0) {
-          if (req->action == UDPT_ACT_ANNOUNCE) {
-            auto c = static_cast<TrackerWatcherCommand*>(req->user_data);
-            if (c) {
-              c->setStatus(Command::STATUS_ONESHOT_REALTIME);
-              e_->setNoWait(true);
-            }
-          }
-        }
+      total += n;
+      for (size_t i = 0; i < n; ++i) {
+        handleDatagram(inbox_[i]);
       }
     }
   }
@@ -147,6 +134,9 @@ bool DHTInteractionCommand::execute()
   receiver_->handleTimeout();
   udpTrackerClient_->handleTimeout(global::wallclock());
   dispatcher_->sendMessages();
+  std::string remoteAddr;
+  uint16_t remotePort;
+  std::array<unsigned char, 64_k> data;
   while (!udpTrackerClient_->getPendingRequests().empty()) {
     // no throw
     ssize_t length = udpTrackerClient_->createRequest(
@@ -156,7 +146,13 @@ bool DHTInteractionCommand::execute()
     }
     try {
       // throw
-      connection_->sendMessage(data.data(), length, remoteAddr, remotePort);
+      if (connection_->queueMessage(data.data(), length, remoteAddr,
+                                    remotePort) == 0) {
+        // Socket buffer is full.  Try again in the next tick.
+        break;
+      }
+      // A datagram lost in flush() is resent by timeout, just like
+      // the one lost in the network.
       udpTrackerClient_->requestSent(global::wallclock());
     }
     catch (RecoverableException& e) {
@@ -164,10 +160,41 @@ bool DHTInteractionCommand::execute()
       udpTrackerClient_->requestFail(UDPT_ERR_NETWORK);
     }
   }
+  connection_->flush();
   e_->addRoutineCommand(std::unique_ptr<Command>(this));
   return false;
 }
 
+void DHTInteractionCommand::handleDatagram(Datagram& dgram)
+{
+  if (dgram.len == 0) {
+    return;
+  }
+  auto& remoteAddr = dgram.endpoint.addr;
+  auto remotePort = dgram.endpoint.port;
+  if (dgram.buf[0] == 'd') {
+    // udp tracker response does not start with 'd', so assume
+    // this message belongs to DHT. nothrow.
+    receiver_->receiveMessage(remoteAddr, remotePort, dgram.buf.data(),
+                              dgram.len);
+  }
+  else {
+    // this may be udp tracker response. nothrow.
+    std::shared_ptr<UDPTrackerRequest> req;
+    if (udpTrackerClient_->receiveReply(req, dgram.buf.data(), dgram.len,
+                                        remoteAddr, remotePort,
+                                        global::wallclock()) == 0) {
+      if (req->action == UDPT_ACT_ANNOUNCE) {
+        auto c = static_cast<TrackerWatcherCommand*>(req->user_data);
+        if (c) {
+          c->setStatus(Command::STATUS_ONESHOT_REALTIME);
+          e_->setNoWait(true);
+        }
+      }
+    }
+  }
+}
+
 void DHTInteractionCommand::setMessageDispatcher(
     DHTMessageDispatcher* dispatcher)
 {
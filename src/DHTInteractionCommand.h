@@ -38,6 +38,9 @@
 #include "Command.h"
 
 #include <memory>
+#include <vector>
+
+#include "SocketCore.h"
 
 namespace aria2 {
 
@@ -45,7 +48,6 @@ class DHTMessageDispatcher;
 class DHTMessageReceiver;
 class DHTTaskQueue;
 class DownloadEngine;
-class SocketCore;
 class DHTConnection;
 class UDPTrackerClient;
 
@@ -59,6 +61,11 @@ private:
   std::unique_ptr<DHTConnection> connection_;
   std::shared_ptr<UDPTrackerClient> udpTrackerClient_;
 
+  // Receive buffers for a batch of datagrams
+  std::vector<Datagram> inbox_;
+
+  void handleDatagram(Datagram& dgram);
+
 public:
   DHTInteractionCommand(cuid_t cuid, DownloadEngine* e);
 
@@ -60,9 +60,27 @@ void DHTMessageTracker::addMessage(DHTMessage* message,
                                    std::chrono::seconds timeout,
                                    std::unique_ptr<DHTMessageCallback> callback)
 {
-  entries_.push_back(make_unique<DHTMessageTrackerEntry>(
+  auto entry = make_unique<DHTMessageTrackerEntry>(
       message->getRemoteNode(), message->getTransactionID(),
-      message->getMessageType(), std::move(timeout), std::move(callback)));
+      message->getMessageType(), std::move(timeout), std::move(callback));
+  auto deadline = entry->getDeadline();
+  auto i = timeouts_.insert(std::make_pair(deadline, std::move(entry)));
+  entries_.insert(std::make_pair(message->getTransactionID(), i));
+}
+
+std::unique_ptr<DHTMessageTrackerEntry>
+DHTMessageTracker::popEntry(TimeoutMap::iterator i)
+{
+  auto range = entries_.equal_range((*i).second->getTransactionID());
+  for (auto j = range.first; j != range.second; ++j) {
+    if ((*j).second == i) {
+      entries_.erase(j);
+      break;
+    }
+  }
+  auto entry = std::move((*i).second);
+  timeouts_.erase(i);
+  return entry;
 }
 
 std::pair<std::unique_ptr<DHTResponseMessage>,
@@ -77,10 +95,10 @@ DHTMessageTracker::messageArrived(const Dict* dict, const std::string& ipaddr,
   }
   A2_LOG_DEBUG(fmt("Searching tracker entry for TransactionID=%s, Remote=%s:%u",
                    util::toHex(tid->s()).c_str(), ipaddr.c_str(), port));
-  for (auto i = std::begin(entries_), eoi = std::end(entries_); i != eoi; ++i) {
-    if ((*i)->match(tid->s(), ipaddr, port)) {
-      auto entry = std::move(*i);
-      entries_.erase(i);
+  auto range = entries_.equal_range(tid->s());
+  for (auto i = range.first; i != range.second; ++i) {
+    if ((*(*i).second).second->match(tid->s(), ipaddr, port)) {
+      auto entry = popEntry((*i).second);
       A2_LOG_DEBUG("Tracker entry found.");
       auto& targetNode = entry->getTargetNode();
       try {
@@ -142,24 +160,20 @@ void DHTMessageTracker::handleTimeoutEntry(DHTMessageTrackerEntry* entry)
 
 void DHTMessageTracker::handleTimeout()
 {
-  entries_.erase(
-      std::remove_if(std::begin(entries_), std::end(entries_),
-                     [&](const std::unique_ptr<DHTMessageTrackerEntry>& ent) {
-                       if (ent->isTimeout()) {
-                         handleTimeoutEntry(ent.get());
-                         return true;
-                       }
-                       else {
-                         return false;
-                       }
-                     }),
-      std::end(entries_));
+  // Entries are popped before handleTimeoutEntry() is called, so
+  // that callbacks are free to add new messages.
+  while (!timeouts_.empty() && (*timeouts_.begin()).second->isTimeout()) {
+    auto entry = popEntry(timeouts_.begin());
+    handleTimeoutEntry(entry.get());
+  }
 }
 
 const DHTMessageTrackerEntry*
 DHTMessageTracker::getEntryFor(const DHTMessage* message) const
 {
-  for (auto& ent : entries_) {
+  auto range = entries_.equal_range(message->getTransactionID());
+  for (auto i = range.first; i != range.second; ++i) {
+    auto& ent = (*(*i).second).second;
     if (ent->match(message->getTransactionID(),
                    message->getRemoteNode()->getIPAddress(),
                    message->getRemoteNode()->getPort())) {
@@ -169,7 +183,7 @@ DHTMessageTracker::getEntryFor(const DHTMessage* message) const
   return nullptr;
 }
 
-size_t DHTMessageTracker::countEntry() const { return entries_.size(); }
+size_t DHTMessageTracker::countEntry() const { return timeouts_.size(); }
 
 void DHTMessageTracker::setRoutingTable(DHTRoutingTable* routingTable)
 {
@@ -38,11 +38,13 @@
 #include "common.h"
 
 #include <utility>
-#include <deque>
+#include <map>
+#include <unordered_map>
 #include <memory>
 
 #include "a2time.h"
 #include "ValueBase.h"
+#include "TimerA2.h"
 
 namespace aria2 {
 
@@ -53,14 +55,30 @@ class DHTRoutingTable;
 class DHTMessageFactory;
 class DHTMessageTrackerEntry;
 
+// Keeps track of outstanding DHT queries.  Entries are owned by
+// timeouts_, which is ordered by deadline, so that handleTimeout()
+// only looks at the entries which are actually timed out.  Incoming
+// replies are looked up through entries_, which is keyed by
+// transaction ID.  Both operations are independent of the number of
+// outstanding queries.
 class DHTMessageTracker {
 private:
-  std::deque<std::unique_ptr<DHTMessageTrackerEntry>> entries_;
+  typedef std::multimap<Timer::Clock::time_point,
+                        std::unique_ptr<DHTMessageTrackerEntry>>
+      TimeoutMap;
+
+  TimeoutMap timeouts_;
+
+  std::unordered_multimap<std::string, TimeoutMap::iterator> entries_;
 
   DHTRoutingTable* routingTable_;
 
   DHTMessageFactory* factory_;
 
+  // Removes the entry pointed by |i| from both timeouts_ and
+  // entries_ and returns it.
+  std::unique_ptr<DHTMessageTrackerEntry> popEntry(TimeoutMap::iterator i);
+
 public:
   DHTMessageTracker();
 
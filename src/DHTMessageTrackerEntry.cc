@@ -60,6 +60,11 @@ bool DHTMessageTrackerEntry::isTimeout() const
   return dispatchedTime_.difference(global::wallclock()) >= timeout_;
 }
 
+Timer::Clock::time_point DHTMessageTrackerEntry::getDeadline() const
+{
+  return dispatchedTime_.getTime() + timeout_;
+}
+
 void DHTMessageTrackerEntry::extendTimeout() {}
 
 bool DHTMessageTrackerEntry::match(const std::string& transactionID,
@@ -91,6 +96,11 @@ const std::shared_ptr<DHTNode>& DHTMessageTrackerEntry::getTargetNode() const
   return targetNode_;
 }
 
+const std::string& DHTMessageTrackerEntry::getTransactionID() const
+{
+  return transactionID_;
+}
+
 const std::string& DHTMessageTrackerEntry::getMessageType() const
 {
   return messageType_;
@@ -72,12 +72,16 @@ public:
 
   bool isTimeout() const;
 
+  // Returns the time when this entry times out.
+  Timer::Clock::time_point getDeadline() const;
+
   void extendTimeout();
 
   bool match(const std::string& transactionID, const std::string& ipaddr,
              uint16_t port) const;
 
   const std::shared_ptr<DHTNode>& getTargetNode() const;
+  const std::string& getTransactionID() const;
   const std::string& getMessageType() const;
   const std::unique_ptr<DHTMessageCallback>& getCallback() const;
   std::unique_ptr<DHTMessageCallback> popCallback();
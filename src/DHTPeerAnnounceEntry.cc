@@ -49,16 +49,31 @@ DHTPeerAnnounceEntry::DHTPeerAnnounceEntry(const unsigned char* infoHash)
 
 DHTPeerAnnounceEntry::~DHTPeerAnnounceEntry() = default;
 
-void DHTPeerAnnounceEntry::addPeerAddrEntry(const PeerAddrEntry& entry)
+bool DHTPeerAnnounceEntry::addPeerAddrEntry(const PeerAddrEntry& entry,
+                                            size_t maxPeers)
 {
+  if (!entry.valid()) {
+    return false;
+  }
+  bool added = false;
   auto i = std::find(peerAddrEntries_.begin(), peerAddrEntries_.end(), entry);
-  if (i == peerAddrEntries_.end()) {
+  if (i != peerAddrEntries_.end()) {
+    (*i).notifyUpdate();
+  }
+  else if (maxPeers == 0 || peerAddrEntries_.size() < maxPeers) {
     peerAddrEntries_.push_back(entry);
+    added = true;
   }
   else {
-    (*i).notifyUpdate();
+    auto oldest = std::min_element(
+        peerAddrEntries_.begin(), peerAddrEntries_.end(),
+        [](const PeerAddrEntry& lhs, const PeerAddrEntry& rhs) {
+          return lhs.getLastUpdated() < rhs.getLastUpdated();
+        });
+    *oldest = entry;
   }
   notifyUpdate();
+  return added;
 }
 
 size_t DHTPeerAnnounceEntry::countPeerAddrEntry() const
@@ -66,9 +81,10 @@ size_t DHTPeerAnnounceEntry::countPeerAddrEntry() const
   return peerAddrEntries_.size();
 }
 
-void DHTPeerAnnounceEntry::removeStalePeerAddrEntry(
+size_t DHTPeerAnnounceEntry::removeStalePeerAddrEntry(
     const std::chrono::seconds& timeout)
 {
+  auto size = peerAddrEntries_.size();
   peerAddrEntries_.erase(
       std::remove_if(std::begin(peerAddrEntries_), std::end(peerAddrEntries_),
                      [&timeout](const PeerAddrEntry& entry) {
@@ -76,6 +92,7 @@ void DHTPeerAnnounceEntry::removeStalePeerAddrEntry(
                                   global::wallclock()) >= timeout;
                      }),
       std::end(peerAddrEntries_));
+  return size - peerAddrEntries_.size();
 }
 
 bool DHTPeerAnnounceEntry::empty() const { return peerAddrEntries_.empty(); }
@@ -62,8 +62,11 @@ public:
   ~DHTPeerAnnounceEntry();
 
   // add peer addr entry.
-  // if it already exists, update "Last Updated" property.
-  void addPeerAddrEntry(const PeerAddrEntry& entry);
+  // if it already exists, update "Last Updated" property.  If there
+  // are already maxPeers entries, the least recently updated one is
+  // replaced.  maxPeers == 0 means no limit.  Returns true if the
+  // number of entries increased.
+  bool addPeerAddrEntry(const PeerAddrEntry& entry, size_t maxPeers = 0);
 
   size_t countPeerAddrEntry() const;
 
@@ -72,7 +75,9 @@ public:
     return peerAddrEntries_;
   }
 
-  void removeStalePeerAddrEntry(const std::chrono::seconds& timeout);
+  // Removes peer addr entries which are not updated in the past
+  // timeout seconds and returns the number of removed entries.
+  size_t removeStalePeerAddrEntry(const std::chrono::seconds& timeout);
 
   bool empty() const;
 
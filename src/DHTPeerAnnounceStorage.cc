@@ -49,36 +49,107 @@
 #include "a2functional.h"
 #include "wallclock.h"
 #include "fmt.h"
+#include "SimpleRandomizer.h"
 
 namespace aria2 {
 
 DHTPeerAnnounceStorage::DHTPeerAnnounceStorage()
-    : taskQueue_{nullptr}, taskFactory_{nullptr}
+    : numEntry_{0},
+      numPeerAddrEntry_{0},
+      maxPeersPerInfoHash_{0},
+      maxMemory_{0},
+      numEvicted_{0},
+      taskQueue_{nullptr},
+      taskFactory_{nullptr}
 {
+  SimpleRandomizer::getInstance()->getRandomBytes(
+      reinterpret_cast<unsigned char*>(hashKey_), sizeof(hashKey_));
 }
 
-bool DHTPeerAnnounceStorage::InfoHashLess::
-operator()(const std::shared_ptr<DHTPeerAnnounceEntry>& lhs,
-           const std::shared_ptr<DHTPeerAnnounceEntry>& rhs) const
+DHTPeerAnnounceStorage::~DHTPeerAnnounceStorage() = default;
+
+size_t DHTPeerAnnounceStorage::hash(const unsigned char* infoHash) const
+{
+  uint64_t w[3] = {0, 0, 0};
+  memcpy(w, infoHash, DHT_ID_LENGTH);
+  uint64_t h = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    h = (h ^ w[i] ^ hashKey_[i]) * 0x9e3779b97f4a7c15ULL;
+    h ^= h >> 32;
+  }
+  return h;
+}
+
+size_t DHTPeerAnnounceStorage::findSlot(const unsigned char* infoHash) const
 {
-  return memcmp(lhs->getInfoHash(), rhs->getInfoHash(), DHT_ID_LENGTH) < 0;
+  auto mask = table_.size() - 1;
+  for (auto i = hash(infoHash) & mask;; i = (i + 1) & mask) {
+    auto& entry = table_[i];
+    if (!entry || memcmp(entry->getInfoHash(), infoHash, DHT_ID_LENGTH) == 0) {
+      return i;
+    }
+  }
 }
 
-std::shared_ptr<DHTPeerAnnounceEntry>
-DHTPeerAnnounceStorage::getPeerAnnounceEntry(const unsigned char* infoHash)
+void DHTPeerAnnounceStorage::rehash(size_t size)
 {
-  auto entry = std::make_shared<DHTPeerAnnounceEntry>(infoHash);
+  auto old = std::move(table_);
+  table_.clear();
+  table_.resize(size);
+  for (auto& entry : old) {
+    if (entry) {
+      table_[findSlot(entry->getInfoHash())] = std::move(entry);
+    }
+  }
+}
 
-  auto i = entries_.lower_bound(entry);
+template <typename Pred> void DHTPeerAnnounceStorage::removeIf(Pred pred)
+{
+  for (auto& entry : table_) {
+    if (entry && pred(entry.get())) {
+      numPeerAddrEntry_ -= entry->countPeerAddrEntry();
+      --numEntry_;
+      entry.reset();
+    }
+  }
+  // Linear probing cannot simply leave holes, so rebuild the table.
+  // This also shrinks the table if many entries were removed.
+  size_t size = numEntry_ == 0 ? 0 : 16;
+  while (size < numEntry_ * 2) {
+    size *= 2;
+  }
+  rehash(size);
+}
 
-  if (i != entries_.end() &&
-      memcmp(infoHash, (*i)->getInfoHash(), DHT_ID_LENGTH) == 0) {
-    entry = *i;
+void DHTPeerAnnounceStorage::evict()
+{
+  std::vector<const DHTPeerAnnounceEntry*> entries;
+  entries.reserve(numEntry_);
+  for (auto& entry : table_) {
+    if (entry) {
+      entries.push_back(entry.get());
+    }
   }
-  else {
-    entries_.insert(i, entry);
+  std::sort(std::begin(entries), std::end(entries),
+            [](const DHTPeerAnnounceEntry* lhs,
+               const DHTPeerAnnounceEntry* rhs) {
+              return lhs->getLastUpdated() < rhs->getLastUpdated();
+            });
+  auto target = maxMemory_ - maxMemory_ / 8;
+  auto usage = getMemoryUsage();
+  auto last = std::begin(entries);
+  for (; last != std::end(entries) && usage > target; ++last) {
+    usage -= sizeof(DHTPeerAnnounceEntry) +
+             (*last)->countPeerAddrEntry() * sizeof(PeerAddrEntry);
   }
-  return entry;
+  entries.erase(last, std::end(entries));
+  std::sort(std::begin(entries), std::end(entries));
+  A2_LOG_DEBUG(fmt("Evicting %lu peer announce entries",
+                   static_cast<unsigned long>(entries.size())));
+  numEvicted_ += entries.size();
+  removeIf([&entries](const DHTPeerAnnounceEntry* entry) {
+    return std::binary_search(std::begin(entries), std::end(entries), entry);
+  });
 }
 
 void DHTPeerAnnounceStorage::addPeerAnnounce(const unsigned char* infoHash,
@@ -88,54 +159,66 @@ void DHTPeerAnnounceStorage::addPeerAnnounce(const unsigned char* infoHash,
   A2_LOG_DEBUG(fmt("Adding %s:%u to peer announce list: infoHash=%s",
                    ipaddr.c_str(), port,
                    util::toHex(infoHash, DHT_ID_LENGTH).c_str()));
-  getPeerAnnounceEntry(infoHash)->addPeerAddrEntry(PeerAddrEntry(ipaddr, port));
+  PeerAddrEntry peerAddrEntry(ipaddr, port, global::wallclock());
+  if (!peerAddrEntry.valid()) {
+    A2_LOG_DEBUG("Not a numeric address. Ignored.");
+    return;
+  }
+  if ((numEntry_ + 1) * 4 > table_.size() * 3) {
+    rehash(std::max(table_.size() * 2, static_cast<size_t>(16)));
+  }
+  auto& entry = table_[findSlot(infoHash)];
+  if (!entry) {
+    entry = make_unique<DHTPeerAnnounceEntry>(infoHash);
+    ++numEntry_;
+  }
+  if (entry->addPeerAddrEntry(peerAddrEntry, maxPeersPerInfoHash_)) {
+    ++numPeerAddrEntry_;
+  }
+  if (maxMemory_ > 0 && getMemoryUsage() > maxMemory_) {
+    evict();
+  }
 }
 
 bool DHTPeerAnnounceStorage::contains(const unsigned char* infoHash) const
 {
-  auto entry = std::make_shared<DHTPeerAnnounceEntry>(infoHash);
-  return std::binary_search(entries_.begin(), entries_.end(), entry,
-                            InfoHashLess());
+  return !table_.empty() && table_[findSlot(infoHash)];
 }
 
 void DHTPeerAnnounceStorage::getPeers(std::vector<std::shared_ptr<Peer>>& peers,
                                       const unsigned char* infoHash)
 {
-  auto entry = std::make_shared<DHTPeerAnnounceEntry>(infoHash);
-
-  auto i = entries_.find(entry);
-  if (i != entries_.end()) {
-    (*i)->getPeers(peers);
+  if (table_.empty()) {
+    return;
+  }
+  auto& entry = table_[findSlot(infoHash)];
+  if (entry) {
+    entry->getPeers(peers);
   }
 }
 
 void DHTPeerAnnounceStorage::handleTimeout()
 {
   A2_LOG_DEBUG(fmt("Now purge peer announces(%lu entries) which are timed out.",
-                   static_cast<unsigned long>(entries_.size())));
-  std::for_each(std::begin(entries_), std::end(entries_),
-                [](const std::shared_ptr<DHTPeerAnnounceEntry>& e) {
-                  e->removeStalePeerAddrEntry(DHT_PEER_ANNOUNCE_PURGE_INTERVAL);
-                });
-
-  for (auto i = std::begin(entries_); i != std::end(entries_);) {
-    if ((*i)->empty()) {
-      entries_.erase(i++);
-    }
-    else {
-      ++i;
+                   static_cast<unsigned long>(numEntry_)));
+  for (auto& entry : table_) {
+    if (entry) {
+      numPeerAddrEntry_ -=
+          entry->removeStalePeerAddrEntry(DHT_PEER_ANNOUNCE_PURGE_INTERVAL);
     }
   }
+  removeIf(
+      [](const DHTPeerAnnounceEntry* entry) { return entry->empty(); });
   A2_LOG_DEBUG(fmt("Currently %lu peer announce entries",
-                   static_cast<unsigned long>(entries_.size())));
+                   static_cast<unsigned long>(numEntry_)));
 }
 
 void DHTPeerAnnounceStorage::announcePeer()
 {
   A2_LOG_DEBUG("Now announcing peer.");
-  for (auto& e : entries_) {
-    if (e->getLastUpdated().difference(global::wallclock()) <
-        DHT_PEER_ANNOUNCE_INTERVAL) {
+  for (auto& e : table_) {
+    if (!e || e->getLastUpdated().difference(global::wallclock()) <
+                  DHT_PEER_ANNOUNCE_INTERVAL) {
       continue;
     }
     e->notifyUpdate();
@@ -146,6 +229,21 @@ void DHTPeerAnnounceStorage::announcePeer()
   }
 }
 
+size_t DHTPeerAnnounceStorage::getMemoryUsage() const
+{
+  return table_.size() * sizeof(table_[0]) +
+         numEntry_ * sizeof(DHTPeerAnnounceEntry) +
+         numPeerAddrEntry_ * sizeof(PeerAddrEntry);
+}
+
+void DHTPeerAnnounceStorage::setMaxMemory(size_t maxMemory)
+{
+  maxMemory_ = maxMemory;
+  if (maxMemory_ > 0 && getMemoryUsage() > maxMemory_) {
+    evict();
+  }
+}
+
 void DHTPeerAnnounceStorage::setTaskQueue(DHTTaskQueue* taskQueue)
 {
   taskQueue_ = taskQueue;
@@ -37,7 +37,6 @@
 
 #include "common.h"
 
-#include <set>
 #include <vector>
 #include <string>
 #include <memory>
@@ -51,25 +50,59 @@ class DHTTaskFactory;
 
 class DHTPeerAnnounceStorage {
 private:
-  class InfoHashLess {
-  public:
-    bool operator()(const std::shared_ptr<DHTPeerAnnounceEntry>& lhs,
-                    const std::shared_ptr<DHTPeerAnnounceEntry>& rhs) const;
-  };
-  typedef std::set<std::shared_ptr<DHTPeerAnnounceEntry>, InfoHashLess>
-      DHTPeerAnnounceEntrySet;
-  DHTPeerAnnounceEntrySet entries_;
-
-  std::shared_ptr<DHTPeerAnnounceEntry>
-  getPeerAnnounceEntry(const unsigned char* infoHash);
+  // Open addressing hash table with linear probing, keyed by info
+  // hash.  Its size is 0 or a power of 2, and at most 3/4 of the
+  // slots are used.
+  std::vector<std::unique_ptr<DHTPeerAnnounceEntry>> table_;
+
+  size_t numEntry_;
+
+  size_t numPeerAddrEntry_;
+
+  // The maximum number of peers stored for each info hash.  0 means
+  // no limit.
+  size_t maxPeersPerInfoHash_;
+
+  // The approximate upper bound of memory used by this object in
+  // bytes.  0 means no limit.
+  size_t maxMemory_;
+
+  // The number of info hashes dropped to keep memory usage under
+  // maxMemory_.
+  uint64_t numEvicted_;
+
+  // Random key mixed into hash values, so that remote nodes cannot
+  // choose info hashes which collide.
+  uint64_t hashKey_[3];
 
   DHTTaskQueue* taskQueue_;
 
   DHTTaskFactory* taskFactory_;
 
+  size_t hash(const unsigned char* infoHash) const;
+
+  // Returns the index of the slot which has infoHash, or the empty
+  // slot where infoHash should be inserted.  table_ must not be
+  // empty.
+  size_t findSlot(const unsigned char* infoHash) const;
+
+  // Puts entries into a new table of the given size, which must be
+  // a power of 2 and large enough.
+  void rehash(size_t size);
+
+  // Removes entries for which pred returns true and shrinks table_
+  // if possible.
+  template <typename Pred> void removeIf(Pred pred);
+
+  // Drops the least recently updated entries until memory usage
+  // falls below 7/8 of maxMemory_.
+  void evict();
+
 public:
   DHTPeerAnnounceStorage();
 
+  ~DHTPeerAnnounceStorage();
+
   void addPeerAnnounce(const unsigned char* infoHash, const std::string& ipaddr,
                        uint16_t port);
 
@@ -88,6 +121,24 @@ public:
   // are excluded from announce.
   void announcePeer();
 
+  // Returns the number of stored info hashes.
+  size_t countEntry() const { return numEntry_; }
+
+  // Returns the number of stored peer addresses.
+  size_t countPeerAddrEntry() const { return numPeerAddrEntry_; }
+
+  uint64_t getNumEvicted() const { return numEvicted_; }
+
+  // Returns the approximate number of bytes used by this object.
+  size_t getMemoryUsage() const;
+
+  void setMaxPeersPerInfoHash(size_t maxPeers)
+  {
+    maxPeersPerInfoHash_ = maxPeers;
+  }
+
+  void setMaxMemory(size_t maxMemory);
+
   void setTaskQueue(DHTTaskQueue* taskQueue);
 
   void setTaskFactory(DHTTaskFactory* taskFactory);
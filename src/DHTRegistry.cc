@@ -46,6 +46,8 @@
 
 namespace aria2 {
 
+DHTRegistry::Data::Data() : initialized(false) {}
+
 DHTRegistry::Data DHTRegistry::data_;
 
 DHTRegistry::Data DHTRegistry::data6_;
@@ -74,7 +74,9 @@ private:
 
     std::unique_ptr<DHTMessageFactory> messageFactory;
 
-    Data() : initialized(false) {}
+    // Defined out of line so that including this header does not
+    // require the complete types of the members above.
+    Data();
   };
 
   static Data data_;
@@ -72,6 +72,7 @@
 #include "RecoverableException.h"
 #include "a2functional.h"
 #include "DownloadEngine.h"
+#include "File.h"
 #include "fmt.h"
 
 namespace aria2 {
@@ -150,6 +151,13 @@ DHTSetup::setup(DownloadEngine* e, int family)
     auto tokenTracker = make_unique<DHTTokenTracker>();
     // For now, UDPTrackerClient was enabled along with DHT
     auto udpTrackerClient = std::make_shared<UDPTrackerClient>();
+    if (family == AF_INET) {
+      const auto& udpTrackerCacheFile =
+          e->getOption()->get(PREF_BT_UDP_TRACKER_CACHE_FILE);
+      if (!udpTrackerCacheFile.empty() && File(udpTrackerCacheFile).isFile()) {
+        udpTrackerClient->load(udpTrackerCacheFile);
+      }
+    }
     const auto messageTimeout =
         e->getOption()->getAsInt(PREF_DHT_MESSAGE_TIMEOUT);
     // wiring up
@@ -173,6 +181,10 @@ DHTSetup::setup(DownloadEngine* e, int family)
 
     peerAnnounceStorage->setTaskQueue(taskQueue.get());
     peerAnnounceStorage->setTaskFactory(taskFactory.get());
+    peerAnnounceStorage->setMaxPeersPerInfoHash(
+        e->getOption()->getAsInt(PREF_DHT_MAX_ANNOUNCED_PEERS));
+    peerAnnounceStorage->setMaxMemory(
+        e->getOption()->getAsLLInt(PREF_DHT_ANNOUNCE_STORAGE_SIZE));
 
     factory->setRoutingTable(routingTable.get());
     factory->setConnection(connection.get());
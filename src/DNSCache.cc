@@ -33,7 +33,18 @@
  */
 /* copyright --> */
 #include "DNSCache.h"
+
+#include <cstdio>
+
 #include "A2STR.h"
+#include "BufferedFile.h"
+#include "File.h"
+#include "LogFactory.h"
+#include "TimeA2.h"
+#include "fmt.h"
+#include "message.h"
+#include "util.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -56,7 +67,7 @@ DNSCache::AddrEntry& DNSCache::AddrEntry::operator=(const AddrEntry& c)
 }
 
 DNSCache::CacheEntry::CacheEntry(const std::string& hostname, uint16_t port)
-    : hostname_(hostname), port_(port)
+    : hostname_(hostname), port_(port), ttl_(0)
 {
 }
 
@@ -70,6 +81,8 @@ DNSCache::CacheEntry& DNSCache::CacheEntry::operator=(const CacheEntry& c)
     hostname_ = c.hostname_;
     port_ = c.port_;
     addrEntries_ = c.addrEntries_;
+    expiry_ = c.expiry_;
+    ttl_ = c.ttl_;
   }
   return *this;
 }
@@ -132,6 +145,18 @@ void DNSCache::CacheEntry::markBad(const std::string& addr)
   }
 }
 
+bool DNSCache::CacheEntry::expired() const
+{
+  return ttl_.count() != 0 && expiry_ < global::wallclock();
+}
+
+void DNSCache::CacheEntry::setTTL(const std::chrono::seconds& ttl)
+{
+  ttl_ = ttl;
+  expiry_ = global::wallclock();
+  expiry_.advance(ttl);
+}
+
 bool DNSCache::CacheEntry::operator<(const CacheEntry& e) const
 {
   int r = hostname_.compare(e.hostname_);
@@ -146,61 +171,292 @@ bool DNSCache::CacheEntry::operator==(const CacheEntry& e) const
   return hostname_ == e.hostname_ && port_ == e.port_;
 }
 
-DNSCache::DNSCache() {}
+DNSCache::DNSCache() : maxSize_(0), hits_(0), misses_(0) {}
 
-DNSCache::DNSCache(const DNSCache& c) = default;
+DNSCache::DNSCache(const DNSCache& c) : maxSize_(0), hits_(0), misses_(0)
+{
+  *this = c;
+}
 
 DNSCache::~DNSCache() = default;
 
 DNSCache& DNSCache::operator=(const DNSCache& c)
 {
   if (this != &c) {
-    entries_ = c.entries_;
+    // Entries are copied so that lruPos_ refers to our own list.
+    entries_.clear();
+    lruEntries_.clear();
+    for (auto& e : c.lruEntries_) {
+      auto entry = std::make_shared<CacheEntry>(*e);
+      entry->lruPos_ = lruEntries_.insert(lruEntries_.end(), entry);
+      entries_.insert(entry);
+    }
+    maxSize_ = c.maxSize_;
+    hits_ = c.hits_;
+    misses_ = c.misses_;
   }
   return *this;
 }
 
-const std::string& DNSCache::find(const std::string& hostname,
-                                  uint16_t port) const
+std::shared_ptr<DNSCache::CacheEntry>
+DNSCache::findEntry(const std::string& hostname, uint16_t port) const
 {
   auto target = std::make_shared<CacheEntry>(hostname, port);
   auto i = entries_.find(target);
-  if (i == entries_.end()) {
+  if (i == entries_.end() || (*i)->expired()) {
+    return nullptr;
+  }
+  return *i;
+}
+
+const std::string& DNSCache::find(const std::string& hostname,
+                                  uint16_t port) const
+{
+  auto entry = findEntry(hostname, port);
+  if (!entry) {
     return A2STR::NIL;
   }
   else {
-    return (*i)->getGoodAddr();
+    return entry->getGoodAddr();
   }
 }
 
-void DNSCache::put(const std::string& hostname, const std::string& ipaddr,
-                   uint16_t port)
+int DNSCache::lookup(std::vector<std::string>& addrs,
+                     const std::string& hostname, uint16_t port)
+{
+  auto entry = findEntry(hostname, port);
+  if (!entry) {
+    ++misses_;
+    return 0;
+  }
+  if (entry->isNegative()) {
+    ++hits_;
+    lruEntries_.splice(lruEntries_.end(), lruEntries_, entry->lruPos_);
+    return -1;
+  }
+  auto size = addrs.size();
+  entry->getAllGoodAddrs(std::back_inserter(addrs));
+  if (addrs.size() == size) {
+    ++misses_;
+    return 0;
+  }
+  ++hits_;
+  lruEntries_.splice(lruEntries_.end(), lruEntries_, entry->lruPos_);
+  return 1;
+}
+
+const std::shared_ptr<DNSCache::CacheEntry>&
+DNSCache::prepareEntry(const std::string& hostname, uint16_t port)
 {
   auto target = std::make_shared<CacheEntry>(hostname, port);
   auto i = entries_.lower_bound(target);
   if (i != entries_.end() && *(*i) == *target) {
-    (*i)->add(ipaddr);
-  }
-  else {
-    target->add(ipaddr);
-    entries_.insert(i, target);
+    if ((*i)->expired() || (*i)->isNegative()) {
+      (*i)->addrEntries_.clear();
+    }
+    lruEntries_.splice(lruEntries_.end(), lruEntries_, (*i)->lruPos_);
+    return *i;
   }
+  target->lruPos_ = lruEntries_.insert(lruEntries_.end(), target);
+  i = entries_.insert(i, target);
+  evict();
+  return *i;
+}
+
+void DNSCache::put(const std::string& hostname, const std::string& ipaddr,
+                   uint16_t port, const std::chrono::seconds& ttl)
+{
+  auto& entry = prepareEntry(hostname, port);
+  entry->add(ipaddr);
+  entry->setTTL(ttl);
+}
+
+void DNSCache::putNegative(const std::string& hostname, uint16_t port,
+                           const std::chrono::seconds& ttl)
+{
+  auto& entry = prepareEntry(hostname, port);
+  entry->addrEntries_.clear();
+  entry->setTTL(ttl);
 }
 
 void DNSCache::markBad(const std::string& hostname, const std::string& ipaddr,
                        uint16_t port)
+{
+  auto entry = findEntry(hostname, port);
+  if (entry) {
+    entry->markBad(ipaddr);
+  }
+}
+
+void DNSCache::erase(CacheEntrySet::iterator i)
+{
+  lruEntries_.erase((*i)->lruPos_);
+  entries_.erase(i);
+}
+
+void DNSCache::remove(const std::string& hostname, uint16_t port)
 {
   auto target = std::make_shared<CacheEntry>(hostname, port);
   auto i = entries_.find(target);
   if (i != entries_.end()) {
-    (*i)->markBad(ipaddr);
+    erase(i);
   }
 }
 
-void DNSCache::remove(const std::string& hostname, uint16_t port)
+void DNSCache::evict()
 {
-  auto target = std::make_shared<CacheEntry>(hostname, port);
-  entries_.erase(target);
+  if (maxSize_ == 0) {
+    return;
+  }
+  while (entries_.size() > maxSize_) {
+    erase(entries_.find(lruEntries_.front()));
+  }
+}
+
+void DNSCache::setMaxSize(size_t maxSize)
+{
+  maxSize_ = maxSize;
+  evict();
+}
+
+bool DNSCache::save(const std::string& filename) const
+{
+  std::string tempfile = filename;
+  tempfile += "__temp";
+  {
+    BufferedFile fp(tempfile.c_str(), BufferedFile::WRITE);
+    if (!fp) {
+      A2_LOG_ERROR(
+          fmt(MSG_OPENING_WRITABLE_DNS_CACHE_FILE_FAILED, filename.c_str()));
+      return false;
+    }
+    for (auto& e : lruEntries_) {
+      if (e->expired()) {
+        continue;
+      }
+      int64_t expiry = 0;
+      if (e->ttl_.count() != 0) {
+        Time t;
+        t.advance(global::wallclock().difference(e->expiry_));
+        expiry = t.getTimeFromEpoch();
+      }
+      std::vector<std::string> addrs;
+      e->getAllGoodAddrs(std::back_inserter(addrs));
+      if (!e->isNegative() && addrs.empty()) {
+        continue;
+      }
+      auto l = fmt("host=%s,port=%u,expiry=%" PRId64 ",addrs=",
+                   e->hostname_.c_str(), e->port_, expiry);
+      l += strjoin(std::begin(addrs), std::end(addrs), ";");
+      l += "\n";
+      if (fp.write(l.data(), l.size()) != l.size()) {
+        A2_LOG_ERROR(fmt(MSG_WRITING_DNS_CACHE_FILE_FAILED, filename.c_str()));
+      }
+    }
+    if (fp.close() == EOF) {
+      A2_LOG_ERROR(fmt(MSG_WRITING_DNS_CACHE_FILE_FAILED, filename.c_str()));
+      return false;
+    }
+  }
+  if (File(tempfile).renameTo(filename)) {
+    A2_LOG_NOTICE(fmt(MSG_DNS_CACHE_SAVED, filename.c_str()));
+    return true;
+  }
+  else {
+    A2_LOG_ERROR(fmt(MSG_WRITING_DNS_CACHE_FILE_FAILED, filename.c_str()));
+    return false;
+  }
+}
+
+namespace {
+// Field and FIELD_NAMES must have same order except for MAX_FIELD.
+enum Field { D_ADDRS, D_EXPIRY, D_HOST, D_PORT, MAX_FIELD };
+
+const char* FIELD_NAMES[] = {
+    "addrs",
+    "expiry",
+    "host",
+    "port",
+};
+} // namespace
+
+namespace {
+int idField(std::string::const_iterator first, std::string::const_iterator last)
+{
+  int i;
+  for (i = 0; i < MAX_FIELD; ++i) {
+    if (util::streq(first, last, FIELD_NAMES[i])) {
+      return i;
+    }
+  }
+  return i;
+}
+} // namespace
+
+bool DNSCache::load(const std::string& filename)
+{
+  BufferedFile fp(filename.c_str(), BufferedFile::READ);
+  if (!fp) {
+    A2_LOG_ERROR(
+        fmt(MSG_OPENING_READABLE_DNS_CACHE_FILE_FAILED, filename.c_str()));
+    return false;
+  }
+  auto now = Time().getTimeFromEpoch();
+  while (1) {
+    std::string line = fp.getLine();
+    if (line.empty()) {
+      if (fp.eof()) {
+        break;
+      }
+      else if (!fp) {
+        A2_LOG_ERROR(fmt(MSG_READING_DNS_CACHE_FILE_FAILED, filename.c_str()));
+        return false;
+      }
+      else {
+        continue;
+      }
+    }
+    auto p = util::stripIter(line.begin(), line.end());
+    if (p.first == p.second) {
+      continue;
+    }
+    std::vector<Scip> items;
+    util::splitIter(p.first, p.second, std::back_inserter(items), ',');
+    std::vector<std::string> m(MAX_FIELD);
+    for (auto& item : items) {
+      auto kv = util::divide(item.first, item.second, '=');
+      int id = idField(kv.first.first, kv.first.second);
+      if (id != MAX_FIELD) {
+        m[id].assign(kv.second.first, kv.second.second);
+      }
+    }
+    uint32_t port;
+    int64_t expiry;
+    if (m[D_HOST].empty() || !util::parseUIntNoThrow(port, m[D_PORT]) ||
+        port > UINT16_MAX || !util::parseLLIntNoThrow(expiry, m[D_EXPIRY])) {
+      continue;
+    }
+    std::chrono::seconds ttl(0);
+    if (expiry != 0) {
+      if (expiry <= now) {
+        continue;
+      }
+      ttl = std::chrono::seconds(expiry - now);
+    }
+    std::vector<std::string> addrs;
+    util::split(std::begin(m[D_ADDRS]), std::end(m[D_ADDRS]),
+                std::back_inserter(addrs), ';');
+    if (addrs.empty()) {
+      putNegative(m[D_HOST], port, ttl);
+    }
+    for (auto& addr : addrs) {
+      if (util::isNumericHost(addr)) {
+        put(m[D_HOST], addr, port, ttl);
+      }
+    }
+  }
+  A2_LOG_NOTICE(fmt(MSG_DNS_CACHE_LOADED, filename.c_str()));
+  return true;
 }
 
 } // namespace aria2
@@ -39,13 +39,21 @@
 
 #include <string>
 #include <set>
+#include <list>
 #include <algorithm>
 #include <vector>
+#include <chrono>
 
 #include "a2functional.h"
+#include "TimerA2.h"
 
 namespace aria2 {
 
+// Caches resolved addresses per hostname and port.  Each entry
+// expires after the TTL given to put(), and the least recently used
+// entry is evicted when the number of entries exceeds the maximum
+// size.  An entry without address is a negative entry, which records
+// that the hostname does not exist.
 class DNSCache {
 private:
   struct AddrEntry {
@@ -63,6 +71,12 @@ private:
     std::string hostname_;
     uint16_t port_;
     std::vector<AddrEntry> addrEntries_;
+    // The time when this entry expires.  If ttl_ is 0, this entry
+    // never expires.
+    Timer expiry_;
+    std::chrono::seconds ttl_;
+    // The position of this entry in DNSCache::lruEntries_.
+    std::list<std::shared_ptr<CacheEntry>>::iterator lruPos_;
 
     CacheEntry(const std::string& hostname, uint16_t port);
     CacheEntry(const CacheEntry& c);
@@ -92,6 +106,12 @@ private:
 
     void markBad(const std::string& addr);
 
+    bool isNegative() const { return addrEntries_.empty(); }
+
+    bool expired() const;
+
+    void setTTL(const std::chrono::seconds& ttl);
+
     bool operator<(const CacheEntry& e) const;
 
     bool operator==(const CacheEntry& e) const;
@@ -101,6 +121,27 @@ private:
                    DerefLess<std::shared_ptr<CacheEntry>>>
       CacheEntrySet;
   CacheEntrySet entries_;
+  // Entries in least recently used order.
+  std::list<std::shared_ptr<CacheEntry>> lruEntries_;
+  // The maximum number of entries.  0 means no limit.
+  size_t maxSize_;
+  uint64_t hits_;
+  uint64_t misses_;
+
+  // Returns the entry for hostname and port if it exists and has not
+  // expired.
+  std::shared_ptr<CacheEntry> findEntry(const std::string& hostname,
+                                        uint16_t port) const;
+
+  // Returns the entry for hostname and port, which is created if it
+  // does not exist.  If the entry has expired or is negative, it is
+  // cleared.  The entry becomes the most recently used one.
+  const std::shared_ptr<CacheEntry>& prepareEntry(const std::string& hostname,
+                                                  uint16_t port);
+
+  void erase(CacheEntrySet::iterator i);
+
+  void evict();
 
 public:
   DNSCache();
@@ -115,20 +156,50 @@ public:
   void findAll(OutputIterator out, const std::string& hostname,
                uint16_t port) const
   {
-    auto target = std::make_shared<CacheEntry>(hostname, port);
-    auto i = entries_.find(target);
-    if (i != entries_.end()) {
-      (*i)->getAllGoodAddrs(out);
+    auto entry = findEntry(hostname, port);
+    if (entry) {
+      entry->getAllGoodAddrs(out);
     }
   }
 
+  // Looks up hostname and port for name resolution, and counts a hit
+  // or a miss.  Returns 1 and appends good addresses to addrs if they
+  // are cached.  Returns -1 if the negative entry is cached.
+  // Otherwise returns 0.
+  int lookup(std::vector<std::string>& addrs, const std::string& hostname,
+             uint16_t port);
+
+  // Adds ipaddr to the entry for hostname and port, which expires
+  // after ttl.  If ttl is 0, the entry never expires.
   void put(const std::string& hostname, const std::string& ipaddr,
-           uint16_t port);
+           uint16_t port,
+           const std::chrono::seconds& ttl = std::chrono::seconds(0));
+
+  // Records that hostname does not exist for ttl.
+  void putNegative(const std::string& hostname, uint16_t port,
+                   const std::chrono::seconds& ttl);
 
   void markBad(const std::string& hostname, const std::string& ipaddr,
                uint16_t port);
 
   void remove(const std::string& hostname, uint16_t port);
+
+  // Sets the maximum number of entries.  0 means no limit.
+  void setMaxSize(size_t maxSize);
+
+  size_t size() const { return entries_.size(); }
+
+  uint64_t getHits() const { return hits_; }
+
+  uint64_t getMisses() const { return misses_; }
+
+  // Loads entries from filename, skipping expired ones.  Returns
+  // true if it succeeds.
+  bool load(const std::string& filename);
+
+  // Saves entries which have not expired to filename.  Addresses
+  // marked bad are not saved.  Returns true if it succeeds.
+  bool save(const std::string& filename) const;
 };
 
 } // namespace aria2
@@ -302,9 +302,15 @@ size_t DefaultBtInteractive::receiveMessages()
 {
   size_t countOldOutstandingRequest = dispatcher_->countOutstandingRequest();
   size_t msgcount = 0;
+  // This connection's share of the download budget of the current
+  // scheduling tick.
+  auto budget = static_cast<int64_t>(
+      downloadContext_->getOwnerRequestGroup()->getConnectionDownloadBudget());
+  auto startLength = peer_->getSessionDownloadLength();
   while (1) {
     if (requestGroupMan_->doesOverallDownloadSpeedExceed() ||
-        downloadContext_->getOwnerRequestGroup()->doesDownloadSpeedExceed()) {
+        downloadContext_->getOwnerRequestGroup()->doesDownloadSpeedExceed() ||
+        peer_->getSessionDownloadLength() - startLength >= budget) {
       break;
     }
     auto message = btMessageReceiver_->receiveMessage();
@@ -338,13 +344,27 @@ size_t DefaultBtInteractive::receiveMessages()
     }
   }
 
-  if (!pieceStorage_->isEndGame() &&
-      countOldOutstandingRequest > dispatcher_->countOutstandingRequest() &&
-      (countOldOutstandingRequest - dispatcher_->countOutstandingRequest()) *
-              4 >=
-          maxOutstandingRequest_) {
-    maxOutstandingRequest_ = std::min((size_t)UB_MAX_OUTSTANDING_REQUEST,
-                                      maxOutstandingRequest_ * 2);
+  if (!pieceStorage_->isEndGame()) {
+    auto rtt = peer_->getRequestRtt();
+    if (rtt > Timer::Clock::duration::zero()) {
+      maxOutstandingRequest_ = bittorrent::calculateRequestQueueDepth(
+          peer_->calculateDownloadSpeed(), rtt, peer_->getReqq());
+    }
+    else if (countOldOutstandingRequest >
+                 dispatcher_->countOutstandingRequest() &&
+             (countOldOutstandingRequest -
+              dispatcher_->countOutstandingRequest()) *
+                     4 >=
+                 maxOutstandingRequest_) {
+      // No round trip time sample yet.  Grow the queue
+      // exponentially while the peer drains it quickly.
+      size_t ub = UB_MAX_OUTSTANDING_REQUEST;
+      if (peer_->getReqq() > 0) {
+        ub = std::min(ub, peer_->getReqq());
+      }
+      maxOutstandingRequest_ = std::min(ub, maxOutstandingRequest_ * 2);
+    }
+    peer_->setRequestQueueDepth(maxOutstandingRequest_);
   }
   return msgcount;
 }
@@ -470,6 +490,11 @@ void DefaultBtInteractive::detectMessageFlooding()
 
 void DefaultBtInteractive::checkActiveInteraction()
 {
+  // Piece hash may be checked by a worker thread, so the result
+  // arrives after BtPieceMessage was processed.
+  if (peer_->badPieceReceived()) {
+    throw DL_ABORT_EX("Bad piece hash.");
+  }
   auto inactiveTime = inactiveTimer_.difference(global::wallclock());
   // To allow aria2 to accept mutially interested peer, disconnect uninterested
   // peer.
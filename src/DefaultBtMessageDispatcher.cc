@@ -161,17 +161,15 @@ void abortOutstandingRequest(const RequestSlot* slot,
 void DefaultBtMessageDispatcher::doAbortOutstandingRequestAction(
     const std::shared_ptr<Piece>& piece)
 {
-  for (auto& slot : requestSlots_) {
-    if (slot->getIndex() == piece->getIndex()) {
-      abortOutstandingRequest(slot.get(), piece, cuid_);
-    }
+  auto range = pieceSlots_.equal_range(piece->getIndex());
+  auto slots = std::vector<RequestSlotMap::iterator>{};
+  for (auto i = range.first; i != range.second; ++i) {
+    slots.push_back((*i).second);
+  }
+  for (auto& i : slots) {
+    abortOutstandingRequest((*i).second.get(), piece, cuid_);
+    eraseRequestSlot(i);
   }
-  requestSlots_.erase(
-      std::remove_if(std::begin(requestSlots_), std::end(requestSlots_),
-                     [&](const std::unique_ptr<RequestSlot>& slot) {
-                       return slot->getIndex() == piece->getIndex();
-                     }),
-      std::end(requestSlots_));
 
   BtAbortOutstandingRequestEvent event(piece);
 
@@ -184,21 +182,20 @@ void DefaultBtMessageDispatcher::doAbortOutstandingRequestAction(
 // localhost received choke message from the peer.
 void DefaultBtMessageDispatcher::doChokedAction()
 {
-  for (auto& slot : requestSlots_) {
+  for (auto i = std::begin(requestSlots_); i != std::end(requestSlots_);) {
+    auto& slot = (*i).second;
     if (!peer_->isInPeerAllowedIndexSet(slot->getIndex())) {
       A2_LOG_DEBUG(fmt(MSG_DELETING_REQUEST_SLOT_CHOKED, cuid_,
                        static_cast<unsigned long>(slot->getIndex()),
                        slot->getBegin(),
                        static_cast<unsigned long>(slot->getBlockIndex())));
       slot->getPiece()->cancelBlock(slot->getBlockIndex());
+      i = eraseRequestSlot(i);
+    }
+    else {
+      ++i;
     }
   }
-  requestSlots_.erase(
-      std::remove_if(std::begin(requestSlots_), std::end(requestSlots_),
-                     [&](const std::unique_ptr<RequestSlot>& slot) {
-                       return !peer_->isInPeerAllowedIndexSet(slot->getIndex());
-                     }),
-      std::end(requestSlots_));
 }
 
 // localhost dispatched choke message to the peer.
@@ -214,31 +211,35 @@ void DefaultBtMessageDispatcher::doChokingAction()
 
 void DefaultBtMessageDispatcher::checkRequestSlotAndDoNecessaryThing()
 {
-  for (auto& slot : requestSlots_) {
-    if (slot->isTimeout(requestTimeout_)) {
-      A2_LOG_DEBUG(fmt(MSG_DELETING_REQUEST_SLOT_TIMEOUT, cuid_,
-                       static_cast<unsigned long>(slot->getIndex()),
-                       slot->getBegin(),
-                       static_cast<unsigned long>(slot->getBlockIndex())));
-      slot->getPiece()->cancelBlock(slot->getBlockIndex());
-      peer_->snubbing(true);
-    }
-    else if (slot->getPiece()->hasBlock(slot->getBlockIndex())) {
+  // requestSlots_ is ordered by dispatched time, so timed out slots
+  // are at the front.
+  auto i = std::begin(requestSlots_);
+  while (i != std::end(requestSlots_) &&
+         (*i).second->isTimeout(requestTimeout_)) {
+    auto& slot = (*i).second;
+    A2_LOG_DEBUG(fmt(MSG_DELETING_REQUEST_SLOT_TIMEOUT, cuid_,
+                     static_cast<unsigned long>(slot->getIndex()),
+                     slot->getBegin(),
+                     static_cast<unsigned long>(slot->getBlockIndex())));
+    slot->getPiece()->cancelBlock(slot->getBlockIndex());
+    peer_->snubbing(true);
+    i = eraseRequestSlot(i);
+  }
+  while (i != std::end(requestSlots_)) {
+    auto& slot = (*i).second;
+    if (slot->getPiece()->hasBlock(slot->getBlockIndex())) {
       A2_LOG_DEBUG(fmt(MSG_DELETING_REQUEST_SLOT_ACQUIRED, cuid_,
                        static_cast<unsigned long>(slot->getIndex()),
                        slot->getBegin(),
                        static_cast<unsigned long>(slot->getBlockIndex())));
       addMessageToQueue(messageFactory_->createCancelMessage(
           slot->getIndex(), slot->getBegin(), slot->getLength()));
+      i = eraseRequestSlot(i);
+    }
+    else {
+      ++i;
     }
   }
-  requestSlots_.erase(
-      std::remove_if(std::begin(requestSlots_), std::end(requestSlots_),
-                     [&](const std::unique_ptr<RequestSlot>& slot) {
-                       return slot->isTimeout(requestTimeout_) ||
-                              slot->getPiece()->hasBlock(slot->getBlockIndex());
-                     }),
-      std::end(requestSlots_));
 }
 
 bool DefaultBtMessageDispatcher::isSendingInProgress()
@@ -249,8 +250,9 @@ bool DefaultBtMessageDispatcher::isSendingInProgress()
 bool DefaultBtMessageDispatcher::isOutstandingRequest(size_t index,
                                                       size_t blockIndex)
 {
-  for (auto& slot : requestSlots_) {
-    if (slot->getIndex() == index && slot->getBlockIndex() == blockIndex) {
+  auto range = pieceSlots_.equal_range(index);
+  for (auto i = range.first; i != range.second; ++i) {
+    if ((*(*i).second).second->getBlockIndex() == blockIndex) {
       return true;
     }
   }
@@ -261,32 +263,56 @@ const RequestSlot*
 DefaultBtMessageDispatcher::getOutstandingRequest(size_t index, int32_t begin,
                                                   int32_t length)
 {
-  for (auto& slot : requestSlots_) {
-    if (slot->getIndex() == index && slot->getBegin() == begin &&
-        slot->getLength() == length) {
-      return slot.get();
-    }
+  auto i = slotIndex_.find(RequestSlotKey{index, begin, length});
+  if (i == std::end(slotIndex_)) {
+    return nullptr;
   }
-  return nullptr;
+  return (*(*i).second).second.get();
 }
 
 void DefaultBtMessageDispatcher::removeOutstandingRequest(
     const RequestSlot* slot)
 {
-  for (auto i = std::begin(requestSlots_), eoi = std::end(requestSlots_);
-       i != eoi; ++i) {
-    if (*(*i) == *slot) {
-      abortOutstandingRequest((*i).get(), (*i)->getPiece(), cuid_);
-      requestSlots_.erase(i);
-      break;
-    }
+  auto i = slotIndex_.find(RequestSlotKey{
+      slot->getIndex(), slot->getBegin(), slot->getLength()});
+  if (i == std::end(slotIndex_)) {
+    return;
   }
+  auto& s = (*(*i).second).second;
+  abortOutstandingRequest(s.get(), s->getPiece(), cuid_);
+  eraseRequestSlot((*i).second);
 }
 
 void DefaultBtMessageDispatcher::addOutstandingRequest(
     std::unique_ptr<RequestSlot> slot)
 {
-  requestSlots_.push_back(std::move(slot));
+  auto key =
+      RequestSlotKey{slot->getIndex(), slot->getBegin(), slot->getLength()};
+  if (slotIndex_.count(key)) {
+    // The same request is already outstanding.
+    return;
+  }
+  auto index = slot->getIndex();
+  auto i = requestSlots_.emplace(slot->getDispatchedTime().getTime(),
+                                 std::move(slot));
+  slotIndex_.emplace(key, i);
+  pieceSlots_.emplace(index, i);
+}
+
+DefaultBtMessageDispatcher::RequestSlotMap::iterator
+DefaultBtMessageDispatcher::eraseRequestSlot(RequestSlotMap::iterator i)
+{
+  auto& slot = (*i).second;
+  slotIndex_.erase(
+      RequestSlotKey{slot->getIndex(), slot->getBegin(), slot->getLength()});
+  auto range = pieceSlots_.equal_range(slot->getIndex());
+  for (auto j = range.first; j != range.second; ++j) {
+    if ((*j).second == i) {
+      pieceSlots_.erase(j);
+      break;
+    }
+  }
+  return requestSlots_.erase(i);
 }
 
 size_t DefaultBtMessageDispatcher::countOutstandingUpload()
@@ -38,6 +38,8 @@
 #include "BtMessageDispatcher.h"
 
 #include <deque>
+#include <map>
+#include <unordered_map>
 
 #include "a2time.h"
 #include "Command.h"
@@ -53,10 +55,24 @@ class RequestGroupMan;
 class PeerConnection;
 
 class DefaultBtMessageDispatcher : public BtMessageDispatcher {
+public:
+  // Outstanding requests ordered by dispatched time.  Since all slots
+  // share the same timeout, this is also the order in which they
+  // expire.
+  typedef std::multimap<Timer::Clock::time_point,
+                        std::unique_ptr<RequestSlot>>
+      RequestSlotMap;
+
 private:
   cuid_t cuid_;
   std::deque<std::unique_ptr<BtMessage>> messageQueue_;
-  std::deque<std::unique_ptr<RequestSlot>> requestSlots_;
+  RequestSlotMap requestSlots_;
+  // Index of requestSlots_ keyed by (index, begin, length).
+  std::unordered_map<RequestSlotKey, RequestSlotMap::iterator,
+                     RequestSlotKeyHash>
+      slotIndex_;
+  // Index of requestSlots_ keyed by piece index.
+  std::unordered_multimap<size_t, RequestSlotMap::iterator> pieceSlots_;
   DownloadContext* downloadContext_;
   PeerConnection* peerConnection_;
   BtMessageFactory* messageFactory_;
@@ -64,6 +80,10 @@ private:
   RequestGroupMan* requestGroupMan_;
   std::chrono::seconds requestTimeout_;
 
+  // Removes slot pointed by i from requestSlots_ and all indexes.
+  // Returns the iterator following i.
+  RequestSlotMap::iterator eraseRequestSlot(RequestSlotMap::iterator i);
+
 public:
   DefaultBtMessageDispatcher();
 
@@ -123,7 +143,7 @@ public:
     return messageQueue_;
   }
 
-  const std::deque<std::unique_ptr<RequestSlot>>& getRequestSlots() const
+  const RequestSlotMap& getRequestSlots() const
   {
     return requestSlots_;
   }
@@ -84,6 +84,8 @@ DefaultBtMessageFactory::DefaultBtMessageFactory()
       routingTable_{nullptr},
       taskQueue_{nullptr},
       taskFactory_{nullptr},
+      pieceHashCheckPool_{nullptr},
+      blockBufferPool_{nullptr},
       metadataGetMode_(false)
 {
 }
@@ -155,6 +157,8 @@ DefaultBtMessageFactory::createBtMessage(const unsigned char* data,
       }
       m->setDownloadContext(downloadContext_);
       m->setPeerStorage(peerStorage_);
+      m->setPieceHashCheckPool(pieceHashCheckPool_);
+      m->setBlockBufferPool(blockBufferPool_);
       msg = std::move(m);
       break;
     }
@@ -294,6 +298,7 @@ DefaultBtMessageFactory::createPieceMessage(size_t index, int32_t begin,
 {
   auto msg = make_unique<BtPieceMessage>(index, begin, length);
   msg->setDownloadContext(downloadContext_);
+  msg->setBlockBufferPool(blockBufferPool_);
   setCommonProperty(msg.get());
   return msg;
 }
@@ -435,6 +440,16 @@ void DefaultBtMessageFactory::setPeerStorage(PeerStorage* peerStorage)
   peerStorage_ = peerStorage;
 }
 
+void DefaultBtMessageFactory::setPieceHashCheckPool(PieceHashCheckPool* pool)
+{
+  pieceHashCheckPool_ = pool;
+}
+
+void DefaultBtMessageFactory::setBlockBufferPool(BlockBufferPool* pool)
+{
+  blockBufferPool_ = pool;
+}
+
 void DefaultBtMessageFactory::setBtMessageDispatcher(
     BtMessageDispatcher* dispatcher)
 {
@@ -53,6 +53,8 @@ class DHTNode;
 class DHTRoutingTable;
 class DHTTaskQueue;
 class DHTTaskFactory;
+class PieceHashCheckPool;
+class BlockBufferPool;
 
 class DefaultBtMessageFactory : public BtMessageFactory {
 private:
@@ -80,6 +82,10 @@ private:
 
   DHTTaskFactory* taskFactory_;
 
+  PieceHashCheckPool* pieceHashCheckPool_;
+
+  BlockBufferPool* blockBufferPool_;
+
   bool metadataGetMode_;
 
   void setCommonProperty(AbstractBtMessage* msg);
@@ -157,6 +163,10 @@ public:
 
   void setPeerStorage(PeerStorage* peerStorage);
 
+  void setPieceHashCheckPool(PieceHashCheckPool* pool);
+
+  void setBlockBufferPool(BlockBufferPool* pool);
+
   void setCuid(cuid_t cuid) { cuid_ = cuid; }
 
   void setDHTEnabled(bool enabled) { dhtEnabled_ = enabled; }
@@ -36,6 +36,8 @@
 
 #include <cstring>
 #include <cstdio>
+#include <algorithm>
+#include <functional>
 
 #include "PieceStorage.h"
 #include "Piece.h"
@@ -164,13 +166,19 @@ void DefaultBtProgressInfoFile::save(IOFile& fp)
   // bitfield
   WRITE_CHECK(fp, pieceStorage_->getBitfield(),
               pieceStorage_->getBitfieldLength());
-  // the number of in-flight piece: 32 bits
-  // TODO implement this
-  uint32_t numInFlightPieceNL = htonl(pieceStorage_->countInFlightPiece());
-  WRITE_CHECK(fp, &numInFlightPieceNL, sizeof(numInFlightPieceNL));
   std::vector<std::shared_ptr<Piece>> inFlightPieces;
   inFlightPieces.reserve(pieceStorage_->countInFlightPiece());
   pieceStorage_->getInFlightPieces(inFlightPieces);
+  // A complete in-flight piece is still waiting for its hash check
+  // result from PieceHashCheckPool.  It is not verified yet, so don't
+  // save it and download it again next time.
+  inFlightPieces.erase(std::remove_if(std::begin(inFlightPieces),
+                                      std::end(inFlightPieces),
+                                      std::mem_fn(&Piece::pieceComplete)),
+                       std::end(inFlightPieces));
+  // the number of in-flight piece: 32 bits
+  uint32_t numInFlightPieceNL = htonl(inFlightPieces.size());
+  WRITE_CHECK(fp, &numInFlightPieceNL, sizeof(numInFlightPieceNL));
   for (std::vector<std::shared_ptr<Piece>>::const_iterator
            itr = inFlightPieces.begin(),
            eoi = inFlightPieces.end();
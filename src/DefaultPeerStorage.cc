@@ -55,13 +55,20 @@ namespace {
 
 const size_t MAX_PEER_LIST_SIZE = 512;
 
+const int MAX_PEER_SCORE = 4;
+
+const int MIN_PEER_SCORE = -4;
+
 } // namespace
 
+const size_t DefaultPeerStorage::MAX_PEER_SCORE_SIZE;
+
 DefaultPeerStorage::DefaultPeerStorage()
     : maxPeerListSize_(MAX_PEER_LIST_SIZE),
       seederStateChoke_(make_unique<BtSeederStateChoke>()),
       leecherStateChoke_(make_unique<BtLeecherStateChoke>()),
-      lastTransferStatMapUpdated_(Timer::zero())
+      lastTransferStatMapUpdated_(Timer::zero()),
+      peerScoreSerial_(0)
 {
 }
 
@@ -77,18 +84,121 @@ size_t DefaultPeerStorage::countAllPeer() const
 
 bool DefaultPeerStorage::isPeerAlreadyAdded(const std::shared_ptr<Peer>& peer)
 {
-  return uniqPeers_.count(
-      std::make_pair(peer->getIPAddress(), peer->getOrigPort()));
+  return uniqPeers_.count(PeerAddr(peer->getIPAddress(), peer->getOrigPort()));
 }
 
 void DefaultPeerStorage::addUniqPeer(const std::shared_ptr<Peer>& peer)
 {
-  uniqPeers_.insert(std::make_pair(peer->getIPAddress(), peer->getOrigPort()));
+  uniqPeers_.insert(PeerAddr(peer->getIPAddress(), peer->getOrigPort()));
+}
+
+int DefaultPeerStorage::getPeerScore(const std::shared_ptr<Peer>& peer) const
+{
+  if (peerScores_.empty()) {
+    return 0;
+  }
+  auto i =
+      peerScores_.find(PeerAddr(peer->getIPAddress(), peer->getOrigPort()));
+  if (i == std::end(peerScores_)) {
+    return 0;
+  }
+  return (*i).second.score;
+}
+
+void DefaultPeerStorage::updatePeerScore(const std::shared_ptr<Peer>& peer,
+                                         bool success)
+{
+  PeerAddr key(peer->getIPAddress(), peer->getOrigPort());
+  auto i = peerScores_.find(key);
+  if (i == std::end(peerScores_)) {
+    if (peerScores_.size() >= MAX_PEER_SCORE_SIZE) {
+      evictPeerScores();
+    }
+    peerScores_.emplace(key, PeerScore{success ? 1 : -1, ++peerScoreSerial_});
+    return;
+  }
+  (*i).second.serial = ++peerScoreSerial_;
+  auto& score = (*i).second.score;
+  if (success) {
+    score = std::min(score + 1, MAX_PEER_SCORE);
+  }
+  else {
+    score = std::max(score - 1, MIN_PEER_SCORE);
+  }
+  if (score == 0) {
+    peerScores_.erase(i);
+  }
+}
+
+void DefaultPeerStorage::evictPeerScores()
+{
+  std::unordered_set<PeerAddr, PeerAddrHash> unusedAddrs;
+  for (auto& peer : unusedPeers_) {
+    unusedAddrs.insert(PeerAddr(peer->getIPAddress(), peer->getOrigPort()));
+  }
+  using ScoreIter = decltype(peerScores_)::iterator;
+  std::vector<ScoreIter> candidates;
+  for (auto i = std::begin(peerScores_), eoi = std::end(peerScores_); i != eoi;
+       ++i) {
+    if (!unusedAddrs.count((*i).first)) {
+      candidates.push_back(i);
+    }
+  }
+  // When all remembered peers are waiting in unusedPeers_, drop the
+  // oldest score and sort unusedPeers_ again.
+  auto resort = candidates.empty();
+  size_t n = 1;
+  if (resort) {
+    for (auto i = std::begin(peerScores_), eoi = std::end(peerScores_);
+         i != eoi; ++i) {
+      candidates.push_back(i);
+    }
+  }
+  else {
+    // Evict several entries at once so that we don't scan the table
+    // every time new peer is scored.
+    n = std::min(candidates.size(), MAX_PEER_SCORE_SIZE / 8);
+  }
+  std::nth_element(std::begin(candidates), std::begin(candidates) + n - 1,
+                   std::end(candidates),
+                   [](const ScoreIter& lhs, const ScoreIter& rhs) {
+                     return (*lhs).second.serial < (*rhs).second.serial;
+                   });
+  for (auto i = std::begin(candidates), eoi = std::begin(candidates) + n;
+       i != eoi; ++i) {
+    peerScores_.erase(*i);
+  }
+  if (resort) {
+    std::stable_sort(std::begin(unusedPeers_), std::end(unusedPeers_),
+                     [this](const std::shared_ptr<Peer>& lhs,
+                            const std::shared_ptr<Peer>& rhs) {
+                       return getPeerScore(lhs) > getPeerScore(rhs);
+                     });
+  }
+}
+
+void DefaultPeerStorage::insertUnusedPeer(const std::shared_ptr<Peer>& peer)
+{
+  if (peerScores_.empty()) {
+    unusedPeers_.push_back(peer);
+    return;
+  }
+  auto score = getPeerScore(peer);
+  unusedPeers_.insert(
+      std::upper_bound(std::begin(unusedPeers_), std::end(unusedPeers_), score,
+                       [this](int score, const std::shared_ptr<Peer>& p) {
+                         return score > getPeerScore(p);
+                       }),
+      peer);
 }
 
 bool DefaultPeerStorage::addPeer(const std::shared_ptr<Peer>& peer)
 {
-  if (unusedPeers_.size() >= maxPeerListSize_) {
+  // If the list is full, the peer can only replace the peer with
+  // lower score.
+  if (unusedPeers_.size() >= maxPeerListSize_ &&
+      (unusedPeers_.empty() ||
+       getPeerScore(peer) <= getPeerScore(unusedPeers_.back()))) {
     A2_LOG_DEBUG(fmt("Adding %s:%u is rejected, since unused peer list is full "
                      "(%lu peers > %lu)",
                      peer->getIPAddress().c_str(), peer->getPort(),
@@ -111,7 +221,7 @@ bool DefaultPeerStorage::addPeer(const std::shared_ptr<Peer>& peer)
   if (peerListSize >= maxPeerListSize_) {
     deleteUnusedPeer(peerListSize - maxPeerListSize_ + 1);
   }
-  unusedPeers_.push_back(peer);
+  insertUnusedPeer(peer);
   addUniqPeer(peer);
   A2_LOG_DEBUG(fmt("Now unused peer list contains %lu peers",
                    static_cast<unsigned long>(unusedPeers_.size())));
@@ -121,40 +231,39 @@ bool DefaultPeerStorage::addPeer(const std::shared_ptr<Peer>& peer)
 void DefaultPeerStorage::addPeer(
     const std::vector<std::shared_ptr<Peer>>& peers)
 {
-  if (unusedPeers_.size() < maxPeerListSize_) {
-    for (auto& peer : peers) {
-      if (isPeerAlreadyAdded(peer)) {
-        A2_LOG_DEBUG(fmt("Adding %s:%u is rejected because it has been already"
-                         " added.",
-                         peer->getIPAddress().c_str(), peer->getPort()));
-        continue;
-      }
-      else if (isBadPeer(peer->getIPAddress())) {
-        A2_LOG_DEBUG(fmt("Adding %s:%u is rejected because it is marked bad.",
-                         peer->getIPAddress().c_str(), peer->getPort()));
-        continue;
-      }
-      else {
-        A2_LOG_DEBUG(fmt(MSG_ADDING_PEER, peer->getIPAddress().c_str(),
-                         peer->getPort()));
-      }
-      unusedPeers_.push_back(peer);
-      addUniqPeer(peer);
-    }
-  }
-  else {
-    for (auto& peer : peers) {
+  for (auto& peer : peers) {
+    if (unusedPeers_.size() >= maxPeerListSize_ &&
+        (unusedPeers_.empty() ||
+         getPeerScore(peer) <= getPeerScore(unusedPeers_.back()))) {
       A2_LOG_DEBUG(
           fmt("Adding %s:%u is rejected, since unused peer list is full "
               "(%lu peers > %lu)",
               peer->getIPAddress().c_str(), peer->getPort(),
               static_cast<unsigned long>(unusedPeers_.size()),
               static_cast<unsigned long>(maxPeerListSize_)));
+      continue;
+    }
+    if (isPeerAlreadyAdded(peer)) {
+      A2_LOG_DEBUG(fmt("Adding %s:%u is rejected because it has been already"
+                       " added.",
+                       peer->getIPAddress().c_str(), peer->getPort()));
+      continue;
+    }
+    else if (isBadPeer(peer->getIPAddress())) {
+      A2_LOG_DEBUG(fmt("Adding %s:%u is rejected because it is marked bad.",
+                       peer->getIPAddress().c_str(), peer->getPort()));
+      continue;
+    }
+    else {
+      A2_LOG_DEBUG(
+          fmt(MSG_ADDING_PEER, peer->getIPAddress().c_str(), peer->getPort()));
+    }
+    insertUnusedPeer(peer);
+    addUniqPeer(peer);
+    const size_t peerListSize = unusedPeers_.size();
+    if (peerListSize > maxPeerListSize_) {
+      deleteUnusedPeer(peerListSize - maxPeerListSize_);
     }
-  }
-  const size_t peerListSize = unusedPeers_.size();
-  if (peerListSize > maxPeerListSize_) {
-    deleteUnusedPeer(peerListSize - maxPeerListSize_);
   }
   A2_LOG_DEBUG(fmt("Now unused peer list contains %lu peers",
                    static_cast<unsigned long>(unusedPeers_.size())));
@@ -220,7 +329,10 @@ bool DefaultPeerStorage::isPeerAvailable() { return !unusedPeers_.empty(); }
 
 bool DefaultPeerStorage::isBadPeer(const std::string& ipaddr)
 {
-  auto i = badPeers_.find(ipaddr);
+  if (badPeers_.empty()) {
+    return false;
+  }
+  auto i = badPeers_.find(PeerAddr(ipaddr, 0));
   if (i == std::end(badPeers_)) {
     return false;
   }
@@ -238,9 +350,7 @@ void DefaultPeerStorage::addBadPeer(const std::string& ipaddr)
   if (lastBadPeerCleaned_.difference(global::wallclock()) >= 1_h) {
     for (auto i = std::begin(badPeers_); i != std::end(badPeers_);) {
       if ((*i).second <= global::wallclock()) {
-        A2_LOG_DEBUG(fmt("Purge %s from bad peer", (*i).first.c_str()));
-        badPeers_.erase(i++);
-        // badPeers_.end() will not be invalidated.
+        i = badPeers_.erase(i);
       }
       else {
         ++i;
@@ -254,7 +364,7 @@ void DefaultPeerStorage::addBadPeer(const std::string& ipaddr)
   t.advance(std::chrono::seconds(
       std::max(SimpleRandomizer::getInstance()->getRandomNumber(601), 120L)));
 
-  badPeers_[ipaddr] = std::move(t);
+  badPeers_[PeerAddr(ipaddr, 0)] = std::move(t);
 }
 
 void DefaultPeerStorage::deleteUnusedPeer(size_t delSize)
@@ -290,7 +400,7 @@ std::shared_ptr<Peer> DefaultPeerStorage::checkoutPeer(cuid_t cuid)
 
 void DefaultPeerStorage::onErasingPeer(const std::shared_ptr<Peer>& peer)
 {
-  uniqPeers_.erase(std::make_pair(peer->getIPAddress(), peer->getOrigPort()));
+  uniqPeers_.erase(PeerAddr(peer->getIPAddress(), peer->getOrigPort()));
 }
 
 void DefaultPeerStorage::onReturningPeer(const std::shared_ptr<Peer>& peer)
@@ -315,6 +425,9 @@ void DefaultPeerStorage::returnPeer(const std::shared_ptr<Peer>& peer)
                    peer->getIPAddress().c_str(), peer->getOrigPort(),
                    peer->usedBy()));
   if (usedPeers_.erase(peer)) {
+    // The session resource is allocated only after the connection
+    // was established.
+    updatePeerScore(peer, peer->isActive());
     onReturningPeer(peer);
     onErasingPeer(peer);
   }
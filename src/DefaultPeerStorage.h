@@ -38,9 +38,11 @@
 #include "PeerStorage.h"
 
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "TimerA2.h"
+#include "PeerAddr.h"
 
 namespace aria2 {
 
@@ -57,8 +59,10 @@ private:
 
   // This contains ip address and port pair and is used to ensure that
   // no duplicate peers are stored.
-  std::set<std::pair<std::string, uint16_t>> uniqPeers_;
-  // Unused (not connected) peers, sorted by last added.
+  std::unordered_set<PeerAddr, PeerAddrHash> uniqPeers_;
+  // Unused (not connected) peers, sorted by connection score in
+  // descending order.  Peers with the same score are sorted by last
+  // added.
   std::deque<std::shared_ptr<Peer>> unusedPeers_;
   // The set of used peers. Some of them are not connected yet. To
   // know it is connected or not, call Peer::isActive().
@@ -71,15 +75,41 @@ private:
 
   Timer lastTransferStatMapUpdated_;
 
-  std::map<std::string, Timer> badPeers_;
+  // Key is the address with port 0.
+  std::unordered_map<PeerAddr, Timer, PeerAddrHash> badPeers_;
   Timer lastBadPeerCleaned_;
 
+  struct PeerScore {
+    int score;
+    // Value of peerScoreSerial_ when score was last updated.
+    uint64_t serial;
+  };
+
+  // Connection score of peers which we have tried to connect.  Score
+  // goes up if the connection was established, and goes down if
+  // not.  Peers with zero score are not stored.
+  std::unordered_map<PeerAddr, PeerScore, PeerAddrHash> peerScores_;
+  uint64_t peerScoreSerial_;
+
   bool isPeerAlreadyAdded(const std::shared_ptr<Peer>& peer);
   void addUniqPeer(const std::shared_ptr<Peer>& peer);
 
+  // Inserts |peer| to unusedPeers_ keeping it sorted by score.
+  void insertUnusedPeer(const std::shared_ptr<Peer>& peer);
+
+  void updatePeerScore(const std::shared_ptr<Peer>& peer, bool success);
+
+  // Removes least recently updated scores from peerScores_ to make
+  // room for new one.  Scores of peers in unusedPeers_ are kept so
+  // that its order is not broken.
+  void evictPeerScores();
+
   void addDroppedPeer(const std::shared_ptr<Peer>& peer);
 
 public:
+  // Maximum number of peers whose connection score is remembered.
+  static const size_t MAX_PEER_SCORE_SIZE = 4096;
+
   DefaultPeerStorage();
 
   virtual ~DefaultPeerStorage();
@@ -132,6 +162,9 @@ public:
   {
     maxPeerListSize_ = maxPeerListSize;
   }
+
+  // Returns connection score of |peer|.  Unknown peer has score 0.
+  int getPeerScore(const std::shared_ptr<Peer>& peer) const;
 };
 
 } // namespace aria2
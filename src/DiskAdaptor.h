@@ -111,6 +111,22 @@ public:
   virtual ssize_t readDataDropCache(unsigned char* data, size_t len,
                                     int64_t offset) = 0;
 
+  // Hints that data in range [offset, offset + len) will be read
+  // soon.  Files which are not opened yet are ignored.
+  virtual void readahead(int64_t len, int64_t offset) {}
+
+  // Finds the file which contains the data at offset, and stores its
+  // file descriptor in fd and the offset relative to the file in
+  // fileOffset.  Returns the number of bytes, up to len, which are
+  // available in that file from fileOffset.  Returns 0 if file
+  // descriptor is not available.  Returned file descriptor is owned
+  // by this object.
+  virtual size_t getFileRange(int& fd, int64_t& fileOffset, size_t len,
+                              int64_t offset)
+  {
+    return 0;
+  }
+
   // Writes cached data to the underlying disk.
   virtual void writeCache(const WrDiskCacheEntry* entry) = 0;
 
@@ -86,6 +86,14 @@ public:
   // Drops cache in range [offset, offset + len)
   virtual void dropCache(int64_t len, int64_t offset) {}
 
+  // Hints that data in range [offset, offset + len) will be read
+  // soon.
+  virtual void readahead(int64_t len, int64_t offset) {}
+
+  // Returns file descriptor of the opened file, which can be used for
+  // zero-copy transfer.  Returns -1 if it is not available.
+  virtual int getFd() const { return -1; }
+
   // Force physical write of data from OS buffer cache.
   virtual void flushOSBuffers() {}
 };
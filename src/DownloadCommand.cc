@@ -157,8 +157,12 @@ bool DownloadCommand::executeInternal()
     // read data from socket here, we will get EOF and leaves 2nd
     // response unprocessed.  To prevent this, we don't read from
     // socket when buffer is not empty.
-    eof = getSocketRecvBuffer()->recv() == 0 && !getSocket()->wantRead() &&
-          !getSocket()->wantWrite();
+    // Read no more than this connection's share of the bandwidth
+    // budget, so that connections of a rate limited download progress
+    // evenly.
+    eof = getSocketRecvBuffer()->recv(
+              getRequestGroup()->getConnectionDownloadBudget()) == 0 &&
+          getSocketRecvBuffer()->eof();
   }
   if (!eof) {
     size_t bufSize;
@@ -304,18 +304,22 @@ void DownloadContext::setSignature(std::unique_ptr<Signature> signature)
 void DownloadContext::updateDownload(size_t bytes)
 {
   netStat_.updateDownload(bytes);
+  ownerRequestGroup_->consumeDownloadBandwidth(bytes);
   RequestGroupMan* rgman = ownerRequestGroup_->getRequestGroupMan();
   if (rgman) {
     rgman->getNetStat().updateDownload(bytes);
+    rgman->consumeDownloadBandwidth(bytes);
   }
 }
 
 void DownloadContext::updateUploadSpeed(size_t bytes)
 {
   netStat_.updateUploadSpeed(bytes);
+  ownerRequestGroup_->consumeUploadBandwidth(bytes);
   auto rgman = ownerRequestGroup_->getRequestGroupMan();
   if (rgman) {
     rgman->getNetStat().updateUploadSpeed(bytes);
+    rgman->consumeUploadBandwidth(bytes);
   }
 }
 
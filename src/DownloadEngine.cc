@@ -63,10 +63,13 @@
 #include "Command.h"
 #include "FileAllocationEntry.h"
 #include "CheckIntegrityEntry.h"
+#include "PieceHashCheckPool.h"
+#include "BlockBufferPool.h"
 #include "BtProgressInfoFile.h"
 #include "DownloadContext.h"
 #include "fmt.h"
 #include "wallclock.h"
+#include "TokenBucket.h"
 #ifdef ENABLE_BITTORRENT
 #  include "BtRegistry.h"
 #endif // ENABLE_BITTORRENT
@@ -75,6 +78,13 @@
 #endif // ENABLE_WEBSOCKET
 #include "Option.h"
 #include "util_security.h"
+#include "HttpPipeline.h"
+#ifdef HAVE_LIBNGHTTP2
+#  include "Http2Session.h"
+#endif // HAVE_LIBNGHTTP2
+#ifdef ENABLE_SSL
+#  include "TLSSessionCache.h"
+#endif // ENABLE_SSL
 
 namespace aria2 {
 
@@ -92,10 +102,25 @@ volatile sig_atomic_t globalHaltRequested = 0;
 
 namespace {
 constexpr auto DEFAULT_REFRESH_INTERVAL = 1_s;
+// HttpPipeline without request is closed after this period, just
+// like pooled socket.
+constexpr auto HTTP_PIPELINE_IDLE_TIMEOUT = 15_s;
+#ifdef HAVE_LIBNGHTTP2
+// HTTP/2 session without stream is closed after this period, just
+// like pooled socket.
+constexpr auto HTTP2_SESSION_IDLE_TIMEOUT = 15_s;
+#endif // HAVE_LIBNGHTTP2
+// The size of buffer in blockBufferPool_.  It can hold a BitTorrent
+// block of default length with 13 bytes piece message header.
+constexpr size_t BLOCK_BUFFER_SIZE = 16_k + 13;
+// The maximum number of buffers kept in blockBufferPool_ for reuse.
+constexpr size_t MAX_FREE_BLOCK_BUFFERS = 256;
 } // namespace
 
 DownloadEngine::DownloadEngine(std::unique_ptr<EventPoll> eventPoll)
     : eventPoll_(std::move(eventPoll)),
+      blockBufferPool_(make_unique<BlockBufferPool>(BLOCK_BUFFER_SIZE,
+                                                    MAX_FREE_BLOCK_BUFFERS)),
       haltRequested_(0),
       noWait_(true),
       refreshInterval_(DEFAULT_REFRESH_INTERVAL),
@@ -173,6 +198,9 @@ int DownloadEngine::run(bool oneshot)
     noWait_ = false;
     global::wallclock().reset();
     calculateStatistics();
+    if (requestGroupMan_) {
+      requestGroupMan_->scheduleBandwidth(global::wallclock());
+    }
     if (lastRefresh_.difference(global::wallclock()) + A2_DELTA_MILLIS >=
         refreshInterval_) {
       refreshInterval_ = DEFAULT_REFRESH_INTERVAL;
@@ -184,6 +212,11 @@ int DownloadEngine::run(bool oneshot)
     }
     executeCommand(routineCommands_, Command::STATUS_ALL);
     afterEachIteration();
+    if (requestGroupMan_ && requestGroupMan_->isBandwidthThrottled()) {
+      // Commands which ran out of bandwidth budget do not watch their
+      // sockets.  Wake them up when the next budget is handed out.
+      refreshInterval_ = std::min(refreshInterval_, BANDWIDTH_SCHEDULE_INTERVAL);
+    }
     if (!noWait_ && oneshot) {
       return 1;
     }
@@ -247,6 +280,18 @@ void DownloadEngine::onEndOfRun()
   requestGroupMan_->removeStoppedGroup(this);
   requestGroupMan_->closeFile();
   requestGroupMan_->save();
+  A2_LOG_INFO(fmt("Block buffer pool: hits=%" PRIu64 ", misses=%" PRIu64
+                  ", free=%lu",
+                  blockBufferPool_->getHits(), blockBufferPool_->getMisses(),
+                  static_cast<unsigned long>(
+                      blockBufferPool_->getNumFreeBuffers())));
+#ifdef ENABLE_SSL
+  auto& tlsSessionCache = SocketCore::getTLSSessionCache();
+  if (tlsSessionCache) {
+    A2_LOG_INFO(fmt("TLS session cache: hits=%" PRIu64 ", misses=%" PRIu64,
+                    tlsSessionCache->getHits(), tlsSessionCache->getMisses()));
+  }
+#endif // ENABLE_SSL
 }
 
 void DownloadEngine::afterEachIteration()
@@ -319,6 +364,28 @@ void DownloadEngine::poolSocket(const std::string& key,
 
 void DownloadEngine::evictSocketPool()
 {
+  for (auto i = std::begin(httpPipelines_); i != std::end(httpPipelines_);) {
+    if ((*i).second->isTimeout(HTTP_PIPELINE_IDLE_TIMEOUT)) {
+      A2_LOG_DEBUG(fmt("Removing HTTP pipeline to %s", (*i).first.c_str()));
+      i = httpPipelines_.erase(i);
+    }
+    else {
+      ++i;
+    }
+  }
+
+#ifdef HAVE_LIBNGHTTP2
+  for (auto i = std::begin(http2Sessions_); i != std::end(http2Sessions_);) {
+    if ((*i).second->isTimeout(HTTP2_SESSION_IDLE_TIMEOUT)) {
+      A2_LOG_DEBUG(fmt("Removing HTTP/2 session to %s", (*i).first.c_str()));
+      i = http2Sessions_.erase(i);
+    }
+    else {
+      ++i;
+    }
+  }
+#endif // HAVE_LIBNGHTTP2
+
   if (socketPool_.empty()) {
     return;
   }
@@ -336,6 +403,61 @@ void DownloadEngine::evictSocketPool()
   socketPool_ = std::move(newPool);
 }
 
+void DownloadEngine::addHttpPipeline(
+    const std::string& hostname, uint16_t port,
+    const std::shared_ptr<HttpPipeline>& pipeline)
+{
+  httpPipelines_[fmt("%s:%u", hostname.c_str(), port)] = pipeline;
+}
+
+std::shared_ptr<HttpPipeline>
+DownloadEngine::findHttpPipeline(const std::string& hostname, uint16_t port)
+{
+  auto i = httpPipelines_.find(fmt("%s:%u", hostname.c_str(), port));
+  if (i == std::end(httpPipelines_)) {
+    return nullptr;
+  }
+  auto& pipeline = (*i).second;
+  if (pipeline->isTimeout(HTTP_PIPELINE_IDLE_TIMEOUT)) {
+    httpPipelines_.erase(i);
+    return nullptr;
+  }
+  if (!pipeline->canAttach()) {
+    return nullptr;
+  }
+  return pipeline;
+}
+
+#ifdef HAVE_LIBNGHTTP2
+void DownloadEngine::addHttp2Session(
+    const std::string& hostname, uint16_t port,
+    const std::shared_ptr<Http2Session>& session)
+{
+  http2Sessions_[fmt("%s:%u", hostname.c_str(), port)] = session;
+}
+
+std::shared_ptr<Http2Session>
+DownloadEngine::findHttp2Session(const std::string& hostname, uint16_t port)
+{
+  auto i = http2Sessions_.find(fmt("%s:%u", hostname.c_str(), port));
+  if (i == std::end(http2Sessions_)) {
+    return nullptr;
+  }
+  auto session = (*i).second;
+  // An idle session is not read by anyone.  Process the frames it
+  // received meanwhile, such as GOAWAY, before handing it out.
+  session->performIO();
+  if (session->isTimeout(HTTP2_SESSION_IDLE_TIMEOUT)) {
+    http2Sessions_.erase(i);
+    return nullptr;
+  }
+  if (!session->canOpenStream()) {
+    return nullptr;
+  }
+  return session;
+}
+#endif // HAVE_LIBNGHTTP2
+
 namespace {
 std::string createSockPoolKey(const std::string& host, uint16_t port,
                               const std::string& username,
@@ -544,9 +666,10 @@ DownloadEngine::findCachedIPAddress(const std::string& hostname,
 }
 
 void DownloadEngine::cacheIPAddress(const std::string& hostname,
-                                    const std::string& ipaddr, uint16_t port)
+                                    const std::string& ipaddr, uint16_t port,
+                                    const std::chrono::seconds& ttl)
 {
-  dnsCache_->put(hostname, ipaddr, port);
+  dnsCache_->put(hostname, ipaddr, port, ttl);
 }
 
 void DownloadEngine::markBadIPAddress(const std::string& hostname,
@@ -612,6 +735,12 @@ void DownloadEngine::setCheckIntegrityMan(
   checkIntegrityMan_ = std::move(ciman);
 }
 
+void DownloadEngine::setPieceHashCheckPool(
+    std::unique_ptr<PieceHashCheckPool> pool)
+{
+  pieceHashCheckPool_ = std::move(pool);
+}
+
 #ifdef HAVE_ARES_ADDR_NODE
 void DownloadEngine::setAsyncDNSServers(ares_addr_node* asyncDNSServers)
 {
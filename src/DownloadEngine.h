@@ -65,6 +65,12 @@ class AuthConfigFactory;
 class Request;
 class EventPoll;
 class Command;
+class PieceHashCheckPool;
+class BlockBufferPool;
+class HttpPipeline;
+#ifdef HAVE_LIBNGHTTP2
+class Http2Session;
+#endif // HAVE_LIBNGHTTP2
 #ifdef ENABLE_BITTORRENT
 class BtRegistry;
 #endif // ENABLE_BITTORRENT
@@ -89,6 +95,10 @@ private:
 
   std::unique_ptr<EventPoll> eventPoll_;
 
+  // Buffers in this pool are held by disk cache and socket buffers.
+  // Declared before them so that it is destroyed last.
+  std::unique_ptr<BlockBufferPool> blockBufferPool_;
+
   std::unique_ptr<StatCalc> statCalc_;
 
   int haltRequested_;
@@ -124,6 +134,14 @@ private:
 
   Timer lastSocketPoolScan_;
 
+  // key = hostname:port
+  std::map<std::string, std::shared_ptr<HttpPipeline>> httpPipelines_;
+
+#ifdef HAVE_LIBNGHTTP2
+  // key = hostname:port
+  std::map<std::string, std::shared_ptr<Http2Session>> http2Sessions_;
+#endif // HAVE_LIBNGHTTP2
+
   bool noWait_;
 
   std::chrono::milliseconds refreshInterval_;
@@ -166,6 +184,7 @@ private:
   std::unique_ptr<RequestGroupMan> requestGroupMan_;
   std::unique_ptr<FileAllocationMan> fileAllocationMan_;
   std::unique_ptr<CheckIntegrityMan> checkIntegrityMan_;
+  std::unique_ptr<PieceHashCheckPool> pieceHashCheckPool_;
   Option* option_;
   // Ensure that Commands are cleaned up before requestGroupMan_ is
   // deleted.
@@ -229,6 +248,20 @@ public:
 
   void setCheckIntegrityMan(std::unique_ptr<CheckIntegrityMan> ciman);
 
+  // Returns nullptr if piece hash computation is not offloaded to
+  // worker threads.
+  PieceHashCheckPool* getPieceHashCheckPool() const
+  {
+    return pieceHashCheckPool_.get();
+  }
+
+  void setPieceHashCheckPool(std::unique_ptr<PieceHashCheckPool> pool);
+
+  BlockBufferPool* getBlockBufferPool() const
+  {
+    return blockBufferPool_.get();
+  }
+
   Option* getOption() const { return option_; }
 
   void setOption(Option* op) { option_ = op; }
@@ -289,6 +322,28 @@ public:
 
   void evictSocketPool();
 
+  // Registers |pipeline| connected to |hostname|:|port| so that the
+  // requests of other downloads to the same host are sent in it.
+  void addHttpPipeline(const std::string& hostname, uint16_t port,
+                       const std::shared_ptr<HttpPipeline>& pipeline);
+
+  // Returns HttpPipeline connected to |hostname|:|port| which can
+  // send one more request, or nullptr.
+  std::shared_ptr<HttpPipeline> findHttpPipeline(const std::string& hostname,
+                                                 uint16_t port);
+
+#ifdef HAVE_LIBNGHTTP2
+  // Registers |session| connected to |hostname|:|port| so that other
+  // requests to the same host open streams in it.
+  void addHttp2Session(const std::string& hostname, uint16_t port,
+                       const std::shared_ptr<Http2Session>& session);
+
+  // Returns HTTP/2 session connected to |hostname|:|port| which can
+  // open a new stream, or nullptr.
+  std::shared_ptr<Http2Session> findHttp2Session(const std::string& hostname,
+                                                 uint16_t port);
+#endif // HAVE_LIBNGHTTP2
+
   const std::unique_ptr<CookieStorage>& getCookieStorage() const;
 
 #ifdef ENABLE_BITTORRENT
@@ -311,13 +366,16 @@ public:
   }
 
   void cacheIPAddress(const std::string& hostname, const std::string& ipaddr,
-                      uint16_t port);
+                      uint16_t port,
+                      const std::chrono::seconds& ttl = std::chrono::seconds(0));
 
   void markBadIPAddress(const std::string& hostname, const std::string& ipaddr,
                         uint16_t port);
 
   void removeCachedIPAddress(const std::string& hostname, uint16_t port);
 
+  const std::unique_ptr<DNSCache>& getDNSCache() const { return dnsCache_; }
+
   void setAuthConfigFactory(std::unique_ptr<AuthConfigFactory> factory);
 
   const std::unique_ptr<AuthConfigFactory>& getAuthConfigFactory() const;
@@ -58,12 +58,17 @@
 #include "DownloadContext.h"
 #include "array_fun.h"
 #include "EvictSocketPoolCommand.h"
+#include "PieceHashCheckPool.h"
+#include "PieceHashCheckCommand.h"
 #ifdef HAVE_LIBUV
 #  include "LibuvEventPoll.h"
 #endif // HAVE_LIBUV
 #ifdef HAVE_EPOLL
 #  include "EpollEventPoll.h"
 #endif // HAVE_EPOLL
+#ifdef HAVE_IO_URING
+#  include "IoUringEventPoll.h"
+#endif // HAVE_IO_URING
 #ifdef HAVE_PORT_ASSOCIATE
 #  include "PortEventPoll.h"
 #endif // HAVE_PORT_ASSOCIATE
@@ -98,6 +103,17 @@ std::unique_ptr<EventPoll> createEventPoll(Option* op)
   }
   else
 #endif // HAVE_LIBUV
+#ifdef HAVE_IO_URING
+      if (pollMethod == V_IO_URING) {
+    auto ep = selectIoUringEventPoll(make_unique<IoUringEventPoll>());
+    if (ep) {
+      return ep;
+    }
+    throw DL_ABORT_EX("Initializing IoUringEventPoll failed."
+                      " Try --event-poll=select");
+  }
+  else
+#endif // HAVE_IO_URING
 #ifdef HAVE_EPOLL
       if (pollMethod == V_EPOLL) {
     auto ep = make_unique<EpollEventPoll>();
@@ -159,7 +175,8 @@ std::unique_ptr<DownloadEngine> DownloadEngineFactory::newDownloadEngine(
     e->setRequestGroupMan(std::move(requestGroupMan));
   }
   e->setFileAllocationMan(make_unique<FileAllocationMan>());
-  e->setCheckIntegrityMan(make_unique<CheckIntegrityMan>());
+  e->setCheckIntegrityMan(make_unique<CheckIntegrityMan>(
+      op->getAsInt(PREF_MAX_CONCURRENT_INTEGRITY_CHECKS)));
   e->addRoutineCommand(
       make_unique<FillRequestGroupCommand>(e->newCUID(), e.get()));
   e->addRoutineCommand(make_unique<FileAllocationDispatcherCommand>(
@@ -168,6 +185,19 @@ std::unique_ptr<DownloadEngine> DownloadEngineFactory::newDownloadEngine(
       e->newCUID(), e->getCheckIntegrityMan().get(), e.get()));
   e->addRoutineCommand(
       make_unique<EvictSocketPoolCommand>(e->newCUID(), e.get(), 30_s));
+  if (op->getAsInt(PREF_HASH_CHECK_THREADS) > 0) {
+    auto pool = make_unique<PieceHashCheckPool>(
+        op->getAsInt(PREF_HASH_CHECK_THREADS));
+    if (pool->init()) {
+      e->setPieceHashCheckPool(std::move(pool));
+      e->addRoutineCommand(make_unique<PieceHashCheckCommand>(
+          e->newCUID(), e.get(), e->getPieceHashCheckPool()));
+    }
+    else {
+      A2_LOG_WARN("Hash check threads are not available. Piece hashes are"
+                  " computed in the main event loop.");
+    }
+  }
 
   if (op->getAsInt(PREF_AUTO_SAVE_INTERVAL) > 0) {
     e->addRoutineCommand(make_unique<AutoSaveCommand>(
@@ -109,7 +109,9 @@ void EpollEventPoll::poll(const struct timeval& tv)
   int timeout = tv.tv_sec * 1000 + tv.tv_usec / 1000;
 
   int res;
-  while ((res = epoll_wait(epfd_, epEvents_.get(), EPOLL_EVENTS_MAX,
+  // epEvents_ grows with the number of sockets.  Use all of it so
+  // that events of all busy sockets are retrieved in one call.
+  while ((res = epoll_wait(epfd_, epEvents_.get(), epEventsSize_,
                            timeout)) == -1 &&
          errno == EINTR)
     ;
@@ -70,6 +70,15 @@
 #ifdef HAVE_LIBSSH2
 #  include <libssh2.h>
 #endif // HAVE_LIBSSH2
+#ifdef HAVE_LIBNGHTTP2
+#  include <nghttp2/nghttp2.h>
+#endif // HAVE_LIBNGHTTP2
+#ifdef HAVE_LIBZSTD
+#  include <zstd.h>
+#endif // HAVE_LIBZSTD
+#ifdef HAVE_LIBBROTLI
+#  include <brotli/decode.h>
+#endif // HAVE_LIBBROTLI
 #include "util.h"
 
 namespace aria2 {
@@ -183,6 +192,30 @@ const char* strSupportedFeature(int feature)
 #endif // !HAVE_LIBSSH2
     break;
 
+  case (FEATURE_HTTP2):
+#if defined(ENABLE_SSL) && defined(HAVE_LIBNGHTTP2)
+    return "HTTP/2";
+#else  // !ENABLE_SSL || !HAVE_LIBNGHTTP2
+    return nullptr;
+#endif // !ENABLE_SSL || !HAVE_LIBNGHTTP2
+    break;
+
+  case (FEATURE_ZSTD):
+#ifdef HAVE_LIBZSTD
+    return "Zstd";
+#else  // !HAVE_LIBZSTD
+    return nullptr;
+#endif // !HAVE_LIBZSTD
+    break;
+
+  case (FEATURE_BROTLI):
+#ifdef HAVE_LIBBROTLI
+    return "Brotli";
+#else  // !HAVE_LIBBROTLI
+    return nullptr;
+#endif // !HAVE_LIBBROTLI
+    break;
+
   default:
     return nullptr;
   }
@@ -241,6 +274,22 @@ std::string usedLibs()
   res += "libssh2/" LIBSSH2_VERSION " ";
 #endif // HAVE_LIBSSH2
 
+#ifdef HAVE_LIBNGHTTP2
+  res += "nghttp2/" NGHTTP2_VERSION " ";
+#endif // HAVE_LIBNGHTTP2
+
+#ifdef HAVE_LIBZSTD
+  res += "zstd/" ZSTD_VERSION_STRING " ";
+#endif // HAVE_LIBZSTD
+
+#ifdef HAVE_LIBBROTLI
+  {
+    // The version is encoded as (major << 24) | (minor << 12) | patch.
+    auto v = BrotliDecoderVersion();
+    res += fmt("brotli/%u.%u.%u ", v >> 24, (v >> 12) & 0xfff, v & 0xfff);
+  }
+#endif // HAVE_LIBBROTLI
+
   if (!res.empty()) {
     res.erase(res.length() - 1);
   }
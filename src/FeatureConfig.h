@@ -54,6 +54,9 @@ enum FeatureType {
   FEATURE_METALINK,
   FEATURE_XML_RPC,
   FEATURE_SFTP,
+  FEATURE_HTTP2,
+  FEATURE_ZSTD,
+  FEATURE_BROTLI,
   MAX_FEATURE
 };
 
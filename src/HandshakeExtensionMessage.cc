@@ -33,6 +33,9 @@
  */
 /* copyright --> */
 #include "HandshakeExtensionMessage.h"
+
+#include <algorithm>
+
 #include "Peer.h"
 #include "util.h"
 #include "DlAbortEx.h"
@@ -52,7 +55,7 @@ namespace aria2 {
 const char HandshakeExtensionMessage::EXTENSION_NAME[] = "handshake";
 
 HandshakeExtensionMessage::HandshakeExtensionMessage()
-    : tcpPort_{0}, metadataSize_{0}, dctx_{nullptr}
+    : tcpPort_{0}, metadataSize_{0}, reqq_{0}, dctx_{nullptr}
 {
 }
 
@@ -100,6 +103,9 @@ void HandshakeExtensionMessage::doReceivedAction()
     peer_->setPort(tcpPort_);
     peer_->setIncomingPeer(false);
   }
+  if (reqq_ > 0) {
+    peer_->setReqq(reqq_);
+  }
   for (int i = 0; i < ExtensionMessageRegistry::MAX_EXTENSION; ++i) {
     int id = extreg_.getExtensionMessageID(i);
     if (id) {
@@ -184,6 +190,11 @@ HandshakeExtensionMessage::create(const unsigned char* data, size_t length)
   if (version) {
     msg->clientVersion_ = version->s();
   }
+  const Integer* reqq = downcast<Integer>(dict->get("reqq"));
+  if (reqq && reqq->i() > 0) {
+    msg->reqq_ = std::min(reqq->i(), static_cast<int64_t>(
+                                         UB_MAX_OUTSTANDING_REQUEST));
+  }
   const Dict* extDict = downcast<Dict>(dict->get("m"));
   if (extDict) {
     for (auto& elem : *extDict) {
@@ -0,0 +1,519 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "Http2Session.h"
+
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include <vector>
+
+#include <nghttp2/nghttp2.h>
+
+#include "SocketCore.h"
+#include "DownloadEngine.h"
+#include "DlRetryEx.h"
+#include "DlAbortEx.h"
+#include "RecoverableException.h"
+#include "LogFactory.h"
+#include "Logger.h"
+#include "fmt.h"
+#include "util.h"
+#include "wallclock.h"
+#include "a2functional.h"
+#include "array_fun.h"
+
+namespace aria2 {
+
+const std::string Http2Session::ALPN_PROTOS(NGHTTP2_PROTO_ALPN "\x8http/1.1");
+
+const std::string Http2Session::PROTO_ID(NGHTTP2_PROTO_VERSION_ID);
+
+namespace {
+int onHeaderCallback(nghttp2_session* session, const nghttp2_frame* frame,
+                     const uint8_t* name, size_t namelen, const uint8_t* value,
+                     size_t valuelen, uint8_t flags, void* userData)
+{
+  if (frame->hd.type != NGHTTP2_HEADERS) {
+    return 0;
+  }
+  static_cast<Http2Session*>(userData)->onHeader(
+      frame->hd.stream_id, std::string(name, name + namelen),
+      std::string(value, value + valuelen));
+  return 0;
+}
+} // namespace
+
+namespace {
+int onFrameRecvCallback(nghttp2_session* session, const nghttp2_frame* frame,
+                        void* userData)
+{
+  auto h2session = static_cast<Http2Session*>(userData);
+  switch (frame->hd.type) {
+  case NGHTTP2_HEADERS:
+    h2session->onHeadersComplete(frame->hd.stream_id);
+    break;
+  case NGHTTP2_GOAWAY:
+    h2session->onGoaway();
+    break;
+  }
+  return 0;
+}
+} // namespace
+
+namespace {
+int onDataChunkRecvCallback(nghttp2_session* session, uint8_t flags,
+                            int32_t streamId, const uint8_t* data, size_t len,
+                            void* userData)
+{
+  static_cast<Http2Session*>(userData)->onData(streamId, data, len);
+  return 0;
+}
+} // namespace
+
+namespace {
+int onStreamCloseCallback(nghttp2_session* session, int32_t streamId,
+                          uint32_t errorCode, void* userData)
+{
+  static_cast<Http2Session*>(userData)->onStreamClose(streamId, errorCode);
+  return 0;
+}
+} // namespace
+
+Http2Session::Stream::Stream()
+    : pos(0),
+      headerLeft(0),
+      headersComplete(false),
+      closed(false),
+      errorCode(NGHTTP2_NO_ERROR)
+{
+}
+
+Http2Session::Http2Session(const std::shared_ptr<SocketCore>& socket,
+                           DownloadEngine* e)
+    : socket_(socket),
+      e_(e),
+      session_(nullptr),
+      readingStreamId_(0),
+      lastActivity_(global::wallclock()),
+      failed_(false),
+      goaway_(false)
+{
+  nghttp2_session_callbacks* callbacks;
+  if (nghttp2_session_callbacks_new(&callbacks) != 0) {
+    throw DL_ABORT_EX("Could not allocate HTTP/2 session callbacks");
+  }
+  nghttp2_session_callbacks_set_on_header_callback(callbacks,
+                                                   onHeaderCallback);
+  nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks,
+                                                       onFrameRecvCallback);
+  nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
+      callbacks, onDataChunkRecvCallback);
+  nghttp2_session_callbacks_set_on_stream_close_callback(
+      callbacks, onStreamCloseCallback);
+
+  nghttp2_option* option;
+  if (nghttp2_option_new(&option) != 0) {
+    nghttp2_session_callbacks_del(callbacks);
+    throw DL_ABORT_EX("Could not allocate HTTP/2 session option");
+  }
+  // Window is given back when the command reads the data, so that a
+  // slow or rate limited download does not make us buffer unbounded
+  // amount of data.
+  nghttp2_option_set_no_auto_window_update(option, 1);
+
+  auto rv = nghttp2_session_client_new2(&session_, callbacks, this, option);
+  nghttp2_option_del(option);
+  nghttp2_session_callbacks_del(callbacks);
+  if (rv != 0) {
+    throw DL_ABORT_EX(fmt("Could not create HTTP/2 session: %s",
+                          nghttp2_strerror(rv)));
+  }
+
+  nghttp2_settings_entry iv[] = {
+      {NGHTTP2_SETTINGS_ENABLE_PUSH, 0},
+      {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, static_cast<uint32_t>(1_m)},
+  };
+  nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, iv, arraySize(iv));
+  nghttp2_session_set_local_window_size(session_, NGHTTP2_FLAG_NONE, 0,
+                                        static_cast<int32_t>(16_m));
+  flush();
+}
+
+Http2Session::~Http2Session() { nghttp2_session_del(session_); }
+
+namespace {
+nghttp2_nv makeNv(const std::string& name, const std::string& value)
+{
+  return {reinterpret_cast<uint8_t*>(const_cast<char*>(name.c_str())),
+          reinterpret_cast<uint8_t*>(const_cast<char*>(value.c_str())),
+          name.size(), value.size(), NGHTTP2_NV_FLAG_NONE};
+}
+} // namespace
+
+namespace {
+// Header fields which are specific to HTTP/1.1 connection, and must
+// not be sent in HTTP/2.
+const char* CONNECTION_SPECIFIC_FIELDS[] = {
+    "connection", "keep-alive", "proxy-connection", "transfer-encoding",
+    "upgrade",
+};
+} // namespace
+
+int32_t Http2Session::submitRequest(const std::string& scheme,
+                                    const std::string& request)
+{
+  if (!canOpenStream()) {
+    throw DL_RETRY_EX("HTTP/2 session cannot open new stream");
+  }
+  // Convert HTTP/1.1 request header into HTTP/2 pseudo and regular
+  // header fields.
+  std::vector<std::pair<std::string, std::string>> fields;
+  auto eol = request.find("\r\n");
+  auto reqline = request.substr(0, eol);
+  auto sp1 = reqline.find(' ');
+  auto sp2 = reqline.rfind(' ');
+  if (eol == std::string::npos || sp1 == std::string::npos || sp1 == sp2) {
+    throw DL_ABORT_EX("Bad HTTP request line");
+  }
+  fields.emplace_back(":method", reqline.substr(0, sp1));
+  fields.emplace_back(":scheme", scheme);
+  fields.emplace_back(":authority", "");
+  fields.emplace_back(":path", reqline.substr(sp1 + 1, sp2 - sp1 - 1));
+  for (auto first = eol + 2; first < request.size();) {
+    eol = request.find("\r\n", first);
+    if (eol == std::string::npos || eol == first) {
+      break;
+    }
+    auto line = request.substr(first, eol - first);
+    first = eol + 2;
+    auto colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    auto name = util::strip(line.substr(0, colon));
+    util::lowercase(name);
+    auto value = util::strip(line.substr(colon + 1));
+    if (name == "host") {
+      fields[2].second = value;
+      continue;
+    }
+    if (std::find_if(std::begin(CONNECTION_SPECIFIC_FIELDS),
+                     std::end(CONNECTION_SPECIFIC_FIELDS),
+                     [&name](const char* s) { return name == s; }) !=
+        std::end(CONNECTION_SPECIFIC_FIELDS)) {
+      continue;
+    }
+    fields.emplace_back(std::move(name), std::move(value));
+  }
+
+  std::vector<nghttp2_nv> nva;
+  nva.reserve(fields.size());
+  for (const auto& f : fields) {
+    nva.push_back(makeNv(f.first, f.second));
+  }
+  auto streamId = nghttp2_submit_request(session_, nullptr, nva.data(),
+                                         nva.size(), nullptr, nullptr);
+  if (streamId < 0) {
+    throw DL_RETRY_EX(fmt("Could not submit HTTP/2 request: %s",
+                          nghttp2_strerror(streamId)));
+  }
+  A2_LOG_DEBUG(fmt("HTTP/2 stream %d opened", streamId));
+  streams_.emplace(streamId, Stream());
+  flush();
+  return streamId;
+}
+
+size_t Http2Session::readStream(int32_t streamId, unsigned char* data,
+                                size_t len)
+{
+  readingStreamId_ = streamId;
+  performIO();
+  readingStreamId_ = 0;
+  auto i = streams_.find(streamId);
+  if (i == std::end(streams_)) {
+    throw DL_RETRY_EX(fmt("HTTP/2 stream %d was not found", streamId));
+  }
+  auto& stream = (*i).second;
+  auto n = std::min(len, stream.buf.size() - stream.pos);
+  if (n == 0) {
+    if (stream.closed &&
+        (stream.errorCode != NGHTTP2_NO_ERROR || !stream.headersComplete)) {
+      throw DL_RETRY_EX(
+          fmt("HTTP/2 stream %d was closed: %s", streamId,
+              failed_ ? error_.c_str()
+                      : nghttp2_http2_strerror(stream.errorCode)));
+    }
+    return 0;
+  }
+  memcpy(data, stream.buf.data() + stream.pos, n);
+  stream.pos += n;
+  if (stream.pos == stream.buf.size()) {
+    stream.buf.clear();
+    stream.pos = 0;
+  }
+  auto hlen = std::min(n, stream.headerLeft);
+  stream.headerLeft -= hlen;
+  if (n > hlen && !failed_) {
+    nghttp2_session_consume(session_, streamId, n - hlen);
+    flush();
+  }
+  return n;
+}
+
+bool Http2Session::hasPendingData(int32_t streamId) const
+{
+  auto i = streams_.find(streamId);
+  return i != std::end(streams_) &&
+         ((*i).second.closed || (*i).second.pos < (*i).second.buf.size());
+}
+
+bool Http2Session::streamEnded(int32_t streamId) const
+{
+  auto i = streams_.find(streamId);
+  return i == std::end(streams_) ||
+         ((*i).second.closed && (*i).second.pos == (*i).second.buf.size());
+}
+
+void Http2Session::closeStream(int32_t streamId)
+{
+  auto i = streams_.find(streamId);
+  if (i == std::end(streams_)) {
+    return;
+  }
+  auto& stream = (*i).second;
+  if (!failed_) {
+    if (!stream.closed) {
+      A2_LOG_DEBUG(fmt("Canceling HTTP/2 stream %d", streamId));
+      nghttp2_submit_rst_stream(session_, NGHTTP2_FLAG_NONE, streamId,
+                                NGHTTP2_CANCEL);
+    }
+    // Give back the window for the data we are not going to read.
+    auto unread = stream.buf.size() - stream.pos - stream.headerLeft;
+    if (unread) {
+      nghttp2_session_consume(session_, streamId, unread);
+    }
+  }
+  streams_.erase(i);
+  if (streams_.empty()) {
+    lastActivity_ = global::wallclock();
+  }
+  flush();
+}
+
+void Http2Session::performIO()
+{
+  if (failed_) {
+    return;
+  }
+  try {
+    std::array<unsigned char, 16_k> buf;
+    for (;;) {
+      size_t len = buf.size();
+      socket_->readData(buf.data(), len);
+      if (len == 0) {
+        if (!socket_->wantRead() && !socket_->wantWrite()) {
+          fail("connection closed by peer");
+          return;
+        }
+        break;
+      }
+      auto rv = nghttp2_session_mem_recv(session_, buf.data(), len);
+      if (rv < 0) {
+        fail(nghttp2_strerror(rv));
+        return;
+      }
+    }
+    send();
+  }
+  catch (RecoverableException& e) {
+    fail(e.what());
+  }
+}
+
+void Http2Session::send()
+{
+  for (;;) {
+    if (sendBuf_.empty()) {
+      const uint8_t* data;
+      auto len = nghttp2_session_mem_send(session_, &data);
+      if (len < 0) {
+        throw DL_ABORT_EX(nghttp2_strerror(len));
+      }
+      if (len == 0) {
+        return;
+      }
+      sendBuf_.assign(data, data + len);
+    }
+    auto n = socket_->writeData(sendBuf_.data(), sendBuf_.size());
+    if (n == 0) {
+      return;
+    }
+    sendBuf_.erase(0, n);
+  }
+}
+
+void Http2Session::flush()
+{
+  if (failed_) {
+    return;
+  }
+  try {
+    send();
+  }
+  catch (RecoverableException& e) {
+    fail(e.what());
+  }
+}
+
+void Http2Session::fail(const std::string& error)
+{
+  A2_LOG_INFO(fmt("HTTP/2 session failed: %s", error.c_str()));
+  failed_ = true;
+  error_ = error;
+  for (auto& kv : streams_) {
+    if (!kv.second.closed) {
+      kv.second.closed = true;
+      kv.second.errorCode = NGHTTP2_INTERNAL_ERROR;
+      wakeup(kv.first);
+    }
+  }
+}
+
+void Http2Session::wakeup(int32_t streamId)
+{
+  // Other streams are read by their own commands.  Make the engine
+  // run them, since data buffered here does not make the socket
+  // readable.
+  if (e_ && streamId != readingStreamId_) {
+    e_->setRefreshInterval(std::chrono::milliseconds(0));
+  }
+}
+
+bool Http2Session::sendBufferIsEmpty() const
+{
+  return failed_ || (sendBuf_.empty() && !nghttp2_session_want_write(session_));
+}
+
+bool Http2Session::canOpenStream() const
+{
+  return !failed_ && !goaway_ &&
+         streams_.size() <
+             nghttp2_session_get_remote_settings(
+                 session_, NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS);
+}
+
+bool Http2Session::isTimeout(std::chrono::seconds timeout) const
+{
+  return failed_ || (streams_.empty() &&
+                     lastActivity_.difference(global::wallclock()) >= timeout);
+}
+
+void Http2Session::onHeader(int32_t streamId, const std::string& name,
+                            const std::string& value)
+{
+  auto i = streams_.find(streamId);
+  if (i == std::end(streams_) || (*i).second.headersComplete) {
+    // Ignore trailer fields.
+    return;
+  }
+  auto& stream = (*i).second;
+  if (name == ":status") {
+    stream.status = value;
+  }
+  else if (!name.empty() && name[0] != ':') {
+    stream.headerFields += name;
+    stream.headerFields += ": ";
+    stream.headerFields += value;
+    stream.headerFields += "\r\n";
+  }
+}
+
+void Http2Session::onHeadersComplete(int32_t streamId)
+{
+  auto i = streams_.find(streamId);
+  if (i == std::end(streams_) || (*i).second.headersComplete) {
+    return;
+  }
+  auto& stream = (*i).second;
+  if (!stream.status.empty() && stream.status[0] == '1') {
+    // Informational response.  Wait for the final one.
+    stream.status.clear();
+    stream.headerFields.clear();
+    return;
+  }
+  // HTTP/2 connection is never closed per response, but each stream
+  // carries a single response.  Tell the HTTP/1.1 layer not to reuse
+  // the stream.
+  std::string header = "HTTP/1.1 ";
+  header += stream.status;
+  header += "\r\n";
+  header += stream.headerFields;
+  header += "Connection: close\r\n\r\n";
+  stream.buf.insert(stream.pos, header);
+  stream.headerLeft += header.size();
+  stream.headersComplete = true;
+  stream.status.clear();
+  stream.headerFields.clear();
+  wakeup(streamId);
+}
+
+void Http2Session::onData(int32_t streamId, const unsigned char* data,
+                          size_t len)
+{
+  auto i = streams_.find(streamId);
+  if (i == std::end(streams_)) {
+    nghttp2_session_consume(session_, streamId, len);
+    return;
+  }
+  (*i).second.buf.append(data, data + len);
+  wakeup(streamId);
+}
+
+void Http2Session::onStreamClose(int32_t streamId, uint32_t errorCode)
+{
+  A2_LOG_DEBUG(fmt("HTTP/2 stream %d closed: %s", streamId,
+                   nghttp2_http2_strerror(errorCode)));
+  auto i = streams_.find(streamId);
+  if (i == std::end(streams_)) {
+    return;
+  }
+  (*i).second.closed = true;
+  (*i).second.errorCode = errorCode;
+  wakeup(streamId);
+}
+
+void Http2Session::onGoaway() { goaway_ = true; }
+
+} // namespace aria2
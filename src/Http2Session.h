@@ -0,0 +1,157 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_HTTP2_SESSION_H
+#define D_HTTP2_SESSION_H
+
+#include "common.h"
+
+#include <string>
+#include <map>
+#include <memory>
+
+#include "TimerA2.h"
+
+struct nghttp2_session;
+
+namespace aria2 {
+
+class SocketCore;
+class DownloadEngine;
+
+// HTTP/2 client session on top of a connected socket.  Each request
+// is sent as a stream, and several streams are multiplexed over the
+// socket.  The response of a stream is presented as a HTTP/1.1
+// formatted byte stream: status line and header fields, followed by
+// response body.  This lets HttpConnection and the download commands
+// process HTTP/2 responses just like HTTP/1.1 responses.
+class Http2Session {
+public:
+  Http2Session(const std::shared_ptr<SocketCore>& socket, DownloadEngine* e);
+
+  ~Http2Session();
+
+  // Submits |request|, which is HTTP/1.1 request header created by
+  // HttpRequest, as a new stream.  The |scheme| is the scheme of
+  // request URI.  Returns the stream ID.
+  int32_t submitRequest(const std::string& scheme, const std::string& request);
+
+  // Reads at most |len| bytes of the response of the stream
+  // |streamId| into |data|.  Returns the number of bytes read, which
+  // is 0 if no data is available at the moment.  Throws
+  // DlRetryException if the stream was reset or the session failed.
+  size_t readStream(int32_t streamId, unsigned char* data, size_t len);
+
+  // Returns true if readStream() for the stream |streamId| returns
+  // data, or end of stream, without waiting for the socket.
+  bool hasPendingData(int32_t streamId) const;
+
+  // Returns true if the stream |streamId| ended and all of its data
+  // were read.
+  bool streamEnded(int32_t streamId) const;
+
+  // Closes the stream |streamId|.  If the stream is still open, it is
+  // canceled by RST_STREAM.
+  void closeStream(int32_t streamId);
+
+  // Reads frames available in the socket and sends pending frames.
+  void performIO();
+
+  bool sendBufferIsEmpty() const;
+
+  // Returns true if a new stream can be opened in this session.
+  bool canOpenStream() const;
+
+  // Returns true if this session failed, or had no stream for the
+  // |timeout|.
+  bool isTimeout(std::chrono::seconds timeout) const;
+
+  const std::shared_ptr<SocketCore>& getSocket() const { return socket_; }
+
+  size_t countStream() const { return streams_.size(); }
+
+  // Following functions are called from nghttp2 callbacks.
+  void onHeader(int32_t streamId, const std::string& name,
+                const std::string& value);
+  void onHeadersComplete(int32_t streamId);
+  void onData(int32_t streamId, const unsigned char* data, size_t len);
+  void onStreamClose(int32_t streamId, uint32_t errorCode);
+  void onGoaway();
+
+  // The list of protocols offered in TLS ALPN extension, in wire
+  // format.
+  static const std::string ALPN_PROTOS;
+  // The ALPN protocol identifier of HTTP/2
+  static const std::string PROTO_ID;
+
+private:
+  struct Stream {
+    Stream();
+    // Response formatted as HTTP/1.1 message, which starts at pos.
+    std::string buf;
+    size_t pos;
+    // The number of unread bytes in buf which belong to the
+    // synthesized header, and are not subject to flow control.
+    size_t headerLeft;
+    std::string status;
+    std::string headerFields;
+    bool headersComplete;
+    bool closed;
+    uint32_t errorCode;
+  };
+
+  void send();
+  void flush();
+  void fail(const std::string& error);
+  // Makes the command reading the stream |streamId| run.
+  void wakeup(int32_t streamId);
+
+  std::shared_ptr<SocketCore> socket_;
+  DownloadEngine* e_;
+  nghttp2_session* session_;
+  std::map<int32_t, Stream> streams_;
+  // The stream which is read by readStream() currently.  Its command
+  // is running, and need not be woken up.
+  int32_t readingStreamId_;
+  // Frames serialized by nghttp2 but not written to the socket yet.
+  std::string sendBuf_;
+  std::string error_;
+  Timer lastActivity_;
+  bool failed_;
+  bool goaway_;
+};
+
+} // namespace aria2
+
+#endif // D_HTTP2_SESSION_H
@@ -58,6 +58,10 @@
 #include "fmt.h"
 #include "SocketRecvBuffer.h"
 #include "array_fun.h"
+#include "HttpPipeline.h"
+#ifdef HAVE_LIBNGHTTP2
+#  include "Http2Session.h"
+#endif // HAVE_LIBNGHTTP2
 
 namespace aria2 {
 
@@ -90,11 +94,58 @@ HttpConnection::HttpConnection(
     : cuid_(cuid),
       socket_(socket),
       socketRecvBuffer_(socketRecvBuffer),
+#ifdef HAVE_LIBNGHTTP2
+      http2StreamId_(-1),
+#endif // HAVE_LIBNGHTTP2
       socketBuffer_(socket)
 {
 }
 
-HttpConnection::~HttpConnection() = default;
+HttpConnection::~HttpConnection()
+{
+  if (pipeline_) {
+    pipeline_->detach(cuid_);
+  }
+#ifdef HAVE_LIBNGHTTP2
+  if (http2Session_ && http2StreamId_ != -1) {
+    http2Session_->closeStream(http2StreamId_);
+  }
+#endif // HAVE_LIBNGHTTP2
+}
+
+void HttpConnection::setHttpPipeline(
+    const std::shared_ptr<HttpPipeline>& pipeline, bool requestSent)
+{
+  pipeline_ = pipeline;
+  pipeline_->attach(cuid_, requestSent);
+}
+
+bool HttpConnection::completeResponse()
+{
+  if (!pipeline_) {
+    return false;
+  }
+  pipeline_->complete(cuid_);
+  return true;
+}
+
+bool HttpConnection::isWaitingForPipeline() const
+{
+  return pipeline_ && !pipeline_->failed() && !pipeline_->isHead(cuid_);
+}
+
+bool HttpConnection::isPipelineFailed() const
+{
+  return pipeline_ && pipeline_->failed() && !pipeline_->isHead(cuid_);
+}
+
+#ifdef HAVE_LIBNGHTTP2
+void HttpConnection::setHttp2Session(
+    const std::shared_ptr<Http2Session>& session)
+{
+  http2Session_ = session;
+}
+#endif // HAVE_LIBNGHTTP2
 
 std::string HttpConnection::eraseConfidentialInfo(const std::string& request)
 {
@@ -127,8 +178,27 @@ void HttpConnection::sendRequest(std::unique_ptr<HttpRequest> httpRequest,
 {
   A2_LOG_INFO(
       fmt(MSG_SENDING_REQUEST, cuid_, eraseConfidentialInfo(request).c_str()));
-  socketBuffer_.pushStr(std::move(request));
-  socketBuffer_.send();
+#ifdef HAVE_LIBNGHTTP2
+  if (http2Session_) {
+    // A stream carries a single request/response pair.
+    if (http2StreamId_ != -1) {
+      http2Session_->closeStream(http2StreamId_);
+    }
+    http2StreamId_ = http2Session_->submitRequest(
+        httpRequest->getRequest()->getProtocol(), request);
+    socketRecvBuffer_->setHttp2Stream(http2Session_, http2StreamId_);
+    outstandingHttpRequests_.push_back(
+        make_unique<HttpRequestEntry>(std::move(httpRequest)));
+    return;
+  }
+#endif // HAVE_LIBNGHTTP2
+  if (pipeline_) {
+    pipeline_->sendRequest(cuid_, std::move(request));
+  }
+  else {
+    socketBuffer_.pushStr(std::move(request));
+    socketBuffer_.send();
+  }
   outstandingHttpRequests_.push_back(
       make_unique<HttpRequestEntry>(std::move(httpRequest)));
 }
@@ -150,9 +220,11 @@ std::unique_ptr<HttpResponse> HttpConnection::receiveResponse()
   if (outstandingHttpRequests_.empty()) {
     throw DL_ABORT_EX(EX_NO_HTTP_REQUEST_ENTRY_FOUND);
   }
+  if (pipeline_ && !pipeline_->isHead(cuid_)) {
+    return nullptr;
+  }
   if (socketRecvBuffer_->bufferEmpty()) {
-    if (socketRecvBuffer_->recv() == 0 && !socket_->wantRead() &&
-        !socket_->wantWrite()) {
+    if (socketRecvBuffer_->recv() == 0 && socketRecvBuffer_->eof()) {
       throw DL_RETRY_EX(EX_GOT_EOF);
     }
   }
@@ -176,6 +248,9 @@ std::unique_ptr<HttpResponse> HttpConnection::receiveResponse()
         outstandingHttpRequests_.front()->popHttpRequest());
     socketRecvBuffer_->drain(proc->getLastBytesProcessed());
     outstandingHttpRequests_.pop_front();
+    if (pipeline_ && !httpResponse->supportsPersistentConnection()) {
+      pipeline_->stop();
+    }
     return httpResponse;
   }
 
@@ -195,9 +270,30 @@ bool HttpConnection::isIssued(const std::shared_ptr<Segment>& segment) const
 
 bool HttpConnection::sendBufferIsEmpty() const
 {
+#ifdef HAVE_LIBNGHTTP2
+  if (http2Session_) {
+    return http2Session_->sendBufferIsEmpty();
+  }
+#endif // HAVE_LIBNGHTTP2
+  if (pipeline_) {
+    return pipeline_->sendBufferIsEmpty();
+  }
   return socketBuffer_.sendBufferIsEmpty();
 }
 
-void HttpConnection::sendPendingData() { socketBuffer_.send(); }
+void HttpConnection::sendPendingData()
+{
+#ifdef HAVE_LIBNGHTTP2
+  if (http2Session_) {
+    http2Session_->performIO();
+    return;
+  }
+#endif // HAVE_LIBNGHTTP2
+  if (pipeline_) {
+    pipeline_->sendPendingData();
+    return;
+  }
+  socketBuffer_.send();
+}
 
 } // namespace aria2
@@ -53,6 +53,10 @@ class Option;
 class Segment;
 class SocketCore;
 class SocketRecvBuffer;
+class HttpPipeline;
+#ifdef HAVE_LIBNGHTTP2
+class Http2Session;
+#endif // HAVE_LIBNGHTTP2
 
 class HttpRequestEntry {
 private:
@@ -83,6 +87,11 @@ private:
   cuid_t cuid_;
   std::shared_ptr<SocketCore> socket_;
   std::shared_ptr<SocketRecvBuffer> socketRecvBuffer_;
+#ifdef HAVE_LIBNGHTTP2
+  std::shared_ptr<Http2Session> http2Session_;
+  int32_t http2StreamId_;
+#endif // HAVE_LIBNGHTTP2
+  std::shared_ptr<HttpPipeline> pipeline_;
   SocketBuffer socketBuffer_;
 
   HttpRequestEntries outstandingHttpRequests_;
@@ -120,6 +129,9 @@ public:
    * received and this method returns non-null HttpResponseHandle object.
    *
    * @return HttpResponse or 0 if whole response header is not received
+   *
+   * If the connection is shared in HttpPipeline, this method returns 0
+   * until the responses to the requests sent before are read.
    */
   std::unique_ptr<HttpResponse> receiveResponse();
 
@@ -133,6 +145,40 @@ public:
   {
     return socketRecvBuffer_;
   }
+
+  // Shares the connection in |pipeline| from now on.  If
+  // |requestSent| is true, the request was already sent in this
+  // connection, and its response is the first one in |pipeline|.
+  void setHttpPipeline(const std::shared_ptr<HttpPipeline>& pipeline,
+                       bool requestSent = false);
+
+  const std::shared_ptr<HttpPipeline>& getHttpPipeline() const
+  {
+    return pipeline_;
+  }
+
+  // Tells HttpPipeline that the whole response was read, so that the
+  // next response is read by its command.  Returns false if the
+  // connection is not shared, and the socket should be pooled
+  // instead.
+  bool completeResponse();
+
+  // Returns true if the response to the request has not been read
+  // because the responses to the requests sent before it are being
+  // read.
+  bool isWaitingForPipeline() const;
+
+  // Returns true if the response to the request will never be read
+  // because the shared connection failed.
+  bool isPipelineFailed() const;
+
+#ifdef HAVE_LIBNGHTTP2
+  // Sends requests as streams of |session| from now on.  The response
+  // is read from the stream.
+  void setHttp2Session(const std::shared_ptr<Http2Session>& session);
+
+  bool isHttp2() const { return http2Session_ != nullptr; }
+#endif // HAVE_LIBNGHTTP2
 };
 
 } // namespace aria2
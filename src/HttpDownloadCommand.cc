@@ -102,8 +102,10 @@ bool HttpDownloadCommand::prepareForNextSegment()
     // pool terminated socket.  In HTTP/1.1, keep-alive is default,
     // so closing connection without Connection: close header means
     // that server is broken or not configured properly.
-    getDownloadEngine()->poolSocket(getRequest(), createProxyRequest(),
-                                    getSocket());
+    if (!httpConnection_->completeResponse()) {
+      getDownloadEngine()->poolSocket(getRequest(), createProxyRequest(),
+                                      getSocket());
+    }
   }
 
   // The request was sent assuming that server supported pipelining, but
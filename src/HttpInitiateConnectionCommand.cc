@@ -55,6 +55,10 @@
 #include "ConnectCommand.h"
 #include "HttpRequestConnectChain.h"
 #include "HttpProxyRequestConnectChain.h"
+#include "HttpPipeline.h"
+#ifdef HAVE_LIBNGHTTP2
+#  include "Http2Session.h"
+#endif // HAVE_LIBNGHTTP2
 
 namespace aria2 {
 
@@ -116,6 +120,47 @@ std::unique_ptr<Command> HttpInitiateConnectionCommand::createNextCommand(
     }
   }
   else {
+#ifdef HAVE_LIBNGHTTP2
+    if (getRequest()->getProtocol() == "https" &&
+        getOption()->getAsBool(PREF_ENABLE_HTTP2)) {
+      auto session = getDownloadEngine()->findHttp2Session(
+          getRequest()->getHost(), getRequest()->getPort());
+      if (session) {
+        A2_LOG_INFO(fmt("CUID#%" PRId64 " - Opening HTTP/2 stream in %s:%u",
+                        getCuid(), getRequest()->getHost().c_str(),
+                        getRequest()->getPort()));
+        setSocket(session->getSocket());
+        setConnectedAddrInfo(getRequest(), hostname, getSocket());
+        auto httpConnection = std::make_shared<HttpConnection>(
+            getCuid(), getSocket(),
+            std::make_shared<SocketRecvBuffer>(getSocket()));
+        httpConnection->setHttp2Session(session);
+        return make_unique<HttpRequestCommand>(
+            getCuid(), getRequest(), getFileEntry(), getRequestGroup(),
+            httpConnection, getDownloadEngine(), getSocket());
+      }
+    }
+#endif // HAVE_LIBNGHTTP2
+    if (getOption()->getAsInt(PREF_HTTP_PIPELINE_DEPTH) > 1 &&
+        getRequest()->isKeepAliveEnabled() &&
+        !getRequest()->isPipeliningHint()) {
+      auto pipeline = getDownloadEngine()->findHttpPipeline(
+          getRequest()->getHost(), getRequest()->getPort());
+      if (pipeline) {
+        A2_LOG_INFO(fmt("CUID#%" PRId64 " - Sending request in HTTP pipeline"
+                        " to %s:%u",
+                        getCuid(), getRequest()->getHost().c_str(),
+                        getRequest()->getPort()));
+        setSocket(pipeline->getSocket());
+        setConnectedAddrInfo(getRequest(), hostname, getSocket());
+        auto httpConnection = std::make_shared<HttpConnection>(
+            getCuid(), getSocket(), pipeline->getSocketRecvBuffer());
+        httpConnection->setHttpPipeline(pipeline);
+        return make_unique<HttpRequestCommand>(
+            getCuid(), getRequest(), getFileEntry(), getRequestGroup(),
+            httpConnection, getDownloadEngine(), getSocket());
+      }
+    }
     std::shared_ptr<SocketCore> pooledSocket =
         getDownloadEngine()->popPooledSocket(resolvedAddresses,
                                              getRequest()->getPort());
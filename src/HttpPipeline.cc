@@ -0,0 +1,170 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "HttpPipeline.h"
+
+#include <algorithm>
+
+#include "DownloadEngine.h"
+#include "SocketCore.h"
+#include "SocketRecvBuffer.h"
+#include "RecoverableException.h"
+#include "LogFactory.h"
+#include "Logger.h"
+#include "fmt.h"
+#include "wallclock.h"
+
+namespace aria2 {
+
+HttpPipeline::HttpPipeline(
+    const std::shared_ptr<SocketCore>& socket,
+    const std::shared_ptr<SocketRecvBuffer>& socketRecvBuffer,
+    DownloadEngine* e, size_t maxRequests)
+    : socket_(socket),
+      socketRecvBuffer_(socketRecvBuffer),
+      socketBuffer_(socket),
+      e_(e),
+      maxRequests_(maxRequests),
+      numConnections_(0),
+      lastActivity_(global::wallclock()),
+      failed_(false)
+{
+}
+
+void HttpPipeline::attach(cuid_t cuid, bool requestSent)
+{
+  ++numConnections_;
+  if (requestSent) {
+    requests_.push_front(cuid);
+  }
+}
+
+void HttpPipeline::detach(cuid_t cuid)
+{
+  if (numConnections_ > 0) {
+    --numConnections_;
+  }
+  auto i = std::find(std::begin(requests_), std::end(requests_), cuid);
+  if (i != std::end(requests_)) {
+    A2_LOG_DEBUG(fmt("CUID#%" PRId64 " - Response in HTTP pipeline abandoned",
+                     cuid));
+    // The responses before it are still read by their commands.
+    requests_.erase(i, std::end(requests_));
+    fail();
+  }
+  lastActivity_ = global::wallclock();
+}
+
+void HttpPipeline::sendRequest(cuid_t cuid, std::string request)
+{
+  try {
+    socketBuffer_.pushStr(std::move(request));
+    socketBuffer_.send();
+  }
+  catch (RecoverableException& e) {
+    // A part of the request may have been sent.
+    fail();
+    throw;
+  }
+  requests_.push_back(cuid);
+  lastActivity_ = global::wallclock();
+}
+
+bool HttpPipeline::isHead(cuid_t cuid) const
+{
+  return !requests_.empty() && requests_.front() == cuid;
+}
+
+void HttpPipeline::complete(cuid_t cuid)
+{
+  if (isHead(cuid)) {
+    requests_.pop_front();
+    lastActivity_ = global::wallclock();
+    wakeup();
+  }
+}
+
+void HttpPipeline::stop()
+{
+  if (requests_.size() > 1) {
+    requests_.resize(1);
+  }
+  fail();
+}
+
+bool HttpPipeline::canAttach() const
+{
+  return !failed_ && numConnections_ < maxRequests_;
+}
+
+bool HttpPipeline::isTimeout(std::chrono::seconds timeout) const
+{
+  return failed_ || (numConnections_ == 0 &&
+                     lastActivity_.difference(global::wallclock()) >= timeout);
+}
+
+bool HttpPipeline::sendBufferIsEmpty() const
+{
+  return socketBuffer_.sendBufferIsEmpty();
+}
+
+void HttpPipeline::sendPendingData()
+{
+  try {
+    socketBuffer_.send();
+  }
+  catch (RecoverableException& e) {
+    fail();
+    throw;
+  }
+}
+
+void HttpPipeline::fail()
+{
+  if (!failed_) {
+    failed_ = true;
+    wakeup();
+  }
+}
+
+void HttpPipeline::wakeup()
+{
+  // The waiting commands do not watch the socket, since it becomes
+  // readable for the response of the command at the head.
+  if (e_) {
+    e_->setRefreshInterval(std::chrono::milliseconds(0));
+  }
+}
+
+} // namespace aria2
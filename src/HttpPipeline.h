@@ -0,0 +1,138 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_HTTP_PIPELINE_H
+#define D_HTTP_PIPELINE_H
+
+#include "common.h"
+
+#include <string>
+#include <deque>
+#include <memory>
+#include <chrono>
+
+#include "SocketBuffer.h"
+#include "TimerA2.h"
+#include "Command.h"
+
+namespace aria2 {
+
+class SocketCore;
+class SocketRecvBuffer;
+class DownloadEngine;
+
+// HTTP/1.1 keep-alive connection shared by the commands of different
+// downloads.  Each command sends its own request without waiting for
+// the responses to the requests sent before it, and the server
+// responds in the same order.  The responses are read from the
+// shared SocketRecvBuffer by the command whose request is at the
+// head of the queue.  It drains exactly its response, just like it
+// does before pooling the socket, and calls complete() to hand the
+// connection to the next command.
+class HttpPipeline {
+public:
+  // |maxRequests| is the maximum number of commands sharing this
+  // connection.
+  HttpPipeline(const std::shared_ptr<SocketCore>& socket,
+               const std::shared_ptr<SocketRecvBuffer>& socketRecvBuffer,
+               DownloadEngine* e, size_t maxRequests);
+
+  // Adds the command |cuid| to this connection.  If |requestSent| is
+  // true, its request was already sent, and its response is the
+  // first one to be read.
+  void attach(cuid_t cuid, bool requestSent = false);
+
+  // Removes the command |cuid| from this connection.  If the response
+  // to its request is not read yet, nobody reads it, and the
+  // responses after it cannot be read either.  In that case, this
+  // connection fails, and the commands waiting for them must retry.
+  void detach(cuid_t cuid);
+
+  // Sends |request| of the command |cuid|.
+  void sendRequest(cuid_t cuid, std::string request);
+
+  // Returns true if the response to the request of the command
+  // |cuid| is the next one to be read.
+  bool isHead(cuid_t cuid) const;
+
+  // Tells that the command |cuid| at the head of the queue has read
+  // its whole response.  The next command is woken up.
+  void complete(cuid_t cuid);
+
+  // Tells that the server closes the connection after the response
+  // being read now.  The requests after it are never answered.
+  void stop();
+
+  bool failed() const { return failed_; }
+
+  // Returns true if one more command can share this connection.
+  bool canAttach() const;
+
+  // Returns true if this connection failed, or had no command for
+  // the |timeout|.
+  bool isTimeout(std::chrono::seconds timeout) const;
+
+  bool sendBufferIsEmpty() const;
+
+  void sendPendingData();
+
+  const std::shared_ptr<SocketCore>& getSocket() const { return socket_; }
+
+  const std::shared_ptr<SocketRecvBuffer>& getSocketRecvBuffer() const
+  {
+    return socketRecvBuffer_;
+  }
+
+  size_t countRequest() const { return requests_.size(); }
+
+private:
+  void fail();
+  // Makes the commands waiting for their turn run.
+  void wakeup();
+
+  std::shared_ptr<SocketCore> socket_;
+  std::shared_ptr<SocketRecvBuffer> socketRecvBuffer_;
+  SocketBuffer socketBuffer_;
+  DownloadEngine* e_;
+  size_t maxRequests_;
+  size_t numConnections_;
+  // The commands which sent requests, in the order of sending.
+  std::deque<cuid_t> requests_;
+  Timer lastActivity_;
+  bool failed_;
+};
+
+} // namespace aria2
+
+#endif // D_HTTP_PIPELINE_H
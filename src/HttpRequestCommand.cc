@@ -59,6 +59,9 @@
 #include "LogFactory.h"
 #include "fmt.h"
 #include "SocketRecvBuffer.h"
+#ifdef HAVE_LIBNGHTTP2
+#  include "Http2Session.h"
+#endif // HAVE_LIBNGHTTP2
 
 namespace aria2 {
 
@@ -120,16 +123,42 @@ createHttpRequest(const std::shared_ptr<Request>& req,
 
 bool HttpRequestCommand::executeInternal()
 {
+  if (httpConnection_->isPipelineFailed()) {
+    A2_LOG_INFO(fmt("CUID#%" PRId64 " - HTTP pipeline failed before the"
+                    " request was sent",
+                    getCuid()));
+    return prepareForRetry(0);
+  }
   // socket->setBlockingMode();
   if (httpConnection_->sendBufferIsEmpty()) {
 #ifdef ENABLE_SSL
     if (getRequest()->getProtocol() == "https") {
-      if (!getSocket()->tlsConnect(getRequest()->getHost())) {
+      std::string alpnProtos;
+#  ifdef HAVE_LIBNGHTTP2
+      // HTTP/2 session is shared by the requests to the same host, so
+      // it is not used via proxy.
+      if (getOption()->getAsBool(PREF_ENABLE_HTTP2) && !createProxyRequest()) {
+        alpnProtos = Http2Session::ALPN_PROTOS;
+      }
+#  endif // HAVE_LIBNGHTTP2
+      if (!getSocket()->tlsConnect(getRequest()->getHost(),
+                                   getRequest()->getPort(), alpnProtos)) {
         setReadCheckSocketIf(getSocket(), getSocket()->wantRead());
         setWriteCheckSocketIf(getSocket(), getSocket()->wantWrite());
         addCommandSelf();
         return false;
       }
+#  ifdef HAVE_LIBNGHTTP2
+      if (!httpConnection_->isHttp2() &&
+          getSocket()->getTLSAlpnProtocol() == Http2Session::PROTO_ID) {
+        A2_LOG_INFO(fmt("CUID#%" PRId64 " - Using HTTP/2", getCuid()));
+        auto session =
+            std::make_shared<Http2Session>(getSocket(), getDownloadEngine());
+        getDownloadEngine()->addHttp2Session(getRequest()->getHost(),
+                                             getRequest()->getPort(), session);
+        httpConnection_->setHttp2Session(session);
+      }
+#  endif // HAVE_LIBNGHTTP2
     }
 #endif // ENABLE_SSL
     if (getSegments().empty()) {
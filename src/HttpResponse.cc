@@ -63,6 +63,12 @@
 #ifdef HAVE_ZLIB
 #  include "GZipDecodingStreamFilter.h"
 #endif // HAVE_ZLIB
+#ifdef HAVE_LIBZSTD
+#  include "ZstdDecodingStreamFilter.h"
+#endif // HAVE_LIBZSTD
+#ifdef HAVE_LIBBROTLI
+#  include "BrotliDecodingStreamFilter.h"
+#endif // HAVE_LIBBROTLI
 
 namespace aria2 {
 
@@ -217,6 +223,16 @@ HttpResponse::getContentEncodingStreamFilter() const
     return make_unique<GZipDecodingStreamFilter>();
   }
 #endif // HAVE_ZLIB
+#ifdef HAVE_LIBZSTD
+  if (util::strieq(getContentEncoding(), "zstd")) {
+    return make_unique<ZstdDecodingStreamFilter>();
+  }
+#endif // HAVE_LIBZSTD
+#ifdef HAVE_LIBBROTLI
+  if (util::strieq(getContentEncoding(), "br")) {
+    return make_unique<BrotliDecodingStreamFilter>();
+  }
+#endif // HAVE_LIBBROTLI
 
   return nullptr;
 }
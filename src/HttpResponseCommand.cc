@@ -77,9 +77,16 @@
 #include "NullProgressInfoFile.h"
 #include "Checksum.h"
 #include "ChecksumCheckIntegrityEntry.h"
+#include "HttpPipeline.h"
 #ifdef HAVE_ZLIB
 #  include "GZipDecodingStreamFilter.h"
 #endif // HAVE_ZLIB
+#ifdef HAVE_LIBZSTD
+#  include "ZstdDecodingStreamFilter.h"
+#endif // HAVE_LIBZSTD
+#ifdef HAVE_LIBBROTLI
+#  include "BrotliDecodingStreamFilter.h"
+#endif // HAVE_LIBBROTLI
 
 namespace aria2 {
 
@@ -145,9 +152,22 @@ bool HttpResponseCommand::executeInternal()
 {
   auto httpResponse = httpConnection_->receiveResponse();
   if (!httpResponse) {
+    if (httpConnection_->isPipelineFailed()) {
+      A2_LOG_INFO(fmt("CUID#%" PRId64 " - HTTP pipeline failed before the"
+                      " response arrived",
+                      getCuid()));
+      return prepareForRetry(0);
+    }
     // The server has not responded to our request yet.
     // For socket->wantRead() == true, setReadCheckSocket(socket) is already
-    // done in the constructor.
+    // done in the constructor.  While the responses to the requests
+    // sent before ours are read, the socket is readable for them.
+    if (httpConnection_->isWaitingForPipeline()) {
+      disableReadCheckSocket();
+    }
+    else {
+      setReadCheckSocket(getSocket());
+    }
     setWriteCheckSocketIf(getSocket(), getSocket()->wantWrite());
     addCommandSelf();
     return false;
@@ -171,6 +191,7 @@ bool HttpResponseCommand::executeInternal()
   else {
     req->setMaxPipelinedRequest(1);
   }
+  startHttpPipeline();
 
   auto statusCode = httpResponse->getStatusCode();
   auto& ctx = getDownloadContext();
@@ -342,10 +363,11 @@ bool HttpResponseCommand::shouldInflateContentEncoding(
   // Meanwhile, Some server returns content-encoding: gzip for .tgz
   // files.  I think those files should not be inflated by clients,
   // because it is the original format of those files. Current
-  // implementation just inflates these files nonetheless.
-  const std::string& ce = httpResponse->getContentEncoding();
+  // implementation just inflates these files nonetheless.  Any
+  // encoding we have a decoder for is inflated, so that the decision
+  // follows getContentEncodingStreamFilter().
   return httpResponse->getHttpRequest()->acceptGZip() &&
-         (ce == "gzip" || ce == "deflate");
+         httpResponse->getContentEncodingStreamFilter();
 }
 
 bool HttpResponseCommand::handleDefaultEncoding(
@@ -517,16 +539,26 @@ namespace {
 
 bool decideFileAllocation(StreamFilter* filter)
 {
-#ifdef HAVE_ZLIB
   for (StreamFilter* f = filter; f; f = f->getDelegate().get()) {
     // Since the compressed file's length are returned in the response header
     // and the decompressed file size is unknown at this point, disable file
     // allocation here.
+#ifdef HAVE_ZLIB
     if (f->getName() == GZipDecodingStreamFilter::NAME) {
       return false;
     }
-  }
 #endif // HAVE_ZLIB
+#ifdef HAVE_LIBZSTD
+    if (f->getName() == ZstdDecodingStreamFilter::NAME) {
+      return false;
+    }
+#endif // HAVE_LIBZSTD
+#ifdef HAVE_LIBBROTLI
+    if (f->getName() == BrotliDecodingStreamFilter::NAME) {
+      return false;
+    }
+#endif // HAVE_LIBBROTLI
+  }
 
   return true;
 }
@@ -560,12 +592,39 @@ HttpResponseCommand::createHttpDownloadCommand(
 
 void HttpResponseCommand::poolConnection()
 {
-  if (getRequest()->supportsPersistentConnection()) {
+  if (!httpConnection_->completeResponse() &&
+      getRequest()->supportsPersistentConnection()) {
     getDownloadEngine()->poolSocket(getRequest(), createProxyRequest(),
                                     getSocket());
   }
 }
 
+void HttpResponseCommand::startHttpPipeline()
+{
+  auto depth = getOption()->getAsInt(PREF_HTTP_PIPELINE_DEPTH);
+  auto& req = getRequest();
+  if (depth <= 1 || !req->supportsPersistentConnection() ||
+      !req->isKeepAliveEnabled() || req->isPipeliningHint() ||
+      httpConnection_->getHttpPipeline() || createProxyRequest()) {
+    return;
+  }
+#ifdef HAVE_LIBNGHTTP2
+  if (httpConnection_->isHttp2()) {
+    return;
+  }
+#endif // HAVE_LIBNGHTTP2
+  auto e = getDownloadEngine();
+  if (e->findHttpPipeline(req->getHost(), req->getPort())) {
+    return;
+  }
+  A2_LOG_INFO(fmt("CUID#%" PRId64 " - Starting HTTP pipeline to %s:%u",
+                  getCuid(), req->getHost().c_str(), req->getPort()));
+  auto pipeline = std::make_shared<HttpPipeline>(
+      getSocket(), httpConnection_->getSocketRecvBuffer(), e, depth);
+  httpConnection_->setHttpPipeline(pipeline, true);
+  e->addHttpPipeline(req->getHost(), req->getPort(), pipeline);
+}
+
 void HttpResponseCommand::onDryRunFileFound()
 {
   getPieceStorage()->markAllPiecesDone();
@@ -73,6 +73,10 @@ private:
 
   void poolConnection();
 
+  // Shares the connection with the downloads from the same server if
+  // --http-pipeline-depth allows it.
+  void startHttpPipeline();
+
   void onDryRunFileFound();
   // Returns true if dctx and checksum has same hash type and hash
   // value.  If they have same hash type but different hash value,
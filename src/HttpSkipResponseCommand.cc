@@ -113,8 +113,7 @@ bool HttpSkipResponseCommand::executeInternal()
   try {
     size_t bufSize;
     if (getSocketRecvBuffer()->bufferEmpty()) {
-      eof = getSocketRecvBuffer()->recv() == 0 && !getSocket()->wantRead() &&
-            !getSocket()->wantWrite();
+      eof = getSocketRecvBuffer()->recv() == 0 && getSocketRecvBuffer()->eof();
     }
     if (!eof) {
       if (sinkFilterOnly_) {
@@ -182,7 +181,8 @@ bool HttpSkipResponseCommand::executeInternal()
 
 void HttpSkipResponseCommand::poolConnection() const
 {
-  if (getRequest()->supportsPersistentConnection()) {
+  if (!httpConnection_->completeResponse() &&
+      getRequest()->supportsPersistentConnection()) {
     getDownloadEngine()->poolSocket(getRequest(), createProxyRequest(),
                                     getSocket());
   }
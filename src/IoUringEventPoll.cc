@@ -0,0 +1,569 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2019 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "IoUringEventPoll.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <endian.h>
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+
+#include "Command.h"
+#include "LogFactory.h"
+#include "Logger.h"
+#include "util.h"
+#include "a2functional.h"
+#include "fmt.h"
+#ifdef HAVE_EPOLL
+#  include "EpollEventPoll.h"
+#endif // HAVE_EPOLL
+
+namespace aria2 {
+
+namespace {
+// user_data of completions which carry no information for us, such
+// as the result of IORING_OP_POLL_REMOVE.
+const uint64_t IGNORED_USER_DATA = 0;
+// user_data of IORING_OP_TIMEOUT request issued in poll().
+const uint64_t TIMEOUT_USER_DATA = 1;
+} // namespace
+
+namespace {
+int ioUringSetup(unsigned entries, struct io_uring_params* p)
+{
+  return syscall(__NR_io_uring_setup, entries, p);
+}
+} // namespace
+
+namespace {
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete,
+                 unsigned flags)
+{
+  return syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags,
+                 nullptr, 0);
+}
+} // namespace
+
+IoUringEventPoll::KSocketEntry::KSocketEntry(sock_t s)
+    : SocketEntry<KCommandEvent, KADNSEvent>(s), pollId_(0), pollEvents_(0)
+{
+}
+
+int accumulateEvent(int events, const IoUringEventPoll::KEvent& event)
+{
+  return events | event.getEvents();
+}
+
+int IoUringEventPoll::KSocketEntry::getEvents()
+{
+#ifdef ENABLE_ASYNC_DNS
+
+  return std::accumulate(adnsEvents_.begin(), adnsEvents_.end(),
+                         std::accumulate(commandEvents_.begin(),
+                                         commandEvents_.end(), 0,
+                                         accumulateEvent),
+                         accumulateEvent);
+
+#else // !ENABLE_ASYNC_DNS
+
+  return std::accumulate(commandEvents_.begin(), commandEvents_.end(), 0,
+                         accumulateEvent);
+
+#endif // !ENABLE_ASYNC_DNS
+}
+
+IoUringEventPoll::IoUringEventPoll(unsigned entries)
+    : ringfd_(-1),
+      features_(0),
+      sqRing_(nullptr),
+      sqRingSize_(0),
+      cqRing_(nullptr),
+      cqRingSize_(0),
+      sqes_(nullptr),
+      sqesSize_(0),
+      sqHead_(nullptr),
+      sqTail_(nullptr),
+      sqRingMask_(nullptr),
+      sqFlags_(nullptr),
+      sqArray_(nullptr),
+      sqEntries_(0),
+      sqLocalTail_(0),
+      numPendingSqe_(0),
+      cqHead_(nullptr),
+      cqTail_(nullptr),
+      cqRingMask_(nullptr),
+      cqes_(nullptr),
+      pollGeneration_(0),
+      timeout_{0, 0}
+{
+  if (!init(entries) && ringfd_ != -1) {
+    close(ringfd_);
+    ringfd_ = -1;
+  }
+}
+
+IoUringEventPoll::~IoUringEventPoll()
+{
+  if (sqes_) {
+    munmap(sqes_, sqesSize_);
+  }
+  if (cqRing_ && cqRing_ != sqRing_) {
+    munmap(cqRing_, cqRingSize_);
+  }
+  if (sqRing_) {
+    munmap(sqRing_, sqRingSize_);
+  }
+  if (ringfd_ != -1) {
+    int r = close(ringfd_);
+    int errNum = errno;
+    if (r == -1) {
+      A2_LOG_ERROR(fmt("Error occurred while closing io_uring file descriptor"
+                       " %d: %s",
+                       ringfd_, util::safeStrerror(errNum).c_str()));
+    }
+  }
+}
+
+bool IoUringEventPoll::init(unsigned entries)
+{
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  ringfd_ = ioUringSetup(entries, &p);
+  if (ringfd_ == -1) {
+    int errNum = errno;
+    A2_LOG_INFO(
+        fmt("io_uring_setup failed: %s", util::safeStrerror(errNum).c_str()));
+    return false;
+  }
+  features_ = p.features;
+  // IORING_FEAT_NODROP (Linux 5.5) guarantees that completions are
+  // not lost when the completion ring is full.  Its presence also
+  // means IORING_OP_TIMEOUT is available.
+  if (!(features_ & IORING_FEAT_NODROP)) {
+    A2_LOG_INFO("io_uring lacks IORING_FEAT_NODROP.");
+    return false;
+  }
+  sqRingSize_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cqRingSize_ = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (features_ & IORING_FEAT_SINGLE_MMAP) {
+    sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+  }
+  auto sqRing = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQ_RING);
+  if (sqRing == MAP_FAILED) {
+    int errNum = errno;
+    A2_LOG_INFO(fmt("Failed to map io_uring submission ring: %s",
+                    util::safeStrerror(errNum).c_str()));
+    return false;
+  }
+  sqRing_ = sqRing;
+  if (features_ & IORING_FEAT_SINGLE_MMAP) {
+    cqRing_ = sqRing_;
+  }
+  else {
+    auto cqRing = mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_CQ_RING);
+    if (cqRing == MAP_FAILED) {
+      int errNum = errno;
+      A2_LOG_INFO(fmt("Failed to map io_uring completion ring: %s",
+                      util::safeStrerror(errNum).c_str()));
+      return false;
+    }
+    cqRing_ = cqRing;
+  }
+  sqesSize_ = p.sq_entries * sizeof(struct io_uring_sqe);
+  auto sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    int errNum = errno;
+    A2_LOG_INFO(fmt("Failed to map io_uring submission queue entries: %s",
+                    util::safeStrerror(errNum).c_str()));
+    return false;
+  }
+  sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+  auto sq = static_cast<char*>(sqRing_);
+  sqHead_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+  sqTail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+  sqRingMask_ = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+  sqFlags_ = reinterpret_cast<unsigned*>(sq + p.sq_off.flags);
+  sqArray_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+  sqEntries_ = p.sq_entries;
+  sqLocalTail_ = *sqTail_;
+
+  auto cq = static_cast<char*>(cqRing_);
+  cqHead_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+  cqTail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+  cqRingMask_ = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+  return true;
+}
+
+bool IoUringEventPoll::good() const { return ringfd_ != -1; }
+
+struct io_uring_sqe* IoUringEventPoll::getSqe()
+{
+  if (sqLocalTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) ==
+      sqEntries_) {
+    // Submission ring is full.  Submit queued requests now.
+    if (submit(0, 0) == -1) {
+      int errNum = errno;
+      A2_LOG_INFO(fmt("io_uring_enter error: %s",
+                      util::safeStrerror(errNum).c_str()));
+    }
+    if (numPendingSqe_ == sqEntries_) {
+      return nullptr;
+    }
+  }
+  auto index = sqLocalTail_ & *sqRingMask_;
+  auto sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqArray_[index] = index;
+  ++sqLocalTail_;
+  ++numPendingSqe_;
+  return sqe;
+}
+
+int IoUringEventPoll::submit(unsigned minComplete, unsigned flags)
+{
+  __atomic_store_n(sqTail_, sqLocalTail_, __ATOMIC_RELEASE);
+  int r;
+  while ((r = ioUringEnter(ringfd_, numPendingSqe_, minComplete, flags)) ==
+             -1 &&
+         errno == EINTR)
+    ;
+  int errNum = errno;
+  numPendingSqe_ = sqLocalTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+  errno = errNum;
+  return r;
+}
+
+bool IoUringEventPoll::queuePollAdd(KSocketEntry& socketEntry, int events)
+{
+  auto sqe = getSqe();
+  if (!sqe) {
+    return false;
+  }
+  if (++pollGeneration_ == 0) {
+    ++pollGeneration_;
+  }
+  // The lower 32 bits hold the socket, so that the completion can be
+  // matched against socketEntries_.  The generation in the upper 32
+  // bits tells stale completions from the current one.
+  uint64_t pollId = (static_cast<uint64_t>(pollGeneration_) << 32) |
+                    static_cast<uint32_t>(socketEntry.getSocket());
+  uint32_t mask = events;
+#if __BYTE_ORDER == __BIG_ENDIAN
+  mask = (mask << 16) | (mask >> 16);
+#endif // __BYTE_ORDER == __BIG_ENDIAN
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = socketEntry.getSocket();
+  sqe->poll32_events = mask;
+  sqe->user_data = pollId;
+  socketEntry.setPoll(pollId, events);
+  return true;
+}
+
+void IoUringEventPoll::queuePollRemove(uint64_t pollId)
+{
+  auto sqe = getSqe();
+  if (!sqe) {
+    // The completion of the poll request will be ignored since no
+    // socket entry has its pollId.
+    A2_LOG_DEBUG("Failed to queue poll removal: submission ring is full.");
+    return;
+  }
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = pollId;
+  sqe->user_data = IGNORED_USER_DATA;
+#ifdef IORING_FEAT_CQE_SKIP
+  if (features_ & IORING_FEAT_CQE_SKIP) {
+    sqe->flags |= IOSQE_CQE_SKIP_SUCCESS;
+  }
+#endif // IORING_FEAT_CQE_SKIP
+}
+
+void IoUringEventPoll::updatePolls()
+{
+  std::set<sock_t> retry;
+  for (auto socket : dirtySockets_) {
+    auto i = socketEntries_.find(socket);
+    if (i == std::end(socketEntries_)) {
+      continue;
+    }
+    auto& socketEntry = (*i).second;
+    int events = socketEntry.getEvents();
+    if (socketEntry.getPollId() != 0) {
+      if (socketEntry.getPollEvents() == events) {
+        continue;
+      }
+      queuePollRemove(socketEntry.getPollId());
+      socketEntry.setPoll(0, 0);
+    }
+    if (events != 0 && !queuePollAdd(socketEntry, events)) {
+      retry.insert(socket);
+    }
+  }
+  dirtySockets_.swap(retry);
+}
+
+void IoUringEventPoll::processCompletions()
+{
+  auto head = *cqHead_;
+  auto tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    auto& cqe = cqes_[head & *cqRingMask_];
+    if (cqe.user_data == IGNORED_USER_DATA ||
+        cqe.user_data == TIMEOUT_USER_DATA) {
+      continue;
+    }
+    auto socket = static_cast<sock_t>(cqe.user_data & 0xffffffffu);
+    auto i = socketEntries_.find(socket);
+    if (i == std::end(socketEntries_) ||
+        (*i).second.getPollId() != cqe.user_data) {
+      // Completion of a poll request which was already replaced or
+      // removed.
+      continue;
+    }
+    auto& socketEntry = (*i).second;
+    socketEntry.setPoll(0, 0);
+    if (cqe.res < 0) {
+      // Don't re-arm the request until the interest changes.
+      // Otherwise, we would loop over the same error, for example,
+      // if socket was closed without deleting its events.
+      A2_LOG_DEBUG(fmt("Poll request for socket %d failed: %s", socket,
+                       util::safeStrerror(-cqe.res).c_str()));
+      continue;
+    }
+    socketEntry.processEvents(cqe.res);
+    dirtySockets_.insert(socket);
+  }
+  __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+}
+
+void IoUringEventPoll::poll(const struct timeval& tv)
+{
+  updatePolls();
+
+  unsigned minComplete = 0;
+  unsigned flags = 0;
+  if (tv.tv_sec > 0 || tv.tv_usec > 0) {
+    auto sqe = getSqe();
+    if (sqe) {
+      timeout_.tv_sec = tv.tv_sec;
+      timeout_.tv_nsec = tv.tv_usec * 1000;
+      sqe->opcode = IORING_OP_TIMEOUT;
+      sqe->fd = -1;
+      sqe->addr = reinterpret_cast<uint64_t>(&timeout_);
+      sqe->len = 1;
+      // Fire the timeout as soon as any other request completes.
+      sqe->off = 1;
+      sqe->user_data = TIMEOUT_USER_DATA;
+      minComplete = 1;
+      flags = IORING_ENTER_GETEVENTS;
+    }
+  }
+  else if (__atomic_load_n(sqFlags_, __ATOMIC_ACQUIRE) &
+           IORING_SQ_CQ_OVERFLOW) {
+    // Let kernel move overflowed completions to the ring.
+    flags = IORING_ENTER_GETEVENTS;
+  }
+  if (numPendingSqe_ > 0 || flags != 0) {
+    if (submit(minComplete, flags) == -1) {
+      int errNum = errno;
+      A2_LOG_INFO(fmt("io_uring_enter error: %s",
+                      util::safeStrerror(errNum).c_str()));
+    }
+  }
+  processCompletions();
+
+#ifdef ENABLE_ASYNC_DNS
+  // It turns out that we have to call ares_process_fd before ares's
+  // own timeout and ares may create new sockets or closes socket in
+  // their API. So we call ares_process_fd for all ares_channel and
+  // re-register their sockets.
+  for (auto& i : nameResolverEntries_) {
+    auto& ent = i.second;
+    ent.processTimeout();
+    ent.removeSocketEvents(this);
+    ent.addSocketEvents(this);
+  }
+#endif // ENABLE_ASYNC_DNS
+}
+
+namespace {
+int translateEvents(EventPoll::EventType events)
+{
+  int newEvents = 0;
+  if (EventPoll::EVENT_READ & events) {
+    newEvents |= IoUringEventPoll::IEV_READ;
+  }
+  if (EventPoll::EVENT_WRITE & events) {
+    newEvents |= IoUringEventPoll::IEV_WRITE;
+  }
+  if (EventPoll::EVENT_ERROR & events) {
+    newEvents |= IoUringEventPoll::IEV_ERROR;
+  }
+  if (EventPoll::EVENT_HUP & events) {
+    newEvents |= IoUringEventPoll::IEV_HUP;
+  }
+  return newEvents;
+}
+} // namespace
+
+bool IoUringEventPoll::addEvents(sock_t socket,
+                                 const IoUringEventPoll::KEvent& event)
+{
+  auto i = socketEntries_.lower_bound(socket);
+  if (i == std::end(socketEntries_) || (*i).first != socket) {
+    i = socketEntries_.insert(i, std::make_pair(socket, KSocketEntry(socket)));
+  }
+  event.addSelf(&(*i).second);
+  // The request is submitted in the next poll() call, together with
+  // other changes.
+  dirtySockets_.insert(socket);
+  return true;
+}
+
+bool IoUringEventPoll::addEvents(sock_t socket, Command* command,
+                                 EventPoll::EventType events)
+{
+  return addEvents(socket, KCommandEvent(command, translateEvents(events)));
+}
+
+#ifdef ENABLE_ASYNC_DNS
+bool IoUringEventPoll::addEvents(sock_t socket, Command* command, int events,
+                                 const std::shared_ptr<AsyncNameResolver>& rs)
+{
+  return addEvents(socket, KADNSEvent(rs, command, socket, events));
+}
+#endif // ENABLE_ASYNC_DNS
+
+bool IoUringEventPoll::deleteEvents(sock_t socket,
+                                    const IoUringEventPoll::KEvent& event)
+{
+  auto i = socketEntries_.find(socket);
+  if (i == std::end(socketEntries_)) {
+    A2_LOG_DEBUG(fmt("Socket %d is not found in SocketEntries.", socket));
+    return false;
+  }
+
+  auto& socketEntry = (*i).second;
+  event.removeSelf(&socketEntry);
+  if (socketEntry.eventEmpty()) {
+    if (socketEntry.getPollId() != 0) {
+      queuePollRemove(socketEntry.getPollId());
+    }
+    socketEntries_.erase(i);
+    dirtySockets_.erase(socket);
+  }
+  else {
+    dirtySockets_.insert(socket);
+  }
+  return true;
+}
+
+#ifdef ENABLE_ASYNC_DNS
+bool IoUringEventPoll::deleteEvents(
+    sock_t socket, Command* command,
+    const std::shared_ptr<AsyncNameResolver>& rs)
+{
+  return deleteEvents(socket, KADNSEvent(rs, command, socket, 0));
+}
+#endif // ENABLE_ASYNC_DNS
+
+bool IoUringEventPoll::deleteEvents(sock_t socket, Command* command,
+                                    EventPoll::EventType events)
+{
+  return deleteEvents(socket, KCommandEvent(command, translateEvents(events)));
+}
+
+#ifdef ENABLE_ASYNC_DNS
+bool IoUringEventPoll::addNameResolver(
+    const std::shared_ptr<AsyncNameResolver>& resolver, Command* command)
+{
+  auto key = std::make_pair(resolver.get(), command);
+  auto itr = nameResolverEntries_.lower_bound(key);
+
+  if (itr != std::end(nameResolverEntries_) && (*itr).first == key) {
+    return false;
+  }
+
+  itr = nameResolverEntries_.insert(
+      itr, std::make_pair(key, KAsyncNameResolverEntry(resolver, command)));
+  (*itr).second.addSocketEvents(this);
+  return true;
+}
+
+bool IoUringEventPoll::deleteNameResolver(
+    const std::shared_ptr<AsyncNameResolver>& resolver, Command* command)
+{
+  auto key = std::make_pair(resolver.get(), command);
+  auto itr = nameResolverEntries_.find(key);
+  if (itr == std::end(nameResolverEntries_)) {
+    return false;
+  }
+
+  (*itr).second.removeSocketEvents(this);
+  nameResolverEntries_.erase(itr);
+  return true;
+}
+#endif // ENABLE_ASYNC_DNS
+
+std::unique_ptr<EventPoll>
+selectIoUringEventPoll(std::unique_ptr<IoUringEventPoll> ep)
+{
+  if (ep->good()) {
+    return std::move(ep);
+  }
+#ifdef HAVE_EPOLL
+  // Kernel may be too old, or io_uring may be disabled by
+  // administrator.
+  A2_LOG_WARN("Initializing IoUringEventPoll failed."
+              " Falling back to epoll.");
+  auto fallback = make_unique<EpollEventPoll>();
+  if (fallback->good()) {
+    return std::move(fallback);
+  }
+#endif // HAVE_EPOLL
+  return nullptr;
+}
+
+} // namespace aria2
@@ -0,0 +1,210 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2019 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_IO_URING_EVENT_POLL_H
+#define D_IO_URING_EVENT_POLL_H
+
+#include "EventPoll.h"
+
+#include <poll.h>
+#include <linux/io_uring.h>
+
+#include <map>
+#include <set>
+
+#include "Event.h"
+#include "a2functional.h"
+#ifdef ENABLE_ASYNC_DNS
+#  include "AsyncNameResolver.h"
+#endif // ENABLE_ASYNC_DNS
+
+namespace aria2 {
+
+// EventPoll implementation using Linux io_uring.  Each socket has at
+// most one outstanding IORING_OP_POLL_ADD request.  Changes of
+// interest are queued in the submission ring and submitted together
+// with the wait in poll(), so that they cost no extra system call.
+// Poll requests are one-shot, and they are re-armed in the next
+// poll() call, which gives the same level-triggered semantics as
+// EpollEventPoll.
+class IoUringEventPoll : public EventPoll {
+private:
+  class KSocketEntry;
+
+  typedef Event<KSocketEntry> KEvent;
+  typedef CommandEvent<KSocketEntry, IoUringEventPoll> KCommandEvent;
+  typedef ADNSEvent<KSocketEntry, IoUringEventPoll> KADNSEvent;
+  typedef AsyncNameResolverEntry<IoUringEventPoll> KAsyncNameResolverEntry;
+  friend class AsyncNameResolverEntry<IoUringEventPoll>;
+
+  class KSocketEntry : public SocketEntry<KCommandEvent, KADNSEvent> {
+  private:
+    // user_data of the outstanding poll request, or 0 if there is
+    // none.
+    uint64_t pollId_;
+    // The events the outstanding poll request waits for.
+    int pollEvents_;
+
+  public:
+    KSocketEntry(sock_t socket);
+
+    KSocketEntry(const KSocketEntry&) = delete;
+    KSocketEntry(KSocketEntry&&) = default;
+
+    int getEvents();
+
+    uint64_t getPollId() const { return pollId_; }
+
+    int getPollEvents() const { return pollEvents_; }
+
+    void setPoll(uint64_t pollId, int pollEvents)
+    {
+      pollId_ = pollId;
+      pollEvents_ = pollEvents;
+    }
+  };
+
+  friend int accumulateEvent(int events, const KEvent& event);
+
+private:
+  typedef std::map<sock_t, KSocketEntry> KSocketEntrySet;
+  KSocketEntrySet socketEntries_;
+#ifdef ENABLE_ASYNC_DNS
+  typedef std::map<std::pair<AsyncNameResolver*, Command*>,
+                   KAsyncNameResolverEntry>
+      KAsyncNameResolverEntrySet;
+  KAsyncNameResolverEntrySet nameResolverEntries_;
+#endif // ENABLE_ASYNC_DNS
+
+  // Sockets whose poll request has to be (re)submitted in the next
+  // poll() call.
+  std::set<sock_t> dirtySockets_;
+
+  int ringfd_;
+  uint32_t features_;
+
+  void* sqRing_;
+  size_t sqRingSize_;
+  void* cqRing_;
+  size_t cqRingSize_;
+  struct io_uring_sqe* sqes_;
+  size_t sqesSize_;
+
+  unsigned* sqHead_;
+  unsigned* sqTail_;
+  unsigned* sqRingMask_;
+  unsigned* sqFlags_;
+  unsigned* sqArray_;
+  unsigned sqEntries_;
+  // Tail of the submission queue which is not visible to the kernel
+  // yet.
+  unsigned sqLocalTail_;
+  // The number of SQEs queued but not submitted yet.
+  unsigned numPendingSqe_;
+
+  unsigned* cqHead_;
+  unsigned* cqTail_;
+  unsigned* cqRingMask_;
+  struct io_uring_cqe* cqes_;
+
+  uint32_t pollGeneration_;
+
+  struct __kernel_timespec timeout_;
+
+  static const unsigned SQ_ENTRIES = 4096;
+
+  bool init(unsigned entries);
+
+  struct io_uring_sqe* getSqe();
+
+  int submit(unsigned minComplete, unsigned flags);
+
+  // Returns false if the submission ring is full.
+  bool queuePollAdd(KSocketEntry& socketEntry, int events);
+
+  void queuePollRemove(uint64_t pollId);
+
+  void updatePolls();
+
+  void processCompletions();
+
+  bool addEvents(sock_t socket, const KEvent& event);
+
+  bool deleteEvents(sock_t socket, const KEvent& event);
+
+  bool addEvents(sock_t socket, Command* command, int events,
+                 const std::shared_ptr<AsyncNameResolver>& rs);
+
+  bool deleteEvents(sock_t socket, Command* command,
+                    const std::shared_ptr<AsyncNameResolver>& rs);
+
+public:
+  // |entries| is the size of the submission ring.
+  explicit IoUringEventPoll(unsigned entries = SQ_ENTRIES);
+
+  bool good() const;
+
+  virtual ~IoUringEventPoll();
+
+  virtual void poll(const struct timeval& tv) CXX11_OVERRIDE;
+
+  virtual bool addEvents(sock_t socket, Command* command,
+                         EventPoll::EventType events) CXX11_OVERRIDE;
+
+  virtual bool deleteEvents(sock_t socket, Command* command,
+                            EventPoll::EventType events) CXX11_OVERRIDE;
+#ifdef ENABLE_ASYNC_DNS
+
+  virtual bool
+  addNameResolver(const std::shared_ptr<AsyncNameResolver>& resolver,
+                  Command* command) CXX11_OVERRIDE;
+  virtual bool
+  deleteNameResolver(const std::shared_ptr<AsyncNameResolver>& resolver,
+                     Command* command) CXX11_OVERRIDE;
+#endif // ENABLE_ASYNC_DNS
+
+  static const int IEV_READ = POLLIN;
+  static const int IEV_WRITE = POLLOUT;
+  static const int IEV_ERROR = POLLERR;
+  static const int IEV_HUP = POLLHUP;
+};
+
+// Returns |ep| if it was initialized successfully.  Otherwise,
+// returns EpollEventPoll if it is available, or nullptr.
+std::unique_ptr<EventPoll>
+selectIoUringEventPoll(std::unique_ptr<IoUringEventPoll> ep);
+
+} // namespace aria2
+
+#endif // D_IO_URING_EVENT_POLL_H
@@ -51,9 +51,49 @@
 #include "MessageDigest.h"
 #include "fmt.h"
 #include "DlAbortEx.h"
+#include "PieceHashCheckPool.h"
+#include "DownloadEngine.h"
 
 namespace aria2 {
 
+namespace {
+class ChunkHashCheckJob : public PieceHashCheckJob {
+public:
+  ChunkHashCheckJob(
+      std::string hashType, std::string expectedDigest,
+      std::vector<unsigned char> data, size_t index, int64_t offset,
+      std::shared_ptr<std::vector<std::pair<size_t, bool>>> results)
+      : PieceHashCheckJob(std::move(hashType), std::move(expectedDigest),
+                          std::move(data)),
+        index_(index),
+        offset_(offset),
+        results_(std::move(results))
+  {
+  }
+
+  virtual void onHashChecked(DownloadEngine* e) CXX11_OVERRIDE
+  {
+    if (!isMatched()) {
+      A2_LOG_INFO(fmt(EX_INVALID_CHUNK_CHECKSUM,
+                      static_cast<unsigned long>(index_),
+                      static_cast<int64_t>(offset_),
+                      util::toHex(getExpectedDigest()).c_str(),
+                      util::toHex(getActualDigest()).c_str()));
+    }
+    results_->emplace_back(index_, isMatched());
+    // CheckIntegrityCommand may be waiting for this result.
+    if (e) {
+      e->setRefreshInterval(std::chrono::milliseconds(0));
+    }
+  }
+
+private:
+  size_t index_;
+  int64_t offset_;
+  std::shared_ptr<std::vector<std::pair<size_t, bool>>> results_;
+};
+} // namespace
+
 IteratableChunkChecksumValidator::IteratableChunkChecksumValidator(
     const std::shared_ptr<DownloadContext>& dctx,
     const std::shared_ptr<PieceStorage>& pieceStorage)
@@ -61,7 +101,10 @@ IteratableChunkChecksumValidator::IteratableChunkChecksumValidator(
       pieceStorage_(pieceStorage),
       bitfield_(make_unique<BitfieldMan>(dctx_->getPieceLength(),
                                          dctx_->getTotalLength())),
-      currentIndex_(0)
+      currentIndex_(0),
+      nextIndex_(0),
+      pieceHashCheckPool_(nullptr),
+      numInFlight_(0)
 {
 }
 
@@ -70,32 +113,12 @@ IteratableChunkChecksumValidator::~IteratableChunkChecksumValidator() = default;
 void IteratableChunkChecksumValidator::validateChunk()
 {
   if (!finished()) {
-    std::string actualChecksum;
-    try {
-      actualChecksum = calculateActualChecksum();
-      if (actualChecksum == dctx_->getPieceHashes()[currentIndex_]) {
-        bitfield_->setBit(currentIndex_);
-      }
-      else {
-        A2_LOG_INFO(
-            fmt(EX_INVALID_CHUNK_CHECKSUM,
-                static_cast<unsigned long>(currentIndex_),
-                static_cast<int64_t>(getCurrentOffset()),
-                util::toHex(dctx_->getPieceHashes()[currentIndex_]).c_str(),
-                util::toHex(actualChecksum).c_str()));
-        bitfield_->unsetBit(currentIndex_);
-      }
+    if (pieceHashCheckPool_) {
+      validateChunkInParallel();
     }
-    catch (RecoverableException& ex) {
-      A2_LOG_DEBUG_EX(fmt("Caught exception while validating piece index=%lu."
-                          " Some part of file may be missing."
-                          " Continue operation.",
-                          static_cast<unsigned long>(currentIndex_)),
-                      ex);
-      bitfield_->unsetBit(currentIndex_);
+    else {
+      validateChunkSequentially();
     }
-
-    ++currentIndex_;
     if (finished()) {
       pieceStorage_->setBitfield(bitfield_->getBitfield(),
                                  bitfield_->getBitfieldLength());
@@ -103,18 +126,129 @@ void IteratableChunkChecksumValidator::validateChunk()
   }
 }
 
-std::string IteratableChunkChecksumValidator::calculateActualChecksum()
+void IteratableChunkChecksumValidator::validateChunkSequentially()
 {
-  int64_t offset = getCurrentOffset();
-  size_t length;
-  // When validating last piece
-  if (currentIndex_ + 1 == dctx_->getNumPieces()) {
-    length = dctx_->getTotalLength() - offset;
+  std::string actualChecksum;
+  try {
+    readahead(currentIndex_ + 1);
+    actualChecksum = calculateActualChecksum();
+    if (actualChecksum == dctx_->getPieceHashes()[currentIndex_]) {
+      bitfield_->setBit(currentIndex_);
+    }
+    else {
+      A2_LOG_INFO(
+          fmt(EX_INVALID_CHUNK_CHECKSUM,
+              static_cast<unsigned long>(currentIndex_),
+              static_cast<int64_t>(getCurrentOffset()),
+              util::toHex(dctx_->getPieceHashes()[currentIndex_]).c_str(),
+              util::toHex(actualChecksum).c_str()));
+      bitfield_->unsetBit(currentIndex_);
+    }
+  }
+  catch (RecoverableException& ex) {
+    A2_LOG_DEBUG_EX(fmt("Caught exception while validating piece index=%lu."
+                        " Some part of file may be missing."
+                        " Continue operation.",
+                        static_cast<unsigned long>(currentIndex_)),
+                    ex);
+    bitfield_->unsetBit(currentIndex_);
+  }
+  ++currentIndex_;
+  nextIndex_ = currentIndex_;
+}
+
+void IteratableChunkChecksumValidator::validateChunkInParallel()
+{
+  for (auto& r : *results_) {
+    if (r.second) {
+      bitfield_->setBit(r.first);
+    }
+    else {
+      bitfield_->unsetBit(r.first);
+    }
+  }
+  currentIndex_ += results_->size();
+  numInFlight_ -= results_->size();
+  results_->clear();
+  // We read at most one piece at a time to keep the event loop
+  // responsive.  If no piece can be submitted, the caller is woken up
+  // when a result arrives.  See waitingForResult().
+  if (canSubmitChunk()) {
+    submitChunk(nextIndex_);
+    ++nextIndex_;
+  }
+}
+
+bool IteratableChunkChecksumValidator::canSubmitChunk() const
+{
+  // Keep all worker threads busy, plus one extra piece so that the
+  // next job is ready when a worker becomes free.
+  return nextIndex_ < dctx_->getNumPieces() &&
+         numInFlight_ <= pieceHashCheckPool_->getNumThreads();
+}
+
+bool IteratableChunkChecksumValidator::waitingForResult() const
+{
+  return pieceHashCheckPool_ && !finished() && numInFlight_ > 0 &&
+         results_->empty() && !canSubmitChunk();
+}
+
+void IteratableChunkChecksumValidator::submitChunk(size_t index)
+{
+  auto offset = static_cast<int64_t>(index) * dctx_->getPieceLength();
+  auto length = getPieceLength(index);
+  std::vector<unsigned char> data(length);
+  try {
+    readahead(index + 1);
+    for (size_t nread = 0; nread < length;) {
+      auto r = pieceStorage_->getDiskAdaptor()->readDataDropCache(
+          data.data() + nread, length - nread, offset + nread);
+      if (r == 0) {
+        throw DL_ABORT_EX(fmt(EX_FILE_READ, dctx_->getBasePath().c_str(),
+                              "data is too short"));
+      }
+      nread += r;
+    }
+  }
+  catch (RecoverableException& ex) {
+    A2_LOG_DEBUG_EX(fmt("Caught exception while validating piece index=%lu."
+                        " Some part of file may be missing."
+                        " Continue operation.",
+                        static_cast<unsigned long>(index)),
+                    ex);
+    bitfield_->unsetBit(index);
+    ++currentIndex_;
+    return;
+  }
+  ++numInFlight_;
+  pieceHashCheckPool_->submit(make_unique<ChunkHashCheckJob>(
+      dctx_->getPieceHashType(), dctx_->getPieceHashes()[index],
+      std::move(data), index, offset, results_));
+}
+
+size_t IteratableChunkChecksumValidator::getPieceLength(size_t index) const
+{
+  if (index + 1 == dctx_->getNumPieces()) {
+    return dctx_->getTotalLength() -
+           static_cast<int64_t>(index) * dctx_->getPieceLength();
   }
   else {
-    length = dctx_->getPieceLength();
+    return dctx_->getPieceLength();
   }
-  return digest(offset, length);
+}
+
+void IteratableChunkChecksumValidator::readahead(size_t index)
+{
+  if (index < dctx_->getNumPieces()) {
+    pieceStorage_->getDiskAdaptor()->readahead(
+        getPieceLength(index),
+        static_cast<int64_t>(index) * dctx_->getPieceLength());
+  }
+}
+
+std::string IteratableChunkChecksumValidator::calculateActualChecksum()
+{
+  return digest(getCurrentOffset(), getPieceLength(currentIndex_));
 }
 
 void IteratableChunkChecksumValidator::init()
@@ -122,6 +256,9 @@ void IteratableChunkChecksumValidator::init()
   ctx_ = MessageDigest::create(dctx_->getPieceHashType());
   bitfield_->clearAllBit();
   currentIndex_ = 0;
+  nextIndex_ = 0;
+  numInFlight_ = 0;
+  results_ = std::make_shared<std::vector<std::pair<size_t, bool>>>();
 }
 
 std::string IteratableChunkChecksumValidator::digest(int64_t offset,
@@ -164,4 +301,10 @@ int64_t IteratableChunkChecksumValidator::getTotalLength() const
   return dctx_->getTotalLength();
 }
 
+void IteratableChunkChecksumValidator::setPieceHashCheckPool(
+    PieceHashCheckPool* pool)
+{
+  pieceHashCheckPool_ = pool;
+}
+
 } // namespace aria2
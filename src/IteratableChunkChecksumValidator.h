@@ -38,6 +38,7 @@
 #include "IteratableValidator.h"
 
 #include <string>
+#include <vector>
 #include <memory>
 
 namespace aria2 {
@@ -46,19 +47,44 @@ class DownloadContext;
 class PieceStorage;
 class BitfieldMan;
 class MessageDigest;
+class PieceHashCheckPool;
 
 class IteratableChunkChecksumValidator : public IteratableValidator {
 private:
   std::shared_ptr<DownloadContext> dctx_;
   std::shared_ptr<PieceStorage> pieceStorage_;
   std::unique_ptr<BitfieldMan> bitfield_;
+  // The number of pieces validated so far
   size_t currentIndex_;
+  // The index of the piece to be read next
+  size_t nextIndex_;
   std::unique_ptr<MessageDigest> ctx_;
+  PieceHashCheckPool* pieceHashCheckPool_;
+  // The number of pieces submitted to pieceHashCheckPool_ whose
+  // results have not been received yet.
+  size_t numInFlight_;
+  // Pairs of piece index and whether its hash matched.  Shared with
+  // submitted jobs, which may outlive this object.
+  std::shared_ptr<std::vector<std::pair<size_t, bool>>> results_;
+
+  size_t getPieceLength(size_t index) const;
+
+  void readahead(size_t index);
 
   std::string calculateActualChecksum();
 
   std::string digest(int64_t offset, size_t length);
 
+  void validateChunkSequentially();
+
+  void validateChunkInParallel();
+
+  // Returns true if another piece can be submitted without exceeding
+  // the number of pieces kept in flight.
+  bool canSubmitChunk() const;
+
+  void submitChunk(size_t index);
+
 public:
   IteratableChunkChecksumValidator(
       const std::shared_ptr<DownloadContext>& dctx,
@@ -75,6 +101,10 @@ public:
   virtual int64_t getCurrentOffset() const CXX11_OVERRIDE;
 
   virtual int64_t getTotalLength() const CXX11_OVERRIDE;
+
+  virtual void setPieceHashCheckPool(PieceHashCheckPool* pool) CXX11_OVERRIDE;
+
+  virtual bool waitingForResult() const CXX11_OVERRIDE;
 };
 
 } // namespace aria2
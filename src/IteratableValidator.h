@@ -41,6 +41,8 @@
 
 namespace aria2 {
 
+class PieceHashCheckPool;
+
 /**
  * This class provides the interface to validate files.
  *
@@ -62,6 +64,14 @@ public:
   virtual int64_t getCurrentOffset() const = 0;
 
   virtual int64_t getTotalLength() const = 0;
+
+  // Sets the thread pool to compute hashes.  The validator may
+  // ignore it if it cannot validate chunks independently.
+  virtual void setPieceHashCheckPool(PieceHashCheckPool* pool) {}
+
+  // Returns true if validateChunk() makes no progress until a job
+  // submitted to the thread pool finishes.
+  virtual bool waitingForResult() const { return false; }
 };
 
 } // namespace aria2
@@ -35,6 +35,7 @@
 #include "LibgnutlsTLSSession.h"
 
 #include <cassert>
+#include <vector>
 
 #include <gnutls/x509.h>
 
@@ -381,4 +382,74 @@ int GnuTLSSession::tlsAccept(TLSVersion& version)
 
 std::string GnuTLSSession::getLastErrorString() { return gnutls_strerror(rv_); }
 
+int GnuTLSSession::setAlpnProtocols(const std::string& protos)
+{
+#if GNUTLS_VERSION_NUMBER >= 0x030200
+  // Convert wire format into the list of gnutls_datum_t.
+  std::vector<gnutls_datum_t> datums;
+  for (size_t i = 0; i < protos.size();) {
+    size_t len = static_cast<unsigned char>(protos[i]);
+    if (i + 1 + len > protos.size()) {
+      return TLS_ERR_ERROR;
+    }
+    gnutls_datum_t d;
+    d.data =
+        reinterpret_cast<unsigned char*>(const_cast<char*>(&protos[i + 1]));
+    d.size = len;
+    datums.push_back(d);
+    i += 1 + len;
+  }
+  rv_ = gnutls_alpn_set_protocols(sslSession_, datums.data(), datums.size(), 0);
+  if (rv_ != GNUTLS_E_SUCCESS) {
+    return TLS_ERR_ERROR;
+  }
+#endif // GNUTLS_VERSION_NUMBER >= 0x030200
+  return TLS_ERR_OK;
+}
+
+std::string GnuTLSSession::getAlpnProtocol()
+{
+#if GNUTLS_VERSION_NUMBER >= 0x030200
+  gnutls_datum_t proto;
+  if (gnutls_alpn_get_selected_protocol(sslSession_, &proto) ==
+      GNUTLS_E_SUCCESS) {
+    return std::string(proto.data, proto.data + proto.size);
+  }
+#endif // GNUTLS_VERSION_NUMBER >= 0x030200
+  return "";
+}
+
+int GnuTLSSession::setSessionData(const std::string& data)
+{
+  rv_ = gnutls_session_set_data(sslSession_, data.data(), data.size());
+  if (rv_ != GNUTLS_E_SUCCESS) {
+    return TLS_ERR_ERROR;
+  }
+  return TLS_ERR_OK;
+}
+
+std::string GnuTLSSession::getSessionData()
+{
+#if GNUTLS_VERSION_NUMBER >= 0x030604
+  // In TLS 1.3, the session is not resumable until NewSessionTicket
+  // is received.
+  if (gnutls_protocol_get_version(sslSession_) == GNUTLS_TLS1_3 &&
+      !(gnutls_session_get_flags(sslSession_) & GNUTLS_SFLAGS_SESSION_TICKET)) {
+    return "";
+  }
+#endif // GNUTLS_VERSION_NUMBER >= 0x030604
+  gnutls_datum_t data;
+  if (gnutls_session_get_data2(sslSession_, &data) != GNUTLS_E_SUCCESS) {
+    return "";
+  }
+  std::string res(data.data, data.data + data.size);
+  gnutls_free(data.data);
+  return res;
+}
+
+bool GnuTLSSession::isSessionResumed()
+{
+  return gnutls_session_is_resumed(sslSession_);
+}
+
 } // namespace aria2
@@ -46,6 +46,7 @@
 #include "fmt.h"
 #include "message.h"
 #include "BufferedFile.h"
+#include "libssl_compat.h"
 
 namespace {
 struct bio_deleter {
@@ -170,6 +171,18 @@ OpenSSLTLSContext::~OpenSSLTLSContext() { SSL_CTX_free(sslCtx_); }
 
 bool OpenSSLTLSContext::good() const { return good_; }
 
+bool OpenSSLTLSContext::enableKernelTLS()
+{
+#if OPENSSL_3_API && !defined(OPENSSL_NO_KTLS)
+  // OpenSSL falls back to user space record layer if the kernel or
+  // the negotiated cipher does not support kTLS.
+  SSL_CTX_set_options(sslCtx_, SSL_OP_ENABLE_KTLS);
+  return true;
+#else  // !OPENSSL_3_API || OPENSSL_NO_KTLS
+  return false;
+#endif // !OPENSSL_3_API || OPENSSL_NO_KTLS
+}
+
 bool OpenSSLTLSContext::addCredentialFile(const std::string& certfile,
                                           const std::string& keyfile)
 {
@@ -371,4 +371,95 @@ std::string OpenSSLTLSSession::getLastErrorString()
   }
 }
 
+int OpenSSLTLSSession::setAlpnProtocols(const std::string& protos)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+  ERR_clear_error();
+  // Unlike most of OpenSSL API, SSL_set_alpn_protos returns 0 on
+  // success.
+  if (SSL_set_alpn_protos(ssl_,
+                          reinterpret_cast<const unsigned char*>(protos.data()),
+                          protos.size()) != 0) {
+    return TLS_ERR_ERROR;
+  }
+#endif // OPENSSL_VERSION_NUMBER >= 0x10002000L
+  return TLS_ERR_OK;
+}
+
+std::string OpenSSLTLSSession::getAlpnProtocol()
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+  const unsigned char* data = nullptr;
+  unsigned int len = 0;
+  SSL_get0_alpn_selected(ssl_, &data, &len);
+  if (data) {
+    return std::string(data, data + len);
+  }
+#endif // OPENSSL_VERSION_NUMBER >= 0x10002000L
+  return "";
+}
+
+int OpenSSLTLSSession::setSessionData(const std::string& data)
+{
+  ERR_clear_error();
+  auto p = reinterpret_cast<const unsigned char*>(data.data());
+  SSL_SESSION* session = d2i_SSL_SESSION(nullptr, &p, data.size());
+  if (!session) {
+    return TLS_ERR_ERROR;
+  }
+  // SSL_set_session increments the reference count of session.
+  rv_ = SSL_set_session(ssl_, session);
+  SSL_SESSION_free(session);
+  if (rv_ != 1) {
+    return TLS_ERR_ERROR;
+  }
+  return TLS_ERR_OK;
+}
+
+std::string OpenSSLTLSSession::getSessionData()
+{
+  SSL_SESSION* session = SSL_get_session(ssl_);
+  if (!session) {
+    return "";
+  }
+#if !LIBRESSL_IN_USE && OPENSSL_VERSION_NUMBER >= 0x10101000L
+  // In TLS 1.3, the session is not resumable until NewSessionTicket
+  // is received.
+  if (!SSL_SESSION_is_resumable(session)) {
+    return "";
+  }
+#endif // !LIBRESSL_IN_USE && OPENSSL_VERSION_NUMBER >= 0x10101000L
+  int len = i2d_SSL_SESSION(session, nullptr);
+  if (len <= 0) {
+    return "";
+  }
+  std::string data(len, '\0');
+  auto p = reinterpret_cast<unsigned char*>(&data[0]);
+  i2d_SSL_SESSION(session, &p);
+  return data;
+}
+
+bool OpenSSLTLSSession::isSessionResumed()
+{
+  return SSL_session_reused(ssl_) == 1;
+}
+
+bool OpenSSLTLSSession::isKernelTLSSend()
+{
+#if OPENSSL_3_API
+  return BIO_get_ktls_send(SSL_get_wbio(ssl_));
+#else  // !OPENSSL_3_API
+  return false;
+#endif // !OPENSSL_3_API
+}
+
+bool OpenSSLTLSSession::isKernelTLSRecv()
+{
+#if OPENSSL_3_API
+  return BIO_get_ktls_recv(SSL_get_rbio(ssl_));
+#else  // !OPENSSL_3_API
+  return false;
+#endif // !OPENSSL_3_API
+}
+
 } // namespace aria2
@@ -61,6 +61,13 @@ public:
   virtual int tlsAccept(TLSVersion& version) CXX11_OVERRIDE;
   virtual std::string getLastErrorString() CXX11_OVERRIDE;
   virtual size_t getRecvBufferedLength() CXX11_OVERRIDE { return 0; }
+  virtual int setAlpnProtocols(const std::string& protos) CXX11_OVERRIDE;
+  virtual std::string getAlpnProtocol() CXX11_OVERRIDE;
+  virtual int setSessionData(const std::string& data) CXX11_OVERRIDE;
+  virtual std::string getSessionData() CXX11_OVERRIDE;
+  virtual bool isSessionResumed() CXX11_OVERRIDE;
+  virtual bool isKernelTLSSend() CXX11_OVERRIDE;
+  virtual bool isKernelTLSRecv() CXX11_OVERRIDE;
 
 private:
   int handshake(TLSVersion& version);
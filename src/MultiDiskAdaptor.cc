@@ -410,6 +410,42 @@ ssize_t MultiDiskAdaptor::readData(unsigned char* data, size_t len,
   return totalReadLength;
 }
 
+void MultiDiskAdaptor::readahead(int64_t len, int64_t offset)
+{
+  auto first = findFirstDiskWriterEntry(diskWriterEntries_, offset);
+  ssize_t rem = len;
+  int64_t fileOffset = offset - (*first)->getFileEntry()->getOffset();
+  for (auto i = first, eoi = diskWriterEntries_.cend(); i != eoi && rem > 0;
+       ++i) {
+    ssize_t readLength = calculateLength((*i).get(), fileOffset, rem);
+    if ((*i)->isOpen()) {
+      (*i)->getDiskWriter()->readahead(readLength, fileOffset);
+    }
+    rem -= readLength;
+    fileOffset = 0;
+  }
+}
+
+size_t MultiDiskAdaptor::getFileRange(int& fd, int64_t& fileOffset,
+                                      size_t len, int64_t offset)
+{
+  auto& dwent = *findFirstDiskWriterEntry(diskWriterEntries_, offset);
+  fileOffset = offset - dwent->getFileEntry()->getOffset();
+  if (fileOffset >= dwent->getFileEntry()->getLength()) {
+    return 0;
+  }
+  openIfNot(dwent.get(), &DiskWriterEntry::openFile);
+  if (!dwent->isOpen()) {
+    return 0;
+  }
+  fd = dwent->getDiskWriter()->getFd();
+  if (fd == -1) {
+    return 0;
+  }
+  return std::min(static_cast<int64_t>(len),
+                  dwent->getFileEntry()->getLength() - fileOffset);
+}
+
 void MultiDiskAdaptor::writeCache(const WrDiskCacheEntry* entry)
 {
   for (auto& d : entry->getDataSet()) {
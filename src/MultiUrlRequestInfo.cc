@@ -72,10 +72,15 @@
 #endif // !ENABLE_WEBSOCKET
 #ifdef ENABLE_SSL
 #  include "TLSContext.h"
+#  include "TLSSessionCache.h"
 #endif // ENABLE_SSL
 #ifdef ENABLE_ASYNC_DNS
 #  include "AsyncNameResolver.h"
 #endif // ENABLE_ASYNC_DNS
+#ifdef ENABLE_BITTORRENT
+#  include "BtRegistry.h"
+#  include "UDPTrackerClient.h"
+#endif // ENABLE_BITTORRENT
 
 namespace aria2 {
 
@@ -198,6 +203,10 @@ int MultiUrlRequestInfo::prepare()
         throw DL_ABORT_EX("Loading private key and/or certificate for secure "
                           "RPC failed.");
       }
+      if (option_->getAsBool(PREF_ENABLE_KERNEL_TLS) &&
+          !svTlsContext->enableKernelTLS()) {
+        A2_LOG_WARN(MSG_KERNEL_TLS_NOT_SUPPORTED);
+      }
       SocketCore::setServerTLSContext(svTlsContext);
     }
 #endif // ENABLE_SSL
@@ -270,7 +279,17 @@ int MultiUrlRequestInfo::prepare()
       }
     }
     clTlsContext->setVerifyPeer(option_->getAsBool(PREF_CHECK_CERTIFICATE));
+    if (option_->getAsBool(PREF_ENABLE_KERNEL_TLS) &&
+        !clTlsContext->enableKernelTLS()) {
+      A2_LOG_WARN(MSG_KERNEL_TLS_NOT_SUPPORTED);
+    }
     SocketCore::setClientTLSContext(clTlsContext);
+    std::shared_ptr<TLSSessionCache> tlsSessionCache;
+    auto tlsSessionCacheSize = option_->getAsInt(PREF_TLS_SESSION_CACHE_SIZE);
+    if (tlsSessionCacheSize > 0) {
+      tlsSessionCache = std::make_shared<TLSSessionCache>(tlsSessionCacheSize);
+    }
+    SocketCore::setTLSSessionCache(tlsSessionCache);
 #endif
 #ifdef HAVE_ARES_ADDR_NODE
     ares_addr_node* asyncDNSServers =
@@ -284,6 +303,11 @@ int MultiUrlRequestInfo::prepare()
       e_->getRequestGroupMan()->removeStaleServerStat(
           std::chrono::seconds(option_->getAsInt(PREF_SERVER_STAT_TIMEOUT)));
     }
+    e_->getDNSCache()->setMaxSize(option_->getAsInt(PREF_DNS_CACHE_SIZE));
+    const std::string& dnsCacheFile = option_->get(PREF_DNS_CACHE_FILE);
+    if (!dnsCacheFile.empty() && File(dnsCacheFile).isFile()) {
+      e_->getDNSCache()->load(dnsCacheFile);
+    }
     e_->setStatCalc(getStatCalc(option_));
     if (uriListParser_) {
       e_->getRequestGroupMan()->setUriListParser(uriListParser_);
@@ -315,6 +339,18 @@ error_code::Value MultiUrlRequestInfo::getResult()
   if (!serverStatOf.empty()) {
     e_->getRequestGroupMan()->saveServerStat(serverStatOf);
   }
+  const std::string& dnsCacheFile = option_->get(PREF_DNS_CACHE_FILE);
+  if (!dnsCacheFile.empty()) {
+    e_->getDNSCache()->save(dnsCacheFile);
+  }
+#ifdef ENABLE_BITTORRENT
+  const std::string& udpTrackerCacheFile =
+      option_->get(PREF_BT_UDP_TRACKER_CACHE_FILE);
+  const auto& udpTrackerClient = e_->getBtRegistry()->getUDPTrackerClient();
+  if (!udpTrackerCacheFile.empty() && udpTrackerClient) {
+    udpTrackerClient->save(udpTrackerCacheFile);
+  }
+#endif // ENABLE_BITTORRENT
   if (!option_->getAsBool(PREF_QUIET) &&
       option_->get(PREF_DOWNLOAD_RESULT) != A2_V_HIDE) {
     e_->getRequestGroupMan()->showDownloadResults(
@@ -56,6 +56,11 @@ int NetStat::calculateDownloadSpeed()
   return downloadSpeed_.calculateSpeed();
 }
 
+int NetStat::calculateDownloadSpeed(const Timer& now) const
+{
+  return downloadSpeed_.calculateSpeed(now);
+}
+
 int NetStat::calculateNewestDownloadSpeed(int seconds)
 {
   return downloadSpeed_.calculateNewestSpeed(seconds);
@@ -63,11 +68,18 @@ int NetStat::calculateNewestDownloadSpeed(int seconds)
 
 int NetStat::calculateAvgDownloadSpeed()
 {
-  return avgDownloadSpeed_ = downloadSpeed_.calculateAvgSpeed();
+  int speed = downloadSpeed_.calculateAvgSpeed();
+  avgDownloadSpeed_.store(speed, std::memory_order_relaxed);
+  return speed;
 }
 
 int NetStat::calculateUploadSpeed() { return uploadSpeed_.calculateSpeed(); }
 
+int NetStat::calculateUploadSpeed(const Timer& now) const
+{
+  return uploadSpeed_.calculateSpeed(now);
+}
+
 int NetStat::calculateNewestUploadSpeed(int seconds)
 {
   return uploadSpeed_.calculateNewestSpeed(seconds);
@@ -75,26 +87,28 @@ int NetStat::calculateNewestUploadSpeed(int seconds)
 
 int NetStat::calculateAvgUploadSpeed()
 {
-  return avgUploadSpeed_ = uploadSpeed_.calculateAvgSpeed();
+  int speed = uploadSpeed_.calculateAvgSpeed();
+  avgUploadSpeed_.store(speed, std::memory_order_relaxed);
+  return speed;
 }
 
 void NetStat::updateDownload(size_t bytes)
 {
   downloadSpeed_.update(bytes);
-  sessionDownloadLength_ += bytes;
+  sessionDownloadLength_.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 void NetStat::updateUpload(size_t bytes)
 {
   uploadSpeed_.update(bytes);
-  sessionUploadLength_ += bytes;
+  sessionUploadLength_.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 void NetStat::updateUploadSpeed(size_t bytes) { uploadSpeed_.update(bytes); }
 
 void NetStat::updateUploadLength(size_t bytes)
 {
-  sessionUploadLength_ += bytes;
+  sessionUploadLength_.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 int NetStat::getMaxDownloadSpeed() const
@@ -109,22 +123,22 @@ void NetStat::reset()
   downloadSpeed_.reset();
   uploadSpeed_.reset();
   downloadStartTime_ = global::wallclock();
-  status_ = IDLE;
-  sessionDownloadLength_ = 0;
-  sessionUploadLength_ = 0;
+  status_.store(IDLE, std::memory_order_relaxed);
+  sessionDownloadLength_.store(0, std::memory_order_relaxed);
+  sessionUploadLength_.store(0, std::memory_order_relaxed);
 }
 
 void NetStat::downloadStart()
 {
   reset();
-  status_ = ACTIVE;
+  status_.store(ACTIVE, std::memory_order_relaxed);
 }
 
 void NetStat::downloadStop()
 {
   calculateAvgDownloadSpeed();
   calculateAvgUploadSpeed();
-  status_ = IDLE;
+  status_.store(IDLE, std::memory_order_relaxed);
 }
 
 TransferStat NetStat::toTransferStat()
@@ -137,4 +151,14 @@ TransferStat NetStat::toTransferStat()
   return stat;
 }
 
+TransferStat NetStat::toTransferStat(const Timer& now) const
+{
+  TransferStat stat;
+  stat.downloadSpeed = calculateDownloadSpeed(now);
+  stat.uploadSpeed = calculateUploadSpeed(now);
+  stat.sessionDownloadLength = getSessionDownloadLength();
+  stat.sessionUploadLength = getSessionUploadLength();
+  return stat;
+}
+
 } // namespace aria2
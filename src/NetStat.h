@@ -37,11 +37,17 @@
 
 #include "common.h"
 
+#include <atomic>
+
 #include "SpeedCalc.h"
 #include "TransferStat.h"
 
 namespace aria2 {
 
+// Transfer statistics of a connection, a download or the whole
+// session.  Updated by the download engine thread only.  The const
+// functions taking the current time read atomics with relaxed
+// ordering, so that they can be called from other threads.
 class NetStat {
 public:
   enum STATUS {
@@ -61,12 +67,16 @@ public:
    */
   int calculateDownloadSpeed();
 
+  int calculateDownloadSpeed(const Timer& now) const;
+
   int calculateNewestDownloadSpeed(int seconds);
 
   int calculateAvgDownloadSpeed();
 
   int calculateUploadSpeed();
 
+  int calculateUploadSpeed(const Timer& now) const;
+
   int calculateNewestUploadSpeed(int seconds);
 
   int calculateAvgUploadSpeed();
@@ -83,9 +93,15 @@ public:
 
   int getMaxUploadSpeed() const;
 
-  int getAvgDownloadSpeed() const { return avgDownloadSpeed_; }
+  int getAvgDownloadSpeed() const
+  {
+    return avgDownloadSpeed_.load(std::memory_order_relaxed);
+  }
 
-  int getAvgUploadSpeed() const { return avgUploadSpeed_; }
+  int getAvgUploadSpeed() const
+  {
+    return avgUploadSpeed_.load(std::memory_order_relaxed);
+  }
 
   void reset();
 
@@ -95,28 +111,36 @@ public:
 
   const Timer& getDownloadStartTime() const { return downloadStartTime_; }
 
-  STATUS getStatus() const { return status_; }
+  STATUS getStatus() const { return status_.load(std::memory_order_relaxed); }
 
-  uint64_t getSessionDownloadLength() const { return sessionDownloadLength_; }
+  uint64_t getSessionDownloadLength() const
+  {
+    return sessionDownloadLength_.load(std::memory_order_relaxed);
+  }
 
-  uint64_t getSessionUploadLength() const { return sessionUploadLength_; }
+  uint64_t getSessionUploadLength() const
+  {
+    return sessionUploadLength_.load(std::memory_order_relaxed);
+  }
 
   void addSessionDownloadLength(uint64_t length)
   {
-    sessionDownloadLength_ += length;
+    sessionDownloadLength_.fetch_add(length, std::memory_order_relaxed);
   }
 
   TransferStat toTransferStat();
 
+  TransferStat toTransferStat(const Timer& now) const;
+
 private:
   SpeedCalc downloadSpeed_;
   SpeedCalc uploadSpeed_;
   Timer downloadStartTime_;
-  STATUS status_;
-  int avgDownloadSpeed_;
-  int avgUploadSpeed_;
-  int64_t sessionDownloadLength_;
-  int64_t sessionUploadLength_;
+  std::atomic<STATUS> status_;
+  std::atomic<int> avgDownloadSpeed_;
+  std::atomic<int> avgUploadSpeed_;
+  std::atomic<int64_t> sessionDownloadLength_;
+  std::atomic<int64_t> sessionUploadLength_;
 };
 
 } // namespace aria2
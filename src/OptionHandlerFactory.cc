@@ -125,6 +125,19 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_ADVANCED);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new NumberOptionHandler(
+        PREF_BANDWIDTH_WEIGHT, TEXT_BANDWIDTH_WEIGHT, "1", 1, 100));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_BITTORRENT);
+    op->addTag(TAG_FTP);
+    op->addTag(TAG_HTTP);
+    op->setInitialOption(true);
+    op->setChangeOption(true);
+    op->setChangeGlobalOption(true);
+    op->setChangeOptionForReserved(true);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new BooleanOptionHandler(PREF_CHECK_INTEGRITY,
                                                TEXT_CHECK_INTEGRITY, A2_V_FALSE,
@@ -229,6 +242,34 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_ADVANCED);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new LocalFilePathOptionHandler(
+        PREF_DNS_CACHE_FILE, TEXT_DNS_CACHE_FILE, NO_DEFAULT_VALUE,
+        /* acceptStdin = */ false, 0, /* mustExist = */ false));
+    op->addTag(TAG_ADVANCED);
+    handlers.push_back(op);
+  }
+  {
+    OptionHandler* op(new NumberOptionHandler(
+        PREF_DNS_CACHE_SIZE, TEXT_DNS_CACHE_SIZE, "10000", 0, INT32_MAX));
+    op->addTag(TAG_ADVANCED);
+    handlers.push_back(op);
+  }
+  {
+    OptionHandler* op(new NumberOptionHandler(
+        PREF_DNS_CACHE_TTL, TEXT_DNS_CACHE_TTL, "300", 0, INT32_MAX));
+    op->addTag(TAG_ADVANCED);
+    handlers.push_back(op);
+  }
+#ifdef ENABLE_ASYNC_DNS
+  {
+    OptionHandler* op(new NumberOptionHandler(PREF_DNS_NEGATIVE_CACHE_TTL,
+                                              TEXT_DNS_NEGATIVE_CACHE_TTL, "60",
+                                              0, INT32_MAX));
+    op->addTag(TAG_ADVANCED);
+    handlers.push_back(op);
+  }
+#endif // ENABLE_ASYNC_DNS
   {
     OptionHandler* op(
         new NumberOptionHandler(PREF_DNS_TIMEOUT, NO_DESCRIPTION, "30", 1, 60));
@@ -263,6 +304,19 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_ADVANCED);
     handlers.push_back(op);
   }
+#ifdef ENABLE_SSL
+  {
+    OptionHandler* op(new BooleanOptionHandler(PREF_ENABLE_KERNEL_TLS,
+                                               TEXT_ENABLE_KERNEL_TLS,
+                                               A2_V_FALSE,
+                                               OptionHandler::OPT_ARG));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_EXPERIMENTAL);
+    op->addTag(TAG_HTTPS);
+    op->addTag(TAG_RPC);
+    handlers.push_back(op);
+  }
+#endif // ENABLE_SSL
 #if defined(HAVE_MMAP) || defined(__MINGW32__)
   {
     OptionHandler* op(new BooleanOptionHandler(PREF_ENABLE_MMAP,
@@ -302,6 +356,9 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
 #ifdef HAVE_EPOLL
                                                      V_EPOLL,
 #endif // HAVE_EPOLL
+#ifdef HAVE_IO_URING
+                                                     V_IO_URING,
+#endif // HAVE_IO_URING
 #ifdef HAVE_KQUEUE
                                                      V_KQUEUE,
 #endif // HAVE_KQUEUE
@@ -383,6 +440,13 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeOptionForReserved(true);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new NumberOptionHandler(
+        PREF_HASH_CHECK_THREADS, TEXT_HASH_CHECK_THREADS, "0", 0, 64));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_BITTORRENT);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new BooleanOptionHandler(PREF_HUMAN_READABLE,
                                                TEXT_HUMAN_READABLE, A2_V_TRUE,
@@ -437,6 +501,14 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeGlobalOption(true);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new NumberOptionHandler(
+        PREF_MAX_CONCURRENT_INTEGRITY_CHECKS,
+        TEXT_MAX_CONCURRENT_INTEGRITY_CHECKS, "1", 1, 64));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_CHECKSUM);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new NumberOptionHandler(PREF_MAX_CONNECTION_PER_SERVER,
                                               TEXT_MAX_CONNECTION_PER_SERVER,
@@ -731,6 +803,16 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_ADVANCED);
     handlers.push_back(op);
   }
+#ifdef ENABLE_SSL
+  {
+    OptionHandler* op(new NumberOptionHandler(PREF_TLS_SESSION_CACHE_SIZE,
+                                              TEXT_TLS_SESSION_CACHE_SIZE,
+                                              "1000", 0, INT32_MAX));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_HTTPS);
+    handlers.push_back(op);
+  }
+#endif // ENABLE_SSL
   {
     OptionHandler* op(new BooleanOptionHandler(
         PREF_TRUNCATE_CONSOLE_READOUT, TEXT_TRUNCATE_CONSOLE_READOUT, A2_V_TRUE,
@@ -1086,6 +1168,18 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeOptionForReserved(true);
     handlers.push_back(op);
   }
+#if defined(ENABLE_SSL) && defined(HAVE_LIBNGHTTP2)
+  {
+    OptionHandler* op(new BooleanOptionHandler(PREF_ENABLE_HTTP2,
+                                               TEXT_ENABLE_HTTP2, A2_V_TRUE,
+                                               OptionHandler::OPT_ARG));
+    op->addTag(TAG_HTTP);
+    op->setInitialOption(true);
+    op->setChangeGlobalOption(true);
+    op->setChangeOptionForReserved(true);
+    handlers.push_back(op);
+  }
+#endif // ENABLE_SSL && HAVE_LIBNGHTTP2
   {
     OptionHandler* op(new CumulativeOptionHandler(PREF_HEADER, TEXT_HEADER,
                                                   NO_DEFAULT_VALUE, "\n"));
@@ -1126,6 +1220,15 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeOptionForReserved(true);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new NumberOptionHandler(
+        PREF_HTTP_PIPELINE_DEPTH, TEXT_HTTP_PIPELINE_DEPTH, "1", 1, 16));
+    op->addTag(TAG_HTTP);
+    op->setInitialOption(true);
+    op->setChangeGlobalOption(true);
+    op->setChangeOptionForReserved(true);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(
         new DefaultOptionHandler(PREF_HTTP_PASSWD, TEXT_HTTP_PASSWD));
@@ -1537,6 +1640,19 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeOptionForReserved(true);
     handlers.push_back(op);
   }
+#ifdef HAVE_SENDFILE
+  {
+    OptionHandler* op(new BooleanOptionHandler(
+        PREF_BT_ENABLE_SENDFILE, TEXT_BT_ENABLE_SENDFILE, A2_V_TRUE,
+        OptionHandler::OPT_ARG));
+    op->addTag(TAG_BITTORRENT);
+    op->addTag(TAG_ADVANCED);
+    op->setInitialOption(true);
+    op->setChangeGlobalOption(true);
+    op->setChangeOptionForReserved(true);
+    handlers.push_back(op);
+  }
+#endif // HAVE_SENDFILE
   {
     OptionHandler* op(new DefaultOptionHandler(
         PREF_BT_LPD_INTERFACE, TEXT_BT_LPD_INTERFACE, NO_DEFAULT_VALUE,
@@ -1700,6 +1816,21 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeOptionForReserved(true);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new LocalFilePathOptionHandler(
+        PREF_BT_UDP_TRACKER_CACHE_FILE, TEXT_BT_UDP_TRACKER_CACHE_FILE,
+        NO_DEFAULT_VALUE, /* acceptStdin = */ false, 0,
+        /* mustExist = */ false));
+    op->addTag(TAG_BITTORRENT);
+    handlers.push_back(op);
+  }
+  {
+    OptionHandler* op(new UnitNumberOptionHandler(
+        PREF_DHT_ANNOUNCE_STORAGE_SIZE, TEXT_DHT_ANNOUNCE_STORAGE_SIZE, "8M",
+        0));
+    op->addTag(TAG_BITTORRENT);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new HostPortOptionHandler(
         PREF_DHT_ENTRY_POINT, TEXT_DHT_ENTRY_POINT, NO_DEFAULT_VALUE,
@@ -1751,6 +1882,13 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_BITTORRENT);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new NumberOptionHandler(PREF_DHT_MAX_ANNOUNCED_PEERS,
+                                              TEXT_DHT_MAX_ANNOUNCED_PEERS,
+                                              "100", 0, UINT16_MAX));
+    op->addTag(TAG_BITTORRENT);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new NumberOptionHandler(
         PREF_DHT_MESSAGE_TIMEOUT, TEXT_DHT_MESSAGE_TIMEOUT, "10", 1, 60));
@@ -174,6 +174,18 @@ void Peer::snubbing(bool b)
   res_->snubbing(b);
 }
 
+bool Peer::badPieceReceived() const
+{
+  assert(res_);
+  return res_->badPieceReceived();
+}
+
+void Peer::badPieceReceived(bool b)
+{
+  assert(res_);
+  res_->badPieceReceived(b);
+}
+
 void Peer::updateUploadSpeed(int32_t bytes)
 {
   assert(res_);
@@ -278,7 +290,7 @@ size_t Peer::countPeerAllowedIndexSet() const
   return res_->peerAllowedIndexSet().size();
 }
 
-const std::set<size_t>& Peer::getPeerAllowedIndexSet() const
+const std::vector<size_t>& Peer::getPeerAllowedIndexSet() const
 {
   assert(res_);
   return res_->peerAllowedIndexSet();
@@ -365,6 +377,42 @@ const Timer& Peer::getLastDownloadUpdate() const
   return res_->getLastDownloadUpdate();
 }
 
+size_t Peer::getReqq() const
+{
+  assert(res_);
+  return res_->reqq();
+}
+
+void Peer::setReqq(size_t n)
+{
+  assert(res_);
+  res_->reqq(n);
+}
+
+size_t Peer::getRequestQueueDepth() const
+{
+  assert(res_);
+  return res_->requestQueueDepth();
+}
+
+void Peer::setRequestQueueDepth(size_t n)
+{
+  assert(res_);
+  res_->requestQueueDepth(n);
+}
+
+Timer::Clock::duration Peer::getRequestRtt() const
+{
+  assert(res_);
+  return res_->requestRtt();
+}
+
+void Peer::updateRequestRtt(Timer::Clock::duration rtt)
+{
+  assert(res_);
+  res_->updateRequestRtt(rtt);
+}
+
 const Timer& Peer::getLastAmUnchoking() const
 {
   assert(res_);
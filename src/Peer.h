@@ -39,7 +39,7 @@
 
 #include <cassert>
 #include <string>
-#include <set>
+#include <vector>
 #include <algorithm>
 
 #include "TimerA2.h"
@@ -171,6 +171,11 @@ public:
 
   void snubbing(bool b);
 
+  // this peer sent a piece whose hash did not match.
+  bool badPieceReceived() const;
+
+  void badPieceReceived(bool b);
+
   void updateUploadSpeed(int32_t bytes);
 
   void updateUploadLength(int32_t bytes);
@@ -221,7 +226,7 @@ public:
 
   size_t countPeerAllowedIndexSet() const;
 
-  const std::set<size_t>& getPeerAllowedIndexSet() const;
+  const std::vector<size_t>& getPeerAllowedIndexSet() const;
 
   void addAmAllowedIndex(size_t index);
 
@@ -247,6 +252,23 @@ public:
 
   const Timer& getLastDownloadUpdate() const;
 
+  // The number of outstanding requests this peer accepts.  0 means
+  // unknown.
+  size_t getReqq() const;
+
+  void setReqq(size_t n);
+
+  // The number of requests localhost keeps outstanding to this peer.
+  size_t getRequestQueueDepth() const;
+
+  void setRequestQueueDepth(size_t n);
+
+  // Returns the minimum request round trip time recently observed,
+  // or zero if it is not known yet.
+  Timer::Clock::duration getRequestRtt() const;
+
+  void updateRequestRtt(Timer::Clock::duration rtt);
+
   const Timer& getLastAmUnchoking() const;
 
   int64_t getCompletedLength() const;
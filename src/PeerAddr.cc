@@ -0,0 +1,78 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "PeerAddr.h"
+
+#include "SocketCore.h"
+#include "MessageDigest.h"
+
+namespace aria2 {
+
+PeerAddr::PeerAddr(const std::string& ipaddr, uint16_t port)
+    : port(port), family(AF_UNSPEC)
+{
+  memset(addr, 0, sizeof(addr));
+  switch (net::getBinAddr(addr, ipaddr)) {
+  case 4:
+    family = AF_INET;
+    break;
+  case 16:
+    family = AF_INET6;
+    break;
+  default: {
+    // Tracker may return peer by host name.  It is rare, so just take
+    // the digest of it to keep the key fixed size.
+    auto md = MessageDigest::sha1();
+    md->update(ipaddr.data(), ipaddr.size());
+    auto digest = md->digest();
+    memcpy(addr, digest.data(), sizeof(addr));
+    break;
+  }
+  }
+}
+
+size_t PeerAddrHash::operator()(const PeerAddr& peerAddr) const
+{
+  // FNV-1a
+  uint64_t h = 14695981039346656037ULL;
+  for (auto c : peerAddr.addr) {
+    h = (h ^ c) * 1099511628211ULL;
+  }
+  h = (h ^ (peerAddr.port & 0xff)) * 1099511628211ULL;
+  h = (h ^ (peerAddr.port >> 8)) * 1099511628211ULL;
+  h = (h ^ peerAddr.family) * 1099511628211ULL;
+  return h;
+}
+
+} // namespace aria2
@@ -0,0 +1,74 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_PEER_ADDR_H
+#define D_PEER_ADDR_H
+
+#include "common.h"
+
+#include <cstring>
+#include <string>
+
+namespace aria2 {
+
+// Binary representation of peer's address and port.  This is used as
+// a key of hash tables in peer storage instead of the pair of textual
+// address and port.
+struct PeerAddr {
+  // 4 bytes for IPv4 and 16 bytes for IPv6 address.  If the peer was
+  // given by host name, this contains first 16 bytes of SHA-1 of the
+  // host name.  The unused bytes are zero-filled.
+  unsigned char addr[16];
+  uint16_t port;
+  // AF_INET, AF_INET6 or AF_UNSPEC for host name.
+  uint8_t family;
+
+  PeerAddr(const std::string& ipaddr, uint16_t port);
+
+  bool operator==(const PeerAddr& other) const
+  {
+    return port == other.port && family == other.family &&
+           memcmp(addr, other.addr, sizeof(addr)) == 0;
+  }
+
+  bool operator!=(const PeerAddr& other) const { return !(*this == other); }
+};
+
+struct PeerAddrHash {
+  size_t operator()(const PeerAddr& peerAddr) const;
+};
+
+} // namespace aria2
+
+#endif // D_PEER_ADDR_H
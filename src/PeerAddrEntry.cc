@@ -33,13 +33,18 @@
  */
 /* copyright --> */
 #include "PeerAddrEntry.h"
+
+#include <cstring>
+
+#include "bittorrent_helper.h"
 #include "wallclock.h"
 
 namespace aria2 {
 
 PeerAddrEntry::PeerAddrEntry(const std::string& ipaddr, uint16_t port,
                              Timer updated)
-    : ipaddr_(ipaddr), port_(port), lastUpdated_(updated)
+    : compactlen_(bittorrent::packcompact(compact_, ipaddr, port)),
+      lastUpdated_(std::move(updated))
 {
 }
 
@@ -47,21 +52,35 @@ PeerAddrEntry::PeerAddrEntry(const PeerAddrEntry& c) = default;
 
 PeerAddrEntry::~PeerAddrEntry() = default;
 
-PeerAddrEntry& PeerAddrEntry::operator=(const PeerAddrEntry& c)
+PeerAddrEntry& PeerAddrEntry::operator=(const PeerAddrEntry& c) = default;
+
+std::string PeerAddrEntry::getIPAddress() const
+{
+  if (compactlen_ == 0) {
+    return "";
+  }
+  return bittorrent::unpackcompact(compact_, compactlen_ == COMPACT_LEN_IPV4
+                                                 ? AF_INET
+                                                 : AF_INET6)
+      .first;
+}
+
+uint16_t PeerAddrEntry::getPort() const
 {
-  if (this != &c) {
-    ipaddr_ = c.ipaddr_;
-    port_ = c.port_;
-    lastUpdated_ = c.lastUpdated_;
+  if (compactlen_ == 0) {
+    return 0;
   }
-  return *this;
+  uint16_t port;
+  memcpy(&port, compact_ + compactlen_ - 2, sizeof(port));
+  return ntohs(port);
 }
 
 void PeerAddrEntry::notifyUpdate() { lastUpdated_ = global::wallclock(); }
 
 bool PeerAddrEntry::operator==(const PeerAddrEntry& entry) const
 {
-  return ipaddr_ == entry.ipaddr_ && port_ == entry.port_;
+  return compactlen_ == entry.compactlen_ &&
+         memcmp(compact_, entry.compact_, compactlen_) == 0;
 }
 
 } // namespace aria2
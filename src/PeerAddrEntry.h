@@ -40,28 +40,43 @@
 #include <string>
 
 #include "TimerA2.h"
+#include "BtConstants.h"
 
 namespace aria2 {
 
+// Peer address announced through DHT.  The address is kept in compact
+// form (4 or 16 bytes of address followed by 2 bytes of port) instead
+// of std::string, because a DHT node may store a lot of them.
 class PeerAddrEntry {
 private:
-  std::string ipaddr_;
+  unsigned char compact_[COMPACT_LEN_IPV6];
 
-  uint16_t port_;
+  // 6 for IPv4, 18 for IPv6, or 0 if the address was not numeric.
+  uint8_t compactlen_;
 
   Timer lastUpdated_;
 
 public:
   PeerAddrEntry(const std::string& ipaddr, uint16_t port,
                 Timer updated = Timer());
+
   PeerAddrEntry(const PeerAddrEntry& c);
+
   ~PeerAddrEntry();
 
   PeerAddrEntry& operator=(const PeerAddrEntry& c);
 
-  const std::string& getIPAddress() const { return ipaddr_; }
+  std::string getIPAddress() const;
+
+  uint16_t getPort() const;
+
+  // Returns true if the address given in the constructor was a numeric
+  // IPv4 or IPv6 address.
+  bool valid() const { return compactlen_ != 0; }
+
+  const unsigned char* getCompact() const { return compact_; }
 
-  uint16_t getPort() const { return port_; }
+  size_t getCompactLength() const { return compactlen_; }
 
   const Timer& getLastUpdated() const { return lastUpdated_; }
 
@@ -0,0 +1,192 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "PeerBitfield.h"
+
+#include <cstring>
+#include <map>
+
+#include "bitfield.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+namespace {
+// Bitfields with no bit set or all bits set, keyed by the number of
+// blocks and whether bits are set.  They are shared by all peers of
+// torrents with the same number of pieces.
+std::map<std::pair<size_t, bool>, std::weak_ptr<unsigned char>>
+    sharedBitfields;
+} // namespace
+
+namespace {
+std::shared_ptr<unsigned char> getSharedBitfield(size_t blocks, bool allSet)
+{
+  auto key = std::make_pair(blocks, allSet);
+  auto i = sharedBitfields.find(key);
+  if (i != std::end(sharedBitfields)) {
+    auto bitfield = (*i).second.lock();
+    if (bitfield) {
+      return bitfield;
+    }
+  }
+  // Purge the bitfields of the torrents which are gone.
+  for (auto j = std::begin(sharedBitfields); j != std::end(sharedBitfields);) {
+    if ((*j).second.expired()) {
+      j = sharedBitfields.erase(j);
+    }
+    else {
+      ++j;
+    }
+  }
+  size_t bitfieldLength = (blocks + 7) / 8;
+  std::shared_ptr<unsigned char> bitfield(
+      new unsigned char[bitfieldLength], std::default_delete<unsigned char[]>());
+  if (allSet && bitfieldLength > 0) {
+    memset(bitfield.get(), 0xff, bitfieldLength - 1);
+    bitfield.get()[bitfieldLength - 1] = bitfield::lastByteMask(blocks);
+  }
+  else {
+    memset(bitfield.get(), 0, bitfieldLength);
+  }
+  sharedBitfields[key] = bitfield;
+  return bitfield;
+}
+} // namespace
+
+PeerBitfield::PeerBitfield(int32_t pieceLength, int64_t totalLength)
+    : totalLength_(totalLength),
+      pieceLength_(pieceLength),
+      blocks_(0),
+      bitfieldLength_(0),
+      numSetBit_(0)
+{
+  if (pieceLength_ > 0 && totalLength_ > 0) {
+    blocks_ = (totalLength_ + pieceLength_ - 1) / pieceLength_;
+    bitfieldLength_ = (blocks_ + 7) / 8;
+  }
+  sharedBitfield_ = getSharedBitfield(blocks_, false);
+}
+
+PeerBitfield::~PeerBitfield() = default;
+
+void PeerBitfield::shareIfPossible()
+{
+  if (numSetBit_ == 0 || numSetBit_ == blocks_) {
+    bitfield_.reset();
+    sharedBitfield_ = getSharedBitfield(blocks_, numSetBit_ != 0);
+  }
+}
+
+void PeerBitfield::ensureOwnBitfield()
+{
+  if (!bitfield_) {
+    bitfield_ = make_unique<unsigned char[]>(bitfieldLength_);
+    memcpy(bitfield_.get(), sharedBitfield_.get(), bitfieldLength_);
+    sharedBitfield_.reset();
+  }
+}
+
+bool PeerBitfield::isBitSet(size_t index) const
+{
+  return bitfield::test(getBitfield(), blocks_, index);
+}
+
+void PeerBitfield::setBit(size_t index)
+{
+  if (index >= blocks_ || isBitSet(index)) {
+    return;
+  }
+  ensureOwnBitfield();
+  bitfield_[index / 8] |= 128 >> (index % 8);
+  ++numSetBit_;
+  shareIfPossible();
+}
+
+void PeerBitfield::unsetBit(size_t index)
+{
+  if (index >= blocks_ || !isBitSet(index)) {
+    return;
+  }
+  ensureOwnBitfield();
+  bitfield_[index / 8] &= ~(128 >> (index % 8));
+  --numSetBit_;
+  shareIfPossible();
+}
+
+void PeerBitfield::setAllBit()
+{
+  numSetBit_ = blocks_;
+  shareIfPossible();
+}
+
+void PeerBitfield::setBitfield(const unsigned char* bitfield,
+                               size_t bitfieldLength)
+{
+  if (bitfieldLength_ != bitfieldLength) {
+    return;
+  }
+  numSetBit_ = bitfield::countSetBit(bitfield, blocks_);
+  if (numSetBit_ == 0 || numSetBit_ == blocks_) {
+    shareIfPossible();
+    return;
+  }
+  ensureOwnBitfield();
+  memcpy(bitfield_.get(), bitfield, bitfieldLength_);
+  // Clear spare bits so that they are never taken as pieces.
+  bitfield_[bitfieldLength_ - 1] &= bitfield::lastByteMask(blocks_);
+}
+
+const unsigned char* PeerBitfield::getBitfield() const
+{
+  return bitfield_ ? bitfield_.get() : sharedBitfield_.get();
+}
+
+int64_t PeerBitfield::getCompletedLength() const
+{
+  if (numSetBit_ == 0) {
+    return 0;
+  }
+  if (numSetBit_ == blocks_) {
+    return totalLength_;
+  }
+  int64_t completedLength = static_cast<int64_t>(pieceLength_) * numSetBit_;
+  if (isBitSet(blocks_ - 1)) {
+    completedLength -= static_cast<int64_t>(pieceLength_) * blocks_ -
+                       totalLength_;
+  }
+  return completedLength;
+}
+
+} // namespace aria2
@@ -0,0 +1,105 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_PEER_BITFIELD_H
+#define D_PEER_BITFIELD_H
+
+#include "common.h"
+
+#include <memory>
+
+namespace aria2 {
+
+// Bitfield of pieces which a remote peer has.  Unlike BitfieldMan,
+// this only keeps the bitfield itself and the number of set bits.
+// While the peer has no piece or all pieces, the bitfield is shared
+// with other peers of the same torrent, so that seeders and new
+// leechers do not need per-peer bitfield at all.
+class PeerBitfield {
+private:
+  int64_t totalLength_;
+  int32_t pieceLength_;
+  size_t blocks_;
+  size_t bitfieldLength_;
+  size_t numSetBit_;
+  // Per-peer bitfield.  This is only allocated when some, but not
+  // all, bits are set.
+  std::unique_ptr<unsigned char[]> bitfield_;
+  // Shared bitfield with no bit set or all bits set.  This is used
+  // when bitfield_ is null.
+  std::shared_ptr<unsigned char> sharedBitfield_;
+
+  // Drops per-peer bitfield and uses shared one if no bit or all bits
+  // are set.
+  void shareIfPossible();
+
+  // Allocates per-peer bitfield, copying the shared one.
+  void ensureOwnBitfield();
+
+public:
+  PeerBitfield(int32_t pieceLength, int64_t totalLength);
+
+  ~PeerBitfield();
+
+  size_t countBlock() const { return blocks_; }
+
+  size_t countSetBit() const { return numSetBit_; }
+
+  bool isBitSet(size_t index) const;
+
+  void setBit(size_t index);
+
+  void unsetBit(size_t index);
+
+  void setAllBit();
+
+  bool isAllBitSet() const { return numSetBit_ == blocks_; }
+
+  // Copies |bitfield|.  If |bitfieldLength| does not match
+  // getBitfieldLength(), this function does nothing.
+  void setBitfield(const unsigned char* bitfield, size_t bitfieldLength);
+
+  const unsigned char* getBitfield() const;
+
+  size_t getBitfieldLength() const { return bitfieldLength_; }
+
+  int64_t getCompletedLength() const;
+
+  // Returns true if the peer does not have its own copy of bitfield.
+  bool isShared() const { return !bitfield_; }
+};
+
+} // namespace aria2
+
+#endif // D_PEER_BITFIELD_H
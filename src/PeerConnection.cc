@@ -77,7 +77,8 @@ PeerConnection::PeerConnection(cuid_t cuid, const std::shared_ptr<Peer>& peer,
       msgOffset_(0),
       socketBuffer_(socket),
       encryptionEnabled_(false),
-      prevPeek_(false)
+      prevPeek_(false),
+      sendfileEnabled_(false)
 {
 }
 
@@ -92,6 +93,26 @@ void PeerConnection::pushBytes(std::vector<unsigned char> data,
   socketBuffer_.pushBytes(std::move(data), std::move(progressUpdate));
 }
 
+void PeerConnection::pushBlockBuffer(
+    BlockBuffer data, size_t length,
+    std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  if (encryptionEnabled_) {
+    encryptor_->encrypt(length, data.get(), data.get());
+  }
+  socketBuffer_.pushBlockBuffer(std::move(data), length,
+                                std::move(progressUpdate));
+}
+
+void PeerConnection::pushFileRange(
+    std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset, size_t length,
+    std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  assert(!encryptionEnabled_);
+  socketBuffer_.pushFileRange(std::move(diskAdaptor), offset, length,
+                              std::move(progressUpdate));
+}
+
 bool PeerConnection::receiveMessage(unsigned char* data, size_t& dataLength)
 {
   while (1) {
@@ -50,6 +50,7 @@ namespace aria2 {
 class Peer;
 class SocketCore;
 class ARC4Encryptor;
+class DiskAdaptor;
 
 // The maximum length of buffer. If the message length (including 4
 // bytes length and payload length) is larger than this value, it is
@@ -84,6 +85,9 @@ private:
 
   bool prevPeek_;
 
+  // True if piece data can be sent directly from file.
+  bool sendfileEnabled_;
+
   void readData(unsigned char* data, size_t& length, bool encryption);
 
   ssize_t sendData(const unsigned char* data, size_t length, bool encryption);
@@ -100,6 +104,31 @@ public:
                  std::unique_ptr<ProgressUpdate> progressUpdate =
                      std::unique_ptr<ProgressUpdate>{});
 
+  // Pushes first length bytes of data into send buffer.  data is
+  // returned to its pool after it is sent.
+  void pushBlockBuffer(BlockBuffer data, size_t length,
+                       std::unique_ptr<ProgressUpdate> progressUpdate =
+                           std::unique_ptr<ProgressUpdate>{});
+
+  // Pushes length bytes of data in diskAdaptor starting at offset
+  // into send buffer.  The data is sent directly from file.  This
+  // function must be called only when isSendfileAvailable() returns
+  // true.
+  void pushFileRange(std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset,
+                     size_t length,
+                     std::unique_ptr<ProgressUpdate> progressUpdate =
+                         std::unique_ptr<ProgressUpdate>{});
+
+  void enableSendfile() { sendfileEnabled_ = true; }
+
+  // Returns true if pushFileRange() can be used.  Data must be
+  // encrypted in user space if encryption is enabled, so sendfile is
+  // not available in that case.
+  bool isSendfileAvailable() const
+  {
+    return sendfileEnabled_ && !encryptionEnabled_;
+  }
+
   bool receiveMessage(unsigned char* data, size_t& dataLength);
 
   /**
@@ -137,6 +137,8 @@ PeerInteractionCommand::PeerInteractionCommand(
   factory->setDownloadContext(requestGroup_->getDownloadContext().get());
   factory->setPieceStorage(pieceStorage.get());
   factory->setPeerStorage(peerStorage.get());
+  factory->setPieceHashCheckPool(e->getPieceHashCheckPool());
+  factory->setBlockBufferPool(e->getBlockBufferPool());
   factory->setExtensionMessageFactory(extensionMessageFactory.get());
   factory->setPeer(getPeer());
   if (family == AF_INET) {
@@ -165,6 +167,11 @@ PeerInteractionCommand::PeerInteractionCommand(
       getDownloadEngine()->setNoWait(true);
     }
   }
+#ifdef HAVE_SENDFILE
+  if (getOption()->getAsBool(PREF_BT_ENABLE_SENDFILE)) {
+    peerConnection->enableSendfile();
+  }
+#endif // HAVE_SENDFILE
   // If the number of pieces gets bigger, the length of Bitfield
   // message payload exceeds the initial buffer capacity of
   // PeerConnection, which is MAX_PAYLOAD_LEN.  We expand buffer as
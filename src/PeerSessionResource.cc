@@ -37,7 +37,7 @@
 #include <cassert>
 #include <algorithm>
 
-#include "BitfieldMan.h"
+#include "PeerBitfield.h"
 #include "A2STR.h"
 #include "BtMessageDispatcher.h"
 #include "wallclock.h"
@@ -47,7 +47,7 @@ namespace aria2 {
 
 PeerSessionResource::PeerSessionResource(int32_t pieceLength,
                                          int64_t totalLength)
-    : bitfieldMan_(make_unique<BitfieldMan>(pieceLength, totalLength)),
+    : bitfield_(make_unique<PeerBitfield>(pieceLength, totalLength)),
       lastDownloadUpdate_(Timer::zero()),
       lastAmUnchoking_(Timer::zero()),
       dispatcher_(nullptr),
@@ -58,9 +58,14 @@ PeerSessionResource::PeerSessionResource(int32_t pieceLength,
       chokingRequired_(true),
       optUnchoking_(false),
       snubbing_(false),
+      badPieceReceived_(false),
       fastExtensionEnabled_(false),
       extendedMessagingEnabled_(false),
-      dhtEnabled_(false)
+      dhtEnabled_(false),
+      reqq_(0),
+      requestQueueDepth_(0),
+      requestRtt_(Timer::Clock::duration::zero()),
+      requestRttTimer_(Timer::zero())
 {
 }
 
@@ -103,70 +108,82 @@ void PeerSessionResource::snubbing(bool b)
 
 bool PeerSessionResource::hasAllPieces() const
 {
-  return bitfieldMan_->isAllBitSet();
+  return bitfield_->isAllBitSet();
 }
 
 void PeerSessionResource::updateBitfield(size_t index, int operation)
 {
   if (operation == 1) {
-    bitfieldMan_->setBit(index);
+    bitfield_->setBit(index);
   }
   else if (operation == 0) {
-    bitfieldMan_->unsetBit(index);
+    bitfield_->unsetBit(index);
   }
 }
 
 void PeerSessionResource::setBitfield(const unsigned char* bitfield,
                                       size_t bitfieldLength)
 {
-  bitfieldMan_->setBitfield(bitfield, bitfieldLength);
+  bitfield_->setBitfield(bitfield, bitfieldLength);
 }
 
 const unsigned char* PeerSessionResource::getBitfield() const
 {
-  return bitfieldMan_->getBitfield();
+  return bitfield_->getBitfield();
 }
 
 size_t PeerSessionResource::getBitfieldLength() const
 {
-  return bitfieldMan_->getBitfieldLength();
+  return bitfield_->getBitfieldLength();
 }
 
 bool PeerSessionResource::hasPiece(size_t index) const
 {
-  return bitfieldMan_->isBitSet(index);
+  return bitfield_->isBitSet(index);
 }
 
-void PeerSessionResource::markSeeder() { bitfieldMan_->setAllBit(); }
+void PeerSessionResource::markSeeder() { bitfield_->setAllBit(); }
 
 void PeerSessionResource::fastExtensionEnabled(bool b)
 {
   fastExtensionEnabled_ = b;
 }
 
-const std::set<size_t>& PeerSessionResource::peerAllowedIndexSet() const
+namespace {
+void insertIndex(std::vector<size_t>& indexes, size_t index)
+{
+  auto i = std::lower_bound(std::begin(indexes), std::end(indexes), index);
+  if (i == std::end(indexes) || *i != index) {
+    indexes.insert(i, index);
+  }
+}
+} // namespace
+
+const std::vector<size_t>& PeerSessionResource::peerAllowedIndexSet() const
 {
   return peerAllowedIndexSet_;
 }
 
 void PeerSessionResource::addPeerAllowedIndex(size_t index)
 {
-  peerAllowedIndexSet_.insert(index);
+  insertIndex(peerAllowedIndexSet_, index);
 }
 
 bool PeerSessionResource::peerAllowedIndexSetContains(size_t index) const
 {
-  return peerAllowedIndexSet_.count(index) == 1;
+  return std::binary_search(std::begin(peerAllowedIndexSet_),
+                            std::end(peerAllowedIndexSet_), index);
 }
 
 void PeerSessionResource::addAmAllowedIndex(size_t index)
 {
-  amAllowedIndexSet_.insert(index);
+  insertIndex(amAllowedIndexSet_, index);
 }
 
 bool PeerSessionResource::amAllowedIndexSetContains(size_t index) const
 {
-  return amAllowedIndexSet_.count(index) == 1;
+  return std::binary_search(std::begin(amAllowedIndexSet_),
+                            std::end(amAllowedIndexSet_), index);
 }
 
 void PeerSessionResource::extendedMessagingEnabled(bool b)
@@ -219,7 +236,7 @@ void PeerSessionResource::updateDownload(int32_t bytes)
 
 int64_t PeerSessionResource::getCompletedLength() const
 {
-  return bitfieldMan_->getCompletedLength();
+  return bitfield_->getCompletedLength();
 }
 
 void PeerSessionResource::setBtMessageDispatcher(BtMessageDispatcher* dpt)
@@ -227,6 +244,18 @@ void PeerSessionResource::setBtMessageDispatcher(BtMessageDispatcher* dpt)
   dispatcher_ = dpt;
 }
 
+void PeerSessionResource::updateRequestRtt(Timer::Clock::duration rtt)
+{
+  if (rtt <= Timer::Clock::duration::zero()) {
+    return;
+  }
+  if (requestRtt_ == Timer::Clock::duration::zero() || rtt < requestRtt_ ||
+      requestRttTimer_.difference(global::wallclock()) >= REQUEST_RTT_WINDOW) {
+    requestRtt_ = rtt;
+    requestRttTimer_ = global::wallclock();
+  }
+}
+
 size_t PeerSessionResource::countOutstandingUpload() const
 {
   assert(dispatcher_);
@@ -235,7 +264,7 @@ size_t PeerSessionResource::countOutstandingUpload() const
 
 void PeerSessionResource::reconfigure(int32_t pieceLength, int64_t totalLenth)
 {
-  bitfieldMan_ = make_unique<BitfieldMan>(pieceLength, totalLenth);
+  bitfield_ = make_unique<PeerBitfield>(pieceLength, totalLenth);
 }
 
 } // namespace aria2
@@ -38,7 +38,7 @@
 #include "common.h"
 
 #include <string>
-#include <set>
+#include <vector>
 #include <memory>
 
 #include "BtConstants.h"
@@ -48,16 +48,18 @@
 
 namespace aria2 {
 
-class BitfieldMan;
+class PeerBitfield;
 class BtMessageDispatcher;
 
 class PeerSessionResource {
 private:
-  std::unique_ptr<BitfieldMan> bitfieldMan_;
-  // fast index set which a peer has sent to localhost.
-  std::set<size_t> peerAllowedIndexSet_;
-  // fast index set which localhost has sent to a peer.
-  std::set<size_t> amAllowedIndexSet_;
+  std::unique_ptr<PeerBitfield> bitfield_;
+  // fast index set which a peer has sent to localhost, sorted in
+  // ascending order.
+  std::vector<size_t> peerAllowedIndexSet_;
+  // fast index set which localhost has sent to a peer, sorted in
+  // ascending order.
+  std::vector<size_t> amAllowedIndexSet_;
   ExtensionMessageRegistry extreg_;
   NetStat netStat_;
 
@@ -81,9 +83,21 @@ private:
   bool optUnchoking_;
   // this peer is snubbing.
   bool snubbing_;
+  // this peer sent a piece whose hash did not match.
+  bool badPieceReceived_;
   bool fastExtensionEnabled_;
   bool extendedMessagingEnabled_;
   bool dhtEnabled_;
+  // The number of outstanding requests this peer accepts, advertised
+  // as "reqq" in the extended handshake.  0 means unknown.
+  size_t reqq_;
+  // The number of requests localhost currently keeps outstanding to
+  // this peer.
+  size_t requestQueueDepth_;
+  // The minimum round trip time of a request observed since
+  // requestRttTimer_.  Zero if there is no sample yet.
+  Timer::Clock::duration requestRtt_;
+  Timer requestRttTimer_;
 
 public:
   PeerSessionResource(int32_t pieceLength, int64_t totalLength);
@@ -127,6 +141,11 @@ public:
 
   void snubbing(bool b);
 
+  // this peer sent a piece whose hash did not match.
+  bool badPieceReceived() const { return badPieceReceived_; }
+
+  void badPieceReceived(bool b) { badPieceReceived_ = b; }
+
   bool hasAllPieces() const;
 
   void updateBitfield(size_t index, int operation);
@@ -148,14 +167,14 @@ public:
   void fastExtensionEnabled(bool b);
 
   // fast index set which a peer has sent to localhost.
-  const std::set<size_t>& peerAllowedIndexSet() const;
+  const std::vector<size_t>& peerAllowedIndexSet() const;
 
   void addPeerAllowedIndex(size_t index);
 
   bool peerAllowedIndexSetContains(size_t index) const;
 
   // fast index set which localhost has sent to a peer.
-  const std::set<size_t>& amAllowedIndexSet() const
+  const std::vector<size_t>& amAllowedIndexSet() const
   {
     return amAllowedIndexSet_;
   }
@@ -180,6 +199,22 @@ public:
 
   NetStat& getNetStat() { return netStat_; }
 
+  size_t reqq() const { return reqq_; }
+
+  void reqq(size_t n) { reqq_ = n; }
+
+  size_t requestQueueDepth() const { return requestQueueDepth_; }
+
+  void requestQueueDepth(size_t n) { requestQueueDepth_ = n; }
+
+  Timer::Clock::duration requestRtt() const { return requestRtt_; }
+
+  // Records the time between sending a request and receiving its
+  // piece.  Only the minimum in REQUEST_RTT_WINDOW is kept, since
+  // larger samples include the time the request was queued at the
+  // peer.
+  void updateRequestRtt(Timer::Clock::duration rtt);
+
   int64_t uploadLength() const;
 
   void updateUploadSpeed(int32_t bytes);
@@ -36,6 +36,7 @@
 
 #include <array>
 #include <cassert>
+#include <cstring>
 
 #include "util.h"
 #include "BitfieldMan.h"
@@ -274,6 +275,43 @@ Piece::getDigestWithWrCache(size_t pieceLength,
   return mdctx->digest();
 }
 
+namespace {
+void readDataFully(unsigned char* buf,
+                   const std::shared_ptr<DiskAdaptor>& adaptor, int64_t offset,
+                   size_t len)
+{
+  ssize_t nread = adaptor->readData(buf, len, offset);
+  if (nread < 0 || static_cast<size_t>(nread) != len) {
+    throw DL_ABORT_EX(fmt(EX_FILE_READ, "n/a", "data is too short"));
+  }
+}
+} // namespace
+
+std::vector<unsigned char>
+Piece::getDataWithWrCache(size_t pieceLength,
+                          const std::shared_ptr<DiskAdaptor>& adaptor)
+{
+  std::vector<unsigned char> data(length_);
+  int64_t start = static_cast<int64_t>(index_) * pieceLength;
+  int64_t goff = start;
+  if (wrCache_) {
+    const WrDiskCacheEntry::DataCellSet& dataSet = wrCache_->getDataSet();
+    for (auto& d : dataSet) {
+      if (goff < d->goff) {
+        readDataFully(data.data() + (goff - start), adaptor, goff,
+                      d->goff - goff);
+      }
+      memcpy(data.data() + (d->goff - start), d->data + d->offset, d->len);
+      goff = d->goff + d->len;
+    }
+  }
+  if (goff < start + length_) {
+    readDataFully(data.data() + (goff - start), adaptor, goff,
+                  start + length_ - goff);
+  }
+  return data;
+}
+
 void Piece::destroyHashContext()
 {
   mdctx_.reset();
@@ -353,6 +391,29 @@ void Piece::updateWrCache(WrDiskCache* diskCache, unsigned char* data,
   assert(rv);
 }
 
+void Piece::updateWrCache(WrDiskCache* diskCache, BlockBuffer data, size_t len,
+                          int64_t goff)
+{
+  if (!diskCache) {
+    return;
+  }
+  assert(wrCache_);
+  A2_LOG_DEBUG(fmt("updateWrCache entry=%p", wrCache_.get()));
+  auto cell = new WrDiskCacheEntry::DataCell();
+  cell->goff = goff;
+  cell->pool = data.get_deleter().pool;
+  cell->data = data.release();
+  cell->offset = 0;
+  cell->len = len;
+  // Don't let appendWrCache() fill the rest of the buffer.
+  cell->capacity = len;
+  bool rv;
+  rv = wrCache_->cacheData(cell);
+  assert(rv);
+  rv = diskCache->update(wrCache_.get(), len);
+  assert(rv);
+}
+
 size_t Piece::appendWrCache(WrDiskCache* diskCache, int64_t goff,
                             const unsigned char* data, size_t len)
 {
@@ -44,6 +44,7 @@
 
 #include "Command.h"
 #include "a2functional.h"
+#include "BlockBufferPool.h"
 
 namespace aria2 {
 
@@ -162,6 +163,12 @@ public:
   // cached data and data on disk.
   std::string getDigestWithWrCache(size_t pieceLength,
                                    const std::shared_ptr<DiskAdaptor>& adaptor);
+
+  // Returns the whole data of this piece, which consists of cached
+  // data and data on disk.
+  std::vector<unsigned char>
+  getDataWithWrCache(size_t pieceLength,
+                     const std::shared_ptr<DiskAdaptor>& adaptor);
   /**
    * Loses current bitfield state.
    */
@@ -185,6 +192,10 @@ public:
   {
     updateWrCache(diskCache, data, offset, len, len, goff);
   }
+  // Caches len bytes of data.  data is returned to the pool it was
+  // obtained from when the cache is flushed.
+  void updateWrCache(WrDiskCache* diskCache, BlockBuffer data, size_t len,
+                     int64_t goff);
   size_t appendWrCache(WrDiskCache* diskCache, int64_t goff,
                        const unsigned char* data, size_t len);
   void releaseWrCache(WrDiskCache* diskCache);
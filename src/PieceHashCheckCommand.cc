@@ -0,0 +1,87 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2019 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "PieceHashCheckCommand.h"
+#include "DownloadEngine.h"
+#include "RequestGroupMan.h"
+#include "PieceHashCheckPool.h"
+#include "SocketCore.h"
+#include "RecoverableException.h"
+#include "Logger.h"
+#include "LogFactory.h"
+#include "message.h"
+
+namespace aria2 {
+
+PieceHashCheckCommand::PieceHashCheckCommand(cuid_t cuid, DownloadEngine* e,
+                                             PieceHashCheckPool* pool)
+    : Command(cuid), e_(e), pool_(pool)
+{
+  setStatusRealtime();
+  if (pool_->getWakeupSocket()) {
+    e_->addSocketForReadCheck(pool_->getWakeupSocket(), this);
+  }
+}
+
+PieceHashCheckCommand::~PieceHashCheckCommand()
+{
+  if (pool_->getWakeupSocket()) {
+    e_->deleteSocketForReadCheck(pool_->getWakeupSocket(), this);
+  }
+}
+
+bool PieceHashCheckCommand::execute()
+{
+  if (e_->isForceHaltRequested()) {
+    return true;
+  }
+  pool_->drainWakeupSocket();
+  for (auto& job : pool_->popFinishedJobs()) {
+    try {
+      job->onHashChecked(e_);
+    }
+    catch (RecoverableException& ex) {
+      A2_LOG_ERROR_EX(EX_EXCEPTION_CAUGHT, ex);
+    }
+  }
+  if (pool_->countOutstandingJob() == 0 &&
+      (e_->isHaltRequested() ||
+       e_->getRequestGroupMan()->downloadFinished())) {
+    return true;
+  }
+  e_->addRoutineCommand(std::unique_ptr<Command>(this));
+  return false;
+}
+
+} // namespace aria2
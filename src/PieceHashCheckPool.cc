@@ -0,0 +1,218 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2019 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "PieceHashCheckPool.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+
+#include "MessageDigest.h"
+#include "SocketCore.h"
+#include "RecoverableException.h"
+#include "Logger.h"
+#include "LogFactory.h"
+#include "fmt.h"
+#include "util.h"
+#include "a2io.h"
+
+namespace aria2 {
+
+PieceHashCheckJob::PieceHashCheckJob(std::string hashType,
+                                     std::string expectedDigest,
+                                     std::vector<unsigned char> data)
+    : hashType_(std::move(hashType)),
+      expectedDigest_(std::move(expectedDigest)),
+      data_(std::move(data)),
+      matched_(false)
+{
+}
+
+PieceHashCheckJob::~PieceHashCheckJob() = default;
+
+void PieceHashCheckJob::check()
+{
+  auto mdctx = MessageDigest::create(hashType_);
+  mdctx->update(data_.data(), data_.size());
+  actualDigest_ = mdctx->digest();
+  matched_ = actualDigest_ == expectedDigest_;
+  // Data is no longer needed.  Release memory as early as possible,
+  // since the job may wait in finished queue for a while.
+  std::vector<unsigned char>().swap(data_);
+}
+
+PieceHashCheckPool::PieceHashCheckPool(size_t numThreads)
+    : numThreads_(numThreads),
+      numOutstandingJob_(0),
+      wakeupWriteFd_((sock_t)-1),
+      shutdown_(false)
+{
+}
+
+PieceHashCheckPool::~PieceHashCheckPool()
+{
+#ifdef HAVE_STD_THREAD
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  cond_.notify_all();
+  for (auto& th : threads_) {
+    th.join();
+  }
+#endif // HAVE_STD_THREAD
+#ifndef __MINGW32__
+  if (wakeupWriteFd_ != (sock_t)-1) {
+    close(wakeupWriteFd_);
+  }
+#endif // !__MINGW32__
+}
+
+bool PieceHashCheckPool::init()
+{
+#ifdef HAVE_STD_THREAD
+#  ifndef __MINGW32__
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+    int errNum = errno;
+    A2_LOG_ERROR(fmt("Failed to create wakeup socket for hash check: %s",
+                     util::safeStrerror(errNum).c_str()));
+    return false;
+  }
+  wakeupSocket_ = std::make_shared<SocketCore>(fds[0], SOCK_STREAM);
+  wakeupSocket_->setNonBlockingMode();
+  wakeupWriteFd_ = fds[1];
+  fcntl(wakeupWriteFd_, F_SETFL, fcntl(wakeupWriteFd_, F_GETFL) | O_NONBLOCK);
+#  endif // !__MINGW32__
+  for (size_t i = 0; i < numThreads_; ++i) {
+    threads_.emplace_back(&PieceHashCheckPool::workerLoop, this);
+  }
+  A2_LOG_INFO(fmt("Started %lu hash check thread(s).",
+                  static_cast<unsigned long>(numThreads_)));
+  return true;
+#else  // !HAVE_STD_THREAD
+  return false;
+#endif // !HAVE_STD_THREAD
+}
+
+void PieceHashCheckPool::submit(std::unique_ptr<PieceHashCheckJob> job)
+{
+  ++numOutstandingJob_;
+#ifdef HAVE_STD_THREAD
+  if (!threads_.empty()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(std::move(job));
+    }
+    cond_.notify_one();
+    return;
+  }
+#endif // HAVE_STD_THREAD
+  job->check();
+  finishedJobs_.push_back(std::move(job));
+}
+
+std::vector<std::unique_ptr<PieceHashCheckJob>>
+PieceHashCheckPool::popFinishedJobs()
+{
+  std::vector<std::unique_ptr<PieceHashCheckJob>> res;
+  {
+#ifdef HAVE_STD_THREAD
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif // HAVE_STD_THREAD
+    res.swap(finishedJobs_);
+  }
+  numOutstandingJob_ -= res.size();
+  return res;
+}
+
+void PieceHashCheckPool::drainWakeupSocket()
+{
+  if (!wakeupSocket_) {
+    return;
+  }
+  unsigned char buf[64];
+  try {
+    for (;;) {
+      size_t len = sizeof(buf);
+      wakeupSocket_->readData(buf, len);
+      if (len < sizeof(buf)) {
+        break;
+      }
+    }
+  }
+  catch (RecoverableException& e) {
+    A2_LOG_ERROR_EX("Failed to read from wakeup socket", e);
+  }
+}
+
+void PieceHashCheckPool::wakeup()
+{
+#ifndef __MINGW32__
+  if (wakeupWriteFd_ != (sock_t)-1) {
+    const char c = 0;
+    ssize_t r;
+    while ((r = write(wakeupWriteFd_, &c, 1)) == -1 && errno == EINTR)
+      ;
+    // If the socket buffer is full, engine thread has not drained the
+    // socket yet, and it will wake up anyway.
+  }
+#endif // !__MINGW32__
+}
+
+void PieceHashCheckPool::workerLoop()
+{
+#ifdef HAVE_STD_THREAD
+  for (;;) {
+    std::unique_ptr<PieceHashCheckJob> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this] { return shutdown_ || !jobs_.empty(); });
+      if (shutdown_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    job->check();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      finishedJobs_.push_back(std::move(job));
+    }
+    wakeup();
+  }
+#endif // HAVE_STD_THREAD
+}
+
+} // namespace aria2
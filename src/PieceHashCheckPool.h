@@ -0,0 +1,152 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2019 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_PIECE_HASH_CHECK_POOL_H
+#define D_PIECE_HASH_CHECK_POOL_H
+
+#include "common.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#ifdef HAVE_STD_THREAD
+#  include <thread>
+#  include <mutex>
+#  include <condition_variable>
+#endif // HAVE_STD_THREAD
+
+#include "a2netcompat.h"
+
+namespace aria2 {
+
+class DownloadEngine;
+class SocketCore;
+
+// A unit of work for PieceHashCheckPool.  The worker thread computes
+// the hash of data using hashType and compares it against
+// expectedDigest.  The result is stored in matched and then
+// onHashChecked() is called in the thread which runs DownloadEngine.
+// Worker threads only touch hashType, expectedDigest, data and
+// matched, so the subclass can safely keep references to engine
+// objects.
+class PieceHashCheckJob {
+public:
+  PieceHashCheckJob(std::string hashType, std::string expectedDigest,
+                    std::vector<unsigned char> data);
+
+  virtual ~PieceHashCheckJob();
+
+  // Computes hash of data_ and updates matched_.  Called by worker
+  // thread.
+  void check();
+
+  // Called in the engine thread after check() is done.
+  virtual void onHashChecked(DownloadEngine* e) = 0;
+
+  bool isMatched() const { return matched_; }
+
+  const std::string& getHashType() const { return hashType_; }
+
+  const std::string& getExpectedDigest() const { return expectedDigest_; }
+
+  // Returns the digest computed by check().
+  const std::string& getActualDigest() const { return actualDigest_; }
+
+  size_t getDataLength() const { return data_.size(); }
+
+private:
+  std::string hashType_;
+  std::string expectedDigest_;
+  std::vector<unsigned char> data_;
+  std::string actualDigest_;
+  bool matched_;
+};
+
+// Thread pool which computes piece hashes off the event loop.  Jobs
+// are added by submit() and finished jobs are retrieved by
+// popFinishedJobs(), both from the engine thread.  When a job is
+// finished, worker writes a byte to the wakeup socket so that
+// DownloadEngine returns from EventPoll::poll() immediately.
+class PieceHashCheckPool {
+public:
+  PieceHashCheckPool(size_t numThreads);
+
+  ~PieceHashCheckPool();
+
+  // Creates the wakeup socket and starts worker threads.  Returns
+  // true if successful.
+  bool init();
+
+  void submit(std::unique_ptr<PieceHashCheckJob> job);
+
+  std::vector<std::unique_ptr<PieceHashCheckJob>> popFinishedJobs();
+
+  // Returns the number of jobs submitted but not popped yet.
+  size_t countOutstandingJob() const { return numOutstandingJob_; }
+
+  size_t getNumThreads() const { return numThreads_; }
+
+  // Returns the read end of the wakeup socket.  It may be null if
+  // the platform lacks socketpair().
+  const std::shared_ptr<SocketCore>& getWakeupSocket() const
+  {
+    return wakeupSocket_;
+  }
+
+  // Reads all pending bytes from the wakeup socket.
+  void drainWakeupSocket();
+
+private:
+  void workerLoop();
+
+  void wakeup();
+
+  size_t numThreads_;
+  size_t numOutstandingJob_;
+  std::shared_ptr<SocketCore> wakeupSocket_;
+  sock_t wakeupWriteFd_;
+  std::deque<std::unique_ptr<PieceHashCheckJob>> jobs_;
+  std::vector<std::unique_ptr<PieceHashCheckJob>> finishedJobs_;
+#ifdef HAVE_STD_THREAD
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+#endif // HAVE_STD_THREAD
+  bool shutdown_;
+};
+
+} // namespace aria2
+
+#endif // D_PIECE_HASH_CHECK_POOL_H
@@ -39,11 +39,17 @@
 
 #include "SimpleRandomizer.h"
 #include "bitfield.h"
+#include "array_fun.h"
+
+using namespace aria2::expr;
 
 namespace aria2 {
 
 PieceStatMan::PieceStatMan(size_t pieceNum, bool randomShuffle)
-    : order_(pieceNum), counts_(pieceNum)
+    : order_(pieceNum),
+      counts_(pieceNum),
+      positions_(pieceNum),
+      bucketStarts_(1)
 {
   for (size_t i = 0; i < pieceNum; ++i) {
     order_[i] = i;
@@ -53,45 +59,68 @@ PieceStatMan::PieceStatMan(size_t pieceNum, bool randomShuffle)
     std::shuffle(order_.begin(), order_.end(),
                  *SimpleRandomizer::getInstance());
   }
+  for (size_t i = 0; i < pieceNum; ++i) {
+    positions_[order_[i]] = i;
+  }
 }
 
 PieceStatMan::~PieceStatMan() = default;
 
-namespace {
-void inc(int& x)
+void PieceStatMan::swapPosition(size_t pos1, size_t pos2)
+{
+  std::swap(order_[pos1], order_[pos2]);
+  positions_[order_[pos1]] = pos1;
+  positions_[order_[pos2]] = pos2;
+}
+
+void PieceStatMan::inc(size_t index)
 {
-  if (x < std::numeric_limits<int>::max()) {
-    ++x;
+  int& count = counts_[index];
+  if (count == std::numeric_limits<int>::max()) {
+    return;
   }
+  if (static_cast<size_t>(count) + 1 == bucketStarts_.size()) {
+    bucketStarts_.push_back(order_.size());
+  }
+  // Swap the piece with the last piece of its bucket, and make it
+  // the first piece of the next bucket.
+  size_t& nextStart = bucketStarts_[count + 1];
+  swapPosition(positions_[index], nextStart - 1);
+  --nextStart;
+  ++count;
 }
-} // namespace
 
-namespace {
-void sub(int& x)
+void PieceStatMan::sub(size_t index)
 {
-  if (x > 0) {
-    --x;
+  int& count = counts_[index];
+  if (count == 0) {
+    return;
   }
+  // Swap the piece with the first piece of its bucket, and make it
+  // the last piece of the previous bucket.
+  size_t& start = bucketStarts_[count];
+  swapPosition(positions_[index], start);
+  ++start;
+  --count;
 }
-} // namespace
 
 void PieceStatMan::addPieceStats(const unsigned char* bitfield,
                                  size_t bitfieldLength)
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      inc(counts_[i]);
-    }
+  const size_t nbits = counts_.size();
+  for (size_t i = bitfield::nextSetBit(bitfield, nbits, 0); i < nbits;
+       i = bitfield::nextSetBit(bitfield, nbits, i + 1)) {
+    inc(i);
   }
 }
 
 void PieceStatMan::subtractPieceStats(const unsigned char* bitfield,
                                       size_t bitfieldLength)
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      sub(counts_[i]);
-    }
+  const size_t nbits = counts_.size();
+  for (size_t i = bitfield::nextSetBit(bitfield, nbits, 0); i < nbits;
+       i = bitfield::nextSetBit(bitfield, nbits, i + 1)) {
+    sub(i);
   }
 }
 
@@ -99,20 +128,19 @@ void PieceStatMan::updatePieceStats(const unsigned char* newBitfield,
                                     size_t newBitfieldLength,
                                     const unsigned char* oldBitfield)
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    bool inNew = bitfield::test(newBitfield, nbits, i);
-    bool inOld = bitfield::test(oldBitfield, nbits, i);
-    if (inNew) {
-      if (!inOld) {
-        inc(counts_[i]);
-      }
-    }
-    else if (inOld) {
-      sub(counts_[i]);
-    }
+  const size_t nbits = counts_.size();
+  auto added = array(newBitfield) & ~array(oldBitfield);
+  for (size_t i = bitfield::nextSetBit(added, nbits, 0); i < nbits;
+       i = bitfield::nextSetBit(added, nbits, i + 1)) {
+    inc(i);
+  }
+  auto removed = ~array(newBitfield) & array(oldBitfield);
+  for (size_t i = bitfield::nextSetBit(removed, nbits, 0); i < nbits;
+       i = bitfield::nextSetBit(removed, nbits, i + 1)) {
+    sub(i);
   }
 }
 
-void PieceStatMan::addPieceStats(size_t index) { inc(counts_[index]); }
+void PieceStatMan::addPieceStats(size_t index) { inc(index); }
 
 } // namespace aria2
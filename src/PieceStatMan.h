@@ -41,10 +41,25 @@
 
 namespace aria2 {
 
+// Keeps the number of peers which have each piece.  Pieces are kept
+// in order_ sorted by their counts, and bucketStarts_[c] is the
+// position in order_ of the first piece whose count is c or more, so
+// that a piece moves to the adjacent bucket in O(1) when its count
+// changes.  The order of pieces with the same count is random if
+// randomShuffle is true.
 class PieceStatMan {
 private:
   std::vector<size_t> order_;
   std::vector<int> counts_;
+  // The position of each piece in order_.
+  std::vector<size_t> positions_;
+  std::vector<size_t> bucketStarts_;
+
+  void swapPosition(size_t pos1, size_t pos2);
+
+  void inc(size_t index);
+
+  void sub(size_t index);
 
 public:
   PieceStatMan(size_t pieceNum, bool randomShuffle);
@@ -61,6 +76,7 @@ public:
                         size_t newBitfieldLength,
                         const unsigned char* oldBitfield);
 
+  // Returns piece indexes sorted by their counts in ascending order.
   const std::vector<size_t>& getOrder() const { return order_; }
 
   const std::vector<int>& getCounts() const { return counts_; }
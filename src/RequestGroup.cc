@@ -36,6 +36,7 @@
 
 #include <cassert>
 #include <algorithm>
+#include <limits>
 
 #include "PostDownloadHandler.h"
 #include "DownloadEngine.h"
@@ -140,8 +141,9 @@ RequestGroup::RequestGroup(const std::shared_ptr<GroupId>& gid,
       numStreamCommand_(0),
       numCommand_(0),
       fileNotFoundCount_(0),
-      maxDownloadSpeedLimit_(option->getAsInt(PREF_MAX_DOWNLOAD_LIMIT)),
-      maxUploadSpeedLimit_(option->getAsInt(PREF_MAX_UPLOAD_LIMIT)),
+      downloadBucket_(option->getAsInt(PREF_MAX_DOWNLOAD_LIMIT)),
+      uploadBucket_(option->getAsInt(PREF_MAX_UPLOAD_LIMIT)),
+      bandwidthWeight_(option->getAsInt(PREF_BANDWIDTH_WEIGHT)),
       resumeFailureCount_(0),
       haltReason_(RequestGroup::NONE),
       lastErrorCode_(error_code::UNDEFINED),
@@ -1276,16 +1278,55 @@ void RequestGroup::setTimeout(std::chrono::seconds timeout)
   timeout_ = std::move(timeout);
 }
 
-bool RequestGroup::doesDownloadSpeedExceed()
+void RequestGroup::refillBandwidth(const Timer& now)
 {
-  int spd = downloadContext_->getNetStat().calculateDownloadSpeed();
-  return maxDownloadSpeedLimit_ > 0 && maxDownloadSpeedLimit_ < spd;
+  downloadBucket_.refill(now);
+  uploadBucket_.refill(now);
 }
 
-bool RequestGroup::doesUploadSpeedExceed()
+int64_t RequestGroup::getDownloadDemand() const
 {
-  int spd = downloadContext_->getNetStat().calculateUploadSpeed();
-  return maxUploadSpeedLimit_ > 0 && maxUploadSpeedLimit_ < spd;
+  return std::max(static_cast<int64_t>(0),
+                  std::min(downloadBucket_.getTokens(),
+                           downloadBudget_.estimateDemand()));
+}
+
+int64_t RequestGroup::getUploadDemand() const
+{
+  return std::max(static_cast<int64_t>(0),
+                  std::min(uploadBucket_.getTokens(),
+                           uploadBudget_.estimateDemand()));
+}
+
+void RequestGroup::assignBandwidth(int64_t download, int64_t upload)
+{
+  downloadBudget_.assign(download);
+  uploadBudget_.assign(upload);
+}
+
+void RequestGroup::consumeDownloadBandwidth(size_t bytes)
+{
+  downloadBucket_.consume(bytes);
+  downloadBudget_.consume(bytes);
+}
+
+void RequestGroup::consumeUploadBandwidth(size_t bytes)
+{
+  uploadBucket_.consume(bytes);
+  uploadBudget_.consume(bytes);
+}
+
+size_t RequestGroup::getConnectionDownloadBudget() const
+{
+  auto remaining = downloadBudget_.getRemaining();
+  if (remaining <= 0) {
+    return 0;
+  }
+  auto share = std::max(static_cast<int64_t>(1),
+                        downloadBudget_.getAssigned() /
+                            std::max(numCommand_, 1));
+  return std::min(std::min(remaining, share),
+                  static_cast<int64_t>(std::numeric_limits<ssize_t>::max()));
 }
 
 void RequestGroup::saveControlFile() const
@@ -49,6 +49,7 @@
 #include "error_code.h"
 #include "MetadataInfo.h"
 #include "GroupId.h"
+#include "TokenBucket.h"
 
 namespace aria2 {
 
@@ -157,9 +158,19 @@ private:
 
   int fileNotFoundCount_;
 
-  int maxDownloadSpeedLimit_;
+  // Bandwidth limits of this download set by --max-download-limit and
+  // --max-upload-limit.
+  TokenBucket downloadBucket_;
 
-  int maxUploadSpeedLimit_;
+  TokenBucket uploadBucket_;
+
+  // Allowance for the current scheduling tick handed out by
+  // RequestGroupMan::scheduleBandwidth().
+  BandwidthBudget downloadBudget_;
+
+  BandwidthBudget uploadBudget_;
+
+  int bandwidthWeight_;
 
   int resumeFailureCount_;
 
@@ -426,23 +437,51 @@ public:
 
   const std::chrono::seconds& getTimeout() const { return timeout_; }
 
-  // Returns true if current download speed exceeds
-  // maxDownloadSpeedLimit_.  Always returns false if
-  // maxDownloadSpeedLimit_ == 0.  Otherwise returns false.
-  bool doesDownloadSpeedExceed();
+  // Returns true if the download budget of the current scheduling
+  // tick is used up.  Always returns false if neither this download
+  // nor overall download speed is limited.
+  bool doesDownloadSpeedExceed() const { return downloadBudget_.exhausted(); }
+
+  // Returns true if the upload budget of the current scheduling tick
+  // is used up.  Always returns false if neither this download nor
+  // overall upload speed is limited.
+  bool doesUploadSpeedExceed() const { return uploadBudget_.exhausted(); }
+
+  int getMaxDownloadSpeedLimit() const { return downloadBucket_.getRate(); }
+
+  void setMaxDownloadSpeedLimit(int speed) { downloadBucket_.setRate(speed); }
+
+  int getMaxUploadSpeedLimit() const { return uploadBucket_.getRate(); }
+
+  void setMaxUploadSpeedLimit(int speed) { uploadBucket_.setRate(speed); }
+
+  int getBandwidthWeight() const { return bandwidthWeight_; }
+
+  void setBandwidthWeight(int weight) { bandwidthWeight_ = weight; }
+
+  // Refills the per-download token buckets.
+  void refillBandwidth(const Timer& now);
+
+  // Returns the download bytes this download can use in the next
+  // scheduling tick, limited by its own token bucket.
+  int64_t getDownloadDemand() const;
 
-  // Returns true if current upload speed exceeds
-  // maxUploadSpeedLimit_. Always returns false if
-  // maxUploadSpeedLimit_ == 0. Otherwise returns false.
-  bool doesUploadSpeedExceed();
+  int64_t getUploadDemand() const;
 
-  int getMaxDownloadSpeedLimit() const { return maxDownloadSpeedLimit_; }
+  // Starts a new scheduling tick with the given allowances.
+  void assignBandwidth(int64_t download, int64_t upload);
 
-  void setMaxDownloadSpeedLimit(int speed) { maxDownloadSpeedLimit_ = speed; }
+  // Charges |bytes| received to the bucket and the budget.
+  void consumeDownloadBandwidth(size_t bytes);
 
-  int getMaxUploadSpeedLimit() const { return maxUploadSpeedLimit_; }
+  // Charges |bytes| sent to the bucket and the budget.
+  void consumeUploadBandwidth(size_t bytes);
 
-  void setMaxUploadSpeedLimit(int speed) { maxUploadSpeedLimit_ = speed; }
+  // Returns the number of bytes one connection of this download may
+  // read at once.  The tick budget is split evenly among the commands
+  // of this download, so that a single connection cannot use it up
+  // before the others get their turn.
+  size_t getConnectionDownloadBudget() const;
 
   void setLastErrorCode(error_code::Value code, const char* message = "")
   {
@@ -113,10 +113,10 @@ RequestGroupMan::RequestGroupMan(
       numActive_(0),
       option_(option),
       serverStatMan_(std::make_shared<ServerStatMan>()),
-      maxOverallDownloadSpeedLimit_(
-          option->getAsInt(PREF_MAX_OVERALL_DOWNLOAD_LIMIT)),
-      maxOverallUploadSpeedLimit_(
-          option->getAsInt(PREF_MAX_OVERALL_UPLOAD_LIMIT)),
+      downloadBucket_(option->getAsInt(PREF_MAX_OVERALL_DOWNLOAD_LIMIT)),
+      uploadBucket_(option->getAsInt(PREF_MAX_OVERALL_UPLOAD_LIMIT)),
+      lastBandwidthSchedule_(Timer::zero()),
+      bandwidthLimited_(false),
       keepRunning_(option->getAsBool(PREF_ENABLE_RPC)),
       queueCheck_(true),
       removedErrorResult_(0),
@@ -983,16 +983,57 @@ void RequestGroupMan::removeStaleServerStat(const std::chrono::seconds& timeout)
   serverStatMan_->removeStaleServerStat(timeout);
 }
 
-bool RequestGroupMan::doesOverallDownloadSpeedExceed()
+void RequestGroupMan::scheduleBandwidth(const Timer& now)
 {
-  return maxOverallDownloadSpeedLimit_ > 0 &&
-         maxOverallDownloadSpeedLimit_ < netStat_.calculateDownloadSpeed();
+  if (lastBandwidthSchedule_.difference(now) + A2_DELTA_MILLIS <
+      BANDWIDTH_SCHEDULE_INTERVAL) {
+    return;
+  }
+  lastBandwidthSchedule_ = now;
+  downloadBucket_.refill(now);
+  uploadBucket_.refill(now);
+  bandwidthLimited_ = downloadBucket_.isLimited() || uploadBucket_.isLimited();
+  std::vector<TokenClaim> downloadClaims, uploadClaims;
+  downloadClaims.reserve(requestGroups_.size());
+  uploadClaims.reserve(requestGroups_.size());
+  for (auto& rg : requestGroups_) {
+    rg->refillBandwidth(now);
+    bandwidthLimited_ = bandwidthLimited_ ||
+                        rg->getMaxDownloadSpeedLimit() > 0 ||
+                        rg->getMaxUploadSpeedLimit() > 0;
+    auto weight = std::max(1, rg->getBandwidthWeight());
+    downloadClaims.push_back(TokenClaim{rg->getDownloadDemand(), weight, 0});
+    uploadClaims.push_back(TokenClaim{rg->getUploadDemand(), weight, 0});
+  }
+  if (!bandwidthLimited_) {
+    for (auto& rg : requestGroups_) {
+      rg->assignBandwidth(TokenBucket::UNLIMITED, TokenBucket::UNLIMITED);
+    }
+    return;
+  }
+  shareTokens(downloadClaims, downloadBucket_.getTokens());
+  shareTokens(uploadClaims, uploadBucket_.getTokens());
+  size_t i = 0;
+  for (auto& rg : requestGroups_) {
+    rg->assignBandwidth(downloadClaims[i].grant, uploadClaims[i].grant);
+    ++i;
+  }
 }
 
-bool RequestGroupMan::doesOverallUploadSpeedExceed()
+bool RequestGroupMan::isBandwidthThrottled() const
 {
-  return maxOverallUploadSpeedLimit_ > 0 &&
-         maxOverallUploadSpeedLimit_ < netStat_.calculateUploadSpeed();
+  if (!bandwidthLimited_) {
+    return false;
+  }
+  if (doesOverallDownloadSpeedExceed() || doesOverallUploadSpeedExceed()) {
+    return true;
+  }
+  for (auto& rg : requestGroups_) {
+    if (rg->doesDownloadSpeedExceed() || rg->doesUploadSpeedExceed()) {
+      return true;
+    }
+  }
+  return false;
 }
 
 void RequestGroupMan::getUsedHosts(
@@ -1090,9 +1131,9 @@ int RequestGroupMan::optimizeConcurrentDownloads()
   }
 
   // apply the rule
-  if ((maxOverallDownloadSpeedLimit_ > 0) &&
-      (optimizationSpeed_ > maxOverallDownloadSpeedLimit_)) {
-    optimizationSpeed_ = maxOverallDownloadSpeedLimit_;
+  if ((downloadBucket_.getRate() > 0) &&
+      (optimizationSpeed_ > downloadBucket_.getRate())) {
+    optimizationSpeed_ = downloadBucket_.getRate();
   }
   int maxConcurrentDownloads =
       ceil(optimizeConcurrentDownloadsCoeffA_ +
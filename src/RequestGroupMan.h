@@ -95,9 +95,17 @@ private:
 
   std::shared_ptr<ServerStatMan> serverStatMan_;
 
-  int maxOverallDownloadSpeedLimit_;
+  // Overall bandwidth limits set by --max-overall-download-limit and
+  // --max-overall-upload-limit.
+  TokenBucket downloadBucket_;
 
-  int maxOverallUploadSpeedLimit_;
+  TokenBucket uploadBucket_;
+
+  Timer lastBandwidthSchedule_;
+
+  // true if any overall or per-download limit was in effect at the
+  // last scheduling.
+  bool bandwidthLimited_;
 
   NetStat netStat_;
 
@@ -286,36 +294,56 @@ public:
 
   void removeStaleServerStat(const std::chrono::seconds& timeout);
 
-  // Returns true if current download speed exceeds
-  // maxOverallDownloadSpeedLimit_.  Always returns false if
-  // maxOverallDownloadSpeedLimit_ == 0.  Otherwise returns false.
-  bool doesOverallDownloadSpeedExceed();
+  // Returns true if the overall download token bucket is empty.
+  // Always returns false if overall download speed is not limited.
+  bool doesOverallDownloadSpeedExceed() const
+  {
+    return downloadBucket_.getTokens() <= 0;
+  }
 
   void setMaxOverallDownloadSpeedLimit(int speed)
   {
-    maxOverallDownloadSpeedLimit_ = speed;
+    downloadBucket_.setRate(speed);
   }
 
   int getMaxOverallDownloadSpeedLimit() const
   {
-    return maxOverallDownloadSpeedLimit_;
+    return downloadBucket_.getRate();
   }
 
-  // Returns true if current upload speed exceeds
-  // maxOverallUploadSpeedLimit_. Always returns false if
-  // maxOverallUploadSpeedLimit_ == 0. Otherwise returns false.
-  bool doesOverallUploadSpeedExceed();
-
-  void setMaxOverallUploadSpeedLimit(int speed)
+  // Returns true if the overall upload token bucket is empty.  Always
+  // returns false if overall upload speed is not limited.
+  bool doesOverallUploadSpeedExceed() const
   {
-    maxOverallUploadSpeedLimit_ = speed;
+    return uploadBucket_.getTokens() <= 0;
   }
 
-  int getMaxOverallUploadSpeedLimit() const
+  void setMaxOverallUploadSpeedLimit(int speed) { uploadBucket_.setRate(speed); }
+
+  int getMaxOverallUploadSpeedLimit() const { return uploadBucket_.getRate(); }
+
+  // Charges |bytes| received to the overall download bucket.
+  void consumeDownloadBandwidth(size_t bytes)
   {
-    return maxOverallUploadSpeedLimit_;
+    downloadBucket_.consume(bytes);
   }
 
+  // Charges |bytes| sent to the overall upload bucket.
+  void consumeUploadBandwidth(size_t bytes) { uploadBucket_.consume(bytes); }
+
+  // Refills the token buckets and hands out the download and upload
+  // budget of the next tick to each active RequestGroup.  The overall
+  // tokens are shared among RequestGroups in proportion to their
+  // --bandwidth-weight, and no RequestGroup gets more than its own
+  // bucket holds.  Does nothing if BANDWIDTH_SCHEDULE_INTERVAL has not
+  // elapsed since the last scheduling.
+  void scheduleBandwidth(const Timer& now);
+
+  // Returns true if a RequestGroup has used up its budget, or overall
+  // tokens have run out, so that commands are waiting for the next
+  // scheduling.
+  bool isBandwidthThrottled() const;
+
   void setMaxConcurrentDownloads(int max) { maxConcurrentDownloads_ = max; }
 
   // Call this function if requestGroups_ queue should be maintained.
@@ -101,6 +101,8 @@ public:
 
   const std::shared_ptr<Piece>& getPiece() const { return piece_; }
 
+  const Timer& getDispatchedTime() const { return dispatchedTime_; }
+
   // For unit test
   void setDispatchedTime(Timer t) { dispatchedTime_ = std::move(t); }
 
@@ -119,6 +121,31 @@ private:
   std::shared_ptr<Piece> piece_;
 };
 
+// Identifies a request on the wire, that is, the triple (index, begin,
+// length) which is carried by request, piece and cancel messages.
+struct RequestSlotKey {
+  size_t index;
+  int32_t begin;
+  int32_t length;
+
+  bool operator==(const RequestSlotKey& key) const
+  {
+    return index == key.index && begin == key.begin && length == key.length;
+  }
+};
+
+struct RequestSlotKeyHash {
+  size_t operator()(const RequestSlotKey& key) const
+  {
+    // Blocks are at most 16KiB and aligned, so begin carries little
+    // entropy in its low bits.  Mix all three fields.
+    size_t h = key.index;
+    h = h * 1000003 ^ static_cast<uint32_t>(key.begin);
+    h = h * 1000003 ^ static_cast<uint32_t>(key.length);
+    return h;
+  }
+};
+
 } // namespace aria2
 
 #endif // D_REQUEST_SLOT_H
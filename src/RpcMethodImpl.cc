@@ -76,7 +76,13 @@
 #  include "Peer.h"
 #  include "BtRuntime.h"
 #  include "BtAnnounce.h"
+#  include "DHTRegistry.h"
+#  include "DHTPeerAnnounceStorage.h"
 #endif // ENABLE_BITTORRENT
+#ifdef ENABLE_SSL
+#  include "SocketCore.h"
+#  include "TLSSessionCache.h"
+#endif // ENABLE_SSL
 #include "CheckIntegrityEntry.h"
 
 namespace aria2 {
@@ -119,6 +125,7 @@ const char KEY_PORT[] = "port";
 const char KEY_AM_CHOKING[] = "amChoking";
 const char KEY_PEER_CHOKING[] = "peerChoking";
 const char KEY_SEEDER[] = "seeder";
+const char KEY_REQUEST_QUEUE_DEPTH[] = "requestQueueDepth";
 const char KEY_INDEX[] = "index";
 const char KEY_PATH[] = "path";
 const char KEY_SELECTED[] = "selected";
@@ -145,6 +152,14 @@ const char KEY_NUM_WAITING[] = "numWaiting";
 const char KEY_NUM_STOPPED[] = "numStopped";
 const char KEY_NUM_ACTIVE[] = "numActive";
 const char KEY_NUM_STOPPED_TOTAL[] = "numStoppedTotal";
+const char KEY_DNS_CACHE_HITS[] = "dnsCacheHits";
+const char KEY_DNS_CACHE_MISSES[] = "dnsCacheMisses";
+const char KEY_TLS_SESSION_CACHE_HITS[] = "tlsSessionCacheHits";
+const char KEY_TLS_SESSION_CACHE_MISSES[] = "tlsSessionCacheMisses";
+const char KEY_DHT_ANNOUNCED_INFO_HASHES[] = "dhtAnnouncedInfoHashes";
+const char KEY_DHT_ANNOUNCED_PEERS[] = "dhtAnnouncedPeers";
+const char KEY_DHT_ANNOUNCE_STORAGE_SIZE[] = "dhtAnnounceStorageSize";
+const char KEY_DHT_ANNOUNCE_EVICTED[] = "dhtAnnounceEvicted";
 const char KEY_VERIFIED_LENGTH[] = "verifiedLength";
 const char KEY_VERIFY_PENDING[] = "verifyIntegrityPending";
 } // namespace
@@ -778,6 +793,8 @@ void gatherPeer(List* peers, const std::shared_ptr<PeerStorage>& ps)
                    util::itos(peer->calculateDownloadSpeed()));
     peerEntry->put(KEY_UPLOAD_SPEED, util::itos(peer->calculateUploadSpeed()));
     peerEntry->put(KEY_SEEDER, peer->isSeeder() ? VLB_TRUE : VLB_FALSE);
+    peerEntry->put(KEY_REQUEST_QUEUE_DEPTH,
+                   util::uitos(peer->getRequestQueueDepth()));
     peers->append(std::move(peerEntry));
   }
 }
@@ -798,14 +815,12 @@ void gatherProgress(Dict* entryDict, const std::shared_ptr<RequestGroup>& group,
   }
 #endif // ENABLE_BITTORRENT
   if (e->getCheckIntegrityMan()) {
-    if (e->getCheckIntegrityMan()->isPicked(
-            [&group](const CheckIntegrityEntry& ent) {
-              return ent.getRequestGroup() == group.get();
-            })) {
-      entryDict->put(
-          KEY_VERIFIED_LENGTH,
-          util::itos(
-              e->getCheckIntegrityMan()->getPickedEntry()->getCurrentLength()));
+    for (auto& ent : e->getCheckIntegrityMan()->getPickedEntries()) {
+      if (ent->getRequestGroup() == group.get()) {
+        entryDict->put(KEY_VERIFIED_LENGTH,
+                       util::itos(ent->getCurrentLength()));
+        break;
+      }
     }
     if (e->getCheckIntegrityMan()->isQueued(
             [&group](const CheckIntegrityEntry& ent) {
@@ -1390,6 +1405,37 @@ GetGlobalStatRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
   res->put(KEY_NUM_STOPPED, util::uitos(rgman->getDownloadResults().size()));
   res->put(KEY_NUM_STOPPED_TOTAL, util::uitos(rgman->getNumStoppedTotal()));
   res->put(KEY_NUM_ACTIVE, util::uitos(rgman->getRequestGroups().size()));
+  res->put(KEY_DNS_CACHE_HITS, util::uitos(e->getDNSCache()->getHits()));
+  res->put(KEY_DNS_CACHE_MISSES, util::uitos(e->getDNSCache()->getMisses()));
+#ifdef ENABLE_SSL
+  auto& tlsSessionCache = SocketCore::getTLSSessionCache();
+  if (tlsSessionCache) {
+    res->put(KEY_TLS_SESSION_CACHE_HITS,
+             util::uitos(tlsSessionCache->getHits()));
+    res->put(KEY_TLS_SESSION_CACHE_MISSES,
+             util::uitos(tlsSessionCache->getMisses()));
+  }
+#endif // ENABLE_SSL
+#ifdef ENABLE_BITTORRENT
+  if (DHTRegistry::isInitialized() || DHTRegistry::isInitialized6()) {
+    size_t numInfoHash = 0, numPeer = 0, size = 0;
+    uint64_t numEvicted = 0;
+    for (auto data : {&DHTRegistry::getData(), &DHTRegistry::getData6()}) {
+      if (!data->initialized) {
+        continue;
+      }
+      auto& storage = data->peerAnnounceStorage;
+      numInfoHash += storage->countEntry();
+      numPeer += storage->countPeerAddrEntry();
+      size += storage->getMemoryUsage();
+      numEvicted += storage->getNumEvicted();
+    }
+    res->put(KEY_DHT_ANNOUNCED_INFO_HASHES, util::uitos(numInfoHash));
+    res->put(KEY_DHT_ANNOUNCED_PEERS, util::uitos(numPeer));
+    res->put(KEY_DHT_ANNOUNCE_STORAGE_SIZE, util::uitos(size));
+    res->put(KEY_DHT_ANNOUNCE_EVICTED, util::uitos(numEvicted));
+  }
+#endif // ENABLE_BITTORRENT
   return std::move(res);
 }
 
@@ -1635,6 +1681,9 @@ void changeOption(const std::shared_ptr<RequestGroup>& group,
   if (option.defined(PREF_MAX_UPLOAD_LIMIT)) {
     group->setMaxUploadSpeedLimit(grOption->getAsInt(PREF_MAX_UPLOAD_LIMIT));
   }
+  if (option.defined(PREF_BANDWIDTH_WEIGHT)) {
+    group->setBandwidthWeight(grOption->getAsInt(PREF_BANDWIDTH_WEIGHT));
+  }
 #ifdef ENABLE_BITTORRENT
   auto btObject = e->getBtRegistry()->get(group->getGID());
   if (btObject) {
@@ -38,31 +38,70 @@
 #include "common.h"
 
 #include <deque>
+#include <vector>
+#include <algorithm>
 #include <memory>
 #include <functional>
 
 namespace aria2 {
 
+// Picks entries in the order they were pushed.  At most
+// maxPickedEntry entries can be picked at the same time.
 template <typename T> class SequentialPicker {
 private:
   std::deque<std::unique_ptr<T>> entries_;
-  std::unique_ptr<T> pickedEntry_;
+  std::vector<std::unique_ptr<T>> pickedEntries_;
+  size_t maxPickedEntry_;
 
 public:
-  bool isPicked() const { return pickedEntry_.get(); }
+  SequentialPicker(size_t maxPickedEntry = 1)
+      : maxPickedEntry_(std::max(static_cast<size_t>(1), maxPickedEntry))
+  {
+  }
+
+  bool isPicked() const { return !pickedEntries_.empty(); }
 
-  const std::unique_ptr<T>& getPickedEntry() const { return pickedEntry_; }
+  // Returns true if no more entry can be picked until one of the
+  // picked entries is dropped.
+  bool isPickedFull() const
+  {
+    return pickedEntries_.size() >= maxPickedEntry_;
+  }
 
-  void dropPickedEntry() { pickedEntry_.reset(); }
+  // Returns the entry picked first among currently picked ones, or
+  // nullptr if nothing is picked.
+  T* getPickedEntry() const
+  {
+    if (pickedEntries_.empty()) {
+      return nullptr;
+    }
+    return pickedEntries_.front().get();
+  }
+
+  const std::vector<std::unique_ptr<T>>& getPickedEntries() const
+  {
+    return pickedEntries_;
+  }
+
+  void dropPickedEntry(const T* entry)
+  {
+    for (auto i = std::begin(pickedEntries_), eoi = std::end(pickedEntries_);
+         i != eoi; ++i) {
+      if ((*i).get() == entry) {
+        pickedEntries_.erase(i);
+        return;
+      }
+    }
+  }
 
   bool hasNext() const { return !entries_.empty(); }
 
   T* pickNext()
   {
     if (hasNext()) {
-      pickedEntry_ = std::move(entries_.front());
+      pickedEntries_.push_back(std::move(entries_.front()));
       entries_.pop_front();
-      return pickedEntry_.get();
+      return pickedEntries_.back().get();
     }
     return nullptr;
   }
@@ -76,7 +115,12 @@ public:
 
   bool isPicked(const std::function<bool(const T&)>& pred) const
   {
-    return pickedEntry_ && pred(*pickedEntry_);
+    for (auto& e : pickedEntries_) {
+      if (pred(*e)) {
+        return true;
+      }
+    }
+    return false;
   }
 
   bool isQueued(const std::function<bool(const T&)>& pred) const
@@ -36,8 +36,10 @@
 
 #include <cassert>
 #include <algorithm>
+#include <array>
 
 #include "SocketCore.h"
+#include "DiskAdaptor.h"
 #include "DlAbortEx.h"
 #include "message.h"
 #include "fmt.h"
@@ -102,6 +104,86 @@ const unsigned char* SocketBuffer::StringBufEntry::getData() const
   return reinterpret_cast<const unsigned char*>(str_.c_str());
 }
 
+SocketBuffer::BlockBufferBufEntry::BlockBufferBufEntry(
+    BlockBuffer buf, size_t length,
+    std::unique_ptr<ProgressUpdate> progressUpdate)
+    : BufEntry(std::move(progressUpdate)), buf_(std::move(buf)), length_(length)
+{
+}
+
+ssize_t SocketBuffer::BlockBufferBufEntry::send(
+    const std::shared_ptr<SocketCore>& socket, size_t offset)
+{
+  return socket->writeData(buf_.get() + offset, length_ - offset);
+}
+
+bool SocketBuffer::BlockBufferBufEntry::final(size_t offset) const
+{
+  return length_ <= offset;
+}
+
+size_t SocketBuffer::BlockBufferBufEntry::getLength() const
+{
+  return length_;
+}
+
+const unsigned char* SocketBuffer::BlockBufferBufEntry::getData() const
+{
+  return buf_.get();
+}
+
+SocketBuffer::FileRangeBufEntry::FileRangeBufEntry(
+    std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset, size_t length,
+    std::unique_ptr<ProgressUpdate> progressUpdate)
+    : BufEntry(std::move(progressUpdate)),
+      diskAdaptor_(std::move(diskAdaptor)),
+      offset_(offset),
+      length_(length)
+{
+}
+
+ssize_t
+SocketBuffer::FileRangeBufEntry::send(const std::shared_ptr<SocketCore>& socket,
+                                      size_t offset)
+{
+  size_t len = length_ - offset;
+#ifdef HAVE_SENDFILE
+  int fd;
+  int64_t fileOffset;
+  size_t flen =
+      diskAdaptor_->getFileRange(fd, fileOffset, len, offset_ + offset);
+  if (flen > 0) {
+    ssize_t r = socket->sendFile(fd, fileOffset, flen);
+    if (r == 0 && !socket->wantWrite()) {
+      // File is shorter than expected.
+      throw DL_ABORT_EX(EX_DATA_READ);
+    }
+    return r;
+  }
+#endif // HAVE_SENDFILE
+  // File descriptor is not available.  Read data into buffer, and
+  // send it.  The data not sent will be read again in the next call.
+  std::array<unsigned char, 16_k> buf;
+  len = std::min(len, buf.size());
+  ssize_t r = diskAdaptor_->readData(buf.data(), len, offset_ + offset);
+  if (r != static_cast<ssize_t>(len)) {
+    throw DL_ABORT_EX(EX_DATA_READ);
+  }
+  return socket->writeData(buf.data(), len);
+}
+
+bool SocketBuffer::FileRangeBufEntry::final(size_t offset) const
+{
+  return length_ <= offset;
+}
+
+size_t SocketBuffer::FileRangeBufEntry::getLength() const { return length_; }
+
+const unsigned char* SocketBuffer::FileRangeBufEntry::getData() const
+{
+  return nullptr;
+}
+
 SocketBuffer::SocketBuffer(std::shared_ptr<SocketCore> socket)
     : socket_(std::move(socket)), offset_(0)
 {
@@ -127,11 +209,52 @@ void SocketBuffer::pushStr(std::string data,
   }
 }
 
+void SocketBuffer::pushBlockBuffer(
+    BlockBuffer buf, size_t length,
+    std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  if (length > 0) {
+    bufq_.push_back(make_unique<BlockBufferBufEntry>(
+        std::move(buf), length, std::move(progressUpdate)));
+  }
+}
+
+void SocketBuffer::pushFileRange(std::shared_ptr<DiskAdaptor> diskAdaptor,
+                                 int64_t offset, size_t length,
+                                 std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  if (length > 0) {
+    bufq_.push_back(make_unique<FileRangeBufEntry>(
+        std::move(diskAdaptor), offset, length, std::move(progressUpdate)));
+  }
+}
+
 ssize_t SocketBuffer::send()
 {
   a2iovec iov[A2_IOV_MAX];
   size_t totalslen = 0;
   while (!bufq_.empty()) {
+    if (!bufq_.front()->getData()) {
+      // Data is not in memory.  Let the entry send it by itself.
+      ssize_t firstlen = bufq_.front()->getLength() - offset_;
+      ssize_t slen = bufq_.front()->send(socket_, offset_);
+      if (slen == 0 && !socket_->wantRead() && !socket_->wantWrite()) {
+        throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, "Connection closed."));
+      }
+      totalslen += slen;
+      if (firstlen > slen) {
+        offset_ += slen;
+        bufq_.front()->progressUpdate(slen, false);
+        if (socket_->wantRead() || socket_->wantWrite()) {
+          goto fin;
+        }
+        continue;
+      }
+      bufq_.front()->progressUpdate(firstlen, true);
+      bufq_.pop_front();
+      offset_ = 0;
+      continue;
+    }
     size_t num;
     size_t bufqlen = bufq_.size();
     ssize_t amount = 24_k;
@@ -147,7 +270,7 @@ ssize_t SocketBuffer::send()
 
       ssize_t len = (*i)->getLength();
 
-      if (amount < len) {
+      if (amount < len || !(*i)->getData()) {
         break;
       }
 
@@ -42,9 +42,12 @@
 #include <memory>
 #include <vector>
 
+#include "BlockBufferPool.h"
+
 namespace aria2 {
 
 class SocketCore;
+class DiskAdaptor;
 
 struct ProgressUpdate {
   virtual ~ProgressUpdate() = default;
@@ -105,6 +108,42 @@ private:
     std::string str_;
   };
 
+  class BlockBufferBufEntry : public BufEntry {
+  public:
+    BlockBufferBufEntry(BlockBuffer buf, size_t length,
+                        std::unique_ptr<ProgressUpdate> progressUpdate);
+    virtual ssize_t send(const std::shared_ptr<SocketCore>& socket,
+                         size_t offset) CXX11_OVERRIDE;
+    virtual bool final(size_t offset) const CXX11_OVERRIDE;
+    virtual size_t getLength() const CXX11_OVERRIDE;
+    virtual const unsigned char* getData() const CXX11_OVERRIDE;
+
+  private:
+    BlockBuffer buf_;
+    size_t length_;
+  };
+
+  // Buffer entry which refers to the data stored in DiskAdaptor.  The
+  // data is sent directly from file using sendfile(2) if available.
+  // getData() returns nullptr, and the entry is never gathered into
+  // iovec with other entries.
+  class FileRangeBufEntry : public BufEntry {
+  public:
+    FileRangeBufEntry(std::shared_ptr<DiskAdaptor> diskAdaptor,
+                      int64_t offset, size_t length,
+                      std::unique_ptr<ProgressUpdate> progressUpdate);
+    virtual ssize_t send(const std::shared_ptr<SocketCore>& socket,
+                         size_t offset) CXX11_OVERRIDE;
+    virtual bool final(size_t offset) const CXX11_OVERRIDE;
+    virtual size_t getLength() const CXX11_OVERRIDE;
+    virtual const unsigned char* getData() const CXX11_OVERRIDE;
+
+  private:
+    std::shared_ptr<DiskAdaptor> diskAdaptor_;
+    int64_t offset_;
+    size_t length_;
+  };
+
   std::shared_ptr<SocketCore> socket_;
 
   std::deque<std::unique_ptr<BufEntry>> bufq_;
@@ -137,6 +176,24 @@ public:
   void pushStr(std::string data,
                std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
 
+  // Feeds first length bytes of buf into queue. This function
+  // doesn't send data.  buf is returned to its pool after it is sent.
+  // If progressUpdate is not null, its update() function will be
+  // called each time the data is sent. It will be deleted by this
+  // object. It can be null.
+  void
+  pushBlockBuffer(BlockBuffer buf, size_t length,
+                  std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
+
+  // Feeds length bytes of data in diskAdaptor starting at offset into
+  // queue.  The data is not read until it is sent.  If
+  // progressUpdate is not null, its update() function will be called
+  // each time the data is sent. It will be deleted by this object. It
+  // can be null.
+  void pushFileRange(std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset,
+                     size_t length,
+                     std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
+
   // Sends data in queue.  Returns the number of bytes sent.
   ssize_t send();
 
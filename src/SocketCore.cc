@@ -39,6 +39,9 @@
 #endif // HAVE_IPHLPAPI_H
 
 #include <unistd.h>
+#ifdef HAVE_SENDFILE
+#  include <sys/sendfile.h>
+#endif // HAVE_SENDFILE
 #ifdef HAVE_IFADDRS_H
 #  include <ifaddrs.h>
 #endif // HAVE_IFADDRS_H
@@ -61,6 +64,7 @@
 #ifdef ENABLE_SSL
 #  include "TLSContext.h"
 #  include "TLSSession.h"
+#  include "TLSSessionCache.h"
 #endif // ENABLE_SSL
 #ifdef HAVE_LIBSSH2
 #  include "SSHSession.h"
@@ -139,6 +143,7 @@ int SocketCore::socketRecvBufferSize_ = 0;
 #ifdef ENABLE_SSL
 std::shared_ptr<TLSContext> SocketCore::clTlsContext_;
 std::shared_ptr<TLSContext> SocketCore::svTlsContext_;
+std::shared_ptr<TLSSessionCache> SocketCore::tlsSessionCache_;
 
 void SocketCore::setClientTLSContext(
     const std::shared_ptr<TLSContext>& tlsContext)
@@ -151,6 +156,17 @@ void SocketCore::setServerTLSContext(
 {
   svTlsContext_ = tlsContext;
 }
+
+void SocketCore::setTLSSessionCache(
+    const std::shared_ptr<TLSSessionCache>& tlsSessionCache)
+{
+  tlsSessionCache_ = tlsSessionCache;
+}
+
+const std::shared_ptr<TLSSessionCache>& SocketCore::getTLSSessionCache()
+{
+  return tlsSessionCache_;
+}
 #endif // ENABLE_SSL
 
 SocketCore::SocketCore(int sockType) : sockType_(sockType), sockfd_(-1)
@@ -171,6 +187,11 @@ void SocketCore::init()
 
   wantRead_ = false;
   wantWrite_ = false;
+
+#ifdef ENABLE_SSL
+  tlsSessionPort_ = 0;
+  tlsSingleUseSession_ = false;
+#endif // ENABLE_SSL
 }
 
 SocketCore::~SocketCore() { closeConnection(); }
@@ -838,6 +859,30 @@ ssize_t SocketCore::writeData(const void* data, size_t len)
   return ret;
 }
 
+#ifdef HAVE_SENDFILE
+ssize_t SocketCore::sendFile(int fd, int64_t offset, size_t len)
+{
+  assert(!secure_);
+  ssize_t ret = 0;
+  wantRead_ = false;
+  wantWrite_ = false;
+
+  off_t off = offset;
+  while ((ret = sendfile(sockfd_, fd, &off, len)) == -1 &&
+         SOCKET_ERRNO == A2_EINTR)
+    ;
+  int errNum = SOCKET_ERRNO;
+  if (ret == -1) {
+    if (!A2_WOULDBLOCK(errNum)) {
+      throw DL_RETRY_EX(fmt(EX_SOCKET_SEND, errorMsg(errNum).c_str()));
+    }
+    wantWrite_ = true;
+    ret = 0;
+  }
+  return ret;
+}
+#endif // HAVE_SENDFILE
+
 void SocketCore::readData(void* data, size_t& len)
 {
   ssize_t ret = 0;
@@ -893,6 +938,10 @@ void SocketCore::readData(void* data, size_t& len)
       }
       ret = 0;
     }
+    // TLS 1.3 session ticket arrives after handshake.
+    if (!tlsSessionHostname_.empty()) {
+      storeTLSSession();
+    }
 #endif // ENABLE_SSL
   }
 
@@ -906,12 +955,37 @@ bool SocketCore::tlsAccept()
   return tlsHandshake(svTlsContext_.get(), A2STR::NIL);
 }
 
-bool SocketCore::tlsConnect(const std::string& hostname)
+bool SocketCore::tlsConnect(const std::string& hostname, uint16_t port,
+                            const std::string& alpnProtos)
+{
+  if (secure_ == A2_TLS_NONE && tlsSessionCache_ && !hostname.empty()) {
+    tlsSessionHostname_ = hostname;
+    tlsSessionPort_ = port;
+  }
+  return tlsHandshake(clTlsContext_.get(), hostname, alpnProtos);
+}
+
+void SocketCore::storeTLSSession()
+{
+  auto data = tlsSession_->getSessionData();
+  if (data.empty()) {
+    return;
+  }
+  tlsSessionCache_->put(tlsSessionHostname_, tlsSessionPort_, data,
+                        tlsSingleUseSession_);
+  tlsSessionHostname_.clear();
+}
+
+std::string SocketCore::getTLSAlpnProtocol() const
 {
-  return tlsHandshake(clTlsContext_.get(), hostname);
+  if (secure_ != A2_TLS_CONNECTED) {
+    return "";
+  }
+  return tlsSession_->getAlpnProtocol();
 }
 
-bool SocketCore::tlsHandshake(TLSContext* tlsctx, const std::string& hostname)
+bool SocketCore::tlsHandshake(TLSContext* tlsctx, const std::string& hostname,
+                              const std::string& alpnProtos)
 {
   wantRead_ = false;
   wantWrite_ = false;
@@ -941,6 +1015,21 @@ bool SocketCore::tlsHandshake(TLSContext* tlsctx, const std::string& hostname)
                               tlsSession_->getLastErrorString().c_str()));
       }
     }
+    if (tlsctx->getSide() == TLS_CLIENT && !alpnProtos.empty()) {
+      rv = tlsSession_->setAlpnProtocols(alpnProtos);
+      if (rv != TLS_ERR_OK) {
+        throw DL_ABORT_EX(fmt(EX_SSL_INIT_FAILURE,
+                              tlsSession_->getLastErrorString().c_str()));
+      }
+    }
+    if (tlsctx->getSide() == TLS_CLIENT && !tlsSessionHostname_.empty()) {
+      auto data = tlsSessionCache_->get(tlsSessionHostname_, tlsSessionPort_);
+      if (!data.empty() && tlsSession_->setSessionData(data) != TLS_ERR_OK) {
+        A2_LOG_DEBUG(fmt("Failed to set cached TLS session for %s: %s",
+                         tlsSessionHostname_.c_str(),
+                         tlsSession_->getLastErrorString().c_str()));
+      }
+    }
     // Done with the setup, now let handshaking begin immediately.
     secure_ = A2_TLS_HANDSHAKING;
     A2_LOG_DEBUG("TLS Handshaking");
@@ -990,6 +1079,22 @@ bool SocketCore::tlsHandshake(TLSContext* tlsctx, const std::string& hostname)
 
       auto peerInfo = ss.str();
 
+      if (!tlsSessionHostname_.empty()) {
+        auto resumed = tlsSession_->isSessionResumed();
+        tlsSessionCache_->countHandshake(resumed);
+        if (resumed) {
+          tlsVersion += ", session resumed";
+        }
+        tlsSingleUseSession_ = ver == TLS_PROTO_TLS13;
+        storeTLSSession();
+      }
+
+      if (tlsSession_->isKernelTLSSend() || tlsSession_->isKernelTLSRecv()) {
+        tlsVersion += fmt(", kernel TLS%s%s",
+                          tlsSession_->isKernelTLSSend() ? " send" : "",
+                          tlsSession_->isKernelTLSRecv() ? " recv" : "");
+      }
+
       A2_LOG_DEBUG(fmt("Securely connected to %s with %s", peerInfo.c_str(),
                        tlsVersion.c_str()));
 
@@ -1014,6 +1119,11 @@ bool SocketCore::tlsHandshake(TLSContext* tlsctx, const std::string& hostname)
     }
 
     if (rv == TLS_ERR_ERROR) {
+      if (!tlsSessionHostname_.empty()) {
+        // The server may have failed to resume the cached session.
+        // Make sure that the next attempt performs a full handshake.
+        tlsSessionCache_->remove(tlsSessionHostname_, tlsSessionPort_);
+      }
       // Damn those error.
       throw DL_ABORT_EX(fmt("SSL/TLS handshake failure: %s",
                             handshakeError.empty()
@@ -1225,6 +1335,100 @@ ssize_t SocketCore::writeData(const void* data, size_t len,
   return r;
 }
 
+namespace {
+// Stores the socket address of numeric host |endpoint| in |addr| and
+// returns its length.
+socklen_t getSockAddr(sockaddr_union& addr, const Endpoint& endpoint,
+                      int family, int sockType)
+{
+  struct addrinfo* res;
+  int s = callGetaddrinfo(&res, endpoint.addr.c_str(),
+                          util::uitos(endpoint.port).c_str(), family,
+                          sockType, AI_NUMERICHOST, 0);
+  if (s) {
+    throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, gai_strerror(s)));
+  }
+  std::unique_ptr<addrinfo, decltype(&freeaddrinfo)> resDeleter(res,
+                                                                freeaddrinfo);
+  memcpy(&addr, res->ai_addr, res->ai_addrlen);
+  return res->ai_addrlen;
+}
+} // namespace
+
+size_t SocketCore::writeDataBatch(const Datagram* dgrams, size_t n)
+{
+  wantRead_ = false;
+  wantWrite_ = false;
+
+  std::vector<sockaddr_union> addrs(n);
+  std::vector<socklen_t> addrlens(n);
+  for (size_t i = 0; i < n; ++i) {
+    try {
+      addrlens[i] = getSockAddr(addrs[i], dgrams[i].endpoint,
+                                protocolFamily_, sockType_);
+    }
+    catch (RecoverableException& e) {
+      if (i == 0) {
+        throw;
+      }
+      // Send the preceding datagrams now.  The error is reported by
+      // the next call.
+      n = i;
+      break;
+    }
+  }
+#ifdef HAVE_SENDMMSG
+  std::vector<mmsghdr> msgs(n);
+  std::vector<iovec> iovs(n);
+  memset(msgs.data(), 0, sizeof(mmsghdr) * n);
+  for (size_t i = 0; i < n; ++i) {
+    iovs[i].iov_base = const_cast<unsigned char*>(dgrams[i].buf.data());
+    iovs[i].iov_len = dgrams[i].len;
+    auto& hdr = msgs[i].msg_hdr;
+    hdr.msg_name = &addrs[i].sa;
+    hdr.msg_namelen = addrlens[i];
+    hdr.msg_iov = &iovs[i];
+    hdr.msg_iovlen = 1;
+  }
+  int r;
+  while ((r = sendmmsg(sockfd_, msgs.data(), n, 0)) == -1 &&
+         A2_EINTR == SOCKET_ERRNO)
+    ;
+  int errNum = SOCKET_ERRNO;
+  if (r == -1) {
+    if (!A2_WOULDBLOCK(errNum)) {
+      throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, errorMsg(errNum).c_str()));
+    }
+    wantWrite_ = true;
+    return 0;
+  }
+  return r;
+#else  // !HAVE_SENDMMSG
+  size_t i = 0;
+  for (; i < n; ++i) {
+    ssize_t r;
+    // Cast for Windows sendto()
+    while ((r = sendto(sockfd_,
+                       reinterpret_cast<const char*>(dgrams[i].buf.data()),
+                       dgrams[i].len, 0, &addrs[i].sa, addrlens[i])) == -1 &&
+           A2_EINTR == SOCKET_ERRNO)
+      ;
+    int errNum = SOCKET_ERRNO;
+    if (r == -1) {
+      if (A2_WOULDBLOCK(errNum)) {
+        wantWrite_ = true;
+        break;
+      }
+      if (i == 0) {
+        throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, errorMsg(errNum).c_str()));
+      }
+      break;
+    }
+  }
+  return i;
+#endif // !HAVE_SENDMMSG
+}
+
 ssize_t SocketCore::readDataFrom(void* data, size_t len, Endpoint& sender)
 {
   wantRead_ = false;
@@ -1252,6 +1456,63 @@ ssize_t SocketCore::readDataFrom(void* data, size_t len, Endpoint& sender)
   return r;
 }
 
+size_t SocketCore::readDataFromBatch(Datagram* dgrams, size_t n)
+{
+  wantRead_ = false;
+  wantWrite_ = false;
+#ifdef HAVE_RECVMMSG
+  std::vector<mmsghdr> msgs(n);
+  std::vector<iovec> iovs(n);
+  std::vector<sockaddr_union> addrs(n);
+  memset(msgs.data(), 0, sizeof(mmsghdr) * n);
+  for (size_t i = 0; i < n; ++i) {
+    iovs[i].iov_base = dgrams[i].buf.data();
+    iovs[i].iov_len = dgrams[i].buf.size();
+    auto& hdr = msgs[i].msg_hdr;
+    hdr.msg_name = &addrs[i].sa;
+    hdr.msg_namelen = sizeof(addrs[i]);
+    hdr.msg_iov = &iovs[i];
+    hdr.msg_iovlen = 1;
+  }
+  int r;
+  while ((r = recvmmsg(sockfd_, msgs.data(), n, 0, nullptr)) == -1 &&
+         A2_EINTR == SOCKET_ERRNO)
+    ;
+  int errNum = SOCKET_ERRNO;
+  if (r == -1) {
+    if (!A2_WOULDBLOCK(errNum)) {
+      throw DL_RETRY_EX(fmt(EX_SOCKET_RECV, errorMsg(errNum).c_str()));
+    }
+    wantRead_ = true;
+    return 0;
+  }
+  for (int i = 0; i < r; ++i) {
+    auto& hdr = msgs[i].msg_hdr;
+    dgrams[i].len = (hdr.msg_flags & MSG_TRUNC) ? 0 : msgs[i].msg_len;
+    dgrams[i].endpoint = util::getNumericNameInfo(&addrs[i].sa, hdr.msg_namelen);
+  }
+  return r;
+#else  // !HAVE_RECVMMSG
+  size_t i = 0;
+  for (; i < n; ++i) {
+    try {
+      dgrams[i].len = readDataFrom(dgrams[i].buf.data(), dgrams[i].buf.size(),
+                                   dgrams[i].endpoint);
+    }
+    catch (RecoverableException& e) {
+      if (i == 0) {
+        throw;
+      }
+      break;
+    }
+    if (wantRead_) {
+      break;
+    }
+  }
+  return i;
+#endif // !HAVE_RECVMMSG
+}
+
 std::string SocketCore::getSocketError() const
 {
   int error;
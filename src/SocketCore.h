@@ -47,12 +47,25 @@
 #include "a2io.h"
 #include "a2netcompat.h"
 #include "a2time.h"
+#include "A2STR.h"
 
 namespace aria2 {
 
+// Datagram read by SocketCore::readDataFromBatch() or written by
+// SocketCore::writeDataBatch().  buf is allocated by the caller.
+// When reading, len is set to the length of the datagram and
+// endpoint to its sender.  When writing, the first len bytes of buf
+// are sent to endpoint, whose addr must be a numeric host.
+struct Datagram {
+  std::vector<unsigned char> buf;
+  size_t len;
+  Endpoint endpoint;
+};
+
 #ifdef ENABLE_SSL
 class TLSContext;
 class TLSSession;
+class TLSSessionCache;
 #endif // ENABLE_SSL
 
 #ifdef HAVE_LIBSSH2
@@ -91,15 +104,32 @@ private:
   // TLS context for server side
   static std::shared_ptr<TLSContext> svTlsContext_;
 
+  // Cache of client side TLS sessions.  If it is null, sessions are
+  // not resumed.
+  static std::shared_ptr<TLSSessionCache> tlsSessionCache_;
+
   std::shared_ptr<TLSSession> tlsSession_;
 
+  // The hostname and port under which the session of this connection
+  // is stored in tlsSessionCache_.  The hostname is cleared once the
+  // session is stored.
+  std::string tlsSessionHostname_;
+  uint16_t tlsSessionPort_;
+  // True if the session is a TLS 1.3 ticket, which is used only once.
+  bool tlsSingleUseSession_;
+
+  // Stores the session of this connection in tlsSessionCache_ if it
+  // is resumable.
+  void storeTLSSession();
+
   /**
    * Makes this socket secure. The connection must be established
    * before calling this method.
    *
    * If you are going to verify peer's certificate, hostname must be supplied.
    */
-  bool tlsHandshake(TLSContext* tlsctx, const std::string& hostname);
+  bool tlsHandshake(TLSContext* tlsctx, const std::string& hostname,
+                    const std::string& alpnProtos = A2STR::NIL);
 #endif // ENABLE_SSL
 
 #ifdef HAVE_LIBSSH2
@@ -264,6 +294,19 @@ public:
 
   ssize_t writeVector(a2iovec* iov, size_t iovcnt);
 
+  // Sends at most n datagrams in dgrams, using a single sendmmsg(2)
+  // call if available.  Returns the number of datagrams sent, which
+  // is 0 if the first one cannot be sent without blocking.  Throws
+  // exception if the first datagram cannot be sent.
+  size_t writeDataBatch(const Datagram* dgrams, size_t n);
+
+#ifdef HAVE_SENDFILE
+  // Sends at most len bytes of the file fd, starting at offset, using
+  // sendfile(2).  This function must not be used for SSL/TLS
+  // connection.  Returns the number of bytes sent.
+  ssize_t sendFile(int fd, int64_t offset, size_t len);
+#endif // HAVE_SENDFILE
+
   /**
    * Reads up to len bytes from this socket.
    * data is a pointer pointing the first
@@ -285,6 +328,12 @@ public:
   // sender.addr will be numerihost assigned.
   ssize_t readDataFrom(void* data, size_t len, Endpoint& sender);
 
+  // Reads at most n datagrams into dgrams, using a single recvmmsg(2)
+  // call if available.  A datagram which does not fit in its buffer
+  // is discarded and reported with len 0.  Returns the number of
+  // datagrams read, which is 0 if none is available.
+  size_t readDataFromBatch(Datagram* dgrams, size_t n);
+
 #ifdef ENABLE_SSL
   // Performs TLS server side handshake. If handshake is completed,
   // returns true. If handshake has not been done yet, returns false.
@@ -294,8 +343,16 @@ public:
   // returns true. If handshake has not been done yet, returns false.
   //
   // If you are going to verify peer's certificate, hostname must be
-  // supplied.
-  bool tlsConnect(const std::string& hostname);
+  // supplied.  The session cached for hostname and port is resumed if
+  // there is one.  The |alpnProtos| is the list of protocols offered
+  // in ALPN extension in wire format.  If it is empty, ALPN is not
+  // used.
+  bool tlsConnect(const std::string& hostname, uint16_t port,
+                  const std::string& alpnProtos = A2STR::NIL);
+
+  // Returns the protocol selected by ALPN in TLS handshake, or empty
+  // string if none was selected.
+  std::string getTLSAlpnProtocol() const;
 #endif // ENABLE_SSL
 
 #ifdef HAVE_LIBSSH2
@@ -347,6 +404,9 @@ public:
   setClientTLSContext(const std::shared_ptr<TLSContext>& tlsContext);
   static void
   setServerTLSContext(const std::shared_ptr<TLSContext>& tlsContext);
+  static void
+  setTLSSessionCache(const std::shared_ptr<TLSSessionCache>& tlsSessionCache);
+  static const std::shared_ptr<TLSSessionCache>& getTLSSessionCache();
 #endif // ENABLE_SSL
 
   static void setProtocolFamily(int protocolFamily)
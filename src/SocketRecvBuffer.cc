@@ -36,31 +36,73 @@
 
 #include <cstring>
 #include <cassert>
+#include <algorithm>
 
 #include "SocketCore.h"
 #include "LogFactory.h"
+#ifdef HAVE_LIBNGHTTP2
+#  include "Http2Session.h"
+#endif // HAVE_LIBNGHTTP2
 
 namespace aria2 {
 
 SocketRecvBuffer::SocketRecvBuffer(std::shared_ptr<SocketCore> socket)
-    : socket_(std::move(socket)), pos_(buf_.data()), last_(pos_)
+    : socket_(std::move(socket)),
+      pos_(buf_.data()),
+      last_(pos_),
+#ifdef HAVE_LIBNGHTTP2
+      http2StreamId_(-1),
+#endif // HAVE_LIBNGHTTP2
+      eof_(false)
 {
 }
 
 SocketRecvBuffer::~SocketRecvBuffer() = default;
 
-ssize_t SocketRecvBuffer::recv()
+ssize_t SocketRecvBuffer::recv() { return recv(buf_.size()); }
+
+ssize_t SocketRecvBuffer::recv(size_t maxLength)
 {
-  size_t n = std::end(buf_) - last_;
+  size_t n = std::min(static_cast<size_t>(std::end(buf_) - last_), maxLength);
   if (n == 0) {
     A2_LOG_DEBUG("Buffer full");
+    eof_ = false;
     return 0;
   }
+#ifdef HAVE_LIBNGHTTP2
+  if (http2Session_) {
+    n = http2Session_->readStream(http2StreamId_, last_, n);
+    eof_ = n == 0 && http2Session_->streamEnded(http2StreamId_);
+    last_ += n;
+    return n;
+  }
+#endif // HAVE_LIBNGHTTP2
   socket_->readData(last_, n);
+  eof_ = n == 0 && !socket_->wantRead() && !socket_->wantWrite();
   last_ += n;
   return n;
 }
 
+bool SocketRecvBuffer::hasPendingData() const
+{
+#ifdef HAVE_LIBNGHTTP2
+  if (http2Session_) {
+    return http2Session_->hasPendingData(http2StreamId_);
+  }
+#endif // HAVE_LIBNGHTTP2
+  return false;
+}
+
+#ifdef HAVE_LIBNGHTTP2
+void SocketRecvBuffer::setHttp2Stream(
+    const std::shared_ptr<Http2Session>& session, int32_t streamId)
+{
+  http2Session_ = session;
+  http2StreamId_ = streamId;
+  eof_ = false;
+}
+#endif // HAVE_LIBNGHTTP2
+
 void SocketRecvBuffer::drain(size_t n)
 {
   assert(pos_ + n <= last_);
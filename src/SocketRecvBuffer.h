@@ -45,6 +45,9 @@
 namespace aria2 {
 
 class SocketCore;
+#ifdef HAVE_LIBNGHTTP2
+class Http2Session;
+#endif // HAVE_LIBNGHTTP2
 
 class SocketRecvBuffer {
 public:
@@ -53,6 +56,20 @@ public:
   // Reads data from socket as much as capacity allows. Returns the
   // number of bytes read.
   ssize_t recv();
+  // Same as recv() but reads at most maxLength bytes.
+  ssize_t recv(size_t maxLength);
+  // Returns true if the last recv() reached the end of data: the
+  // remote endpoint closed the connection, or HTTP/2 stream ended.
+  bool eof() const { return eof_; }
+  // Returns true if recv() returns data, or reaches the end of data,
+  // without waiting for the socket.
+  bool hasPendingData() const;
+#ifdef HAVE_LIBNGHTTP2
+  // Reads the response of HTTP/2 stream |streamId| of |session|
+  // instead of the socket.
+  void setHttp2Stream(const std::shared_ptr<Http2Session>& session,
+                      int32_t streamId);
+#endif // HAVE_LIBNGHTTP2
   // Truncates the contents of buffer to 0.
   void truncateBuffer();
   // Drains first n bytes of data from buffer.  It is an programmer's
@@ -73,6 +90,11 @@ private:
   std::shared_ptr<SocketCore> socket_;
   unsigned char* pos_;
   unsigned char* last_;
+#ifdef HAVE_LIBNGHTTP2
+  std::shared_ptr<Http2Session> http2Session_;
+  int32_t http2StreamId_;
+#endif // HAVE_LIBNGHTTP2
+  bool eof_;
 };
 
 } // namespace aria2
@@ -35,7 +35,6 @@
 #include "SpeedCalc.h"
 
 #include <algorithm>
-#include <functional>
 
 #include "wallclock.h"
 
@@ -43,99 +42,104 @@ namespace aria2 {
 
 namespace {
 constexpr auto WINDOW_TIME = 10_s;
-} // namespace
-
-SpeedCalc::SpeedCalc() : accumulatedLength_(0), bytesWindow_(0), maxSpeed_(0) {}
 
-void SpeedCalc::reset()
+int64_t toMillis(const Timer& t)
 {
-  timeSlots_.clear();
-  start_ = global::wallclock();
-  accumulatedLength_ = 0;
-  bytesWindow_ = 0;
-  maxSpeed_ = 0;
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             t.getTime().time_since_epoch())
+      .count();
 }
+} // namespace
+
+constexpr size_t SpeedCalc::NUM_SLOTS;
+
+SpeedCalc::SpeedCalc() { reset(); }
 
-void SpeedCalc::removeStaleTimeSlot(const Timer& now)
+void SpeedCalc::reset()
 {
-  while (!timeSlots_.empty()) {
-    if (timeSlots_[0].first.difference(now) <= WINDOW_TIME) {
-      break;
-    }
-    bytesWindow_ -= timeSlots_[0].second;
-    timeSlots_.pop_front();
+  for (auto& slot : slots_) {
+    slot.time.store(-1, std::memory_order_relaxed);
+    slot.bytes.store(0, std::memory_order_relaxed);
   }
+  start_.store(toMillis(global::wallclock()), std::memory_order_relaxed);
+  accumulatedLength_.store(0, std::memory_order_relaxed);
+  maxSpeed_.store(0, std::memory_order_relaxed);
 }
 
 int SpeedCalc::calculateSpeed()
 {
-  const auto& now = global::wallclock();
-  removeStaleTimeSlot(now);
-  if (timeSlots_.empty()) {
-    return 0;
-  }
-  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                     timeSlots_[0].first.difference(now))
-                     .count();
-  if (elapsed <= 0) {
-    elapsed = 1;
+  int speed = calculateSpeed(global::wallclock());
+  if (speed > maxSpeed_.load(std::memory_order_relaxed)) {
+    maxSpeed_.store(speed, std::memory_order_relaxed);
   }
-  int speed = bytesWindow_ * 1000 / elapsed;
-  maxSpeed_ = std::max(speed, maxSpeed_);
   return speed;
 }
 
+int SpeedCalc::calculateSpeed(const Timer& now) const
+{
+  return calculateNewestSpeed(
+      std::chrono::duration_cast<std::chrono::seconds>(WINDOW_TIME).count(),
+      now);
+}
+
 int SpeedCalc::calculateNewestSpeed(int seconds)
 {
-  const auto& now = global::wallclock();
-  removeStaleTimeSlot(now);
-
-  int64_t bytesCount(0);
-  auto it = timeSlots_.rbegin();
-  while (it != timeSlots_.rend()) {
-    if (it->first.difference(now) > seconds * 1_s) {
-      break;
+  return calculateNewestSpeed(seconds, global::wallclock());
+}
+
+int SpeedCalc::calculateNewestSpeed(int seconds, const Timer& now) const
+{
+  auto nowMillis = toMillis(now);
+  auto window = seconds * static_cast<int64_t>(1000);
+  int64_t bytesCount = 0;
+  auto oldest = nowMillis;
+  for (auto& slot : slots_) {
+    auto time = slot.time.load(std::memory_order_relaxed);
+    if (time < 0 || nowMillis - time > window) {
+      continue;
     }
-    bytesCount += (*it++).second;
+    bytesCount += slot.bytes.load(std::memory_order_relaxed);
+    oldest = std::min(oldest, time);
   }
-  if (it == timeSlots_.rbegin()) {
+  if (bytesCount == 0) {
     return 0;
   }
-
-  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                     (*--it).first.difference(now))
-                     .count();
+  auto elapsed = nowMillis - oldest;
   if (elapsed <= 0) {
     elapsed = 1;
   }
-  return bytesCount * (1000. / elapsed);
+  return bytesCount * 1000 / elapsed;
 }
 
 void SpeedCalc::update(size_t bytes)
 {
-  const auto& now = global::wallclock();
-  removeStaleTimeSlot(now);
-  if (timeSlots_.empty() ||
-      std::chrono::duration_cast<std::chrono::seconds>(
-          timeSlots_.back().first.difference(now)) >= 1_s) {
-    timeSlots_.push_back(std::make_pair(now, bytes));
+  auto now = toMillis(global::wallclock());
+  auto& slot = slots_[(now / 1000) % NUM_SLOTS];
+  auto time = slot.time.load(std::memory_order_relaxed);
+  if (time < 0 || time / 1000 != now / 1000) {
+    // The slot holds a second which already left the window.
+    slot.bytes.store(bytes, std::memory_order_relaxed);
+    slot.time.store(now, std::memory_order_relaxed);
   }
   else {
-    timeSlots_.back().second += bytes;
+    slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
   }
-  bytesWindow_ += bytes;
-  accumulatedLength_ += bytes;
+  accumulatedLength_.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 int SpeedCalc::calculateAvgSpeed() const
 {
-  auto milliElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                          start_.difference(global::wallclock()))
-                          .count();
+  return calculateAvgSpeed(global::wallclock());
+}
+
+int SpeedCalc::calculateAvgSpeed(const Timer& now) const
+{
+  auto milliElapsed = toMillis(now) - start_.load(std::memory_order_relaxed);
   // if milliElapsed is too small, the average speed is rubbish, better
   // return 0
   if (milliElapsed > 4) {
-    int speed = accumulatedLength_ * 1000 / milliElapsed;
+    int speed = accumulatedLength_.load(std::memory_order_relaxed) * 1000 /
+                milliElapsed;
     return speed;
   }
   else {
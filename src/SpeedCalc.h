@@ -37,22 +37,21 @@
 
 #include "common.h"
 
-#include <deque>
+#include <array>
+#include <atomic>
 
 #include "TimerA2.h"
 
 namespace aria2 {
 
+// Calculates transfer speed from bytes counted in a ring of one-second
+// slots, so that both update and query take constant time.  Only one
+// thread may call update() and reset(), but the calculate functions
+// taking the current time can be called from any thread: all state is
+// kept in atomics accessed with relaxed ordering.  A concurrent reader
+// may see a slot which is being recycled, which only skews a single
+// speed sample.
 class SpeedCalc {
-private:
-  std::deque<std::pair<Timer, size_t>> timeSlots_;
-  Timer start_;
-  int64_t accumulatedLength_;
-  int64_t bytesWindow_;
-  int maxSpeed_;
-
-  void removeStaleTimeSlot(const Timer& now);
-
 public:
   SpeedCalc();
 
@@ -61,15 +60,40 @@ public:
    */
   int calculateSpeed();
 
+  // Same as calculateSpeed() but does not update the max speed.
+  int calculateSpeed(const Timer& now) const;
+
   int calculateNewestSpeed(int seconds);
 
-  int getMaxSpeed() const { return maxSpeed_; }
+  int calculateNewestSpeed(int seconds, const Timer& now) const;
+
+  int getMaxSpeed() const { return maxSpeed_.load(std::memory_order_relaxed); }
 
   int calculateAvgSpeed() const;
 
+  int calculateAvgSpeed(const Timer& now) const;
+
   void update(size_t bytes);
 
   void reset();
+
+private:
+  // One slot more than the window length in seconds, so that the
+  // partially filled current second never overwrites a slot still in
+  // the window.
+  static constexpr size_t NUM_SLOTS = 11;
+
+  struct Slot {
+    // Time of the first update in this slot in milliseconds, or -1 if
+    // the slot has never been used.
+    std::atomic<int64_t> time;
+    std::atomic<int64_t> bytes;
+  };
+
+  std::array<Slot, NUM_SLOTS> slots_;
+  std::atomic<int64_t> start_;
+  std::atomic<int64_t> accumulatedLength_;
+  std::atomic<int> maxSpeed_;
 };
 
 } // namespace aria2
@@ -69,6 +69,12 @@ public:
   virtual TLSSessionSide getSide() const = 0;
   virtual bool getVerifyPeer() const = 0;
   virtual void setVerifyPeer(bool) = 0;
+
+  // Lets the sessions created after this call move the record layer
+  // into the kernel (kTLS) once handshake completes, if the kernel
+  // and the negotiated cipher support it.  Returns false if the
+  // backend does not support kernel TLS.
+  virtual bool enableKernelTLS() { return false; }
 };
 
 } // namespace aria2
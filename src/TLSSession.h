@@ -111,6 +111,45 @@ public:
   // contacting network.
   virtual size_t getRecvBufferedLength() = 0;
 
+  // Sets the protocols offered in TLS ALPN extension.  The |protos|
+  // is a list of protocol names in wire format, each prefixed by its
+  // length.  This is only meaningful for client side session.
+  // Backends without ALPN support ignore it.  This function returns
+  // TLS_ERR_OK if it succeeds, or TLS_ERR_ERROR.
+  virtual int setAlpnProtocols(const std::string& protos)
+  {
+    return TLS_ERR_OK;
+  }
+
+  // Returns the protocol selected by ALPN in the handshake, or empty
+  // string if no protocol was selected.
+  virtual std::string getAlpnProtocol() { return ""; }
+
+  // Sets the session |data| previously obtained by getSessionData()
+  // to resume it in the handshake.  This is only meaningful for
+  // client side session, and must be called before tlsConnect().
+  // Backends without session resumption support ignore it.  This
+  // function returns TLS_ERR_OK if it succeeds, or TLS_ERR_ERROR.
+  virtual int setSessionData(const std::string& data) { return TLS_ERR_OK; }
+
+  // Returns the serialized session of the established connection,
+  // which can be passed to setSessionData() of another session, or
+  // empty string if the session cannot be resumed.  In TLS 1.3, the
+  // session becomes resumable only after the server sends a session
+  // ticket, which happens after the handshake.
+  virtual std::string getSessionData() { return ""; }
+
+  // Returns true if the handshake resumed a previous session.
+  virtual bool isSessionResumed() { return false; }
+
+  // Returns true if the kernel encrypts the data sent by this
+  // session.  See TLSContext::enableKernelTLS().
+  virtual bool isKernelTLSSend() { return false; }
+
+  // Returns true if the kernel decrypts the data received by this
+  // session.
+  virtual bool isKernelTLSRecv() { return false; }
+
 protected:
   TLSSession() = default;
 
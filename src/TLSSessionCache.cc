@@ -0,0 +1,134 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "TLSSessionCache.h"
+
+#include "a2functional.h"
+#include "wallclock.h"
+
+namespace aria2 {
+
+const std::chrono::seconds TLSSessionCache::SESSION_LIFETIME = 2_h;
+
+TLSSessionCache::TLSSessionCache(size_t maxSize)
+    : maxSize_(maxSize), hits_(0), misses_(0)
+{
+}
+
+std::string TLSSessionCache::get(const std::string& hostname, uint16_t port)
+{
+  auto i = entries_.find(Key(hostname, port));
+  if (i == entries_.end()) {
+    return "";
+  }
+  auto& sessions = (*i).second.sessions;
+  while (!sessions.empty() && sessions.front().expiry < global::wallclock()) {
+    sessions.pop_front();
+  }
+  if (sessions.empty()) {
+    erase(i);
+    return "";
+  }
+  lruEntries_.splice(lruEntries_.end(), lruEntries_, (*i).second.lruPos);
+  if (!sessions.front().singleUse) {
+    return sessions.front().data;
+  }
+  auto data = std::move(sessions.front().data);
+  sessions.pop_front();
+  if (sessions.empty()) {
+    erase(i);
+  }
+  return data;
+}
+
+void TLSSessionCache::put(const std::string& hostname, uint16_t port,
+                          const std::string& data, bool singleUse)
+{
+  Key key(hostname, port);
+  auto i = entries_.lower_bound(key);
+  if (i == entries_.end() || (*i).first != key) {
+    i = entries_.insert(i, std::make_pair(key, CacheEntry()));
+    (*i).second.lruPos = lruEntries_.insert(lruEntries_.end(), key);
+  }
+  else {
+    lruEntries_.splice(lruEntries_.end(), lruEntries_, (*i).second.lruPos);
+  }
+  auto& sessions = (*i).second.sessions;
+  if (!singleUse || (!sessions.empty() && !sessions.front().singleUse)) {
+    sessions.clear();
+  }
+  else if (sessions.size() == MAX_TICKETS) {
+    sessions.pop_front();
+  }
+  Session session{data, singleUse, global::wallclock()};
+  session.expiry.advance(SESSION_LIFETIME);
+  sessions.push_back(std::move(session));
+  evict();
+}
+
+void TLSSessionCache::erase(std::map<Key, CacheEntry>::iterator i)
+{
+  lruEntries_.erase((*i).second.lruPos);
+  entries_.erase(i);
+}
+
+void TLSSessionCache::remove(const std::string& hostname, uint16_t port)
+{
+  auto i = entries_.find(Key(hostname, port));
+  if (i != entries_.end()) {
+    erase(i);
+  }
+}
+
+void TLSSessionCache::evict()
+{
+  if (maxSize_ == 0) {
+    return;
+  }
+  while (entries_.size() > maxSize_) {
+    erase(entries_.find(lruEntries_.front()));
+  }
+}
+
+void TLSSessionCache::countHandshake(bool resumed)
+{
+  if (resumed) {
+    ++hits_;
+  }
+  else {
+    ++misses_;
+  }
+}
+
+} // namespace aria2
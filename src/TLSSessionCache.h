@@ -0,0 +1,127 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_TLS_SESSION_CACHE_H
+#define D_TLS_SESSION_CACHE_H
+
+#include "common.h"
+
+#include <string>
+#include <map>
+#include <list>
+#include <deque>
+#include <chrono>
+
+#include "TimerA2.h"
+
+namespace aria2 {
+
+// Caches TLS sessions per hostname and port so that subsequent
+// connections to the same server can resume them instead of
+// performing a full handshake.  A session is kept as the opaque data
+// returned by TLSSession::getSessionData().
+//
+// TLS 1.3 session tickets should not be used more than once, so they
+// are stored as single-use sessions: get() removes them, and the
+// server issues new tickets on each resumed connection.  Older
+// versions share one reusable session among all connections.  The
+// least recently used hostname and port is evicted when the number of
+// entries exceeds the maximum size.
+class TLSSessionCache {
+private:
+  struct Session {
+    std::string data;
+    bool singleUse;
+    Timer expiry;
+  };
+
+  typedef std::pair<std::string, uint16_t> Key;
+
+  struct CacheEntry {
+    std::deque<Session> sessions;
+    // The position of this entry in TLSSessionCache::lruEntries_.
+    std::list<Key>::iterator lruPos;
+  };
+
+  std::map<Key, CacheEntry> entries_;
+  // Keys in least recently used order.
+  std::list<Key> lruEntries_;
+  // The maximum number of entries.  0 means no limit.
+  size_t maxSize_;
+  uint64_t hits_;
+  uint64_t misses_;
+
+  void erase(std::map<Key, CacheEntry>::iterator i);
+
+  void evict();
+
+public:
+  TLSSessionCache(size_t maxSize = 0);
+
+  // Returns the session data to resume for hostname and port, or
+  // empty string if there is none.  A single-use session is removed
+  // from the cache.
+  std::string get(const std::string& hostname, uint16_t port);
+
+  // Stores the session data for hostname and port.  If singleUse is
+  // true, the session is a TLS 1.3 ticket and up to MAX_TICKETS of
+  // them are kept.  Otherwise, the session replaces all sessions
+  // cached for hostname and port.
+  void put(const std::string& hostname, uint16_t port,
+           const std::string& data, bool singleUse);
+
+  void remove(const std::string& hostname, uint16_t port);
+
+  // Counts a client handshake.  If resumed is true, the handshake
+  // resumed a cached session, and it is counted as a hit.  Otherwise
+  // it is counted as a miss.
+  void countHandshake(bool resumed);
+
+  size_t size() const { return entries_.size(); }
+
+  uint64_t getHits() const { return hits_; }
+
+  uint64_t getMisses() const { return misses_; }
+
+  // The maximum number of TLS 1.3 tickets kept per hostname and port.
+  static const size_t MAX_TICKETS = 4;
+
+  // Sessions are dropped after this duration.  Servers commonly
+  // limit the lifetime of session tickets to a few hours.
+  static const std::chrono::seconds SESSION_LIFETIME;
+};
+
+} // namespace aria2
+
+#endif // D_TLS_SESSION_CACHE_H
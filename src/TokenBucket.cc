@@ -0,0 +1,153 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "TokenBucket.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace aria2 {
+
+constexpr int64_t TokenBucket::UNLIMITED;
+
+TokenBucket::TokenBucket(int rate) : rate_(rate), tokens_(getBurst()) {}
+
+int64_t TokenBucket::getBurst() const
+{
+  return std::max(static_cast<int64_t>(1),
+                  static_cast<int64_t>(rate_) *
+                      std::chrono::duration_cast<std::chrono::milliseconds>(
+                          TOKEN_BUCKET_BURST)
+                          .count() /
+                      1000);
+}
+
+void TokenBucket::setRate(int rate)
+{
+  auto wasLimited = isLimited();
+  rate_ = rate;
+  tokens_ = wasLimited ? std::min(tokens_, getBurst()) : getBurst();
+}
+
+void TokenBucket::refill(const Timer& now)
+{
+  if (!isLimited()) {
+    lastRefill_ = now;
+    return;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                     lastRefill_.difference(now))
+                     .count();
+  auto tokens = static_cast<int64_t>(rate_) * elapsed / 1000000;
+  // Keep the fraction of a token for the next refill, otherwise
+  // frequent refills would lose credit.
+  if (tokens > 0) {
+    tokens_ = std::min(getBurst(), tokens_ + tokens);
+    lastRefill_ = now;
+  }
+}
+
+void TokenBucket::consume(size_t bytes)
+{
+  if (isLimited()) {
+    tokens_ -= bytes;
+  }
+}
+
+int64_t TokenBucket::getTokens() const
+{
+  return isLimited() ? tokens_ : UNLIMITED;
+}
+
+BandwidthBudget::BandwidthBudget()
+    : assigned_(TokenBucket::UNLIMITED),
+      remaining_(TokenBucket::UNLIMITED),
+      used_(0)
+{
+}
+
+void BandwidthBudget::assign(int64_t bytes)
+{
+  assigned_ = remaining_ = bytes;
+  used_ = 0;
+}
+
+void BandwidthBudget::consume(size_t bytes)
+{
+  if (remaining_ != TokenBucket::UNLIMITED) {
+    remaining_ -= bytes;
+  }
+  used_ += bytes;
+}
+
+int64_t BandwidthBudget::estimateDemand() const
+{
+  if (exhausted()) {
+    return TokenBucket::UNLIMITED;
+  }
+  return std::max(BANDWIDTH_MIN_DEMAND, used_ * 2);
+}
+
+void shareTokens(std::vector<TokenClaim>& claims, int64_t tokens)
+{
+  if (tokens == TokenBucket::UNLIMITED) {
+    for (auto& c : claims) {
+      c.grant = c.demand;
+    }
+    return;
+  }
+  // Satisfy the claims with the smallest demand per weight first, so
+  // that what they leave over is split among the rest.
+  std::vector<size_t> order(claims.size());
+  std::iota(std::begin(order), std::end(order), 0);
+  std::sort(std::begin(order), std::end(order), [&claims](size_t a, size_t b) {
+    return static_cast<double>(claims[a].demand) / claims[a].weight <
+           static_cast<double>(claims[b].demand) / claims[b].weight;
+  });
+  int64_t remaining = std::max(static_cast<int64_t>(0), tokens);
+  int64_t totalWeight = 0;
+  for (auto& c : claims) {
+    totalWeight += c.weight;
+  }
+  for (auto i : order) {
+    auto& c = claims[i];
+    auto fair = static_cast<int64_t>(static_cast<double>(remaining) *
+                                     c.weight / totalWeight);
+    c.grant = std::max(static_cast<int64_t>(0), std::min(c.demand, fair));
+    remaining -= c.grant;
+    totalWeight -= c.weight;
+  }
+}
+
+} // namespace aria2
@@ -0,0 +1,144 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_TOKEN_BUCKET_H
+#define D_TOKEN_BUCKET_H
+
+#include "common.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "TimerA2.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+// Interval between distributions of bandwidth budgets to downloads.
+constexpr auto BANDWIDTH_SCHEDULE_INTERVAL = 100_ms;
+
+// Burst size of TokenBucket, expressed as time at the configured rate.
+constexpr auto TOKEN_BUCKET_BURST = 200_ms;
+
+// Minimum demand assumed for a download which used little of its
+// previous budget.  This is the size of a BitTorrent block.
+constexpr int64_t BANDWIDTH_MIN_DEMAND = 16_k;
+
+// Token bucket holding byte credits for a transfer rate limit.  Tokens
+// are refilled at the configured rate and capped at the burst size,
+// which is TOKEN_BUCKET_BURST worth of the rate.  If the rate is 0,
+// the bucket is unlimited.
+class TokenBucket {
+public:
+  static constexpr int64_t UNLIMITED = std::numeric_limits<int64_t>::max();
+
+  explicit TokenBucket(int rate = 0);
+
+  // Changes the rate in bytes/sec.  Accumulated tokens are clamped to
+  // the new burst size.
+  void setRate(int rate);
+
+  int getRate() const { return rate_; }
+
+  bool isLimited() const { return rate_ > 0; }
+
+  // Adds tokens accrued between the last refill and |now|.
+  void refill(const Timer& now);
+
+  // Removes |bytes| tokens.  The balance may become negative, since a
+  // socket read or a BitTorrent block cannot be split.  The debt is
+  // repaid by later refills.
+  void consume(size_t bytes);
+
+  // Returns the token balance, or UNLIMITED if the bucket has no
+  // rate limit.
+  int64_t getTokens() const;
+
+private:
+  int64_t getBurst() const;
+
+  int rate_;
+  int64_t tokens_;
+  Timer lastRefill_;
+};
+
+// Byte allowance handed to one download for a single scheduling tick.
+// Unless assigned, the budget is unlimited.
+class BandwidthBudget {
+public:
+  BandwidthBudget();
+
+  // Starts a new tick with |bytes| allowance.
+  void assign(int64_t bytes);
+
+  void consume(size_t bytes);
+
+  bool exhausted() const { return remaining_ <= 0; }
+
+  int64_t getAssigned() const { return assigned_; }
+
+  int64_t getRemaining() const { return remaining_; }
+
+  // Returns the number of bytes the holder is expected to want in the
+  // next tick.  A holder which ran out of its allowance is assumed to
+  // want everything; otherwise twice the last usage, but at least
+  // BANDWIDTH_MIN_DEMAND, so that idle downloads yield their share
+  // while still being able to ramp up quickly.
+  int64_t estimateDemand() const;
+
+private:
+  int64_t assigned_;
+  int64_t remaining_;
+  int64_t used_;
+};
+
+struct TokenClaim {
+  // Maximum number of bytes the claimant can use.
+  int64_t demand;
+  // Relative weight of the claimant.  Must be positive.
+  int weight;
+  // Output: bytes granted to the claimant.
+  int64_t grant;
+};
+
+// Distributes |tokens| among |claims| in weighted max-min fair manner:
+// no claim is granted more than its demand, and the remainder is
+// split in proportion to the weights among the claims which still
+// want more.
+void shareTokens(std::vector<TokenClaim>& claims, int64_t tokens);
+
+} // namespace aria2
+
+#endif // D_TOKEN_BUCKET_H
@@ -34,37 +34,71 @@
 /* copyright --> */
 #include "UDPTrackerClient.h"
 
+#include <cstdio>
+
 #include "UDPTrackerRequest.h"
 #include "bittorrent_helper.h"
 #include "util.h"
 #include "LogFactory.h"
 #include "SimpleRandomizer.h"
 #include "fmt.h"
+#include "BufferedFile.h"
+#include "File.h"
+#include "TimeA2.h"
+#include "wallclock.h"
+#include "message.h"
 
 namespace aria2 {
 
 UDPTrackerClient::UDPTrackerClient() : numWatchers_(0) {}
 
 namespace {
-template <typename InputIterator>
-void failRequest(InputIterator first, InputIterator last, int error)
+void failRequest(const std::shared_ptr<UDPTrackerRequest>& req, int error)
+{
+  req->state = UDPT_STA_COMPLETE;
+  req->error = error;
+}
+} // namespace
+
+namespace {
+void failRequest(const std::deque<std::shared_ptr<UDPTrackerRequest>>& reqs,
+                 int error)
+{
+  for (auto& req : reqs) {
+    failRequest(req, error);
+  }
+}
+} // namespace
+
+namespace {
+void failRequest(const UDPTrackerClient::ConnectRequestMap& reqs, int error)
 {
-  for (; first != last; ++first) {
-    (*first)->state = UDPT_STA_COMPLETE;
-    (*first)->error = error;
+  for (auto& e : reqs) {
+    for (auto& req : e.second) {
+      failRequest(req, error);
+    }
   }
 }
 } // namespace
 
 namespace {
-uint32_t generateTransactionId()
+void failRequest(const UDPTrackerClient::InflightRequestMap& reqs, int error)
+{
+  for (auto& e : reqs) {
+    failRequest(e.second, error);
+  }
+}
+} // namespace
+
+uint32_t UDPTrackerClient::generateTransactionId() const
 {
   uint32_t res;
-  SimpleRandomizer::getInstance()->getRandomBytes(
-      reinterpret_cast<unsigned char*>(&res), sizeof(res));
+  do {
+    SimpleRandomizer::getInstance()->getRandomBytes(
+        reinterpret_cast<unsigned char*>(&res), sizeof(res));
+  } while (inflightRequests_.count(res));
   return res;
 }
-} // namespace
 
 namespace {
 void logInvalidLength(const std::string& remoteAddr, uint16_t remotePort,
@@ -104,34 +138,11 @@ UDPTrackerClient::~UDPTrackerClient()
 {
   // Make all contained requests fail
   int error = UDPT_ERR_SHUTDOWN;
-  failRequest(inflightRequests_.begin(), inflightRequests_.end(), error);
-  failRequest(pendingRequests_.begin(), pendingRequests_.end(), error);
-  failRequest(connectRequests_.begin(), connectRequests_.end(), error);
+  failRequest(inflightRequests_, error);
+  failRequest(pendingRequests_, error);
+  failRequest(connectRequests_, error);
 }
 
-namespace {
-struct CollectAddrPortMatch {
-  bool operator()(const std::shared_ptr<UDPTrackerRequest>& req) const
-  {
-    if (req->remoteAddr == remoteAddr && req->remotePort == remotePort) {
-      dest.push_back(req);
-      return true;
-    }
-    else {
-      return false;
-    }
-  }
-  std::vector<std::shared_ptr<UDPTrackerRequest>>& dest;
-  std::string remoteAddr;
-  uint16_t remotePort;
-  CollectAddrPortMatch(std::vector<std::shared_ptr<UDPTrackerRequest>>& dest,
-                       std::string remoteAddr, uint16_t remotePort)
-      : dest(dest), remoteAddr(std::move(remoteAddr)), remotePort(remotePort)
-  {
-  }
-};
-} // namespace
-
 int UDPTrackerClient::receiveReply(std::shared_ptr<UDPTrackerRequest>& recvReq,
                                    const unsigned char* data, size_t length,
                                    const std::string& remoteAddr,
@@ -158,15 +169,16 @@ int UDPTrackerClient::receiveReply(std::shared_ptr<UDPTrackerRequest>& recvReq,
             "connection_id=%016" PRIx64,
             remoteAddr.c_str(), remotePort, transactionId, connectionId));
     UDPTrackerConnection c(UDPT_CST_CONNECTED, connectionId, now);
-    connectionIdCache_[std::make_pair(remoteAddr, remotePort)] = c;
+    auto key = std::make_pair(remoteAddr, remotePort);
+    connectionIdCache_[key] = c;
     // Now we have connection ID, push requests which are waiting for
     // it.
-    std::vector<std::shared_ptr<UDPTrackerRequest>> reqs;
-    connectRequests_.erase(
-        std::remove_if(connectRequests_.begin(), connectRequests_.end(),
-                       CollectAddrPortMatch(reqs, remoteAddr, remotePort)),
-        connectRequests_.end());
-    pendingRequests_.insert(pendingRequests_.begin(), reqs.begin(), reqs.end());
+    auto i = connectRequests_.find(key);
+    if (i != connectRequests_.end()) {
+      pendingRequests_.insert(pendingRequests_.begin(), (*i).second.begin(),
+                              (*i).second.end());
+      connectRequests_.erase(i);
+    }
 
     recvReq = std::move(req);
 
@@ -269,6 +281,11 @@ ssize_t UDPTrackerClient::createRequest(unsigned char* data, size_t length,
   while (!pendingRequests_.empty()) {
     const std::shared_ptr<UDPTrackerRequest>& req = pendingRequests_.front();
     if (req->action == UDPT_ACT_CONNECT) {
+      // The transaction ID might be taken while this request was
+      // waiting for resend.
+      if (inflightRequests_.count(req->transactionId)) {
+        req->transactionId = generateTransactionId();
+      }
       ssize_t rv;
       rv = createUDPTrackerConnect(data, length, remoteAddr, remotePort, req);
       return rv;
@@ -287,7 +304,8 @@ ssize_t UDPTrackerClient::createRequest(unsigned char* data, size_t length,
       return rv;
     }
     if (c->state == UDPT_CST_CONNECTING) {
-      connectRequests_.push_back(req);
+      connectRequests_[std::make_pair(req->remoteAddr, req->remotePort)]
+          .push_back(req);
       pendingRequests_.pop_front();
       continue;
     }
@@ -333,7 +351,7 @@ void UDPTrackerClient::requestSent(const Timer& now)
     break;
   }
   }
-  inflightRequests_.push_back(req);
+  inflightRequests_[req->transactionId] = req;
   pendingRequests_.pop_front();
 }
 
@@ -454,10 +472,15 @@ struct TimeoutCheck {
 void UDPTrackerClient::handleTimeout(const Timer& now)
 {
   std::vector<std::shared_ptr<UDPTrackerRequest>> dest;
-  inflightRequests_.erase(std::remove_if(inflightRequests_.begin(),
-                                         inflightRequests_.end(),
-                                         TimeoutCheck(dest, this, now)),
-                          inflightRequests_.end());
+  TimeoutCheck check(dest, this, now);
+  for (auto i = inflightRequests_.begin(); i != inflightRequests_.end();) {
+    if (check((*i).second)) {
+      i = inflightRequests_.erase(i);
+    }
+    else {
+      ++i;
+    }
+  }
   pendingRequests_.insert(pendingRequests_.begin(), dest.begin(), dest.end());
 }
 
@@ -466,17 +489,14 @@ UDPTrackerClient::findInflightRequest(const std::string& remoteAddr,
                                       uint16_t remotePort,
                                       uint32_t transactionId, bool remove)
 {
-  std::shared_ptr<UDPTrackerRequest> res;
-  for (auto i = inflightRequests_.begin(), eoi = inflightRequests_.end();
-       i != eoi; ++i) {
-    if ((*i)->remoteAddr == remoteAddr && (*i)->remotePort == remotePort &&
-        (*i)->transactionId == transactionId) {
-      res = *i;
-      if (remove) {
-        inflightRequests_.erase(i);
-      }
-      break;
-    }
+  auto i = inflightRequests_.find(transactionId);
+  if (i == inflightRequests_.end() || (*i).second->remoteAddr != remoteAddr ||
+      (*i).second->remotePort != remotePort) {
+    return nullptr;
+  }
+  auto res = (*i).second;
+  if (remove) {
+    inflightRequests_.erase(i);
   }
   return res;
 }
@@ -490,7 +510,7 @@ UDPTrackerClient::getConnectionId(const std::string& remoteAddr,
     return nullptr;
   }
   if ((*i).second.state == UDPT_CST_CONNECTED &&
-      (*i).second.lastUpdated.difference(now) > 1_min) {
+      (*i).second.lastUpdated.difference(now) > UDPT_CONNECTION_ID_TIMEOUT) {
     connectionIdCache_.erase(i);
     return nullptr;
   }
@@ -528,12 +548,19 @@ struct FailConnectDelete {
 void UDPTrackerClient::failConnect(const std::string& remoteAddr,
                                    uint16_t remotePort, int error)
 {
-  connectionIdCache_.erase(std::make_pair(remoteAddr, remotePort));
+  auto key = std::make_pair(remoteAddr, remotePort);
+  connectionIdCache_.erase(key);
   // Fail all requests which are waiting for connection ID of the host.
-  connectRequests_.erase(
-      std::remove_if(connectRequests_.begin(), connectRequests_.end(),
-                     FailConnectDelete(remoteAddr, remotePort, error)),
-      connectRequests_.end());
+  auto i = connectRequests_.find(key);
+  if (i != connectRequests_.end()) {
+    auto& reqs = (*i).second;
+    reqs.erase(std::remove_if(std::begin(reqs), std::end(reqs),
+                              FailConnectDelete(remoteAddr, remotePort, error)),
+               std::end(reqs));
+    if (reqs.empty()) {
+      connectRequests_.erase(i);
+    }
+  }
   pendingRequests_.erase(
       std::remove_if(pendingRequests_.begin(), pendingRequests_.end(),
                      FailConnectDelete(remoteAddr, remotePort, error)),
@@ -543,15 +570,146 @@ void UDPTrackerClient::failConnect(const std::string& remoteAddr,
 void UDPTrackerClient::failAll()
 {
   int error = UDPT_ERR_SHUTDOWN;
-  failRequest(inflightRequests_.begin(), inflightRequests_.end(), error);
-  failRequest(pendingRequests_.begin(), pendingRequests_.end(), error);
-  failRequest(connectRequests_.begin(), connectRequests_.end(), error);
+  failRequest(inflightRequests_, error);
+  failRequest(pendingRequests_, error);
+  failRequest(connectRequests_, error);
 }
 
 void UDPTrackerClient::increaseWatchers() { ++numWatchers_; }
 
 void UDPTrackerClient::decreaseWatchers() { --numWatchers_; }
 
+bool UDPTrackerClient::save(const std::string& filename) const
+{
+  std::string tempfile = filename;
+  tempfile += "__temp";
+  {
+    BufferedFile fp(tempfile.c_str(), BufferedFile::WRITE);
+    if (!fp) {
+      A2_LOG_ERROR(fmt(MSG_OPENING_WRITABLE_UDP_TRACKER_CACHE_FILE_FAILED,
+                       filename.c_str()));
+      return false;
+    }
+    for (auto& e : connectionIdCache_) {
+      auto& c = e.second;
+      auto age = c.lastUpdated.difference(global::wallclock());
+      if (c.state != UDPT_CST_CONNECTED || age > UDPT_CONNECTION_ID_TIMEOUT) {
+        continue;
+      }
+      // Record the time when the connection ID was received in wall
+      // clock time, so that it can be validated after restart.
+      Time t;
+      t.advance(-age);
+      auto l = fmt("host=%s,port=%u,connection_id=%" PRId64 ",time=%" PRId64
+                   "\n",
+                   e.first.first.c_str(), e.first.second, c.connectionId,
+                   static_cast<int64_t>(t.getTimeFromEpoch()));
+      if (fp.write(l.data(), l.size()) != l.size()) {
+        A2_LOG_ERROR(fmt(MSG_WRITING_UDP_TRACKER_CACHE_FILE_FAILED,
+                         filename.c_str()));
+      }
+    }
+    if (fp.close() == EOF) {
+      A2_LOG_ERROR(
+          fmt(MSG_WRITING_UDP_TRACKER_CACHE_FILE_FAILED, filename.c_str()));
+      return false;
+    }
+  }
+  if (File(tempfile).renameTo(filename)) {
+    A2_LOG_NOTICE(fmt(MSG_UDP_TRACKER_CACHE_SAVED, filename.c_str()));
+    return true;
+  }
+  else {
+    A2_LOG_ERROR(
+        fmt(MSG_WRITING_UDP_TRACKER_CACHE_FILE_FAILED, filename.c_str()));
+    return false;
+  }
+}
+
+namespace {
+// Field and FIELD_NAMES must have same order except for MAX_FIELD.
+enum Field { U_CONNECTION_ID, U_HOST, U_PORT, U_TIME, MAX_FIELD };
+
+const char* FIELD_NAMES[] = {
+    "connection_id",
+    "host",
+    "port",
+    "time",
+};
+} // namespace
+
+namespace {
+int idField(std::string::const_iterator first, std::string::const_iterator last)
+{
+  int i;
+  for (i = 0; i < MAX_FIELD; ++i) {
+    if (util::streq(first, last, FIELD_NAMES[i])) {
+      return i;
+    }
+  }
+  return i;
+}
+} // namespace
+
+bool UDPTrackerClient::load(const std::string& filename)
+{
+  BufferedFile fp(filename.c_str(), BufferedFile::READ);
+  if (!fp) {
+    A2_LOG_ERROR(fmt(MSG_OPENING_READABLE_UDP_TRACKER_CACHE_FILE_FAILED,
+                     filename.c_str()));
+    return false;
+  }
+  auto now = Time().getTimeFromEpoch();
+  while (1) {
+    std::string line = fp.getLine();
+    if (line.empty()) {
+      if (fp.eof()) {
+        break;
+      }
+      else if (!fp) {
+        A2_LOG_ERROR(
+            fmt(MSG_READING_UDP_TRACKER_CACHE_FILE_FAILED, filename.c_str()));
+        return false;
+      }
+      else {
+        continue;
+      }
+    }
+    auto p = util::stripIter(line.begin(), line.end());
+    if (p.first == p.second) {
+      continue;
+    }
+    std::vector<Scip> items;
+    util::splitIter(p.first, p.second, std::back_inserter(items), ',');
+    std::vector<std::string> m(MAX_FIELD);
+    for (auto& item : items) {
+      auto kv = util::divide(item.first, item.second, '=');
+      int id = idField(kv.first.first, kv.first.second);
+      if (id != MAX_FIELD) {
+        m[id].assign(kv.second.first, kv.second.second);
+      }
+    }
+    uint32_t port;
+    int64_t connectionId, t;
+    if (m[U_HOST].empty() || !util::parseUIntNoThrow(port, m[U_PORT]) ||
+        port > UINT16_MAX ||
+        !util::parseLLIntNoThrow(connectionId, m[U_CONNECTION_ID]) ||
+        !util::parseLLIntNoThrow(t, m[U_TIME])) {
+      continue;
+    }
+    auto age = std::chrono::seconds(now - t);
+    if (age.count() < 0 || age > UDPT_CONNECTION_ID_TIMEOUT) {
+      continue;
+    }
+    Timer lastUpdated = global::wallclock();
+    lastUpdated.sub(age);
+    connectionIdCache_[std::make_pair(m[U_HOST], port)] =
+        UDPTrackerConnection(UDPT_CST_CONNECTED, connectionId, lastUpdated);
+  }
+  A2_LOG_NOTICE(fmt(MSG_UDP_TRACKER_CACHE_LOADED, filename.c_str()));
+  return true;
+}
+
 ssize_t createUDPTrackerConnect(unsigned char* data, size_t length,
                                 std::string& remoteAddr, uint16_t& remotePort,
                                 const std::shared_ptr<UDPTrackerRequest>& req)
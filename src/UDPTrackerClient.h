@@ -40,6 +40,8 @@
 #include <string>
 #include <deque>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include <memory>
 
 #include "TimerA2.h"
@@ -48,6 +50,10 @@ namespace aria2 {
 
 #define UDPT_INITIAL_CONNECTION_ID 0x41727101980LL
 
+// A connection ID may be used for this period after it was received
+// (BEP 15).
+constexpr auto UDPT_CONNECTION_ID_TIMEOUT = 1_min;
+
 struct UDPTrackerRequest;
 
 enum UDPTrackerConnectionState { UDPT_CST_CONNECTING, UDPT_CST_CONNECTED };
@@ -71,6 +77,15 @@ struct UDPTrackerConnection {
 
 class UDPTrackerClient {
 public:
+  // Requests waiting for a connection ID, keyed by tracker address
+  // and port.
+  typedef std::map<std::pair<std::string, uint16_t>,
+                   std::vector<std::shared_ptr<UDPTrackerRequest>>>
+      ConnectRequestMap;
+  // Requests sent to trackers, keyed by transaction ID.
+  typedef std::unordered_map<uint32_t, std::shared_ptr<UDPTrackerRequest>>
+      InflightRequestMap;
+
   UDPTrackerClient();
   ~UDPTrackerClient();
 
@@ -104,13 +119,11 @@ public:
   {
     return pendingRequests_;
   }
-  const std::deque<std::shared_ptr<UDPTrackerRequest>>&
-  getConnectRequests() const
+  const ConnectRequestMap& getConnectRequests() const
   {
     return connectRequests_;
   }
-  const std::deque<std::shared_ptr<UDPTrackerRequest>>&
-  getInflightRequests() const
+  const InflightRequestMap& getInflightRequests() const
   {
     return inflightRequests_;
   }
@@ -129,6 +142,14 @@ public:
   void increaseWatchers();
   void decreaseWatchers();
 
+  // Saves connection IDs, which are still valid, to |filename|.
+  bool save(const std::string& filename) const;
+
+  // Loads connection IDs from |filename|.  The connection IDs which
+  // were obtained more than UDPT_CONNECTION_ID_TIMEOUT ago are
+  // ignored.
+  bool load(const std::string& filename);
+
   // Actually private function, but made public, to be used by unnamed
   // function.
   void failConnect(const std::string& remoteAddr, uint16_t remotePort,
@@ -142,11 +163,14 @@ private:
   UDPTrackerConnection* getConnectionId(const std::string& remoteAddr,
                                         uint16_t remotePort, const Timer& now);
 
+  // Returns transaction ID which is not used by any inflight request.
+  uint32_t generateTransactionId() const;
+
   std::map<std::pair<std::string, uint16_t>, UDPTrackerConnection>
       connectionIdCache_;
-  std::deque<std::shared_ptr<UDPTrackerRequest>> inflightRequests_;
+  InflightRequestMap inflightRequests_;
   std::deque<std::shared_ptr<UDPTrackerRequest>> pendingRequests_;
-  std::deque<std::shared_ptr<UDPTrackerRequest>> connectRequests_;
+  ConnectRequestMap connectRequests_;
   int numWatchers_;
 };
 
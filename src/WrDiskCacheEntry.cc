@@ -41,6 +41,7 @@
 #include "DownloadFailureException.h"
 #include "LogFactory.h"
 #include "fmt.h"
+#include "BlockBufferPool.h"
 
 namespace aria2 {
 
@@ -67,7 +68,12 @@ WrDiskCacheEntry::~WrDiskCacheEntry()
 void WrDiskCacheEntry::deleteDataCells()
 {
   for (auto& e : set_) {
-    delete[] e->data;
+    if (e->pool) {
+      e->pool->release(e->data);
+    }
+    else {
+      delete[] e->data;
+    }
     delete e;
   }
   set_.clear();
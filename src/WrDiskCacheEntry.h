@@ -47,6 +47,7 @@ namespace aria2 {
 
 class DiskAdaptor;
 class WrDiskCache;
+class BlockBufferPool;
 
 class WrDiskCacheEntry {
 public:
@@ -60,6 +61,9 @@ public:
     size_t len;
     // valid memory range from data+offset
     size_t capacity;
+    // If not null, data was obtained from this pool and is returned
+    // to it.  Otherwise, data is deleted by delete[].
+    BlockBufferPool* pool;
     bool operator<(const DataCell& rhs) const { return goff < rhs.goff; }
   };
 
@@ -37,7 +37,9 @@
 
 #include "common.h"
 
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 
 namespace aria2 {
@@ -62,9 +64,35 @@ public:
 };
 
 // Expression Template for array
+//
+// Expressions over byte arrays can also be evaluated 8 bytes at a
+// time using word(i), which returns elements [i, i+8) as a 64 bits
+// word in host byte order.  The caller must make sure that these
+// elements exist.
 
 namespace expr {
 
+template <typename T> struct bit_neg {
+  typedef T result_type;
+
+  T operator()(T t) const { return ~t; }
+};
+
+// Maps the operation on elements to the same operation on words.
+template <typename Op> struct word_op;
+
+template <typename T> struct word_op<std::bit_and<T>> {
+  typedef std::bit_and<uint64_t> type;
+};
+
+template <typename T> struct word_op<std::bit_or<T>> {
+  typedef std::bit_or<uint64_t> type;
+};
+
+template <typename T> struct word_op<bit_neg<T>> {
+  typedef bit_neg<uint64_t> type;
+};
+
 template <typename L, typename R, typename Op> struct BinExpr {
   typedef typename Op::result_type value_type;
 
@@ -75,6 +103,11 @@ template <typename L, typename R, typename Op> struct BinExpr {
 
   value_type operator[](size_t i) const { return op(lhs[i], rhs[i]); }
 
+  uint64_t word(size_t i) const
+  {
+    return typename word_op<Op>::type()(lhs.word(i), rhs.word(i));
+  }
+
   L lhs;
   R rhs;
   Op op;
@@ -101,14 +134,15 @@ template <typename Arg, typename Op> struct UnExpr {
 
   value_type operator[](size_t i) const { return op(arg[i]); }
 
+  uint64_t word(size_t i) const
+  {
+    return typename word_op<Op>::type()(arg.word(i));
+  }
+
   Arg arg;
   Op op;
 };
 
-template <typename T> struct bit_neg : std::function<T(T)> {
-  T operator()(T t) const { return ~t; }
-};
-
 template <typename Arg, typename Op = bit_neg<typename Arg::value_type>>
 UnExpr<Arg, Op> operator~(Arg arg)
 {
@@ -122,6 +156,14 @@ template <typename T> struct Array {
 
   T operator[](size_t i) const { return t[i]; }
 
+  uint64_t word(size_t i) const
+  {
+    static_assert(sizeof(T) == 1, "word() requires byte array");
+    uint64_t w;
+    memcpy(&w, t + i, sizeof(w));
+    return w;
+  }
+
   T* t;
 };
 
@@ -34,10 +34,73 @@
 /* copyright --> */
 #include "bitfield.h"
 
+// POPCNT is not part of the baseline x86 instruction set.  If the
+// compiler was not told to use it, countSetBitWords() checks for it
+// at runtime.
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(__POPCNT__) &&    \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#  define BITFIELD_POPCNT_DISPATCH 1
+#endif // (__x86_64__ || __i386__) && !__POPCNT__ && ...
+
 namespace aria2 {
 
 namespace bitfield {
 
+namespace {
+size_t countSetBitWordsGeneric(const unsigned char* bitfield, size_t nwords)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < nwords; ++i) {
+    uint64_t v;
+    memcpy(&v, bitfield + i * sizeof(v), sizeof(v));
+    count += countBit64(v);
+  }
+  return count;
+}
+
+#ifdef BITFIELD_POPCNT_DISPATCH
+__attribute__((target("popcnt"))) size_t
+countSetBitWordsPopcnt(const unsigned char* bitfield, size_t nwords)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < nwords; ++i) {
+    uint64_t v;
+    memcpy(&v, bitfield + i * sizeof(v), sizeof(v));
+    count += __builtin_popcountll(v);
+  }
+  return count;
+}
+#endif // BITFIELD_POPCNT_DISPATCH
+} // namespace
+
+size_t countSetBitWords(const unsigned char* bitfield, size_t nwords)
+{
+#ifdef BITFIELD_POPCNT_DISPATCH
+  static const bool popcnt = __builtin_cpu_supports("popcnt");
+  if (popcnt) {
+    return countSetBitWordsPopcnt(bitfield, nwords);
+  }
+#endif // BITFIELD_POPCNT_DISPATCH
+  return countSetBitWordsGeneric(bitfield, nwords);
+}
+
+size_t countSetBit(const unsigned char* bitfield, size_t nbits)
+{
+  if (nbits == 0) {
+    return 0;
+  }
+  size_t len = (nbits + 7) / 8;
+  // Leave at least the last byte, which needs masking, for the loop
+  // below.
+  size_t nwords = (len - 1) / 8;
+  size_t count = countSetBitWords(bitfield, nwords);
+  for (size_t i = nwords * 8; i < len - 1; ++i) {
+    count += cntbits[bitfield[i]];
+  }
+  count += cntbits[bitfield[len - 1] & lastByteMask(nbits)];
+  return count;
+}
+
 void flipBit(unsigned char* data, size_t length, size_t bitIndex)
 {
   size_t byteIndex = bitIndex / 8;
@@ -37,11 +37,13 @@
 
 #include "common.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
 
 #include "util.h"
+#include "array_fun.h"
 
 namespace aria2 {
 
@@ -94,34 +96,91 @@ inline size_t countBit32(uint32_t n)
          cntbits[(n >> 16) & 0xffu] + cntbits[(n >> 24) & 0xffu];
 }
 
-// Counts set bit in bitfield.
-inline size_t countSetBit(const unsigned char* bitfield, size_t nbits)
+inline size_t countBit64(uint64_t n)
 {
-  if (nbits == 0) {
-    return 0;
-  }
+#ifdef __GNUC__
+  return __builtin_popcountll(n);
+#else  // !__GNUC__
+  n = n - ((n >> 1) & 0x5555555555555555ULL);
+  n = (n & 0x3333333333333333ULL) + ((n >> 2) & 0x3333333333333333ULL);
+  n = (n + (n >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (n * 0x0101010101010101ULL) >> 56;
+#endif // !__GNUC__
+}
+
+// Returns the number of leading zero bits of n, which must not be 0.
+inline size_t countLeadingZero64(uint64_t n)
+{
+  assert(n);
+#ifdef __GNUC__
+  return __builtin_clzll(n);
+#else  // !__GNUC__
   size_t count = 0;
-  size_t size = sizeof(uint32_t);
-  size_t len = (nbits + 7) / 8;
-  if (nbits % 32 != 0) {
-    --len;
-    count +=
-        countBit32(static_cast<uint32_t>(bitfield[len] & lastByteMask(nbits)));
+  for (; !(n & 0x8000000000000000ULL); n <<= 1) {
+    ++count;
   }
-  size_t to = len / size;
-  for (size_t i = 0; i < to; ++i) {
-    uint32_t v;
-    memcpy(&v, &bitfield[i * size], sizeof(v));
-    count += countBit32(v);
+  return count;
+#endif // !__GNUC__
+}
+
+// Returns bytes [i, i+8) of bitfield as a word in host byte order.
+// Use ntoh64() to get a word whose most significant bit is bit index
+// i*8.  Array template expressions are evaluated 8 bytes at once.
+template <typename Array> uint64_t loadWord(const Array& bitfield, size_t i)
+{
+  unsigned char bytes[8];
+  for (size_t j = 0; j < 8; ++j) {
+    bytes[j] = bitfield[i + j];
   }
-  for (size_t i = len - len % size; i < len; ++i) {
-    count += countBit32(static_cast<uint32_t>(bitfield[i]));
+  uint64_t w;
+  memcpy(&w, bytes, sizeof(w));
+  return w;
+}
+
+template <typename L, typename R, typename Op>
+uint64_t loadWord(const expr::BinExpr<L, R, Op>& bitfield, size_t i)
+{
+  return bitfield.word(i);
+}
+
+template <typename Arg, typename Op>
+uint64_t loadWord(const expr::UnExpr<Arg, Op>& bitfield, size_t i)
+{
+  return bitfield.word(i);
+}
+
+template <typename T>
+uint64_t loadWord(const expr::Array<T>& bitfield, size_t i)
+{
+  return bitfield.word(i);
+}
+
+// Like loadWord(), but bitfield has len bytes, and missing bytes are
+// read as 0.
+template <typename Array>
+uint64_t getWord(const Array& bitfield, size_t i, size_t len)
+{
+  if (i + 8 <= len) {
+    return loadWord(bitfield, i);
   }
-  return count;
+  unsigned char bytes[8] = {};
+  for (size_t j = 0; i + j < len; ++j) {
+    bytes[j] = bitfield[i + j];
+  }
+  uint64_t w;
+  memcpy(&w, bytes, sizeof(w));
+  return w;
 }
 
+// Counts set bit in the first nwords * 64 bits of bitfield.
+size_t countSetBitWords(const unsigned char* bitfield, size_t nwords);
+
+// Counts set bit in bitfield.
+size_t countSetBit(const unsigned char* bitfield, size_t nbits);
+
 // Counts set bit in bitfield. This is a bit slower than countSetBit
-// but can accept array template expression as bitfield.
+// but can accept array template expression as bitfield, which is
+// evaluated in one pass, 64 bits at a time.
 template <typename Array>
 size_t countSetBitSlow(const Array& bitfield, size_t nbits)
 {
@@ -129,31 +188,88 @@ size_t countSetBitSlow(const Array& bitfield, size_t nbits)
     return 0;
   }
   size_t count = 0;
-  size_t to = (nbits + 7) / 8;
-  if (to > 1) {
-    for (size_t i = 0; i < to - 1; ++i) {
-      count += cntbits[static_cast<unsigned char>(bitfield[i])];
+  size_t len = (nbits + 7) / 8;
+  size_t i = 0;
+  // Evaluate bitfield into buf, and count its bits with
+  // countSetBitWords(), which uses the fastest method available.
+  uint64_t buf[64];
+  while (i + 8 < len) {
+    size_t n = std::min((len - 1 - i) / 8, arraySize(buf));
+    for (size_t j = 0; j < n; ++j, i += 8) {
+      buf[j] = loadWord(bitfield, i);
     }
+    count += countSetBitWords(reinterpret_cast<unsigned char*>(buf), n);
   }
-  count += cntbits[static_cast<unsigned char>(bitfield[to - 1]) &
+  for (; i < len - 1; ++i) {
+    count += cntbits[static_cast<unsigned char>(bitfield[i])];
+  }
+  count += cntbits[static_cast<unsigned char>(bitfield[len - 1]) &
                    lastByteMask(nbits)];
   return count;
 }
 
 void flipBit(unsigned char* data, size_t length, size_t bitIndex);
 
+// Returns the smallest set bit index in bitfield, or in its
+// complement if invert is true, which is equal to or greater than
+// index.  bitfield contains nbits.  If no such bit is found, returns
+// nbits.
+template <bool invert, typename Array>
+size_t nextBit(const Array& bitfield, size_t nbits, size_t index)
+{
+  if (index >= nbits) {
+    return nbits;
+  }
+  const size_t len = (nbits + 7) / 8;
+  const uint64_t x = invert ? ~0ULL : 0;
+  size_t i = index / 64 * 8;
+  uint64_t w = (getWord(bitfield, i, len) ^ x) & hton64(~0ULL >> (index % 64));
+  while (!w) {
+    i += 8;
+    if (i + 8 <= len) {
+      w = loadWord(bitfield, i) ^ x;
+    }
+    else if (i < len) {
+      // Inverted padding bits are found after the last bit, and
+      // clipped below.
+      w = getWord(bitfield, i, len) ^ x;
+    }
+    else {
+      return nbits;
+    }
+  }
+  return std::min(i * 8 + countLeadingZero64(ntoh64(w)), nbits);
+}
+
+// Returns the smallest set bit index in bitfield which is equal to or
+// greater than index.  bitfield contains nbits.  If no such bit is
+// found, returns nbits.
+template <typename Array>
+size_t nextSetBit(const Array& bitfield, size_t nbits, size_t index)
+{
+  return nextBit<false>(bitfield, nbits, index);
+}
+
+// Returns the smallest unset bit index in bitfield which is equal to
+// or greater than index.  bitfield contains nbits.  If no such bit is
+// found, returns nbits.
+template <typename Array>
+size_t nextUnsetBit(const Array& bitfield, size_t nbits, size_t index)
+{
+  return nextBit<true>(bitfield, nbits, index);
+}
+
 // Stores first set bit index of bitfield to index.  bitfield contains
 // nbits. Returns true if set bit is found. Otherwise returns false.
 template <typename Array>
 bool getFirstSetBitIndex(size_t& index, const Array& bitfield, size_t nbits)
 {
-  for (size_t i = 0; i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      index = i;
-      return true;
-    }
+  size_t i = nextSetBit(bitfield, nbits, 0);
+  if (i == nbits) {
+    return false;
   }
-  return false;
+  index = i;
+  return true;
 }
 
 // Appends first at most n set bit index in bitfield to out.  bitfield
@@ -162,19 +278,15 @@ template <typename Array, typename OutputIterator>
 size_t getFirstNSetBitIndex(OutputIterator out, size_t n, const Array& bitfield,
                             size_t nbits)
 {
-  if (n == 0) {
-    return 0;
-  }
-  const size_t origN = n;
-  for (size_t i = 0; i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      *out++ = i;
-      if (--n == 0) {
-        break;
-      }
+  size_t count = 0;
+  for (size_t i = 0; count < n; ++i, ++count) {
+    i = nextSetBit(bitfield, nbits, i);
+    if (i == nbits) {
+      break;
     }
+    *out++ = i;
   }
-  return origN - n;
+  return count;
 }
 
 } // namespace bitfield
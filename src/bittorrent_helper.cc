@@ -62,6 +62,7 @@
 #include "array_fun.h"
 #include "DownloadFailureException.h"
 #include "ValueBaseBencodeParser.h"
+#include "Piece.h"
 
 namespace aria2 {
 
@@ -677,6 +678,22 @@ std::vector<size_t> computeFastSet(const std::string& ipaddr, size_t numPieces,
   return fastSet;
 }
 
+size_t calculateRequestQueueDepth(int speed, Timer::Clock::duration rtt,
+                                  size_t reqq)
+{
+  auto usec =
+      std::chrono::duration_cast<std::chrono::microseconds>(rtt).count();
+  auto bdp = static_cast<int64_t>(speed) * usec / 1000000;
+  auto depth = static_cast<int64_t>(DEFAULT_MAX_OUTSTANDING_REQUEST);
+  depth = std::max(depth, (bdp + Piece::BLOCK_LENGTH - 1) /
+                              Piece::BLOCK_LENGTH * 2);
+  auto ub = static_cast<int64_t>(UB_MAX_OUTSTANDING_REQUEST);
+  if (reqq > 0) {
+    ub = std::min(ub, static_cast<int64_t>(reqq));
+  }
+  return std::min(depth, ub);
+}
+
 std::string generatePeerId(const std::string& peerIdPrefix)
 {
   std::string peerId = peerIdPrefix;
@@ -154,6 +154,15 @@ std::vector<size_t> computeFastSet(const std::string& ipaddr, size_t numPieces,
                                    const unsigned char* infoHash,
                                    size_t fastSetSize);
 
+// Returns the number of requests to keep outstanding to a peer which
+// sends speed bytes per second with minimum request round trip time
+// rtt.  This is twice the bandwidth-delay product in blocks, so that
+// the measured speed is not limited by the queue itself.  The result
+// is at least DEFAULT_MAX_OUTSTANDING_REQUEST and at most
+// UB_MAX_OUTSTANDING_REQUEST, or reqq if it is not 0.
+size_t calculateRequestQueueDepth(int speed, Timer::Clock::duration rtt,
+                                  size_t reqq);
+
 // Make sure that don't receive return value into std::shared_ptr.
 TorrentAttribute* getTorrentAttrs(DownloadContext* dctx);
 TorrentAttribute* getTorrentAttrs(const std::shared_ptr<DownloadContext>& dctx);
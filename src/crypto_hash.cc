@@ -10,6 +10,15 @@
 #include <stdexcept>
 #include <unordered_map>
 
+// x86 SHA extensions. Kernels are compiled with target attributes and
+// selected at runtime, so the rest of the file does not require them.
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#  define __hash_have_sha_ni 1
+#  include <cpuid.h>
+#  include <immintrin.h>
+#endif // (__x86_64__ || __i386__) && (__clang__ || __GNUC__ >= 5)
+
 // Compiler hints
 #if defined(__GNUG__)
 #  define likely(x) __builtin_expect(!!(x), 1)
@@ -93,6 +102,15 @@ protected:
 
   virtual void transform(const word_t* buffer) = 0;
 
+  // |transform| |blocks| consecutive blocks.  Implementations which can
+  // keep the state in registers across blocks override this.
+  virtual void transformBlocks(const uint8_t* bytes, uint64_t blocks)
+  {
+    for (; blocks; --blocks, bytes += sizeof(buffer_)) {
+      transform(reinterpret_cast<const word_t*>(bytes));
+    }
+  }
+
   virtual std::string digest()
   {
     return std::string((const char*)state_.bytes, sizeof(state_.bytes));
@@ -125,13 +143,14 @@ public:
     }
 
     // |transform| as many blocks as possible.
-    while (len >= sizeof(buffer_)) {
+    if (len >= sizeof(buffer_)) {
       // |offset_| has to be 0 at this point!
       // Which is guaranteed by the block above.
 
-      transform(reinterpret_cast<const word_t*>(bytes));
-      bytes += sizeof(buffer_);
-      len -= sizeof(buffer_);
+      const uint64_t blocks = len / sizeof(buffer_);
+      transformBlocks(bytes, blocks);
+      bytes += blocks * sizeof(buffer_);
+      len -= blocks * sizeof(buffer_);
     }
 
     // Buffer remaining bytes, if any.
@@ -1024,6 +1043,211 @@ const SHA384::word_t SHA384::initvec[] = {
     0x152fecd8f70e5939, 0x67332667ffc00b31, 0x8eb44a8768581511,
     0xdb0c2e0d64f98fa7, 0x47b5481dbefa4fa4};
 
+#ifdef __hash_have_sha_ni
+// SHA-1 and SHA-256 using the x86 SHA extensions, following the
+// instruction sequences in Intel's "Intel SHA Extensions" white paper.
+
+static bool cpuSupportsSHANI()
+{
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  // SSSE3 and SSE4.1 are used for byte shuffles and blends.
+  if (!(ecx & (1 << 9)) || !(ecx & (1 << 19))) {
+    return false;
+  }
+  if (__get_cpuid_max(0, nullptr) < 7) {
+    return false;
+  }
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  return ebx & (1 << 29);
+}
+
+// Schedules message words 4(g+1)...4(g+1)+3 while doing rounds 4g...
+#define __hash_sha1_ni_msg(g, mp, mc, mn, mx)                                  \
+  if (g >= 3 && g <= 18)                                                       \
+    mn = _mm_sha1msg2_epu32(mn, mc);                                           \
+  if (g >= 1 && g <= 16)                                                       \
+    mp = _mm_sha1msg1_epu32(mp, mc);                                           \
+  if (g >= 2 && g <= 17)                                                       \
+  mx = _mm_xor_si128(mx, mc)
+
+#define __hash_sha1_ni_rounds(g, ein, eout, mp, mc, mn, mx)                    \
+  ein = _mm_sha1nexte_epu32(ein, mc);                                          \
+  eout = abcd;                                                                 \
+  __hash_sha1_ni_msg(g, mp, mc, mn, mx);                                       \
+  abcd = _mm_sha1rnds4_epu32(abcd, ein, g / 5)
+
+__attribute__((target("sha,sse4.1"))) static void
+sha1NITransform(uint32_t* state, const uint8_t* data, uint64_t blocks)
+{
+  const __m128i mask =
+      _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+  __m128i abcd, abcd_save, e0, e0_save, e1;
+  __m128i m0, m1, m2, m3;
+
+  abcd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+  e0 = _mm_set_epi32(state[4], 0, 0, 0);
+  abcd = _mm_shuffle_epi32(abcd, 0x1b);
+
+  for (; blocks; --blocks, data += 64) {
+    abcd_save = abcd;
+    e0_save = e0;
+
+    m0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    m0 = _mm_shuffle_epi8(m0, mask);
+    m1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+    m1 = _mm_shuffle_epi8(m1, mask);
+    m2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32));
+    m2 = _mm_shuffle_epi8(m2, mask);
+    m3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48));
+    m3 = _mm_shuffle_epi8(m3, mask);
+
+    // Rounds 0-3
+    e0 = _mm_add_epi32(e0, m0);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+    __hash_sha1_ni_rounds(1, e1, e0, m0, m1, m2, m3);
+    __hash_sha1_ni_rounds(2, e0, e1, m1, m2, m3, m0);
+    __hash_sha1_ni_rounds(3, e1, e0, m2, m3, m0, m1);
+    __hash_sha1_ni_rounds(4, e0, e1, m3, m0, m1, m2);
+    __hash_sha1_ni_rounds(5, e1, e0, m0, m1, m2, m3);
+    __hash_sha1_ni_rounds(6, e0, e1, m1, m2, m3, m0);
+    __hash_sha1_ni_rounds(7, e1, e0, m2, m3, m0, m1);
+    __hash_sha1_ni_rounds(8, e0, e1, m3, m0, m1, m2);
+    __hash_sha1_ni_rounds(9, e1, e0, m0, m1, m2, m3);
+    __hash_sha1_ni_rounds(10, e0, e1, m1, m2, m3, m0);
+    __hash_sha1_ni_rounds(11, e1, e0, m2, m3, m0, m1);
+    __hash_sha1_ni_rounds(12, e0, e1, m3, m0, m1, m2);
+    __hash_sha1_ni_rounds(13, e1, e0, m0, m1, m2, m3);
+    __hash_sha1_ni_rounds(14, e0, e1, m1, m2, m3, m0);
+    __hash_sha1_ni_rounds(15, e1, e0, m2, m3, m0, m1);
+    __hash_sha1_ni_rounds(16, e0, e1, m3, m0, m1, m2);
+    __hash_sha1_ni_rounds(17, e1, e0, m0, m1, m2, m3);
+    __hash_sha1_ni_rounds(18, e0, e1, m1, m2, m3, m0);
+    __hash_sha1_ni_rounds(19, e1, e0, m2, m3, m0, m1);
+
+    e0 = _mm_sha1nexte_epu32(e0, e0_save);
+    abcd = _mm_add_epi32(abcd, abcd_save);
+  }
+
+  abcd = _mm_shuffle_epi32(abcd, 0x1b);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), abcd);
+  state[4] = _mm_extract_epi32(e0, 3);
+}
+
+#undef __hash_sha1_ni_rounds
+#undef __hash_sha1_ni_msg
+
+static const uint32_t sha256NIK[] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+// Rounds 4g...4g+3, scheduling message words for the following rounds.
+#define __hash_sha256_ni_rounds(g, mp, mc, mn)                                 \
+  msg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256NIK + 4 * g));  \
+  msg = _mm_add_epi32(msg, mc);                                                \
+  state1 = _mm_sha256rnds2_epu32(state1, state0, msg);                         \
+  if (g >= 3 && g <= 14) {                                                     \
+    tmp = _mm_alignr_epi8(mc, mp, 4);                                          \
+    mn = _mm_add_epi32(mn, tmp);                                               \
+    mn = _mm_sha256msg2_epu32(mn, mc);                                         \
+  }                                                                            \
+  msg = _mm_shuffle_epi32(msg, 0x0e);                                          \
+  state0 = _mm_sha256rnds2_epu32(state0, state1, msg);                         \
+  if (g >= 1 && g <= 12)                                                       \
+  mp = _mm_sha256msg1_epu32(mp, mc)
+
+__attribute__((target("sha,sse4.1"))) static void
+sha256NITransform(uint32_t* state, const uint8_t* data, uint64_t blocks)
+{
+  const __m128i mask =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  __m128i state0, state1, abef_save, cdgh_save;
+  __m128i msg, tmp;
+  __m128i m0, m1, m2, m3;
+
+  tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+  state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4));
+  tmp = _mm_shuffle_epi32(tmp, 0xb1);          // CDAB
+  state1 = _mm_shuffle_epi32(state1, 0x1b);    // EFGH
+  state0 = _mm_alignr_epi8(tmp, state1, 8);    // ABEF
+  state1 = _mm_blend_epi16(state1, tmp, 0xf0); // CDGH
+
+  for (; blocks; --blocks, data += 64) {
+    abef_save = state0;
+    cdgh_save = state1;
+
+    m0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    m0 = _mm_shuffle_epi8(m0, mask);
+    m1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+    m1 = _mm_shuffle_epi8(m1, mask);
+    m2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32));
+    m2 = _mm_shuffle_epi8(m2, mask);
+    m3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48));
+    m3 = _mm_shuffle_epi8(m3, mask);
+
+    __hash_sha256_ni_rounds(0, m3, m0, m1);
+    __hash_sha256_ni_rounds(1, m0, m1, m2);
+    __hash_sha256_ni_rounds(2, m1, m2, m3);
+    __hash_sha256_ni_rounds(3, m2, m3, m0);
+    __hash_sha256_ni_rounds(4, m3, m0, m1);
+    __hash_sha256_ni_rounds(5, m0, m1, m2);
+    __hash_sha256_ni_rounds(6, m1, m2, m3);
+    __hash_sha256_ni_rounds(7, m2, m3, m0);
+    __hash_sha256_ni_rounds(8, m3, m0, m1);
+    __hash_sha256_ni_rounds(9, m0, m1, m2);
+    __hash_sha256_ni_rounds(10, m1, m2, m3);
+    __hash_sha256_ni_rounds(11, m2, m3, m0);
+    __hash_sha256_ni_rounds(12, m3, m0, m1);
+    __hash_sha256_ni_rounds(13, m0, m1, m2);
+    __hash_sha256_ni_rounds(14, m1, m2, m3);
+    __hash_sha256_ni_rounds(15, m2, m3, m0);
+
+    state0 = _mm_add_epi32(state0, abef_save);
+    state1 = _mm_add_epi32(state1, cdgh_save);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1b);       // FEBA
+  state1 = _mm_shuffle_epi32(state1, 0xb1);    // DCHG
+  state0 = _mm_blend_epi16(tmp, state1, 0xf0); // DCBA
+  state1 = _mm_alignr_epi8(state1, tmp, 8);    // ABEF
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+
+#undef __hash_sha256_ni_rounds
+
+template <typename Base, void (*kernel)(uint32_t*, const uint8_t*, uint64_t)>
+class SHANI : public Base {
+protected:
+  virtual void transform(const typename Base::word_t* buffer)
+  {
+    kernel(this->state_.words, reinterpret_cast<const uint8_t*>(buffer), 1);
+  }
+
+  virtual void transformBlocks(const uint8_t* bytes, uint64_t blocks)
+  {
+    kernel(this->state_.words, bytes, blocks);
+  }
+};
+
+typedef SHANI<SHA1, sha1NITransform> SHA1NI;
+typedef SHANI<SHA224, sha256NITransform> SHA224NI;
+typedef SHANI<SHA256, sha256NITransform> SHA256NI;
+#endif // __hash_have_sha_ni
+
 namespace {
 // For |all|
 static const std::set<std::string> names{
@@ -1052,8 +1276,65 @@ Algorithms crypto::hash::lookup(const std::string& name)
   return i->second;
 }
 
-std::unique_ptr<Algorithm> crypto::hash::create(Algorithms algo)
+bool crypto::hash::supported(Implementations impl)
+{
+  switch (impl) {
+  case implAuto:
+  case implGeneric:
+    return true;
+
+  case implSHANI: {
+#ifdef __hash_have_sha_ni
+    static const bool rv = cpuSupportsSHANI();
+    return rv;
+#else  // !__hash_have_sha_ni
+    return false;
+#endif // !__hash_have_sha_ni
+  }
+
+  default:
+    return false;
+  }
+}
+
+const char* crypto::hash::name(Implementations impl)
 {
+  switch (impl) {
+  case implAuto:
+    return "auto";
+
+  case implGeneric:
+    return "generic";
+
+  case implSHANI:
+    return "sha-ni";
+
+  default:
+    return "unknown";
+  }
+}
+
+std::unique_ptr<Algorithm> crypto::hash::create(Algorithms algo,
+                                                 Implementations impl)
+{
+#ifdef __hash_have_sha_ni
+  if ((impl == implAuto || impl == implSHANI) && supported(implSHANI)) {
+    switch (algo) {
+    case algoSHA1:
+      return aria2::make_unique<SHA1NI>();
+
+    case algoSHA224:
+      return aria2::make_unique<SHA224NI>();
+
+    case algoSHA256:
+      return aria2::make_unique<SHA256NI>();
+
+    default:
+      break;
+    }
+  }
+#endif // __hash_have_sha_ni
+
   switch (algo) {
   case algoMD5:
     return aria2::make_unique<MD5>();
@@ -25,6 +25,16 @@ enum Algorithms {
   algoSHA512 = 0x6,
 };
 
+// Implementations of the algorithms.  implAuto selects the fastest
+// one supported by the running CPU.
+enum Implementations {
+  implAuto = 0x0,
+  // Portable C++ implementation of all algorithms.
+  implGeneric = 0x1,
+  // x86 SHA extensions.  Only SHA-1, SHA-224 and SHA-256.
+  implSHANI = 0x2,
+};
+
 class Algorithm {
 public:
   Algorithm() = default;
@@ -56,7 +66,21 @@ const std::set<std::string>& all();
 
 Algorithms lookup(const std::string& name);
 
-std::unique_ptr<Algorithm> create(Algorithms algo);
+// Returns true if impl can be used on the running CPU.
+bool supported(Implementations impl);
+
+// Returns the human readable name of impl, e.g. "generic".
+const char* name(Implementations impl);
+
+// Creates algo using impl.  If impl does not support algo, or the
+// running CPU does not support impl, the generic implementation is
+// used.
+std::unique_ptr<Algorithm> create(Algorithms algo, Implementations impl);
+
+inline std::unique_ptr<Algorithm> create(Algorithms algo)
+{
+  return create(algo, implAuto);
+}
 
 inline std::unique_ptr<Algorithm> create(const std::string& name)
 {
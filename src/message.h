@@ -63,6 +63,8 @@
 #define MSG_NAME_RESOLUTION_FAILED                      \
   "CUID#%" PRId64 " - Name resolution for %s failed:%s"
 #define MSG_DNS_CACHE_HIT "CUID#%" PRId64 " - DNS cache hit: %s -> %s"
+#define MSG_DNS_NEGATIVE_CACHE_HIT                      \
+  "CUID#%" PRId64 " - DNS negative cache hit: %s"
 #define MSG_CONNECTING_TO_PEER "CUID#%" PRId64 " - Connecting to the peer %s"
 #define MSG_PIECE_RECEIVED                                              \
   "CUID#%" PRId64 " - Piece received. index=%lu, begin=%d, length=%d, offset=%" PRId64 "," \
@@ -169,6 +171,28 @@
 #define MSG_SERVER_STAT_SAVED _("ServerStat file %s saved successfully.")
 #define MSG_WRITING_SERVER_STAT_FILE_FAILED _("Failed to write ServerStat to" \
                                               " %s.")
+#define MSG_OPENING_READABLE_DNS_CACHE_FILE_FAILED      \
+  _("Failed to open DNS cache file %s for read.")
+#define MSG_DNS_CACHE_LOADED _("DNS cache file %s loaded successfully.")
+#define MSG_READING_DNS_CACHE_FILE_FAILED _("Failed to read DNS cache from" \
+                                            " %s.")
+#define MSG_OPENING_WRITABLE_DNS_CACHE_FILE_FAILED      \
+  _("Failed to open DNS cache file %s for write.")
+#define MSG_DNS_CACHE_SAVED _("DNS cache file %s saved successfully.")
+#define MSG_WRITING_DNS_CACHE_FILE_FAILED _("Failed to write DNS cache to" \
+                                            " %s.")
+#define MSG_OPENING_READABLE_UDP_TRACKER_CACHE_FILE_FAILED      \
+  _("Failed to open UDP tracker cache file %s for read.")
+#define MSG_UDP_TRACKER_CACHE_LOADED                            \
+  _("UDP tracker cache file %s loaded successfully.")
+#define MSG_READING_UDP_TRACKER_CACHE_FILE_FAILED               \
+  _("Failed to read UDP tracker cache from %s.")
+#define MSG_OPENING_WRITABLE_UDP_TRACKER_CACHE_FILE_FAILED      \
+  _("Failed to open UDP tracker cache file %s for write.")
+#define MSG_UDP_TRACKER_CACHE_SAVED                             \
+  _("UDP tracker cache file %s saved successfully.")
+#define MSG_WRITING_UDP_TRACKER_CACHE_FILE_FAILED               \
+  _("Failed to write UDP tracker cache to %s.")
 #define MSG_ESTABLISHING_CONNECTION_FAILED              \
   _("Failed to establish connection, cause: %s")
 #define MSG_NETWORK_PROBLEM _("Network problem has occurred. cause:%s")
@@ -185,6 +209,9 @@
 #define MSG_WARN_NO_CA_CERT                                             \
   _("You may encounter the certificate verification error with HTTPS server." \
     " See --ca-certificate and --check-certificate option.")
+#define MSG_KERNEL_TLS_NOT_SUPPORTED                                    \
+  _("Kernel TLS is not supported by the SSL/TLS library. Ignoring"      \
+    " --enable-kernel-tls option.")
 #define MSG_WARN_UNKNOWN_TLS_CONNECTION \
   _("aria2c had to connect to the other side using an unknown TLS protocol. " \
     "The integrity and confidentiality of the connection might be " \
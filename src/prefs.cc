@@ -137,6 +137,7 @@ const std::string V_FEEDBACK("feedback");
 const std::string V_ADAPTIVE("adaptive");
 const std::string V_LIBUV("libuv");
 const std::string V_EPOLL("epoll");
+const std::string V_IO_URING("io_uring");
 const std::string V_KQUEUE("kqueue");
 const std::string V_PORT("port");
 const std::string V_POLL("poll");
@@ -165,6 +166,14 @@ PrefPtr PREF_TIMEOUT = makePref("timeout");
 // values: 1*digit
 PrefPtr PREF_DNS_TIMEOUT = makePref("dns-timeout");
 // values: 1*digit
+PrefPtr PREF_DNS_CACHE_SIZE = makePref("dns-cache-size");
+// values: 1*digit
+PrefPtr PREF_DNS_CACHE_TTL = makePref("dns-cache-ttl");
+// values: 1*digit
+PrefPtr PREF_DNS_NEGATIVE_CACHE_TTL = makePref("dns-negative-cache-ttl");
+// values: a string that your file system recognizes as a file name.
+PrefPtr PREF_DNS_CACHE_FILE = makePref("dns-cache-file");
+// values: 1*digit
 PrefPtr PREF_CONNECT_TIMEOUT = makePref("connect-timeout");
 // values: 1*digit
 PrefPtr PREF_MAX_TRIES = makePref("max-tries");
@@ -192,6 +201,8 @@ PrefPtr PREF_MAX_OVERALL_DOWNLOAD_LIMIT =
 // value: 1*digit
 PrefPtr PREF_MAX_DOWNLOAD_LIMIT = makePref("max-download-limit");
 // value: 1*digit
+PrefPtr PREF_BANDWIDTH_WEIGHT = makePref("bandwidth-weight");
+// value: 1*digit
 PrefPtr PREF_STARTUP_IDLE_TIME = makePref("startup-idle-time");
 // value: prealloc | fallc | none
 PrefPtr PREF_FILE_ALLOCATION = makePref("file-allocation");
@@ -217,6 +228,9 @@ PrefPtr PREF_INPUT_FILE = makePref("input-file");
 PrefPtr PREF_DEFERRED_INPUT = makePref("deferred-input");
 // value: 1*digit
 PrefPtr PREF_MAX_CONCURRENT_DOWNLOADS = makePref("max-concurrent-downloads");
+// value: 1*digit
+PrefPtr PREF_MAX_CONCURRENT_INTEGRITY_CHECKS =
+    makePref("max-concurrent-integrity-checks");
 // value: true | false | A:B
 PrefPtr PREF_OPTIMIZE_CONCURRENT_DOWNLOADS =
     makePref("optimize-concurrent-downloads");
@@ -340,6 +354,8 @@ PrefPtr PREF_PAUSE = makePref("pause");
 PrefPtr PREF_DOWNLOAD_RESULT = makePref("download-result");
 // value: true | false
 PrefPtr PREF_HASH_CHECK_ONLY = makePref("hash-check-only");
+// value: 1*digit
+PrefPtr PREF_HASH_CHECK_THREADS = makePref("hash-check-threads");
 // values: hashType=digest
 PrefPtr PREF_CHECKSUM = makePref("checksum");
 // value: pid
@@ -368,6 +384,10 @@ PrefPtr PREF_RLIMIT_NOFILE = makePref("rlimit-nofile");
 // values: SSLv3 | TLSv1 | TLSv1.1 | TLSv1.2
 PrefPtr PREF_MIN_TLS_VERSION = makePref("min-tls-version");
 // value: 1*digit
+PrefPtr PREF_TLS_SESSION_CACHE_SIZE = makePref("tls-session-cache-size");
+// value: true | false
+PrefPtr PREF_ENABLE_KERNEL_TLS = makePref("enable-kernel-tls");
+// value: 1*digit
 PrefPtr PREF_SOCKET_RECV_BUFFER_SIZE = makePref("socket-recv-buffer-size");
 // value: 1*digit
 PrefPtr PREF_MAX_MMAP_LIMIT = makePref("max-mmap-limit");
@@ -406,8 +426,11 @@ PrefPtr PREF_SAVE_COOKIES = makePref("save-cookies");
 PrefPtr PREF_ENABLE_HTTP_KEEP_ALIVE = makePref("enable-http-keep-alive");
 // values: true | false
 PrefPtr PREF_ENABLE_HTTP_PIPELINING = makePref("enable-http-pipelining");
+PrefPtr PREF_ENABLE_HTTP2 = makePref("enable-http2");
 // value: 1*digit
 PrefPtr PREF_MAX_HTTP_PIPELINING = makePref("max-http-pipelining");
+// value: 1*digit
+PrefPtr PREF_HTTP_PIPELINE_DEPTH = makePref("http-pipeline-depth");
 // value: string
 PrefPtr PREF_HEADER = makePref("header");
 // value: string that your file system recognizes as a file name.
@@ -549,8 +572,14 @@ PrefPtr PREF_BT_TRACKER_TIMEOUT = makePref("bt-tracker-timeout");
 // values: 1*digit
 PrefPtr PREF_BT_TRACKER_CONNECT_TIMEOUT =
     makePref("bt-tracker-connect-timeout");
+// values: a string that your file system recognizes as a file name.
+PrefPtr PREF_BT_UDP_TRACKER_CACHE_FILE = makePref("bt-udp-tracker-cache-file");
 // values: 1*digit
 PrefPtr PREF_DHT_MESSAGE_TIMEOUT = makePref("dht-message-timeout");
+// values: 1*digit
+PrefPtr PREF_DHT_MAX_ANNOUNCED_PEERS = makePref("dht-max-announced-peers");
+// values: 1*digit
+PrefPtr PREF_DHT_ANNOUNCE_STORAGE_SIZE = makePref("dht-announce-storage-size");
 // values: string
 PrefPtr PREF_ON_BT_DOWNLOAD_COMPLETE = makePref("on-bt-download-complete");
 // values: string
@@ -566,6 +595,8 @@ PrefPtr PREF_BT_ENABLE_HOOK_AFTER_HASH_CHECK =
     makePref("bt-enable-hook-after-hash-check");
 // values: true | false
 PrefPtr PREF_BT_LOAD_SAVED_METADATA = makePref("bt-load-saved-metadata");
+// values: true | false
+PrefPtr PREF_BT_ENABLE_SENDFILE = makePref("bt-enable-sendfile");
 
 /**
  * Metalink related preferences
@@ -94,6 +94,7 @@ extern const std::string V_FEEDBACK;
 extern const std::string V_ADAPTIVE;
 extern const std::string V_LIBUV;
 extern const std::string V_EPOLL;
+extern const std::string V_IO_URING;
 extern const std::string V_KQUEUE;
 extern const std::string V_PORT;
 extern const std::string V_POLL;
@@ -122,6 +123,14 @@ extern PrefPtr PREF_TIMEOUT;
 // values: 1*digit
 extern PrefPtr PREF_DNS_TIMEOUT;
 // values: 1*digit
+extern PrefPtr PREF_DNS_CACHE_SIZE;
+// values: 1*digit
+extern PrefPtr PREF_DNS_CACHE_TTL;
+// values: 1*digit
+extern PrefPtr PREF_DNS_NEGATIVE_CACHE_TTL;
+// values: a string that your file system recognizes as a file name.
+extern PrefPtr PREF_DNS_CACHE_FILE;
+// values: 1*digit
 extern PrefPtr PREF_CONNECT_TIMEOUT;
 // values: 1*digit
 extern PrefPtr PREF_MAX_TRIES;
@@ -146,6 +155,8 @@ extern PrefPtr PREF_PIECE_LENGTH;
 // value: 1*digit
 extern PrefPtr PREF_MAX_DOWNLOAD_LIMIT;
 // value: 1*digit
+extern PrefPtr PREF_BANDWIDTH_WEIGHT;
+// value: 1*digit
 extern PrefPtr PREF_STARTUP_IDLE_TIME;
 // value: prealloc | falloc | none
 extern PrefPtr PREF_FILE_ALLOCATION;
@@ -173,6 +184,8 @@ extern PrefPtr PREF_INPUT_FILE;
 extern PrefPtr PREF_DEFERRED_INPUT;
 // value: 1*digit
 extern PrefPtr PREF_MAX_CONCURRENT_DOWNLOADS;
+// value: 1*digit
+extern PrefPtr PREF_MAX_CONCURRENT_INTEGRITY_CHECKS;
 // value: true | false
 extern PrefPtr PREF_OPTIMIZE_CONCURRENT_DOWNLOADS;
 // value: 1*digit ['.' [ 1*digit ] ]
@@ -293,6 +306,8 @@ extern PrefPtr PREF_PAUSE;
 extern PrefPtr PREF_DOWNLOAD_RESULT;
 // value: true | false
 extern PrefPtr PREF_HASH_CHECK_ONLY;
+// value: 1*digit
+extern PrefPtr PREF_HASH_CHECK_THREADS;
 // values: hashType=digest
 extern PrefPtr PREF_CHECKSUM;
 // value: pid
@@ -322,6 +337,10 @@ extern PrefPtr PREF_RLIMIT_NOFILE;
 // values: SSLv3 | TLSv1 | TLSv1.1 | TLSv1.2
 extern PrefPtr PREF_MIN_TLS_VERSION;
 // value: 1*digit
+extern PrefPtr PREF_TLS_SESSION_CACHE_SIZE;
+// value: true | false
+extern PrefPtr PREF_ENABLE_KERNEL_TLS;
+// value: 1*digit
 extern PrefPtr PREF_SOCKET_RECV_BUFFER_SIZE;
 // value: 1*digit
 extern PrefPtr PREF_MAX_MMAP_LIMIT;
@@ -359,8 +378,12 @@ extern PrefPtr PREF_SAVE_COOKIES;
 extern PrefPtr PREF_ENABLE_HTTP_KEEP_ALIVE;
 // values: true | false
 extern PrefPtr PREF_ENABLE_HTTP_PIPELINING;
+// values: true | false
+extern PrefPtr PREF_ENABLE_HTTP2;
 // value: 1*digit
 extern PrefPtr PREF_MAX_HTTP_PIPELINING;
+// value: 1*digit
+extern PrefPtr PREF_HTTP_PIPELINE_DEPTH;
 // value: string
 extern PrefPtr PREF_HEADER;
 // value: string that your file system recognizes as a file name.
@@ -499,8 +522,14 @@ extern PrefPtr PREF_BT_LPD_INTERFACE;
 extern PrefPtr PREF_BT_TRACKER_TIMEOUT;
 // values: 1*digit
 extern PrefPtr PREF_BT_TRACKER_CONNECT_TIMEOUT;
+// values: a string that your file system recognizes as a file name.
+extern PrefPtr PREF_BT_UDP_TRACKER_CACHE_FILE;
 // values: 1*digit
 extern PrefPtr PREF_DHT_MESSAGE_TIMEOUT;
+// values: 1*digit
+extern PrefPtr PREF_DHT_MAX_ANNOUNCED_PEERS;
+// values: 1*digit
+extern PrefPtr PREF_DHT_ANNOUNCE_STORAGE_SIZE;
 // values: string
 extern PrefPtr PREF_ON_BT_DOWNLOAD_COMPLETE;
 // values: string
@@ -517,6 +546,8 @@ extern PrefPtr PREF_BT_FORCE_ENCRYPTION;
 extern PrefPtr PREF_BT_ENABLE_HOOK_AFTER_HASH_CHECK;
 // values: true | false
 extern PrefPtr PREF_BT_LOAD_SAVED_METADATA;
+// values: true | false
+extern PrefPtr PREF_BT_ENABLE_SENDFILE;
 
 /**
  * Metalink related preferences
@@ -130,6 +130,13 @@
     "                              You can append K or M(1K = 1024, 1M = 1024K).\n" \
     "                              To limit the overall download speed, use\n" \
     "                              --max-overall-download-limit option.")
+#define TEXT_BANDWIDTH_WEIGHT                                           \
+  _(" --bandwidth-weight=WEIGHT    Set the share of overall download and upload\n" \
+    "                              bandwidth this download gets relative to other\n" \
+    "                              downloads when --max-overall-download-limit or\n" \
+    "                              --max-overall-upload-limit is used. A download\n" \
+    "                              with weight 2 gets twice as much bandwidth as a\n" \
+    "                              download with weight 1 if both can use it.")
 #define TEXT_FILE_ALLOCATION                                            \
   _(" --file-allocation=METHOD     Specify file allocation method.\n"   \
     "                              'none' doesn't pre-allocate file space. 'prealloc'\n" \
@@ -192,6 +199,18 @@
   _(" --enable-http-keep-alive[=true|false] Enable HTTP/1.1 persistent connection.")
 #define TEXT_ENABLE_HTTP_PIPELINING                                     \
   _(" --enable-http-pipelining[=true|false] Enable HTTP/1.1 pipelining.")
+#define TEXT_ENABLE_HTTP2                                               \
+  _(" --enable-http2[=true|false] Offer HTTP/2 in TLS ALPN extension for HTTPS\n" \
+    "                              downloads. If the server selects HTTP/2,\n" \
+    "                              connections to the same host are multiplexed\n" \
+    "                              as streams over a single connection.")
+#define TEXT_HTTP_PIPELINE_DEPTH                                        \
+  _(" --http-pipeline-depth=<NUM> Send the requests of up to NUM downloads from\n" \
+    "                              the same HTTP/1.1 server over a single\n" \
+    "                              persistent connection without waiting for the\n" \
+    "                              responses to the previous requests. 1 disables\n" \
+    "                              it. This option is ignored for the downloads\n" \
+    "                              with --enable-http-pipelining and via proxy.")
 #define TEXT_CHECK_INTEGRITY                                            \
   _(" -V, --check-integrity[=true|false] Check file integrity by validating piece\n" \
     "                              hashes or a hash of entire file. This option has\n" \
@@ -245,6 +264,10 @@
   _(" -j, --max-concurrent-downloads=N Set maximum number of parallel downloads for\n" \
     "                              every static (HTTP/FTP) URL, torrent and metalink.\n" \
     "                              See also --split and --optimize-concurrent-downloads options.")
+#define TEXT_MAX_CONCURRENT_INTEGRITY_CHECKS                            \
+  _(" --max-concurrent-integrity-checks=NUM Set the maximum number of downloads\n" \
+    "                              whose integrity is checked at the same time.\n" \
+    "                              See also --hash-check-threads option.")
 #define TEXT_OPTIMIZE_CONCURRENT_DOWNLOADS\
   _(" --optimize-concurrent-downloads[=true|false|A:B] Optimizes the number of\n" \
     "                              concurrent downloads according to the bandwidth\n" \
@@ -642,6 +665,21 @@
     "                              ignored.")
 #define TEXT_DISABLE_IPV6                               \
   _(" --disable-ipv6[=true|false]  Disable IPv6.")
+#define TEXT_DNS_CACHE_FILE                     \
+  _(" --dns-cache-file=FILE        Load DNS cache from FILE at startup, and save\n" \
+    "                              DNS cache to FILE on exit. Expired entries are\n" \
+    "                              not loaded.")
+#define TEXT_DNS_CACHE_SIZE                     \
+  _(" --dns-cache-size=NUM         Set the maximum number of hostnames kept in DNS\n" \
+    "                              cache. When the cache is full, the least\n" \
+    "                              recently used one is removed. 0 means unlimited.")
+#define TEXT_DNS_CACHE_TTL                      \
+  _(" --dns-cache-ttl=SEC          Keep resolved addresses in DNS cache for SEC\n" \
+    "                              seconds when the resolver does not report TTL\n" \
+    "                              of the DNS records. 0 means forever.")
+#define TEXT_DNS_NEGATIVE_CACHE_TTL             \
+  _(" --dns-negative-cache-ttl=SEC Remember that a hostname does not exist for SEC\n" \
+    "                              seconds. 0 disables negative caching.")
 #define TEXT_BT_SAVE_METADATA                                           \
   _(" --bt-save-metadata[=true|false] Save metadata as .torrent file. This option has\n" \
     "                              effect only when BitTorrent Magnet URI is used.\n" \
@@ -714,6 +752,11 @@
     "                              See --always-resume option.")
 #define TEXT_BT_TRACKER_TIMEOUT                                 \
   _(" --bt-tracker-timeout=SEC     Set timeout in seconds.")
+#define TEXT_BT_UDP_TRACKER_CACHE_FILE                          \
+  _(" --bt-udp-tracker-cache-file=FILE Load connection IDs of UDP trackers from\n" \
+    "                              FILE at startup, and save them to FILE on exit.\n" \
+    "                              Connection IDs are only reused within 1 minute\n" \
+    "                              after they were obtained.")
 #define TEXT_BT_TRACKER_CONNECT_TIMEOUT                                 \
   _(" --bt-tracker-connect-timeout=SEC Set the connect timeout in seconds to\n" \
     "                              establish connection to tracker. After the\n" \
@@ -722,11 +765,24 @@
     "                              instead.")
 #define TEXT_DHT_MESSAGE_TIMEOUT                \
   _(" --dht-message-timeout=SEC    Set timeout in seconds.")
+#define TEXT_DHT_MAX_ANNOUNCED_PEERS            \
+  _(" --dht-max-announced-peers=NUM Set the maximum number of peers stored for\n" \
+    "                              each info hash announced by other DHT nodes.\n" \
+    "                              If the limit is reached, the least recently\n" \
+    "                              announced peer is replaced. 0 means no limit.")
+#define TEXT_DHT_ANNOUNCE_STORAGE_SIZE          \
+  _(" --dht-announce-storage-size=SIZE Set the maximum amount of memory used to\n" \
+    "                              store peers announced by other DHT nodes. If\n" \
+    "                              the limit is reached, the info hashes which\n" \
+    "                              were least recently announced are dropped. 0\n" \
+    "                              means no limit.")
 #define TEXT_HTTP_ACCEPT_GZIP                   \
   _(" --http-accept-gzip[=true|false] Send 'Accept: deflate, gzip' request header\n" \
     "                              and inflate response if remote server responds\n" \
     "                              with 'Content-Encoding: gzip' or\n"  \
-    "                              'Content-Encoding: deflate'.")
+    "                              'Content-Encoding: deflate'. If aria2 is built\n" \
+    "                              with libbrotli or libzstd, 'br' or 'zstd' is\n" \
+    "                              also accepted and decoded.")
 #define TEXT_SAVE_SESSION                       \
   _(" --save-session=FILE          Save error/unfinished downloads to FILE on exit.\n" \
     "                              You can pass this output file to aria2c with -i\n" \
@@ -904,6 +960,14 @@
   _(" --hash-check-only[=true|false] If true is given, after hash check using\n" \
     "                              --check-integrity option, abort download whether\n" \
     "                              or not download is complete.")
+#define TEXT_HASH_CHECK_THREADS                                         \
+  _(" --hash-check-threads=NUM     Set the number of worker threads which compute\n" \
+    "                              piece hashes of BitTorrent downloads. The\n" \
+    "                              threads are also used to verify pieces in\n" \
+    "                              parallel when checking integrity. 0 means\n" \
+    "                              hashes are computed in the main event loop,\n" \
+    "                              which may stall all other transfers while\n" \
+    "                              large pieces are verified.")
 #define TEXT_CHECKSUM                                                   \
   _(" --checksum=TYPE=DIGEST       Set checksum. TYPE is hash type. The supported\n" \
     "                              hash type is listed in \"Hash Algorithms\" in\n" \
@@ -1066,6 +1130,15 @@
     "                              recognized as active download in RPC method.")
 #define TEXT_MIN_TLS_VERSION                                            \
   _(" --min-tls-version=VERSION    Specify minimum SSL/TLS version to enable.")
+#define TEXT_ENABLE_KERNEL_TLS                                          \
+  _(" --enable-kernel-tls[=true|false]\n"                               \
+    "                              Let the kernel encrypt and decrypt SSL/TLS\n" \
+    "                              records (kTLS) after handshake. This requires\n" \
+    "                              Linux and OpenSSL 3.0 or later.")
+#define TEXT_TLS_SESSION_CACHE_SIZE                                     \
+  _(" --tls-session-cache-size=NUM Set the maximum number of servers whose TLS\n" \
+    "                              sessions are cached to resume them in later\n" \
+    "                              connections. 0 disables session resumption.")
 #define TEXT_BT_FORCE_ENCRYPTION                                        \
   _(" --bt-force-encryption[=true|false]\n"                             \
     "                              Requires BitTorrent message payload encryption\n" \
@@ -1126,5 +1199,10 @@
     "                              file saved by --bt-save-metadata option. If it is\n" \
     "                              successful, then skip downloading metadata from\n" \
     "                              DHT.")
+#define TEXT_BT_ENABLE_SENDFILE \
+  _(" --bt-enable-sendfile[=true|false]\n" \
+    "                              Send piece data to unencrypted peers directly\n" \
+    "                              from file using sendfile(2) system call, instead\n" \
+    "                              of reading it into memory first.")
 
 // clang-format on
@@ -0,0 +1,97 @@
+// Measures BitfieldMan operations which are used to select pieces, on
+// a bitfield of 1M pieces.  Build with "make bench-bitfield" and run
+// without arguments.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "BitfieldMan.h"
+#include "bitfield.h"
+
+using namespace aria2;
+
+namespace {
+const size_t NUM_PIECES = 1024 * 1024;
+const int32_t PIECE_LENGTH = 16 * 1024;
+
+template <typename F> void measure(const char* name, size_t rounds, F f)
+{
+  size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    sink += f();
+  }
+  std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  printf("%-32s %10.2f us/call (%zu)\n", name, elapsed.count() / rounds,
+         sink / rounds);
+}
+} // namespace
+
+int main()
+{
+  // All pieces but every 4096th piece in the last quarter are
+  // downloaded, and a few of the missing pieces are in use.  This is
+  // the worst case for scanning since almost all bits are set.
+  BitfieldMan bt(PIECE_LENGTH, static_cast<int64_t>(NUM_PIECES) * PIECE_LENGTH);
+  bt.setAllBit();
+  for (size_t i = NUM_PIECES * 3 / 4; i < NUM_PIECES; i += 4096) {
+    bt.unsetBit(i);
+  }
+  for (size_t i = NUM_PIECES * 3 / 4; i < NUM_PIECES; i += 4096 * 8) {
+    bt.setUseBit(i);
+  }
+  std::vector<unsigned char> ignore(bt.getBitfieldLength());
+  std::vector<unsigned char> peer(bt.getBitfieldLength(), 0xff);
+
+  const size_t rounds = 200;
+  measure("getFirstMissingUnusedIndex", rounds, [&]() {
+    size_t index = 0;
+    bt.getFirstMissingUnusedIndex(index);
+    return index;
+  });
+  measure("getFirstNMissingUnusedIndex", rounds, [&]() {
+    std::vector<size_t> out;
+    return bt.getFirstNMissingUnusedIndex(out, 10);
+  });
+  measure("getSparseMissingUnusedIndex", rounds, [&]() {
+    size_t index = 0;
+    bt.getSparseMissingUnusedIndex(index, 1024 * 1024, ignore.data(),
+                                   ignore.size());
+    return index;
+  });
+  measure("getInorderMissingUnusedIndex", rounds, [&]() {
+    size_t index = 0;
+    bt.getInorderMissingUnusedIndex(index, 1024 * 1024, ignore.data(),
+                                    ignore.size());
+    return index;
+  });
+  measure("hasMissingPiece", rounds, [&]() {
+    return bt.hasMissingPiece(peer.data(), peer.size());
+  });
+  measure("countMissingBlockNow", rounds,
+          [&]() { return bt.countMissingBlockNow(); });
+  measure("countSetBit", rounds, [&]() {
+    return bitfield::countSetBit(bt.getBitfield(), bt.countBlock());
+  });
+
+  bt.addFilter(0, static_cast<int64_t>(NUM_PIECES) * PIECE_LENGTH / 2);
+  bt.addFilter(static_cast<int64_t>(NUM_PIECES) * PIECE_LENGTH * 7 / 8,
+               static_cast<int64_t>(NUM_PIECES) * PIECE_LENGTH / 8);
+  bt.enableFilter();
+  measure("getFirstMissingUnusedIndex/filter", rounds, [&]() {
+    size_t index = 0;
+    bt.getFirstMissingUnusedIndex(index);
+    return index;
+  });
+  measure("getSparseMissingUnusedIndex/filter", rounds, [&]() {
+    size_t index = 0;
+    bt.getSparseMissingUnusedIndex(index, 1024 * 1024, ignore.data(),
+                                   ignore.size());
+    return index;
+  });
+  measure("countMissingBlockNow/filter", rounds,
+          [&]() { return bt.countMissingBlockNow(); });
+  return 0;
+}
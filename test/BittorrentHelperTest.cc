@@ -44,6 +44,7 @@ class BittorrentHelperTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testGetPeerId);
   CPPUNIT_TEST(testGetPeerAgent);
   CPPUNIT_TEST(testComputeFastSet);
+  CPPUNIT_TEST(testCalculateRequestQueueDepth);
   CPPUNIT_TEST(testGetFileEntries_multiFileUrlList);
   CPPUNIT_TEST(testGetFileEntries_singleFileUrlList);
   CPPUNIT_TEST(testGetFileEntries_singleFileUrlListEndsWithSlash);
@@ -103,6 +104,7 @@ public:
   void testGetPeerId();
   void testGetPeerAgent();
   void testComputeFastSet();
+  void testCalculateRequestQueueDepth();
   void testGetFileEntries_multiFileUrlList();
   void testGetFileEntries_singleFileUrlList();
   void testGetFileEntries_singleFileUrlListEndsWithSlash();
@@ -335,6 +337,29 @@ void BittorrentHelperTest::testGetPeerAgent()
                        bittorrent::getStaticPeerAgent());
 }
 
+void BittorrentHelperTest::testCalculateRequestQueueDepth()
+{
+  // No speed: lower bound
+  CPPUNIT_ASSERT_EQUAL(
+      DEFAULT_MAX_OUTSTANDING_REQUEST,
+      calculateRequestQueueDepth(0, std::chrono::milliseconds(100), 0));
+  // 1MiB/s * 100ms = 102.4KiB -> 7 blocks -> 14
+  CPPUNIT_ASSERT_EQUAL(
+      (size_t)14,
+      calculateRequestQueueDepth(1_m, std::chrono::milliseconds(100), 0));
+  // 10MiB/s * 300ms = 3MiB -> 192 blocks -> capped
+  CPPUNIT_ASSERT_EQUAL(
+      UB_MAX_OUTSTANDING_REQUEST,
+      calculateRequestQueueDepth(10_m, std::chrono::milliseconds(300), 0));
+  // reqq caps the depth
+  CPPUNIT_ASSERT_EQUAL(
+      (size_t)50,
+      calculateRequestQueueDepth(10_m, std::chrono::milliseconds(300), 50));
+  CPPUNIT_ASSERT_EQUAL(
+      (size_t)2,
+      calculateRequestQueueDepth(0, std::chrono::milliseconds(300), 2));
+}
+
 void BittorrentHelperTest::testComputeFastSet()
 {
   std::string ipaddr = "192.168.0.1";
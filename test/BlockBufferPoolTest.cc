@@ -0,0 +1,55 @@
+#include "BlockBufferPool.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace aria2 {
+
+class BlockBufferPoolTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(BlockBufferPoolTest);
+  CPPUNIT_TEST(testAcquire);
+  CPPUNIT_TEST(testRelease_maxFreeBuffers);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testAcquire();
+  void testRelease_maxFreeBuffers();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BlockBufferPoolTest);
+
+void BlockBufferPoolTest::testAcquire()
+{
+  BlockBufferPool pool(16, 2);
+  CPPUNIT_ASSERT_EQUAL((size_t)16, pool.getBufferSize());
+  const unsigned char* p;
+  {
+    auto buf = pool.acquire();
+    CPPUNIT_ASSERT(buf);
+    p = buf.get();
+    CPPUNIT_ASSERT_EQUAL((uint64_t)0, pool.getHits());
+    CPPUNIT_ASSERT_EQUAL((uint64_t)1, pool.getMisses());
+    CPPUNIT_ASSERT_EQUAL((size_t)0, pool.getNumFreeBuffers());
+  }
+  CPPUNIT_ASSERT_EQUAL((size_t)1, pool.getNumFreeBuffers());
+
+  auto buf = pool.acquire();
+  CPPUNIT_ASSERT(p == buf.get());
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, pool.getHits());
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, pool.getMisses());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, pool.getNumFreeBuffers());
+}
+
+void BlockBufferPoolTest::testRelease_maxFreeBuffers()
+{
+  BlockBufferPool pool(16, 2);
+  {
+    auto buf1 = pool.acquire();
+    auto buf2 = pool.acquire();
+    auto buf3 = pool.acquire();
+    CPPUNIT_ASSERT_EQUAL((uint64_t)3, pool.getMisses());
+  }
+  CPPUNIT_ASSERT_EQUAL((size_t)2, pool.getNumFreeBuffers());
+}
+
+} // namespace aria2
@@ -0,0 +1,95 @@
+#include "BrotliDecodingStreamFilter.h"
+
+#include <cassert>
+#include <iostream>
+#include <fstream>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Exception.h"
+#include "util.h"
+#include "Segment.h"
+#include "ByteArrayDiskWriter.h"
+#include "SinkStreamFilter.h"
+#include "MockSegment.h"
+#include "MessageDigest.h"
+
+namespace aria2 {
+
+class BrotliDecodingStreamFilterTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(BrotliDecodingStreamFilterTest);
+  CPPUNIT_TEST(testTransform);
+  CPPUNIT_TEST(testTransform_error);
+  CPPUNIT_TEST_SUITE_END();
+
+  class MockSegment2 : public MockSegment {
+  private:
+    int64_t positionToWrite_;
+
+  public:
+    MockSegment2() : positionToWrite_(0) {}
+
+    virtual void updateWrittenLength(int64_t bytes) CXX11_OVERRIDE
+    {
+      positionToWrite_ += bytes;
+    }
+
+    virtual int64_t getPositionToWrite() const CXX11_OVERRIDE
+    {
+      return positionToWrite_;
+    }
+  };
+
+  std::unique_ptr<BrotliDecodingStreamFilter> filter_;
+  std::shared_ptr<ByteArrayDiskWriter> writer_;
+  std::shared_ptr<MockSegment2> segment_;
+
+public:
+  void setUp()
+  {
+    writer_ = std::make_shared<ByteArrayDiskWriter>();
+    auto sinkFilter = make_unique<SinkStreamFilter>();
+    sinkFilter->init();
+    filter_ = make_unique<BrotliDecodingStreamFilter>(std::move(sinkFilter));
+    filter_->init();
+    segment_ = std::make_shared<MockSegment2>();
+  }
+
+  void testTransform();
+  void testTransform_error();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BrotliDecodingStreamFilterTest);
+
+void BrotliDecodingStreamFilterTest::testTransform()
+{
+  unsigned char buf[4_k];
+  std::ifstream in(A2_TEST_DIR "/brotli_decode_test.br", std::ios::binary);
+  while (in) {
+    in.read(reinterpret_cast<char*>(buf), sizeof(buf));
+    filter_->transform(writer_, segment_, buf, in.gcount());
+  }
+  CPPUNIT_ASSERT(filter_->finished());
+  std::string data = writer_->getString();
+  std::shared_ptr<MessageDigest> sha1(MessageDigest::sha1());
+  sha1->update(data.data(), data.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("8b577b33c0411b2be9d4fa74c7402d54a8d21f96"),
+                       util::toHex(sha1->digest()));
+}
+
+void BrotliDecodingStreamFilterTest::testTransform_error()
+{
+  std::string data = "this is not brotli compressed data";
+  try {
+    filter_->transform(writer_, segment_,
+                       reinterpret_cast<const unsigned char*>(data.data()),
+                       data.size());
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (Exception& e) {
+    // success
+  }
+}
+
+} // namespace aria2
@@ -13,6 +13,7 @@ class DHTConnectionImplTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(DHTConnectionImplTest);
   CPPUNIT_TEST(testWriteAndReadData);
+  CPPUNIT_TEST(testQueueAndReceiveMessages);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -21,6 +22,7 @@ public:
   void tearDown() {}
 
   void testWriteAndReadData();
+  void testQueueAndReceiveMessages();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DHTConnectionImplTest);
@@ -59,4 +61,55 @@ void DHTConnectionImplTest::testWriteAndReadData()
   }
 }
 
+void DHTConnectionImplTest::testQueueAndReceiveMessages()
+{
+  try {
+    DHTConnectionImpl con1(AF_INET);
+    uint16_t con1port = 0;
+    CPPUNIT_ASSERT(con1.bind(con1port, "127.0.0.1"));
+
+    DHTConnectionImpl con2(AF_INET);
+    uint16_t con2port = 0;
+    CPPUNIT_ASSERT(con2.bind(con2port, "127.0.0.1"));
+
+    std::string messages[] = {"alpha", "bravo", "charlie"};
+    for (auto& m : messages) {
+      CPPUNIT_ASSERT_EQUAL(
+          (ssize_t)m.size(),
+          con1.queueMessage(reinterpret_cast<const unsigned char*>(m.c_str()),
+                            m.size(), "127.0.0.1", con2port));
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t)3, con1.countQueuedMessage());
+    CPPUNIT_ASSERT(!con2.getSocket()->isReadable(0));
+
+    con1.flush();
+    CPPUNIT_ASSERT_EQUAL((size_t)0, con1.countQueuedMessage());
+
+    std::vector<Datagram> dgrams(4);
+    for (auto& dgram : dgrams) {
+      dgram.buf.resize(100);
+    }
+    size_t received = 0;
+    while (received < 3) {
+      while (!con2.getSocket()->isReadable(0))
+        ;
+      received += con2.receiveMessages(dgrams.data() + received,
+                                       dgrams.size() - received);
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t)3, received);
+    for (size_t i = 0; i < 3; ++i) {
+      CPPUNIT_ASSERT_EQUAL(messages[i],
+                           std::string(&dgrams[i].buf[0],
+                                       &dgrams[i].buf[dgrams[i].len]));
+      CPPUNIT_ASSERT_EQUAL(std::string("127.0.0.1"), dgrams[i].endpoint.addr);
+      CPPUNIT_ASSERT_EQUAL(con1port, dgrams[i].endpoint.port);
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t)0,
+                         con2.receiveMessages(dgrams.data(), dgrams.size()));
+  }
+  catch (Exception& e) {
+    CPPUNIT_FAIL(e.stackTrace());
+  }
+}
+
 } // namespace aria2
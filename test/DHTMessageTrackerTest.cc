@@ -4,6 +4,7 @@
 
 #include "Exception.h"
 #include "util.h"
+#include "fmt.h"
 #include "MockDHTMessage.h"
 #include "MockDHTMessageCallback.h"
 #include "DHTNode.h"
@@ -32,6 +33,25 @@ public:
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DHTMessageTrackerTest);
 
+namespace {
+class TimeoutCallback : public MockDHTMessageCallback {
+public:
+  TimeoutCallback(std::vector<std::shared_ptr<DHTNode>>* timedout)
+      : timedout_(timedout)
+  {
+  }
+
+  virtual void
+  onTimeout(const std::shared_ptr<DHTNode>& remoteNode) CXX11_OVERRIDE
+  {
+    timedout_->push_back(remoteNode);
+  }
+
+private:
+  std::vector<std::shared_ptr<DHTNode>>* timedout_;
+};
+} // namespace
+
 void DHTMessageTrackerTest::testMessageArrived()
 {
   auto localNode = std::make_shared<DHTNode>();
@@ -95,6 +115,43 @@ void DHTMessageTrackerTest::testMessageArrived()
   }
 }
 
-void DHTMessageTrackerTest::testHandleTimeout() {}
+void DHTMessageTrackerTest::testHandleTimeout()
+{
+  auto localNode = std::make_shared<DHTNode>();
+  auto routingTable = make_unique<DHTRoutingTable>(localNode);
+
+  std::vector<std::shared_ptr<DHTNode>> remoteNodes;
+  std::vector<std::unique_ptr<MockDHTMessage>> messages;
+  for (int i = 0; i < 4; ++i) {
+    auto node = std::make_shared<DHTNode>();
+    node->setIPAddress(fmt("192.168.0.%d", i + 1));
+    node->setPort(6881 + i);
+    remoteNodes.push_back(node);
+    messages.push_back(make_unique<MockDHTMessage>(localNode, node));
+  }
+  std::vector<std::shared_ptr<DHTNode>> timedout;
+
+  DHTMessageTracker tracker;
+  tracker.setRoutingTable(routingTable.get());
+  tracker.addMessage(messages[0].get(), 20_s,
+                     make_unique<TimeoutCallback>(&timedout));
+  tracker.addMessage(messages[1].get(), 0_s,
+                     make_unique<TimeoutCallback>(&timedout));
+  tracker.addMessage(messages[2].get(), DHT_MESSAGE_TIMEOUT,
+                     make_unique<TimeoutCallback>(&timedout));
+  tracker.addMessage(messages[3].get(), 0_s,
+                     make_unique<TimeoutCallback>(&timedout));
+
+  tracker.handleTimeout();
+
+  CPPUNIT_ASSERT_EQUAL((size_t)2, timedout.size());
+  CPPUNIT_ASSERT(remoteNodes[1] == timedout[0]);
+  CPPUNIT_ASSERT(remoteNodes[3] == timedout[1]);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, tracker.countEntry());
+  CPPUNIT_ASSERT(!tracker.getEntryFor(messages[1].get()));
+  CPPUNIT_ASSERT(!tracker.getEntryFor(messages[3].get()));
+  CPPUNIT_ASSERT(tracker.getEntryFor(messages[0].get()));
+  CPPUNIT_ASSERT(tracker.getEntryFor(messages[2].get()));
+}
 
 } // namespace aria2
@@ -18,6 +18,7 @@ class DHTPeerAnnounceEntryTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testEmpty);
   CPPUNIT_TEST(testAddPeerAddrEntry);
   CPPUNIT_TEST(testGetPeers);
+  CPPUNIT_TEST(testAddPeerAddrEntry_maxPeers);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -25,6 +26,7 @@ public:
   void testEmpty();
   void testAddPeerAddrEntry();
   void testGetPeers();
+  void testAddPeerAddrEntry_maxPeers();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DHTPeerAnnounceEntryTest);
@@ -110,4 +112,25 @@ void DHTPeerAnnounceEntryTest::testGetPeers()
   }
 }
 
+void DHTPeerAnnounceEntryTest::testAddPeerAddrEntry_maxPeers()
+{
+  unsigned char infohash[DHT_ID_LENGTH];
+  memset(infohash, 0xff, DHT_ID_LENGTH);
+
+  DHTPeerAnnounceEntry entry(infohash);
+  CPPUNIT_ASSERT(entry.addPeerAddrEntry(PeerAddrEntry("192.168.0.1", 6881), 2));
+  CPPUNIT_ASSERT(entry.addPeerAddrEntry(
+      PeerAddrEntry("192.168.0.2", 6882, Timer::zero()), 2));
+  CPPUNIT_ASSERT(
+      !entry.addPeerAddrEntry(PeerAddrEntry("192.168.0.3", 6883), 2));
+  CPPUNIT_ASSERT(!entry.addPeerAddrEntry(PeerAddrEntry("localhost", 6884)));
+
+  CPPUNIT_ASSERT_EQUAL((size_t)2, entry.countPeerAddrEntry());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.1"),
+                       entry.getPeerAddrEntries()[0].getIPAddress());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.3"),
+                       entry.getPeerAddrEntries()[1].getIPAddress());
+  CPPUNIT_ASSERT_EQUAL((uint16_t)6883, entry.getPeerAddrEntries()[1].getPort());
+}
+
 } // namespace aria2
@@ -11,6 +11,7 @@
 #include "Peer.h"
 #include "FileEntry.h"
 #include "bittorrent_helper.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -18,10 +19,20 @@ class DHTPeerAnnounceStorageTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(DHTPeerAnnounceStorageTest);
   CPPUNIT_TEST(testAddAnnounce);
+  CPPUNIT_TEST(testAddAnnounce_manyInfoHashes);
+  CPPUNIT_TEST(testAddAnnounce_nonNumeric);
+  CPPUNIT_TEST(testSetMaxPeersPerInfoHash);
+  CPPUNIT_TEST(testSetMaxMemory);
+  CPPUNIT_TEST(testHandleTimeout);
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testAddAnnounce();
+  void testAddAnnounce_manyInfoHashes();
+  void testAddAnnounce_nonNumeric();
+  void testSetMaxPeersPerInfoHash();
+  void testSetMaxMemory();
+  void testHandleTimeout();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DHTPeerAnnounceStorageTest);
@@ -47,4 +58,121 @@ void DHTPeerAnnounceStorageTest::testAddAnnounce()
   CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.4"), peers[1]->getIPAddress());
 }
 
+namespace {
+void createInfoHash(unsigned char* infoHash, uint32_t n)
+{
+  memset(infoHash, 0, DHT_ID_LENGTH);
+  memcpy(infoHash + DHT_ID_LENGTH - sizeof(n), &n, sizeof(n));
+}
+} // namespace
+
+void DHTPeerAnnounceStorageTest::testAddAnnounce_manyInfoHashes()
+{
+  DHTPeerAnnounceStorage storage;
+  unsigned char infohash[DHT_ID_LENGTH];
+  for (uint32_t i = 0; i < 1000; ++i) {
+    createInfoHash(infohash, i);
+    storage.addPeerAnnounce(infohash, "192.168.0.1", 6881);
+    storage.addPeerAnnounce(infohash, "2001:db8::1", 6881);
+  }
+  CPPUNIT_ASSERT_EQUAL((size_t)1000, storage.countEntry());
+  CPPUNIT_ASSERT_EQUAL((size_t)2000, storage.countPeerAddrEntry());
+  for (uint32_t i = 0; i < 1000; ++i) {
+    createInfoHash(infohash, i);
+    CPPUNIT_ASSERT(storage.contains(infohash));
+    std::vector<std::shared_ptr<Peer>> peers;
+    storage.getPeers(peers, infohash);
+    CPPUNIT_ASSERT_EQUAL((size_t)2, peers.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("2001:db8::1"), peers[1]->getIPAddress());
+  }
+  createInfoHash(infohash, 1000);
+  CPPUNIT_ASSERT(!storage.contains(infohash));
+}
+
+void DHTPeerAnnounceStorageTest::testAddAnnounce_nonNumeric()
+{
+  unsigned char infohash[DHT_ID_LENGTH];
+  memset(infohash, 0xff, DHT_ID_LENGTH);
+  DHTPeerAnnounceStorage storage;
+  storage.addPeerAnnounce(infohash, "localhost", 6881);
+  CPPUNIT_ASSERT(!storage.contains(infohash));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, storage.countEntry());
+}
+
+void DHTPeerAnnounceStorageTest::testSetMaxPeersPerInfoHash()
+{
+  unsigned char infohash[DHT_ID_LENGTH];
+  memset(infohash, 0xff, DHT_ID_LENGTH);
+  DHTPeerAnnounceStorage storage;
+  storage.setMaxPeersPerInfoHash(2);
+  storage.addPeerAnnounce(infohash, "192.168.0.1", 6881);
+  global::wallclock().advance(1_s);
+  storage.addPeerAnnounce(infohash, "192.168.0.2", 6882);
+  global::wallclock().advance(1_s);
+  // Replaces the least recently updated 192.168.0.1
+  storage.addPeerAnnounce(infohash, "192.168.0.3", 6883);
+
+  CPPUNIT_ASSERT_EQUAL((size_t)2, storage.countPeerAddrEntry());
+  std::vector<std::shared_ptr<Peer>> peers;
+  storage.getPeers(peers, infohash);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, peers.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.3"), peers[0]->getIPAddress());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.2"), peers[1]->getIPAddress());
+}
+
+void DHTPeerAnnounceStorageTest::testSetMaxMemory()
+{
+  DHTPeerAnnounceStorage storage;
+  unsigned char infohash[DHT_ID_LENGTH];
+  for (uint32_t i = 0; i < 100; ++i) {
+    createInfoHash(infohash, i);
+    storage.addPeerAnnounce(infohash, "192.168.0.1", 6881);
+    global::wallclock().advance(1_s);
+  }
+  auto usage = storage.getMemoryUsage();
+  storage.setMaxMemory(usage / 2);
+  CPPUNIT_ASSERT(storage.getMemoryUsage() <= usage / 2);
+  CPPUNIT_ASSERT(storage.getNumEvicted() > 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)100 - storage.getNumEvicted(),
+                       storage.countEntry());
+  // The most recently announced ones survive.
+  createInfoHash(infohash, 99);
+  CPPUNIT_ASSERT(storage.contains(infohash));
+  createInfoHash(infohash, 0);
+  CPPUNIT_ASSERT(!storage.contains(infohash));
+
+  for (uint32_t i = 100; i < 1000; ++i) {
+    createInfoHash(infohash, i);
+    storage.addPeerAnnounce(infohash, "192.168.0.1", 6881);
+    CPPUNIT_ASSERT(storage.getMemoryUsage() <= usage / 2);
+  }
+  createInfoHash(infohash, 999);
+  CPPUNIT_ASSERT(storage.contains(infohash));
+}
+
+void DHTPeerAnnounceStorageTest::testHandleTimeout()
+{
+  unsigned char infohash1[DHT_ID_LENGTH];
+  memset(infohash1, 0xff, DHT_ID_LENGTH);
+  unsigned char infohash2[DHT_ID_LENGTH];
+  memset(infohash2, 0xf0, DHT_ID_LENGTH);
+  DHTPeerAnnounceStorage storage;
+
+  storage.addPeerAnnounce(infohash1, "192.168.0.1", 6881);
+  storage.addPeerAnnounce(infohash2, "192.168.0.2", 6882);
+  global::wallclock().advance(DHT_PEER_ANNOUNCE_PURGE_INTERVAL);
+  storage.addPeerAnnounce(infohash2, "192.168.0.3", 6883);
+
+  storage.handleTimeout();
+
+  CPPUNIT_ASSERT(!storage.contains(infohash1));
+  CPPUNIT_ASSERT(storage.contains(infohash2));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, storage.countEntry());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, storage.countPeerAddrEntry());
+  std::vector<std::shared_ptr<Peer>> peers;
+  storage.getPeers(peers, infohash2);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, peers.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.3"), peers[0]->getIPAddress());
+}
+
 } // namespace aria2
@@ -2,6 +2,11 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#include "BufferedFile.h"
+#include "util.h"
+#include "TimeA2.h"
+#include "wallclock.h"
+
 namespace aria2 {
 
 class DNSCacheTest : public CppUnit::TestFixture {
@@ -11,6 +16,12 @@ class DNSCacheTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testMarkBad);
   CPPUNIT_TEST(testPutBadAddr);
   CPPUNIT_TEST(testRemove);
+  CPPUNIT_TEST(testExpire);
+  CPPUNIT_TEST(testLookup);
+  CPPUNIT_TEST(testPutNegative);
+  CPPUNIT_TEST(testSetMaxSize);
+  CPPUNIT_TEST(testSaveAndLoad);
+  CPPUNIT_TEST(testLoad);
   CPPUNIT_TEST_SUITE_END();
 
   DNSCache cache_;
@@ -29,6 +40,12 @@ public:
   void testMarkBad();
   void testPutBadAddr();
   void testRemove();
+  void testExpire();
+  void testLookup();
+  void testPutNegative();
+  void testSetMaxSize();
+  void testSaveAndLoad();
+  void testLoad();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DNSCacheTest);
@@ -61,4 +78,125 @@ void DNSCacheTest::testRemove()
   CPPUNIT_ASSERT_EQUAL(std::string(""), cache_.find("www", 80));
 }
 
+void DNSCacheTest::testExpire()
+{
+  global::wallclock().reset();
+  cache_.put("expire", "192.168.0.3", 80, 10_s);
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.3"), cache_.find("expire", 80));
+  global::wallclock().advance(11_s);
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache_.find("expire", 80));
+  // Entries without TTL never expire.
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.1"), cache_.find("www", 80));
+  // Addresses of the expired entry are not reused.
+  cache_.put("expire", "192.168.0.4", 80, 10_s);
+  std::vector<std::string> addrs;
+  cache_.findAll(std::back_inserter(addrs), "expire", 80);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, addrs.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.4"), addrs[0]);
+  global::wallclock().reset();
+}
+
+void DNSCacheTest::testLookup()
+{
+  std::vector<std::string> addrs;
+  CPPUNIT_ASSERT_EQUAL(1, cache_.lookup(addrs, "www", 80));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, addrs.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.1"), addrs[0]);
+  CPPUNIT_ASSERT_EQUAL(std::string("::1"), addrs[1]);
+  addrs.clear();
+  CPPUNIT_ASSERT_EQUAL(0, cache_.lookup(addrs, "another", 80));
+  CPPUNIT_ASSERT(addrs.empty());
+  // No good address is left.
+  cache_.markBad("ftp", "192.168.0.1", 21);
+  CPPUNIT_ASSERT_EQUAL(0, cache_.lookup(addrs, "ftp", 21));
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, cache_.getHits());
+  CPPUNIT_ASSERT_EQUAL((uint64_t)2, cache_.getMisses());
+}
+
+void DNSCacheTest::testPutNegative()
+{
+  global::wallclock().reset();
+  cache_.putNegative("nxdomain", 80, 10_s);
+  std::vector<std::string> addrs;
+  CPPUNIT_ASSERT_EQUAL(-1, cache_.lookup(addrs, "nxdomain", 80));
+  CPPUNIT_ASSERT(addrs.empty());
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache_.find("nxdomain", 80));
+  global::wallclock().advance(11_s);
+  CPPUNIT_ASSERT_EQUAL(0, cache_.lookup(addrs, "nxdomain", 80));
+  global::wallclock().reset();
+  // Positive answer replaces negative entry.
+  cache_.putNegative("nxdomain", 80, 10_s);
+  cache_.put("nxdomain", "192.168.0.5", 80, 10_s);
+  CPPUNIT_ASSERT_EQUAL(1, cache_.lookup(addrs, "nxdomain", 80));
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.5"), addrs[0]);
+}
+
+void DNSCacheTest::testSetMaxSize()
+{
+  std::vector<std::string> addrs;
+  // Make "www" most recently used.
+  CPPUNIT_ASSERT_EQUAL(1, cache_.lookup(addrs, "www", 80));
+  cache_.setMaxSize(2);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, cache_.size());
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache_.find("ftp", 21));
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.1"), cache_.find("www", 80));
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.1.2"), cache_.find("proxy", 8080));
+  cache_.put("ftp", "192.168.0.1", 21);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, cache_.size());
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache_.find("proxy", 8080));
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.1"), cache_.find("www", 80));
+}
+
+void DNSCacheTest::testSaveAndLoad()
+{
+  const char* filename = A2_TEST_OUT_DIR "/aria2_DNSCacheTest_testSaveAndLoad";
+  global::wallclock().reset();
+  cache_.put("expire", "192.168.0.3", 80, 1_h);
+  cache_.putNegative("nxdomain", 80, 1_h);
+  cache_.markBad("www", "::1", 80);
+  CPPUNIT_ASSERT(cache_.save(filename));
+
+  DNSCache cache;
+  CPPUNIT_ASSERT(cache.load(filename));
+  CPPUNIT_ASSERT_EQUAL((size_t)5, cache.size());
+  std::vector<std::string> addrs;
+  CPPUNIT_ASSERT_EQUAL(1, cache.lookup(addrs, "www", 80));
+  // Bad address is not saved.
+  CPPUNIT_ASSERT_EQUAL((size_t)1, addrs.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.1"), addrs[0]);
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.3"), cache.find("expire", 80));
+  CPPUNIT_ASSERT_EQUAL(-1, cache.lookup(addrs, "nxdomain", 80));
+  global::wallclock().advance(2_h);
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache.find("expire", 80));
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.1.2"), cache.find("proxy", 8080));
+  global::wallclock().reset();
+}
+
+void DNSCacheTest::testLoad()
+{
+  const char* filename = A2_TEST_OUT_DIR "/aria2_DNSCacheTest_testLoad";
+  auto now = Time().getTimeFromEpoch();
+  std::string in = "host=expired, port=80, expiry=" + util::itos(now - 1) +
+                   ", addrs=192.168.0.1\n"
+                   "host=alive, port=80, expiry=" +
+                   util::itos(now + 3600) +
+                   ", addrs=192.168.0.2;::2\n"
+                   "host=noexpiry, port=443, expiry=0, addrs=192.168.0.3\n"
+                   "host=badaddr, port=80, expiry=0, addrs=foo\n"
+                   "host=badport, port=65536, expiry=0, addrs=192.168.0.4\n";
+  BufferedFile fp(filename, BufferedFile::WRITE);
+  CPPUNIT_ASSERT_EQUAL((size_t)in.size(), fp.write(in.data(), in.size()));
+  CPPUNIT_ASSERT(fp.close() != EOF);
+
+  DNSCache cache;
+  CPPUNIT_ASSERT(cache.load(filename));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, cache.size());
+  std::vector<std::string> addrs;
+  cache.findAll(std::back_inserter(addrs), "alive", 80);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, addrs.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("::2"), addrs[1]);
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.3"), cache.find("noexpiry", 443));
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache.find("expired", 80));
+}
+
 } // namespace aria2
@@ -0,0 +1,139 @@
+// Measures the throughput of the content decoding stream filters.
+// Build with "make bench-decoding" and run without arguments to decode
+// the test data, or pass files ending with .gz, .zst or .br, e.g. the
+// same package index compressed with each of gzip, zstd and brotli.
+
+#include "common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "StreamFilter.h"
+#include "util.h"
+#ifdef HAVE_ZLIB
+#  include "GZipDecodingStreamFilter.h"
+#endif // HAVE_ZLIB
+#ifdef HAVE_LIBZSTD
+#  include "ZstdDecodingStreamFilter.h"
+#endif // HAVE_LIBZSTD
+#ifdef HAVE_LIBBROTLI
+#  include "BrotliDecodingStreamFilter.h"
+#endif // HAVE_LIBBROTLI
+
+using namespace aria2;
+
+namespace {
+// Feeds the input in pieces of 16KiB, which is the size of the buffer
+// DownloadCommand reads from the socket, and decodes about 256MiB in
+// total.
+const size_t CHUNK_SIZE = 16 * 1024;
+const size_t TOTAL_OUTPUT = 256 * 1024 * 1024;
+
+// Discards decoded data, so that only decoding is measured.
+class NullStreamFilter : public StreamFilter {
+public:
+  virtual void init() CXX11_OVERRIDE {}
+
+  virtual ssize_t transform(const std::shared_ptr<BinaryStream>& out,
+                            const std::shared_ptr<Segment>& segment,
+                            const unsigned char* inbuf,
+                            size_t inlen) CXX11_OVERRIDE
+  {
+    return inlen;
+  }
+
+  virtual bool finished() CXX11_OVERRIDE { return true; }
+
+  virtual void release() CXX11_OVERRIDE {}
+
+  virtual const std::string& getName() const CXX11_OVERRIDE { return name_; }
+
+  virtual size_t getBytesProcessed() const CXX11_OVERRIDE { return 0; }
+
+private:
+  std::string name_ = "NullStreamFilter";
+};
+
+std::unique_ptr<StreamFilter> createFilter(const std::string& path)
+{
+  auto sink = make_unique<NullStreamFilter>();
+#ifdef HAVE_ZLIB
+  if (util::endsWith(path, ".gz")) {
+    return make_unique<GZipDecodingStreamFilter>(std::move(sink));
+  }
+#endif // HAVE_ZLIB
+#ifdef HAVE_LIBZSTD
+  if (util::endsWith(path, ".zst")) {
+    return make_unique<ZstdDecodingStreamFilter>(std::move(sink));
+  }
+#endif // HAVE_LIBZSTD
+#ifdef HAVE_LIBBROTLI
+  if (util::endsWith(path, ".br")) {
+    return make_unique<BrotliDecodingStreamFilter>(std::move(sink));
+  }
+#endif // HAVE_LIBBROTLI
+  return nullptr;
+}
+
+// Decodes |data| once and returns the decoded length.
+size_t decode(StreamFilter* filter, const std::string& data)
+{
+  std::shared_ptr<BinaryStream> out;
+  std::shared_ptr<Segment> segment;
+  auto p = reinterpret_cast<const unsigned char*>(data.data());
+  size_t outlen = 0;
+  filter->init();
+  for (size_t i = 0; i < data.size(); i += CHUNK_SIZE) {
+    outlen += filter->transform(out, segment, p + i,
+                                std::min(CHUNK_SIZE, data.size() - i));
+  }
+  return outlen;
+}
+
+void measure(const std::string& path)
+{
+  auto name = path.substr(path.rfind('/') + 1);
+  auto filter = createFilter(path);
+  if (!filter) {
+    printf("%-32s not supported by this build\n", name.c_str());
+    return;
+  }
+  std::ifstream in(path, std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(in)),
+                   std::istreambuf_iterator<char>());
+  auto outlen = decode(filter.get(), data);
+  if (outlen == 0) {
+    printf("%-32s empty\n", name.c_str());
+    return;
+  }
+  auto rounds = std::max(static_cast<size_t>(1), TOTAL_OUTPUT / outlen);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    decode(filter.get(), data);
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  printf("%-32s ratio %5.2f %8.1f MB/s\n", name.c_str(),
+         static_cast<double>(outlen) / data.size(),
+         static_cast<double>(outlen) * rounds / elapsed.count() / 1e6);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> paths(argv + 1, argv + argc);
+  if (paths.empty()) {
+    paths = {A2_TEST_DIR "/gzip_decode_test.gz",
+             A2_TEST_DIR "/zstd_decode_test.zst",
+             A2_TEST_DIR "/brotli_decode_test.br"};
+  }
+  for (const auto& path : paths) {
+    measure(path);
+  }
+  return 0;
+}
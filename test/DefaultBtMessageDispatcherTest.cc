@@ -33,6 +33,8 @@ class DefaultBtMessageDispatcherTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testCheckRequestSlotAndDoNecessaryThing);
   CPPUNIT_TEST(testCheckRequestSlotAndDoNecessaryThing_timeout);
   CPPUNIT_TEST(testCheckRequestSlotAndDoNecessaryThing_completeBlock);
+  CPPUNIT_TEST(testCheckRequestSlotAndDoNecessaryThing_partialTimeout);
+  CPPUNIT_TEST(testDoAbortOutstandingRequestAction);
   CPPUNIT_TEST(testCountOutstandingRequest);
   CPPUNIT_TEST(testIsOutstandingRequest);
   CPPUNIT_TEST(testGetOutstandingRequest);
@@ -59,6 +61,8 @@ public:
   void testCheckRequestSlotAndDoNecessaryThing();
   void testCheckRequestSlotAndDoNecessaryThing_timeout();
   void testCheckRequestSlotAndDoNecessaryThing_completeBlock();
+  void testCheckRequestSlotAndDoNecessaryThing_partialTimeout();
+  void testDoAbortOutstandingRequestAction();
   void testCountOutstandingRequest();
   void testIsOutstandingRequest();
   void testGetOutstandingRequest();
@@ -265,6 +269,68 @@ void DefaultBtMessageDispatcherTest::
                        btMessageDispatcher->getRequestSlots().size());
 }
 
+void DefaultBtMessageDispatcherTest::
+    testCheckRequestSlotAndDoNecessaryThing_partialTimeout()
+{
+  auto piece = std::make_shared<Piece>(0, MY_PIECE_LENGTH * 3);
+  for (size_t i = 0; i < 3; ++i) {
+    size_t index;
+    CPPUNIT_ASSERT(piece->getMissingUnusedBlockIndex(index));
+    CPPUNIT_ASSERT_EQUAL(i, index);
+  }
+  btMessageDispatcher->setRequestTimeout(1_min);
+  // Slots are added out of dispatched time order.
+  btMessageDispatcher->addOutstandingRequest(
+      make_unique<RequestSlot>(0, 0, MY_PIECE_LENGTH, 0, piece));
+  auto slot = make_unique<RequestSlot>(0, MY_PIECE_LENGTH, MY_PIECE_LENGTH, 1,
+                                       piece);
+  slot->setDispatchedTime(Timer::zero());
+  btMessageDispatcher->addOutstandingRequest(std::move(slot));
+  btMessageDispatcher->addOutstandingRequest(make_unique<RequestSlot>(
+      0, MY_PIECE_LENGTH * 2, MY_PIECE_LENGTH, 2, piece));
+
+  btMessageDispatcher->checkRequestSlotAndDoNecessaryThing();
+
+  CPPUNIT_ASSERT_EQUAL((size_t)2,
+                       btMessageDispatcher->countOutstandingRequest());
+  CPPUNIT_ASSERT(btMessageDispatcher->isOutstandingRequest(0, 0));
+  CPPUNIT_ASSERT(!btMessageDispatcher->isOutstandingRequest(0, 1));
+  CPPUNIT_ASSERT(btMessageDispatcher->isOutstandingRequest(0, 2));
+  CPPUNIT_ASSERT(!btMessageDispatcher->getOutstandingRequest(
+      0, MY_PIECE_LENGTH, MY_PIECE_LENGTH));
+  CPPUNIT_ASSERT(piece->isBlockUsed(0));
+  CPPUNIT_ASSERT(!piece->isBlockUsed(1));
+  CPPUNIT_ASSERT(piece->isBlockUsed(2));
+}
+
+void DefaultBtMessageDispatcherTest::testDoAbortOutstandingRequestAction()
+{
+  auto piece0 = std::make_shared<Piece>(0, MY_PIECE_LENGTH * 2);
+  auto piece1 = std::make_shared<Piece>(1, MY_PIECE_LENGTH);
+  size_t index;
+  CPPUNIT_ASSERT(piece0->getMissingUnusedBlockIndex(index));
+  CPPUNIT_ASSERT(piece0->getMissingUnusedBlockIndex(index));
+  CPPUNIT_ASSERT(piece1->getMissingUnusedBlockIndex(index));
+  btMessageDispatcher->addOutstandingRequest(
+      make_unique<RequestSlot>(0, 0, MY_PIECE_LENGTH, 0, piece0));
+  btMessageDispatcher->addOutstandingRequest(
+      make_unique<RequestSlot>(1, 0, MY_PIECE_LENGTH, 0, piece1));
+  btMessageDispatcher->addOutstandingRequest(make_unique<RequestSlot>(
+      0, MY_PIECE_LENGTH, MY_PIECE_LENGTH, 1, piece0));
+
+  btMessageDispatcher->doAbortOutstandingRequestAction(piece0);
+
+  CPPUNIT_ASSERT_EQUAL((size_t)1,
+                       btMessageDispatcher->countOutstandingRequest());
+  CPPUNIT_ASSERT(!btMessageDispatcher->isOutstandingRequest(0, 0));
+  CPPUNIT_ASSERT(!btMessageDispatcher->isOutstandingRequest(0, 1));
+  CPPUNIT_ASSERT(btMessageDispatcher->getOutstandingRequest(1, 0,
+                                                            MY_PIECE_LENGTH));
+  CPPUNIT_ASSERT(!piece0->isBlockUsed(0));
+  CPPUNIT_ASSERT(!piece0->isBlockUsed(1));
+  CPPUNIT_ASSERT(piece1->isBlockUsed(0));
+}
+
 void DefaultBtMessageDispatcherTest::testCountOutstandingRequest()
 {
   btMessageDispatcher->addOutstandingRequest(
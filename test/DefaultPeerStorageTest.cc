@@ -25,6 +25,9 @@ class DefaultPeerStorageTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testReturnPeer);
   CPPUNIT_TEST(testOnErasingPeer);
   CPPUNIT_TEST(testAddBadPeer);
+  CPPUNIT_TEST(testPeerScore);
+  CPPUNIT_TEST(testPeerScoreEviction);
+  CPPUNIT_TEST(testAddPeerByHostname);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -49,6 +52,9 @@ public:
   void testReturnPeer();
   void testOnErasingPeer();
   void testAddBadPeer();
+  void testPeerScore();
+  void testPeerScoreEviction();
+  void testAddPeerByHostname();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DefaultPeerStorageTest);
@@ -231,6 +237,98 @@ void DefaultPeerStorageTest::testAddBadPeer()
   ps.addBadPeer("192.168.0.1");
   CPPUNIT_ASSERT(ps.isBadPeer("192.168.0.1"));
   CPPUNIT_ASSERT(!ps.isBadPeer("192.168.0.2"));
+  ps.addBadPeer("2001:db8::1");
+  CPPUNIT_ASSERT(ps.isBadPeer("2001:db8::1"));
+  CPPUNIT_ASSERT(!ps.isBadPeer("2001:db8::2"));
+}
+
+void DefaultPeerStorageTest::testPeerScore()
+{
+  DefaultPeerStorage ps;
+  ps.setMaxPeerListSize(3);
+
+  auto good = std::make_shared<Peer>("192.168.0.1", 6889);
+  auto bad = std::make_shared<Peer>("192.168.0.2", 6889);
+  CPPUNIT_ASSERT(ps.addPeer(good));
+  CPPUNIT_ASSERT(ps.addPeer(bad));
+  CPPUNIT_ASSERT(good == ps.checkoutPeer(1));
+  CPPUNIT_ASSERT(bad == ps.checkoutPeer(2));
+  good->allocateSessionResource(1_m, 10_m);
+  ps.returnPeer(good);
+  ps.returnPeer(bad);
+  CPPUNIT_ASSERT_EQUAL(1, ps.getPeerScore(good));
+  CPPUNIT_ASSERT_EQUAL(-1, ps.getPeerScore(bad));
+
+  std::vector<std::shared_ptr<Peer>> peers{
+      std::make_shared<Peer>("192.168.0.2", 6889),
+      std::make_shared<Peer>("192.168.0.3", 6889),
+      std::make_shared<Peer>("192.168.0.1", 6889),
+  };
+  ps.addPeer(peers);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, ps.getUnusedPeers().size());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.1"),
+                       ps.getUnusedPeers()[0]->getIPAddress());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.3"),
+                       ps.getUnusedPeers()[1]->getIPAddress());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.2"),
+                       ps.getUnusedPeers()[2]->getIPAddress());
+
+  // The list is full.  New peer replaces the peer with lower score.
+  CPPUNIT_ASSERT(ps.addPeer(std::make_shared<Peer>("192.168.0.4", 6889)));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, ps.getUnusedPeers().size());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.4"),
+                       ps.getUnusedPeers()[2]->getIPAddress());
+  CPPUNIT_ASSERT(!ps.addPeer(std::make_shared<Peer>("192.168.0.5", 6889)));
+  CPPUNIT_ASSERT(!ps.addPeer(std::make_shared<Peer>("192.168.0.2", 6889)));
+}
+
+void DefaultPeerStorageTest::testPeerScoreEviction()
+{
+  DefaultPeerStorage ps;
+
+  auto good = std::make_shared<Peer>("192.168.0.1", 6889);
+  auto bad = std::make_shared<Peer>("192.168.0.2", 6889);
+  CPPUNIT_ASSERT(ps.addPeer(good));
+  CPPUNIT_ASSERT(ps.addPeer(bad));
+  CPPUNIT_ASSERT(good == ps.checkoutPeer(1));
+  CPPUNIT_ASSERT(bad == ps.checkoutPeer(2));
+  good->allocateSessionResource(1_m, 10_m);
+  ps.returnPeer(good);
+  ps.returnPeer(bad);
+  CPPUNIT_ASSERT(ps.addPeer(std::make_shared<Peer>("192.168.0.2", 6889)));
+  CPPUNIT_ASSERT(ps.addPeer(std::make_shared<Peer>("192.168.0.1", 6889)));
+
+  // Fill the score table with the peers which failed to connect.
+  std::vector<std::shared_ptr<Peer>> failed;
+  for (size_t i = 0; i < DefaultPeerStorage::MAX_PEER_SCORE_SIZE; ++i) {
+    auto peer = std::make_shared<Peer>("192.168.1.1", 1024 + i);
+    CPPUNIT_ASSERT(peer == ps.addAndCheckoutPeer(peer, 3 + i));
+    ps.returnPeer(peer);
+    failed.push_back(peer);
+  }
+
+  // The scores of unused peers survive, and their order is kept.
+  CPPUNIT_ASSERT_EQUAL(1, ps.getPeerScore(good));
+  CPPUNIT_ASSERT_EQUAL(-1, ps.getPeerScore(bad));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, ps.getUnusedPeers().size());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.1"),
+                       ps.getUnusedPeers()[0]->getIPAddress());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.2"),
+                       ps.getUnusedPeers()[1]->getIPAddress());
+  // The least recently updated scores are evicted instead.
+  CPPUNIT_ASSERT_EQUAL(0, ps.getPeerScore(failed.front()));
+  CPPUNIT_ASSERT_EQUAL(-1, ps.getPeerScore(failed.back()));
+}
+
+void DefaultPeerStorageTest::testAddPeerByHostname()
+{
+  DefaultPeerStorage ps;
+  CPPUNIT_ASSERT(ps.addPeer(std::make_shared<Peer>("peer.example.org", 6889)));
+  CPPUNIT_ASSERT(ps.addPeer(std::make_shared<Peer>("peer.example.org", 6890)));
+  CPPUNIT_ASSERT(ps.addPeer(std::make_shared<Peer>("peer.example.net", 6889)));
+  CPPUNIT_ASSERT(
+      !ps.addPeer(std::make_shared<Peer>("peer.example.org", 6889)));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, ps.countAllPeer());
 }
 
 } // namespace aria2
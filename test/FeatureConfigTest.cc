@@ -89,6 +89,18 @@ void FeatureConfigTest::testFeatureSummary()
 #ifdef HAVE_LIBSSH2
       "SFTP",
 #endif // HAVE_LIBSSH2
+
+#if defined(ENABLE_SSL) && defined(HAVE_LIBNGHTTP2)
+      "HTTP/2",
+#endif // ENABLE_SSL && HAVE_LIBNGHTTP2
+
+#ifdef HAVE_LIBZSTD
+      "Zstd",
+#endif // HAVE_LIBZSTD
+
+#ifdef HAVE_LIBBROTLI
+      "Brotli",
+#endif // HAVE_LIBBROTLI
   };
 
   std::string featuresString =
@@ -107,12 +107,14 @@ void HandshakeExtensionMessageTest::testDoReceivedAction()
   msg.setExtension(ExtensionMessageRegistry::UT_PEX, 1);
   msg.setExtension(ExtensionMessageRegistry::UT_METADATA, 3);
   msg.setMetadataSize(1_k);
+  msg.setReqq(500);
   msg.setPeer(peer);
   msg.setDownloadContext(dctx.get());
 
   msg.doReceivedAction();
 
   CPPUNIT_ASSERT_EQUAL((uint16_t)6889, peer->getPort());
+  CPPUNIT_ASSERT_EQUAL((size_t)500, peer->getReqq());
   CPPUNIT_ASSERT_EQUAL((uint8_t)1, peer->getExtensionMessageID(
                                        ExtensionMessageRegistry::UT_PEX));
   CPPUNIT_ASSERT_EQUAL((uint8_t)3, peer->getExtensionMessageID(
@@ -134,7 +136,8 @@ void HandshakeExtensionMessageTest::testDoReceivedAction()
 void HandshakeExtensionMessageTest::testCreate()
 {
   std::string in =
-      "0d1:pi6881e1:v5:aria21:md5:a2dhti2e6:ut_pexi1ee13:metadata_sizei1024ee";
+      "0d1:pi6881e1:v5:aria21:md5:a2dhti2e6:ut_pexi1ee13:metadata_sizei1024e"
+      "4:reqqi128ee";
   std::shared_ptr<HandshakeExtensionMessage> m(
       HandshakeExtensionMessage::create(
           reinterpret_cast<const unsigned char*>(in.c_str()), in.size()));
@@ -143,6 +146,21 @@ void HandshakeExtensionMessageTest::testCreate()
   CPPUNIT_ASSERT_EQUAL(
       (uint8_t)1, m->getExtensionMessageID(ExtensionMessageRegistry::UT_PEX));
   CPPUNIT_ASSERT_EQUAL((size_t)1_k, m->getMetadataSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)128, m->getReqq());
+  {
+    // reqq is capped by UB_MAX_OUTSTANDING_REQUEST
+    std::string in = "0d4:reqqi100000ee";
+    auto m = HandshakeExtensionMessage::create(
+        reinterpret_cast<const unsigned char*>(in.c_str()), in.size());
+    CPPUNIT_ASSERT_EQUAL(UB_MAX_OUTSTANDING_REQUEST, m->getReqq());
+  }
+  {
+    // negative reqq is ignored
+    std::string in = "0d4:reqqi-1ee";
+    auto m = HandshakeExtensionMessage::create(
+        reinterpret_cast<const unsigned char*>(in.c_str()), in.size());
+    CPPUNIT_ASSERT_EQUAL((size_t)0, m->getReqq());
+  }
   try {
     // bad payload format
     std::string in = "011:hello world";
@@ -0,0 +1,283 @@
+#include "Http2Session.h"
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <nghttp2/nghttp2.h>
+
+#include "SocketCore.h"
+#include "DlRetryEx.h"
+#include "util.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+class Http2SessionTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(Http2SessionTest);
+  CPPUNIT_TEST(testMultiplexedRequests);
+  CPPUNIT_TEST(testStreamReset);
+  CPPUNIT_TEST(testCloseStream);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp();
+  void tearDown();
+
+  void testMultiplexedRequests();
+  void testStreamReset();
+  void testCloseStream();
+
+  // A minimal HTTP/2 server built on nghttp2 server session.
+  struct Server {
+    nghttp2_session* session;
+    std::shared_ptr<SocketCore> socket;
+    std::string body;
+    bool resetStream;
+    std::map<int32_t, std::vector<std::pair<std::string, std::string>>>
+        requests;
+    std::map<int32_t, size_t> offsets;
+    std::vector<int32_t> resetStreams;
+  };
+
+private:
+  std::shared_ptr<SocketCore> clientSocket_;
+  std::unique_ptr<Server> server_;
+
+  void pump(Http2Session& session);
+  std::string readAll(Http2Session& session, int32_t streamId);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(Http2SessionTest);
+
+namespace {
+Http2SessionTest::Server* toServer(void* userData)
+{
+  return static_cast<Http2SessionTest::Server*>(userData);
+}
+} // namespace
+
+namespace {
+ssize_t sendCallback(nghttp2_session* session, const uint8_t* data,
+                     size_t len, int flags, void* userData)
+{
+  auto n = toServer(userData)->socket->writeData(data, len);
+  return n == 0 ? NGHTTP2_ERR_WOULDBLOCK : n;
+}
+} // namespace
+
+namespace {
+ssize_t recvCallback(nghttp2_session* session, uint8_t* buf, size_t len,
+                     int flags, void* userData)
+{
+  toServer(userData)->socket->readData(buf, len);
+  return len == 0 ? NGHTTP2_ERR_WOULDBLOCK : len;
+}
+} // namespace
+
+namespace {
+int onHeaderCallback(nghttp2_session* session, const nghttp2_frame* frame,
+                     const uint8_t* name, size_t namelen, const uint8_t* value,
+                     size_t valuelen, uint8_t flags, void* userData)
+{
+  toServer(userData)->requests[frame->hd.stream_id].emplace_back(
+      std::string(name, name + namelen), std::string(value, value + valuelen));
+  return 0;
+}
+} // namespace
+
+namespace {
+ssize_t readBodyCallback(nghttp2_session* session, int32_t streamId,
+                         uint8_t* buf, size_t len, uint32_t* dataFlags,
+                         nghttp2_data_source* source, void* userData)
+{
+  auto server = toServer(userData);
+  auto& offset = server->offsets[streamId];
+  auto n = std::min(len, server->body.size() - offset);
+  memcpy(buf, server->body.data() + offset, n);
+  offset += n;
+  if (offset == server->body.size()) {
+    *dataFlags |= NGHTTP2_DATA_FLAG_EOF;
+  }
+  return n;
+}
+} // namespace
+
+namespace {
+int onFrameRecvCallback(nghttp2_session* session, const nghttp2_frame* frame,
+                        void* userData)
+{
+  auto server = toServer(userData);
+  if (frame->hd.type == NGHTTP2_RST_STREAM) {
+    server->resetStreams.push_back(frame->hd.stream_id);
+    return 0;
+  }
+  if (frame->hd.type != NGHTTP2_HEADERS ||
+      !(frame->hd.flags & NGHTTP2_FLAG_END_STREAM)) {
+    return 0;
+  }
+  if (server->resetStream) {
+    nghttp2_submit_rst_stream(session, NGHTTP2_FLAG_NONE, frame->hd.stream_id,
+                              NGHTTP2_REFUSED_STREAM);
+    return 0;
+  }
+  std::string status = "206";
+  auto length = util::uitos(server->body.size());
+  nghttp2_nv nva[] = {
+      {(uint8_t*)":status", (uint8_t*)&status[0], 7, status.size(),
+       NGHTTP2_NV_FLAG_NONE},
+      {(uint8_t*)"content-length", (uint8_t*)&length[0], 14, length.size(),
+       NGHTTP2_NV_FLAG_NONE},
+  };
+  nghttp2_data_provider prd;
+  prd.read_callback = readBodyCallback;
+  nghttp2_submit_response(session, frame->hd.stream_id, nva, 2, &prd);
+  return 0;
+}
+} // namespace
+
+void Http2SessionTest::setUp()
+{
+  SocketCore serverSock;
+  serverSock.bind(0);
+  serverSock.beginListen();
+  serverSock.setBlockingMode();
+
+  clientSocket_ = std::make_shared<SocketCore>();
+  clientSocket_->establishConnection("localhost",
+                                     serverSock.getAddrInfo().port);
+  clientSocket_->setBlockingMode();
+
+  server_ = make_unique<Server>();
+  server_->resetStream = false;
+  server_->socket = serverSock.acceptConnection();
+  server_->socket->setNonBlockingMode();
+  clientSocket_->setNonBlockingMode();
+
+  nghttp2_session_callbacks* callbacks;
+  nghttp2_session_callbacks_new(&callbacks);
+  nghttp2_session_callbacks_set_send_callback(callbacks, sendCallback);
+  nghttp2_session_callbacks_set_recv_callback(callbacks, recvCallback);
+  nghttp2_session_callbacks_set_on_header_callback(callbacks,
+                                                   onHeaderCallback);
+  nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks,
+                                                       onFrameRecvCallback);
+  nghttp2_session_server_new(&server_->session, callbacks, server_.get());
+  nghttp2_session_callbacks_del(callbacks);
+  nghttp2_submit_settings(server_->session, NGHTTP2_FLAG_NONE, nullptr, 0);
+}
+
+void Http2SessionTest::tearDown() { nghttp2_session_del(server_->session); }
+
+void Http2SessionTest::pump(Http2Session& session)
+{
+  for (int i = 0; i < 10; ++i) {
+    nghttp2_session_recv(server_->session);
+    nghttp2_session_send(server_->session);
+    session.performIO();
+  }
+}
+
+std::string Http2SessionTest::readAll(Http2Session& session, int32_t streamId)
+{
+  std::string res;
+  unsigned char buf[4096];
+  while (!session.streamEnded(streamId)) {
+    pump(session);
+    for (;;) {
+      auto n = session.readStream(streamId, buf, sizeof(buf));
+      if (n == 0) {
+        break;
+      }
+      res.append(&buf[0], &buf[n]);
+    }
+  }
+  return res;
+}
+
+void Http2SessionTest::testMultiplexedRequests()
+{
+  // Larger than the initial window, so that the window must be given
+  // back while the body is read.
+  server_->body.assign(3_m, 'a');
+  Http2Session session(clientSocket_, nullptr);
+  auto request = std::string("GET /file HTTP/1.1\r\n"
+                             "User-Agent: aria2\r\n"
+                             "Host: localhost:8443\r\n"
+                             "Connection: close\r\n"
+                             "Range: bytes=0-\r\n"
+                             "\r\n");
+  auto stream1 = session.submitRequest("https", request);
+  auto stream2 = session.submitRequest("https", request);
+  CPPUNIT_ASSERT(stream1 != stream2);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, session.countStream());
+
+  auto expected = std::string("HTTP/1.1 206\r\n"
+                              "content-length: 3145728\r\n"
+                              "Connection: close\r\n"
+                              "\r\n") +
+                  server_->body;
+  CPPUNIT_ASSERT(expected == readAll(session, stream1));
+  CPPUNIT_ASSERT(expected == readAll(session, stream2));
+
+  auto& fields = server_->requests[stream1];
+  std::vector<std::pair<std::string, std::string>> expectedFields = {
+      {":method", "GET"},
+      {":scheme", "https"},
+      {":authority", "localhost:8443"},
+      {":path", "/file"},
+      {"user-agent", "aria2"},
+      {"range", "bytes=0-"},
+  };
+  CPPUNIT_ASSERT(expectedFields == fields);
+
+  session.closeStream(stream1);
+  session.closeStream(stream2);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, session.countStream());
+  CPPUNIT_ASSERT(session.canOpenStream());
+}
+
+void Http2SessionTest::testStreamReset()
+{
+  server_->resetStream = true;
+  Http2Session session(clientSocket_, nullptr);
+  auto streamId = session.submitRequest(
+      "https", "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  pump(session);
+  CPPUNIT_ASSERT(session.hasPendingData(streamId));
+  unsigned char buf[16];
+  try {
+    session.readStream(streamId, buf, sizeof(buf));
+    CPPUNIT_FAIL("exception must be thrown");
+  }
+  catch (DlRetryEx& e) {
+  }
+  // The session is still usable.
+  CPPUNIT_ASSERT(session.canOpenStream());
+}
+
+void Http2SessionTest::testCloseStream()
+{
+  server_->body.assign(2_m, 'a');
+  Http2Session session(clientSocket_, nullptr);
+  auto streamId = session.submitRequest(
+      "https", "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  pump(session);
+  CPPUNIT_ASSERT(session.hasPendingData(streamId));
+  // Canceling the stream in the middle of body sends RST_STREAM.
+  session.closeStream(streamId);
+  pump(session);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, server_->resetStreams.size());
+  CPPUNIT_ASSERT_EQUAL(streamId, server_->resetStreams[0]);
+  CPPUNIT_ASSERT(session.streamEnded(streamId));
+
+  // The session keeps working for other streams.
+  auto nextStreamId = session.submitRequest(
+      "https", "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  auto res = readAll(session, nextStreamId);
+  CPPUNIT_ASSERT(util::endsWith(res, server_->body));
+}
+
+} // namespace aria2
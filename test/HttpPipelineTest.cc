@@ -0,0 +1,222 @@
+#include "HttpPipeline.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SocketCore.h"
+#include "SocketRecvBuffer.h"
+#include "HttpConnection.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "HttpHeader.h"
+#include "Request.h"
+#include "FileEntry.h"
+#include "Option.h"
+#include "AuthConfigFactory.h"
+#include "prefs.h"
+#include "wallclock.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+class HttpPipelineTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(HttpPipelineTest);
+  CPPUNIT_TEST(testResponseOrder);
+  CPPUNIT_TEST(testDetach);
+  CPPUNIT_TEST(testStop);
+  CPPUNIT_TEST(testCanAttach);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp();
+
+  void testResponseOrder();
+  void testDetach();
+  void testStop();
+  void testCanAttach();
+
+private:
+  std::shared_ptr<SocketCore> clientSocket_;
+  std::shared_ptr<SocketCore> serverSocket_;
+  std::unique_ptr<Option> option_;
+  std::unique_ptr<AuthConfigFactory> authConfigFactory_;
+
+  std::unique_ptr<HttpRequest> createHttpRequest(const std::string& uri);
+  std::shared_ptr<HttpPipeline> createPipeline(size_t maxRequests);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HttpPipelineTest);
+
+void HttpPipelineTest::setUp()
+{
+  SocketCore serverSock;
+  serverSock.bind(0);
+  serverSock.beginListen();
+  serverSock.setBlockingMode();
+
+  clientSocket_ = std::make_shared<SocketCore>();
+  clientSocket_->establishConnection("localhost",
+                                     serverSock.getAddrInfo().port);
+  clientSocket_->setBlockingMode();
+  serverSocket_ = serverSock.acceptConnection();
+  serverSocket_->setBlockingMode();
+
+  option_ = make_unique<Option>();
+  authConfigFactory_ = make_unique<AuthConfigFactory>();
+}
+
+std::unique_ptr<HttpRequest>
+HttpPipelineTest::createHttpRequest(const std::string& uri)
+{
+  auto req = std::make_shared<Request>();
+  req->setUri(uri);
+  auto httpRequest = make_unique<HttpRequest>();
+  httpRequest->setRequest(req);
+  httpRequest->setFileEntry(std::make_shared<FileEntry>("file", 0, 0));
+  httpRequest->setAuthConfigFactory(authConfigFactory_.get());
+  httpRequest->setOption(option_.get());
+  return httpRequest;
+}
+
+std::shared_ptr<HttpPipeline>
+HttpPipelineTest::createPipeline(size_t maxRequests)
+{
+  return std::make_shared<HttpPipeline>(
+      clientSocket_, std::make_shared<SocketRecvBuffer>(clientSocket_),
+      nullptr, maxRequests);
+}
+
+void HttpPipelineTest::testResponseOrder()
+{
+  auto pipeline = createPipeline(2);
+  auto conn1 = std::make_shared<HttpConnection>(
+      1, clientSocket_, pipeline->getSocketRecvBuffer());
+  auto conn2 = std::make_shared<HttpConnection>(
+      2, clientSocket_, pipeline->getSocketRecvBuffer());
+  conn1->setHttpPipeline(pipeline);
+  conn2->setHttpPipeline(pipeline);
+  CPPUNIT_ASSERT(!pipeline->canAttach());
+
+  conn1->sendRequest(createHttpRequest("http://localhost/a"));
+  conn2->sendRequest(createHttpRequest("http://localhost/b"));
+  CPPUNIT_ASSERT(conn2->sendBufferIsEmpty());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, pipeline->countRequest());
+
+  // Both requests arrive without waiting for the first response.
+  std::string requests;
+  while (requests.find("GET /b ") == std::string::npos) {
+    char buf[4_k];
+    size_t len = sizeof(buf);
+    serverSocket_->readData(buf, len);
+    CPPUNIT_ASSERT(len > 0);
+    requests.append(buf, len);
+  }
+  CPPUNIT_ASSERT(requests.find("GET /a ") < requests.find("GET /b "));
+
+  std::string responses = "HTTP/1.1 200 OK\r\n"
+                          "Content-Length: 3\r\n"
+                          "\r\n"
+                          "foo"
+                          "HTTP/1.1 404 Not Found\r\n"
+                          "Content-Length: 0\r\n"
+                          "\r\n";
+  serverSocket_->writeData(responses);
+
+  // The second response is not read until the first one completes.
+  CPPUNIT_ASSERT(!conn2->receiveResponse());
+  CPPUNIT_ASSERT(conn2->isWaitingForPipeline());
+  std::unique_ptr<HttpResponse> res1;
+  while (!(res1 = conn1->receiveResponse()))
+    ;
+  CPPUNIT_ASSERT_EQUAL(200, res1->getStatusCode());
+  CPPUNIT_ASSERT_EQUAL(std::string("a"),
+                       res1->getHttpRequest()->getRequest()->getFile());
+  CPPUNIT_ASSERT(!conn2->receiveResponse());
+  auto& recvBuf = pipeline->getSocketRecvBuffer();
+  CPPUNIT_ASSERT(recvBuf->getBufferLength() >= 3);
+  CPPUNIT_ASSERT_EQUAL(std::string("foo"),
+                       std::string(recvBuf->getBuffer(),
+                                   recvBuf->getBuffer() + 3));
+  recvBuf->drain(3);
+  CPPUNIT_ASSERT(conn1->completeResponse());
+  CPPUNIT_ASSERT(!conn2->isWaitingForPipeline());
+
+  auto res2 = conn2->receiveResponse();
+  CPPUNIT_ASSERT(res2);
+  CPPUNIT_ASSERT_EQUAL(404, res2->getStatusCode());
+  CPPUNIT_ASSERT(conn2->completeResponse());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, pipeline->countRequest());
+  CPPUNIT_ASSERT(!pipeline->failed());
+
+  // Without pipeline, the socket is pooled as usual.
+  HttpConnection conn3(3, clientSocket_,
+                       std::make_shared<SocketRecvBuffer>(clientSocket_));
+  CPPUNIT_ASSERT(!conn3.completeResponse());
+}
+
+void HttpPipelineTest::testDetach()
+{
+  auto pipeline = createPipeline(4);
+  pipeline->attach(1, true);
+  pipeline->attach(2);
+  pipeline->attach(3);
+  pipeline->attach(4);
+  pipeline->sendRequest(2, "GET /b HTTP/1.1\r\n\r\n");
+  pipeline->sendRequest(3, "GET /c HTTP/1.1\r\n\r\n");
+  CPPUNIT_ASSERT_EQUAL((size_t)3, pipeline->countRequest());
+  CPPUNIT_ASSERT(pipeline->isHead(1));
+
+  // Detaching before sending request does not break the connection.
+  pipeline->detach(4);
+  CPPUNIT_ASSERT(!pipeline->failed());
+  CPPUNIT_ASSERT_EQUAL((size_t)3, pipeline->countRequest());
+
+  // Nobody reads the response for 2, and the response for 3 after it.
+  pipeline->detach(2);
+  CPPUNIT_ASSERT(pipeline->failed());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, pipeline->countRequest());
+  CPPUNIT_ASSERT(pipeline->isHead(1));
+  CPPUNIT_ASSERT(!pipeline->isHead(3));
+  CPPUNIT_ASSERT(!pipeline->canAttach());
+  CPPUNIT_ASSERT(pipeline->isTimeout(std::chrono::seconds(15)));
+
+  pipeline->complete(1);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, pipeline->countRequest());
+}
+
+void HttpPipelineTest::testStop()
+{
+  auto pipeline = createPipeline(3);
+  pipeline->attach(1, true);
+  pipeline->attach(2);
+  pipeline->attach(3);
+  pipeline->sendRequest(2, "GET /b HTTP/1.1\r\n\r\n");
+  pipeline->sendRequest(3, "GET /c HTTP/1.1\r\n\r\n");
+  pipeline->stop();
+  CPPUNIT_ASSERT(pipeline->failed());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, pipeline->countRequest());
+  CPPUNIT_ASSERT(pipeline->isHead(1));
+}
+
+void HttpPipelineTest::testCanAttach()
+{
+  global::wallclock().reset();
+  auto pipeline = createPipeline(2);
+  pipeline->attach(1, true);
+  pipeline->attach(2);
+  CPPUNIT_ASSERT(!pipeline->canAttach());
+  pipeline->complete(2);
+  // Only the command at the head completes the response.
+  CPPUNIT_ASSERT_EQUAL((size_t)1, pipeline->countRequest());
+  pipeline->complete(1);
+  pipeline->detach(1);
+  CPPUNIT_ASSERT(pipeline->canAttach());
+  pipeline->detach(2);
+  CPPUNIT_ASSERT(!pipeline->failed());
+  CPPUNIT_ASSERT(!pipeline->isTimeout(std::chrono::seconds(15)));
+  global::wallclock().advance(15_s);
+  CPPUNIT_ASSERT(pipeline->isTimeout(std::chrono::seconds(15)));
+  global::wallclock().reset();
+}
+
+} // namespace aria2
@@ -0,0 +1,162 @@
+#include "HttpResponseCommand.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "TestUtil.h"
+#include "DownloadEngine.h"
+#include "SelectEventPoll.h"
+#include "RequestGroupMan.h"
+#include "RequestGroup.h"
+#include "DownloadContext.h"
+#include "FileEntry.h"
+#include "Request.h"
+#include "SocketCore.h"
+#include "SocketRecvBuffer.h"
+#include "HttpConnection.h"
+#include "HttpRequest.h"
+#include "AuthConfigFactory.h"
+#include "OptionParser.h"
+#include "Option.h"
+#include "prefs.h"
+#include "util.h"
+#include "File.h"
+
+namespace aria2 {
+
+class HttpResponseCommandTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(HttpResponseCommandTest);
+  CPPUNIT_TEST(testUnsupportedContentEncoding);
+#ifdef HAVE_LIBBROTLI
+  CPPUNIT_TEST(testBrotliContentEncoding);
+#endif // HAVE_LIBBROTLI
+#ifdef HAVE_LIBZSTD
+  CPPUNIT_TEST(testZstdContentEncoding);
+#endif // HAVE_LIBZSTD
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::shared_ptr<Option> option_;
+  std::unique_ptr<DownloadEngine> e_;
+  std::unique_ptr<AuthConfigFactory> authConfigFactory_;
+  std::shared_ptr<RequestGroup> group_;
+  std::shared_ptr<SocketCore> clientSocket_;
+  std::shared_ptr<SocketCore> serverSocket_;
+
+  // Receives the response with |contentEncoding| and Content-Length
+  // for the request to |file|.
+  void receiveResponse(const std::string& file,
+                       const std::string& contentEncoding);
+
+public:
+  void setUp();
+
+  void tearDown()
+  {
+    // The commands created by HttpResponseCommand refer to group_.
+    e_.reset();
+    group_.reset();
+  }
+
+  void testUnsupportedContentEncoding();
+  void testBrotliContentEncoding();
+  void testZstdContentEncoding();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HttpResponseCommandTest);
+
+void HttpResponseCommandTest::setUp()
+{
+  option_ = std::make_shared<Option>();
+  OptionParser::getInstance()->parseDefaultValues(*option_);
+  option_->put(PREF_DIR, A2_TEST_OUT_DIR "/a2HttpResponseCommandTest");
+  option_->put(PREF_FILE_ALLOCATION, V_PREALLOC);
+  File(option_->get(PREF_DIR)).mkdirs();
+
+  e_ = make_unique<DownloadEngine>(make_unique<SelectEventPoll>());
+  e_->setOption(option_.get());
+  e_->setRequestGroupMan(make_unique<RequestGroupMan>(
+      std::vector<std::shared_ptr<RequestGroup>>{}, 1, option_.get()));
+  authConfigFactory_ = make_unique<AuthConfigFactory>();
+
+  SocketCore serverSock;
+  serverSock.bind(0);
+  serverSock.beginListen();
+  serverSock.setBlockingMode();
+  clientSocket_ = std::make_shared<SocketCore>();
+  clientSocket_->establishConnection("localhost",
+                                     serverSock.getAddrInfo().port);
+  clientSocket_->setBlockingMode();
+  serverSocket_ = serverSock.acceptConnection();
+  serverSocket_->setBlockingMode();
+}
+
+void HttpResponseCommandTest::receiveResponse(
+    const std::string& file, const std::string& contentEncoding)
+{
+  auto uri = "http://localhost/" + file;
+  File(option_->get(PREF_DIR) + "/" + file).remove();
+  group_ = createRequestGroup(1_m, 0, "", uri, option_);
+  auto& fileEntry = group_->getDownloadContext()->getFirstFileEntry();
+  auto req = fileEntry->getRequest(group_->getURISelector().get(), true, {});
+  CPPUNIT_ASSERT(req);
+
+  auto httpRequest = make_unique<HttpRequest>();
+  httpRequest->setRequest(req);
+  httpRequest->setFileEntry(fileEntry);
+  httpRequest->setAuthConfigFactory(authConfigFactory_.get());
+  httpRequest->setOption(option_.get());
+  httpRequest->enableAcceptGZip();
+  auto httpConnection = std::make_shared<HttpConnection>(
+      1, clientSocket_, std::make_shared<SocketRecvBuffer>(clientSocket_));
+  httpConnection->sendRequest(std::move(httpRequest));
+
+  serverSocket_->writeData("HTTP/1.1 200 OK\r\n"
+                           "Content-Length: 1024\r\n"
+                           "Content-Encoding: " +
+                           contentEncoding +
+                           "\r\n"
+                           "\r\n");
+
+  auto command = make_unique<HttpResponseCommand>(
+      1, req, fileEntry, group_.get(), httpConnection, e_.get(),
+      clientSocket_);
+  // The whole response header may not arrive at once.
+  for (int i = 0; i < 100; ++i) {
+    command->readEventReceived();
+    if (command->execute()) {
+      break;
+    }
+  }
+}
+
+void HttpResponseCommandTest::testUnsupportedContentEncoding()
+{
+  receiveResponse("compress", "compress");
+  // The encoded content is saved as is.  Content-Length is the size
+  // of the file, and segmented download is possible.
+  CPPUNIT_ASSERT_EQUAL((int64_t)1024, group_->getTotalLength());
+  CPPUNIT_ASSERT(group_->getDownloadContext()->knowsTotalLength());
+  CPPUNIT_ASSERT(group_->isFileAllocationEnabled());
+}
+
+void HttpResponseCommandTest::testBrotliContentEncoding()
+{
+  receiveResponse("br", "br");
+  // Content-Length is the size of the encoded content, so it is
+  // ignored.  File allocation is disabled because the decoding filter
+  // is installed.
+  CPPUNIT_ASSERT_EQUAL((int64_t)0, group_->getTotalLength());
+  CPPUNIT_ASSERT(!group_->getDownloadContext()->knowsTotalLength());
+  CPPUNIT_ASSERT(!group_->isFileAllocationEnabled());
+}
+
+void HttpResponseCommandTest::testZstdContentEncoding()
+{
+  receiveResponse("zstd", "zstd");
+  CPPUNIT_ASSERT_EQUAL((int64_t)0, group_->getTotalLength());
+  CPPUNIT_ASSERT(!group_->getDownloadContext()->knowsTotalLength());
+  CPPUNIT_ASSERT(!group_->isFileAllocationEnabled());
+}
+
+} // namespace aria2
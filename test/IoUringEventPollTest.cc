@@ -0,0 +1,162 @@
+#include "IoUringEventPoll.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Command.h"
+#ifdef HAVE_EPOLL
+#  include "EpollEventPoll.h"
+#endif // HAVE_EPOLL
+
+namespace aria2 {
+
+class IoUringEventPollTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(IoUringEventPollTest);
+  CPPUNIT_TEST(testAddEvents);
+  CPPUNIT_TEST(testModifyEvents);
+  CPPUNIT_TEST(testDeleteEvents);
+  CPPUNIT_TEST(testStaleCompletion);
+  CPPUNIT_TEST(testFallback);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  int fds_[2];
+
+  class MockCommand : public Command {
+  public:
+    MockCommand() : Command(1) {}
+
+    virtual bool execute() CXX11_OVERRIDE { return false; }
+
+    using Command::readEventEnabled;
+    using Command::writeEventEnabled;
+  };
+
+  void writeByte() { CPPUNIT_ASSERT_EQUAL((ssize_t)1, write(fds_[1], "a", 1)); }
+
+  void poll(int msec)
+  {
+    struct timeval tv = {0, msec * 1000};
+    poll_->poll(tv);
+  }
+
+  std::unique_ptr<IoUringEventPoll> poll_;
+
+public:
+  void setUp()
+  {
+    CPPUNIT_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+    poll_ = make_unique<IoUringEventPoll>();
+    CPPUNIT_ASSERT(poll_->good());
+  }
+
+  void tearDown()
+  {
+    poll_.reset();
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  void testAddEvents();
+  void testModifyEvents();
+  void testDeleteEvents();
+  void testStaleCompletion();
+  void testFallback();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IoUringEventPollTest);
+
+void IoUringEventPollTest::testAddEvents()
+{
+  MockCommand command;
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &command, EventPoll::EVENT_READ));
+  poll(10);
+  CPPUNIT_ASSERT(!command.readEventEnabled());
+
+  writeByte();
+  poll(1000);
+  CPPUNIT_ASSERT(command.readEventEnabled());
+  CPPUNIT_ASSERT(!command.writeEventEnabled());
+
+  // The request is re-armed, and the unread data is reported again.
+  command.clearIOEvents();
+  poll(1000);
+  CPPUNIT_ASSERT(command.readEventEnabled());
+}
+
+void IoUringEventPollTest::testModifyEvents()
+{
+  MockCommand command;
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &command, EventPoll::EVENT_READ));
+  poll(10);
+  CPPUNIT_ASSERT(!command.writeEventEnabled());
+
+  // The socket is writable all the time.
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &command, EventPoll::EVENT_WRITE));
+  poll(1000);
+  CPPUNIT_ASSERT(command.writeEventEnabled());
+  CPPUNIT_ASSERT(!command.readEventEnabled());
+
+  CPPUNIT_ASSERT(
+      poll_->deleteEvents(fds_[0], &command, EventPoll::EVENT_WRITE));
+  command.clearIOEvents();
+  poll(10);
+  CPPUNIT_ASSERT(!command.writeEventEnabled());
+  writeByte();
+  poll(1000);
+  CPPUNIT_ASSERT(command.readEventEnabled());
+  CPPUNIT_ASSERT(!command.writeEventEnabled());
+}
+
+void IoUringEventPollTest::testDeleteEvents()
+{
+  MockCommand command;
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &command, EventPoll::EVENT_READ));
+  poll(10);
+  CPPUNIT_ASSERT(poll_->deleteEvents(fds_[0], &command, EventPoll::EVENT_READ));
+  writeByte();
+  poll(10);
+  poll(10);
+  CPPUNIT_ASSERT(!command.readEventEnabled());
+  CPPUNIT_ASSERT(
+      !poll_->deleteEvents(fds_[0], &command, EventPoll::EVENT_READ));
+}
+
+void IoUringEventPollTest::testStaleCompletion()
+{
+  MockCommand command;
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &command, EventPoll::EVENT_READ));
+  poll(10);
+  // The outstanding read request completes, but its completion is
+  // not reaped until the next poll().  In the meantime, the interest
+  // changes to write, and a new request is armed.
+  writeByte();
+  CPPUNIT_ASSERT(poll_->deleteEvents(fds_[0], &command, EventPoll::EVENT_READ));
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &command, EventPoll::EVENT_WRITE));
+  poll(1000);
+  CPPUNIT_ASSERT(command.writeEventEnabled());
+  CPPUNIT_ASSERT(!command.readEventEnabled());
+}
+
+void IoUringEventPollTest::testFallback()
+{
+  // io_uring_setup fails with EINVAL if the number of entries is 0.
+  auto ep = make_unique<IoUringEventPoll>(0);
+  CPPUNIT_ASSERT(!ep->good());
+  auto fallback = selectIoUringEventPoll(std::move(ep));
+#ifdef HAVE_EPOLL
+  CPPUNIT_ASSERT(dynamic_cast<EpollEventPoll*>(fallback.get()));
+#else  // !HAVE_EPOLL
+  CPPUNIT_ASSERT(!fallback);
+#endif // !HAVE_EPOLL
+
+  ep = make_unique<IoUringEventPoll>();
+  auto p = ep.get();
+  CPPUNIT_ASSERT_EQUAL(static_cast<EventPoll*>(p),
+                       selectIoUringEventPoll(std::move(ep)).get());
+}
+
+} // namespace aria2
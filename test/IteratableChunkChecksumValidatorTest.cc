@@ -9,6 +9,7 @@
 #include "DiskAdaptor.h"
 #include "FileEntry.h"
 #include "PieceSelector.h"
+#include "PieceHashCheckPool.h"
 
 namespace aria2 {
 
@@ -17,6 +18,7 @@ class IteratableChunkChecksumValidatorTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(IteratableChunkChecksumValidatorTest);
   CPPUNIT_TEST(testValidate);
   CPPUNIT_TEST(testValidate_readError);
+  CPPUNIT_TEST(testValidate_pieceHashCheckPool);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -27,6 +29,7 @@ public:
 
   void testValidate();
   void testValidate_readError();
+  void testValidate_pieceHashCheckPool();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(IteratableChunkChecksumValidatorTest);
@@ -106,4 +109,56 @@ void IteratableChunkChecksumValidatorTest::testValidate_readError()
   CPPUNIT_ASSERT(!ps->hasPiece(4));
 }
 
+void IteratableChunkChecksumValidatorTest::testValidate_pieceHashCheckPool()
+{
+  Option option;
+  std::shared_ptr<DownloadContext> dctx(new DownloadContext(
+      100, 500, A2_TEST_DIR "/chunkChecksumTestFile250.txt"));
+  std::deque<std::string> hashes(&csArray[0], &csArray[3]);
+  hashes[1] = fromHex("ffffffffffffffffffffffffffffffffffffffff");
+  hashes.push_back(fromHex("ffffffffffffffffffffffffffffffffffffffff"));
+  hashes.push_back(fromHex("ffffffffffffffffffffffffffffffffffffffff"));
+  dctx->setPieceHashes("sha-1", hashes.begin(), hashes.end());
+  std::shared_ptr<DefaultPieceStorage> ps(
+      new DefaultPieceStorage(dctx, &option));
+  ps->initStorage();
+  ps->getDiskAdaptor()->enableReadOnly();
+  ps->getDiskAdaptor()->openFile();
+
+  PieceHashCheckPool pool(2);
+  CPPUNIT_ASSERT(pool.init());
+
+  IteratableChunkChecksumValidator validator(dctx, ps);
+  validator.setPieceHashCheckPool(&pool);
+  validator.init();
+
+  // Results are delivered only when the validator waits for them, so
+  // it must stop submitting pieces and return without blocking.
+  size_t numWaits = 0;
+  while (!validator.finished()) {
+    validator.validateChunk();
+    if (validator.waitingForResult()) {
+      ++numWaits;
+      validator.validateChunk();
+      CPPUNIT_ASSERT(validator.waitingForResult());
+      std::vector<std::unique_ptr<PieceHashCheckJob>> jobs;
+      while (jobs.empty()) {
+        jobs = pool.popFinishedJobs();
+      }
+      for (auto& job : jobs) {
+        job->onHashChecked(nullptr);
+      }
+    }
+  }
+  CPPUNIT_ASSERT(numWaits > 0);
+  CPPUNIT_ASSERT(!validator.waitingForResult());
+
+  CPPUNIT_ASSERT_EQUAL((size_t)0, pool.countOutstandingJob());
+  CPPUNIT_ASSERT(ps->hasPiece(0));
+  CPPUNIT_ASSERT(!ps->hasPiece(1));
+  CPPUNIT_ASSERT(!ps->hasPiece(2));
+  CPPUNIT_ASSERT(!ps->hasPiece(3));
+  CPPUNIT_ASSERT(!ps->hasPiece(4));
+}
+
 } // namespace aria2
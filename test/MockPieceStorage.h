@@ -4,6 +4,7 @@
 #include "PieceStorage.h"
 
 #include <algorithm>
+#include <deque>
 
 #include "BitfieldMan.h"
 #include "FatalException.h"
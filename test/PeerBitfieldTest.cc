@@ -0,0 +1,134 @@
+#include "PeerBitfield.h"
+
+#include <cstring>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "a2functional.h"
+
+namespace aria2 {
+
+class PeerBitfieldTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(PeerBitfieldTest);
+  CPPUNIT_TEST(testSetBit);
+  CPPUNIT_TEST(testSetAllBit);
+  CPPUNIT_TEST(testSetBitfield);
+  CPPUNIT_TEST(testGetCompletedLength);
+  CPPUNIT_TEST(testShareBitfield);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testSetBit();
+  void testSetAllBit();
+  void testSetBitfield();
+  void testGetCompletedLength();
+  void testShareBitfield();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PeerBitfieldTest);
+
+void PeerBitfieldTest::testSetBit()
+{
+  PeerBitfield bf(1_k, 10_k);
+  CPPUNIT_ASSERT_EQUAL((size_t)10, bf.countBlock());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, bf.getBitfieldLength());
+  CPPUNIT_ASSERT(bf.isShared());
+  bf.setBit(9);
+  CPPUNIT_ASSERT(!bf.isShared());
+  CPPUNIT_ASSERT(bf.isBitSet(9));
+  CPPUNIT_ASSERT(!bf.isBitSet(8));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, bf.countSetBit());
+  // Setting bit twice is not counted.
+  bf.setBit(9);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, bf.countSetBit());
+  // Out of range
+  bf.setBit(10);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, bf.countSetBit());
+  CPPUNIT_ASSERT_EQUAL((int)0x40, (int)bf.getBitfield()[1]);
+  bf.unsetBit(9);
+  CPPUNIT_ASSERT(!bf.isBitSet(9));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, bf.countSetBit());
+  CPPUNIT_ASSERT(bf.isShared());
+}
+
+void PeerBitfieldTest::testSetAllBit()
+{
+  PeerBitfield bf(1_k, 10_k);
+  for (size_t i = 0; i < 9; ++i) {
+    bf.setBit(i);
+  }
+  CPPUNIT_ASSERT(!bf.isAllBitSet());
+  CPPUNIT_ASSERT(!bf.isShared());
+  bf.setBit(9);
+  CPPUNIT_ASSERT(bf.isAllBitSet());
+  CPPUNIT_ASSERT(bf.isShared());
+  CPPUNIT_ASSERT_EQUAL((int)0xff, (int)bf.getBitfield()[0]);
+  CPPUNIT_ASSERT_EQUAL((int)0xc0, (int)bf.getBitfield()[1]);
+  bf.unsetBit(0);
+  CPPUNIT_ASSERT(!bf.isAllBitSet());
+  CPPUNIT_ASSERT(!bf.isBitSet(0));
+  CPPUNIT_ASSERT(bf.isBitSet(1));
+  CPPUNIT_ASSERT_EQUAL((size_t)9, bf.countSetBit());
+
+  PeerBitfield seeder(1_k, 10_k);
+  seeder.setAllBit();
+  CPPUNIT_ASSERT(seeder.isAllBitSet());
+  CPPUNIT_ASSERT(seeder.isBitSet(9));
+  CPPUNIT_ASSERT(seeder.isShared());
+}
+
+void PeerBitfieldTest::testSetBitfield()
+{
+  PeerBitfield bf(1_k, 10_k);
+  // Spare bits are ignored.
+  unsigned char data[] = {0x81, 0x7f};
+  bf.setBitfield(data, sizeof(data));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, bf.countSetBit());
+  CPPUNIT_ASSERT(bf.isBitSet(0));
+  CPPUNIT_ASSERT(bf.isBitSet(7));
+  CPPUNIT_ASSERT(bf.isBitSet(9));
+  CPPUNIT_ASSERT_EQUAL((int)0x40, (int)bf.getBitfield()[1]);
+
+  unsigned char full[] = {0xff, 0xff};
+  bf.setBitfield(full, sizeof(full));
+  CPPUNIT_ASSERT(bf.isAllBitSet());
+  CPPUNIT_ASSERT(bf.isShared());
+
+  // Length mismatch
+  unsigned char empty[] = {0, 0, 0};
+  bf.setBitfield(empty, sizeof(empty));
+  CPPUNIT_ASSERT(bf.isAllBitSet());
+  bf.setBitfield(empty, 2);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, bf.countSetBit());
+  CPPUNIT_ASSERT(bf.isShared());
+}
+
+void PeerBitfieldTest::testGetCompletedLength()
+{
+  PeerBitfield bf(1_k, 10_k - 100);
+  CPPUNIT_ASSERT_EQUAL((int64_t)0, bf.getCompletedLength());
+  bf.setBit(0);
+  CPPUNIT_ASSERT_EQUAL((int64_t)1_k, bf.getCompletedLength());
+  bf.setBit(9);
+  CPPUNIT_ASSERT_EQUAL((int64_t)(2_k - 100), bf.getCompletedLength());
+  bf.setAllBit();
+  CPPUNIT_ASSERT_EQUAL((int64_t)(10_k - 100), bf.getCompletedLength());
+}
+
+void PeerBitfieldTest::testShareBitfield()
+{
+  PeerBitfield bf1(1_k, 10_k);
+  PeerBitfield bf2(1_k, 10_k);
+  PeerBitfield bf3(1_k, 20_k);
+  CPPUNIT_ASSERT(bf1.getBitfield() == bf2.getBitfield());
+  CPPUNIT_ASSERT(bf1.getBitfield() != bf3.getBitfield());
+  bf1.setAllBit();
+  bf2.setAllBit();
+  CPPUNIT_ASSERT(bf1.getBitfield() == bf2.getBitfield());
+  bf3.setAllBit();
+  CPPUNIT_ASSERT(bf1.getBitfield() != bf3.getBitfield());
+  CPPUNIT_ASSERT_EQUAL((int)0xf0, (int)bf3.getBitfield()[2]);
+}
+
+} // namespace aria2
@@ -5,6 +5,7 @@
 #include "MockBtMessageDispatcher.h"
 #include "Exception.h"
 #include "util.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -29,6 +30,7 @@ class PeerSessionResourceTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testOptUnchoking);
   CPPUNIT_TEST(testShouldBeChoking);
   CPPUNIT_TEST(testCountOutstandingRequest);
+  CPPUNIT_TEST(testUpdateRequestRtt);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -54,6 +56,7 @@ public:
   void testOptUnchoking();
   void testShouldBeChoking();
   void testCountOutstandingRequest();
+  void testUpdateRequestRtt();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PeerSessionResourceTest);
@@ -258,4 +261,24 @@ void PeerSessionResourceTest::testCountOutstandingRequest()
   CPPUNIT_ASSERT_EQUAL((size_t)0, res.countOutstandingUpload());
 }
 
+void PeerSessionResourceTest::testUpdateRequestRtt()
+{
+  PeerSessionResource res(1_k, 1_m);
+
+  CPPUNIT_ASSERT(Timer::Clock::duration::zero() == res.requestRtt());
+  res.updateRequestRtt(Timer::Clock::duration::zero());
+  CPPUNIT_ASSERT(Timer::Clock::duration::zero() == res.requestRtt());
+  res.updateRequestRtt(200_ms);
+  CPPUNIT_ASSERT(std::chrono::milliseconds(200) == res.requestRtt());
+  // Only the minimum is kept
+  res.updateRequestRtt(300_ms);
+  CPPUNIT_ASSERT(std::chrono::milliseconds(200) == res.requestRtt());
+  res.updateRequestRtt(100_ms);
+  CPPUNIT_ASSERT(std::chrono::milliseconds(100) == res.requestRtt());
+  // After REQUEST_RTT_WINDOW, a larger sample replaces the minimum.
+  global::wallclock().advance(REQUEST_RTT_WINDOW);
+  res.updateRequestRtt(300_ms);
+  CPPUNIT_ASSERT(std::chrono::milliseconds(300) == res.requestRtt());
+}
+
 } // namespace aria2
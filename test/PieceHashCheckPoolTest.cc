@@ -0,0 +1,103 @@
+#include "PieceHashCheckPool.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "a2functional.h"
+#include "util.h"
+#include "TimerA2.h"
+
+namespace aria2 {
+
+class PieceHashCheckPoolTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(PieceHashCheckPoolTest);
+  CPPUNIT_TEST(testSubmit);
+  CPPUNIT_TEST(testSubmit_noThread);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testSubmit();
+  void testSubmit_noThread();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PieceHashCheckPoolTest);
+
+namespace {
+class MockPieceHashCheckJob : public PieceHashCheckJob {
+public:
+  MockPieceHashCheckJob(const std::string& expectedDigest,
+                        const std::string& data, int* numChecked)
+      : PieceHashCheckJob("sha-1", util::fromHex(expectedDigest.begin(),
+                                                 expectedDigest.end()),
+                          std::vector<unsigned char>(data.begin(), data.end())),
+        numChecked_(numChecked)
+  {
+  }
+
+  virtual void onHashChecked(DownloadEngine* e) CXX11_OVERRIDE
+  {
+    ++*numChecked_;
+  }
+
+private:
+  int* numChecked_;
+};
+} // namespace
+
+namespace {
+std::vector<std::unique_ptr<PieceHashCheckJob>>
+waitFinishedJobs(PieceHashCheckPool& pool, size_t n)
+{
+  std::vector<std::unique_ptr<PieceHashCheckJob>> res;
+  Timer start;
+  while (res.size() < n && start.difference() < 10_s) {
+    auto jobs = pool.popFinishedJobs();
+    std::move(std::begin(jobs), std::end(jobs), std::back_inserter(res));
+  }
+  return res;
+}
+} // namespace
+
+void PieceHashCheckPoolTest::testSubmit()
+{
+  int numChecked = 0;
+  PieceHashCheckPool pool(2);
+  CPPUNIT_ASSERT(pool.init());
+  CPPUNIT_ASSERT(pool.getWakeupSocket());
+  // Only the second digest is sha-1 of "aria2"
+  pool.submit(make_unique<MockPieceHashCheckJob>(
+      "2c1fa7a4e4a53a3b5b3c65d1ff4a1a5a2ec4af25", "aria2", &numChecked));
+  pool.submit(make_unique<MockPieceHashCheckJob>(
+      "f36003f22b462ffa184390533c500d8989e9f681", "aria2", &numChecked));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, pool.countOutstandingJob());
+
+  auto jobs = waitFinishedJobs(pool, 2);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, jobs.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, pool.countOutstandingJob());
+  size_t matched = 0;
+  for (auto& job : jobs) {
+    if (job->isMatched()) {
+      ++matched;
+    }
+    job->onHashChecked(nullptr);
+  }
+  CPPUNIT_ASSERT_EQUAL((size_t)1, matched);
+  CPPUNIT_ASSERT_EQUAL(2, numChecked);
+  pool.drainWakeupSocket();
+}
+
+void PieceHashCheckPoolTest::testSubmit_noThread()
+{
+  int numChecked = 0;
+  // Without init(), job is checked in place.
+  PieceHashCheckPool pool(0);
+  pool.submit(make_unique<MockPieceHashCheckJob>(
+      "f36003f22b462ffa184390533c500d8989e9f681", "aria2", &numChecked));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, pool.countOutstandingJob());
+  auto jobs = pool.popFinishedJobs();
+  CPPUNIT_ASSERT_EQUAL((size_t)1, jobs.size());
+  CPPUNIT_ASSERT(jobs[0]->isMatched());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, pool.countOutstandingJob());
+}
+
+} // namespace aria2
@@ -1,5 +1,7 @@
 #include "PieceStatMan.h"
 
+#include <algorithm>
+
 #include <cppunit/extensions/HelperMacros.h>
 
 namespace aria2 {
@@ -11,6 +13,7 @@ class PieceStatManTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testAddPieceStats_bitfield);
   CPPUNIT_TEST(testUpdatePieceStats);
   CPPUNIT_TEST(testSubtractPieceStats);
+  CPPUNIT_TEST(testGetOrder);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -22,22 +25,40 @@ public:
   void testAddPieceStats_bitfield();
   void testUpdatePieceStats();
   void testSubtractPieceStats();
+  void testGetOrder();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PieceStatManTest);
 
+namespace {
+// Checks that getOrder() has all pieces sorted by their counts.
+void checkOrder(const PieceStatMan& pieceStatMan)
+{
+  const std::vector<size_t>& order(pieceStatMan.getOrder());
+  const std::vector<int>& counts(pieceStatMan.getCounts());
+  CPPUNIT_ASSERT_EQUAL(counts.size(), order.size());
+  std::vector<size_t> sorted(order);
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    CPPUNIT_ASSERT_EQUAL(i, sorted[i]);
+  }
+  for (size_t i = 1; i < order.size(); ++i) {
+    CPPUNIT_ASSERT(counts[order[i - 1]] <= counts[order[i]]);
+  }
+}
+} // namespace
+
 void PieceStatManTest::testAddPieceStats_index()
 {
   PieceStatMan pieceStatMan(10, false);
   pieceStatMan.addPieceStats(1);
   {
     int ans[] = {0, 1, 0, 0, 0, 0, 0, 0, 0, 0};
-    const std::vector<size_t>& order(pieceStatMan.getOrder());
     const std::vector<int>& counts(pieceStatMan.getCounts());
     for (size_t i = 0; i < 10; ++i) {
-      CPPUNIT_ASSERT_EQUAL(i, order[i]);
       CPPUNIT_ASSERT_EQUAL(ans[i], counts[i]);
     }
+    CPPUNIT_ASSERT_EQUAL((size_t)1, pieceStatMan.getOrder().back());
   }
   pieceStatMan.addPieceStats(1);
   {
@@ -126,4 +147,49 @@ void PieceStatManTest::testSubtractPieceStats()
   }
 }
 
+void PieceStatManTest::testGetOrder()
+{
+  PieceStatMan pieceStatMan(20, true);
+  checkOrder(pieceStatMan);
+  const unsigned char bitfield1[] = {0xff, 0x0f, 0xf0};
+  const unsigned char bitfield2[] = {0x0f, 0xf0, 0x30};
+  pieceStatMan.addPieceStats(bitfield1, sizeof(bitfield1));
+  pieceStatMan.addPieceStats(bitfield1, sizeof(bitfield1));
+  pieceStatMan.addPieceStats(bitfield2, sizeof(bitfield2));
+  pieceStatMan.addPieceStats(19);
+  checkOrder(pieceStatMan);
+  {
+    int ans[] = {2, 2, 2, 2, 3, 3, 3, 3, 1, 1,
+                 1, 1, 2, 2, 2, 2, 2, 2, 3, 4};
+    const std::vector<int>& counts(pieceStatMan.getCounts());
+    for (size_t i = 0; i < 20; ++i) {
+      CPPUNIT_ASSERT_EQUAL(ans[i], counts[i]);
+    }
+  }
+  pieceStatMan.updatePieceStats(bitfield1, sizeof(bitfield1), bitfield2);
+  checkOrder(pieceStatMan);
+  {
+    int ans[] = {3, 3, 3, 3, 3, 3, 3, 3, 0, 0,
+                 0, 0, 3, 3, 3, 3, 3, 3, 3, 4};
+    const std::vector<int>& counts(pieceStatMan.getCounts());
+    for (size_t i = 0; i < 20; ++i) {
+      CPPUNIT_ASSERT_EQUAL(ans[i], counts[i]);
+    }
+  }
+  pieceStatMan.subtractPieceStats(bitfield1, sizeof(bitfield1));
+  pieceStatMan.subtractPieceStats(bitfield1, sizeof(bitfield1));
+  pieceStatMan.subtractPieceStats(bitfield2, sizeof(bitfield2));
+  pieceStatMan.subtractPieceStats(bitfield2, sizeof(bitfield2));
+  checkOrder(pieceStatMan);
+  {
+    // Counts never go below 0.
+    int ans[] = {1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
+                 0, 0, 1, 1, 1, 1, 1, 1, 0, 0};
+    const std::vector<int>& counts(pieceStatMan.getCounts());
+    for (size_t i = 0; i < 20; ++i) {
+      CPPUNIT_ASSERT_EQUAL(ans[i], counts[i]);
+    }
+  }
+}
+
 } // namespace aria2
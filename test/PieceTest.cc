@@ -8,6 +8,7 @@
 #include "DirectDiskAdaptor.h"
 #include "ByteArrayDiskWriter.h"
 #include "WrDiskCache.h"
+#include "RecoverableException.h"
 
 namespace aria2 {
 
@@ -20,6 +21,7 @@ class PieceTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testAppendWrCache);
 
   CPPUNIT_TEST(testGetDigestWithWrCache);
+  CPPUNIT_TEST(testGetDataWithWrCache);
   CPPUNIT_TEST(testUpdateHash);
 
   CPPUNIT_TEST_SUITE_END();
@@ -43,6 +45,7 @@ public:
   void testAppendWrCache();
 
   void testGetDigestWithWrCache();
+  void testGetDataWithWrCache();
   void testUpdateHash();
 };
 
@@ -139,6 +142,40 @@ void PieceTest::testGetDigestWithWrCache()
       util::toHex(p.getDigestWithWrCache(p.getLength(), adaptor_)));
 }
 
+void PieceTest::testGetDataWithWrCache()
+{
+  unsigned char* data;
+  Piece p(1, 10);
+  WrDiskCache dc(64);
+  //                  01234567890123456789
+  writer_->setString("0123456789abc..fg.ij");
+  p.initWrCache(&dc, adaptor_);
+  data = new unsigned char[2];
+  memcpy(data, "de", 2);
+  p.updateWrCache(&dc, data, 0, 2, 13);
+  data = new unsigned char[1];
+  memcpy(data, "h", 1);
+  p.updateWrCache(&dc, data, 0, 1, 17);
+
+  auto res = p.getDataWithWrCache(p.getLength(), adaptor_);
+  CPPUNIT_ASSERT_EQUAL(std::string("abcdefghij"),
+                       std::string(res.begin(), res.end()));
+
+  Piece q(0, 10);
+  res = q.getDataWithWrCache(q.getLength(), adaptor_);
+  CPPUNIT_ASSERT_EQUAL(std::string("0123456789"),
+                       std::string(res.begin(), res.end()));
+
+  Piece r(2, 10);
+  try {
+    r.getDataWithWrCache(r.getLength(), adaptor_);
+    CPPUNIT_FAIL("exception must be thrown");
+  }
+  catch (RecoverableException& e) {
+  }
+  p.clearWrCache(&dc);
+}
+
 void PieceTest::testUpdateHash()
 {
   Piece p(0, 16, 2_m);
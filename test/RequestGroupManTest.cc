@@ -20,6 +20,7 @@
 #include "DownloadEngine.h"
 #include "SelectEventPoll.h"
 #include "UriListParser.h"
+#include "TokenBucket.h"
 
 namespace aria2 {
 
@@ -35,6 +36,7 @@ class RequestGroupManTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testFillRequestGroupFromReserver_uriParser);
   CPPUNIT_TEST(testInsertReservedGroup);
   CPPUNIT_TEST(testAddDownloadResult);
+  CPPUNIT_TEST(testScheduleBandwidth);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -67,6 +69,7 @@ public:
   void testFillRequestGroupFromReserver_uriParser();
   void testInsertReservedGroup();
   void testAddDownloadResult();
+  void testScheduleBandwidth();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RequestGroupManTest);
@@ -280,4 +283,48 @@ void RequestGroupManTest::testAddDownloadResult()
                        rgman_->getDownloadStat().getLastErrorResult());
 }
 
+void RequestGroupManTest::testScheduleBandwidth()
+{
+  auto rg1 = std::make_shared<RequestGroup>(GroupId::create(),
+                                            util::copy(option_));
+  auto rg2 = std::make_shared<RequestGroup>(GroupId::create(),
+                                            util::copy(option_));
+  rg2->setBandwidthWeight(3);
+  rgman_->addRequestGroup(rg1);
+  rgman_->addRequestGroup(rg2);
+
+  Timer now;
+  rgman_->scheduleBandwidth(now);
+  CPPUNIT_ASSERT(!rg1->doesDownloadSpeedExceed());
+  CPPUNIT_ASSERT(!rgman_->isBandwidthThrottled());
+
+  // Burst of the overall bucket is 40000 bytes.
+  rgman_->setMaxOverallDownloadSpeedLimit(200000);
+  now.advance(BANDWIDTH_SCHEDULE_INTERVAL);
+  rgman_->scheduleBandwidth(now);
+  // Neither group has used bandwidth yet, so each is assumed to need
+  // a block.
+  CPPUNIT_ASSERT_EQUAL((size_t)16384, rg1->getConnectionDownloadBudget());
+  CPPUNIT_ASSERT_EQUAL((size_t)16384, rg2->getConnectionDownloadBudget());
+
+  for (auto& rg : {rg1, rg2}) {
+    rg->consumeDownloadBandwidth(16384);
+    rgman_->consumeDownloadBandwidth(16384);
+  }
+  CPPUNIT_ASSERT(rg1->doesDownloadSpeedExceed());
+  CPPUNIT_ASSERT(rgman_->isBandwidthThrottled());
+
+  // Scheduling is not repeated within an interval.
+  rgman_->scheduleBandwidth(now);
+  CPPUNIT_ASSERT(rg1->doesDownloadSpeedExceed());
+
+  // Both groups used up their budget; the 27232 tokens available are
+  // split 1:3.
+  now.advance(BANDWIDTH_SCHEDULE_INTERVAL);
+  rgman_->scheduleBandwidth(now);
+  CPPUNIT_ASSERT_EQUAL((size_t)6808, rg1->getConnectionDownloadBudget());
+  CPPUNIT_ASSERT_EQUAL((size_t)20424, rg2->getConnectionDownloadBudget());
+  CPPUNIT_ASSERT(!rgman_->isBandwidthThrottled());
+}
+
 } // namespace aria2
@@ -10,10 +10,12 @@ class SequentialPickerTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(SequentialPickerTest);
   CPPUNIT_TEST(testPick);
+  CPPUNIT_TEST(testPick_multiple);
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testPick();
+  void testPick_multiple();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SequentialPickerTest);
@@ -37,7 +39,7 @@ void SequentialPickerTest::testPick()
   CPPUNIT_ASSERT(picker.isPicked());
   CPPUNIT_ASSERT_EQUAL(1, *picker.getPickedEntry());
 
-  picker.dropPickedEntry();
+  picker.dropPickedEntry(picker.getPickedEntry());
 
   CPPUNIT_ASSERT(!picker.isPicked());
   CPPUNIT_ASSERT(picker.hasNext());
@@ -48,4 +50,35 @@ void SequentialPickerTest::testPick()
   CPPUNIT_ASSERT(!picker.hasNext());
 }
 
+void SequentialPickerTest::testPick_multiple()
+{
+  SequentialPicker<int> picker(2);
+
+  picker.pushEntry(make_unique<int>(1));
+  picker.pushEntry(make_unique<int>(2));
+  picker.pushEntry(make_unique<int>(3));
+
+  CPPUNIT_ASSERT(!picker.isPickedFull());
+  int* first = picker.pickNext();
+  CPPUNIT_ASSERT(!picker.isPickedFull());
+  int* second = picker.pickNext();
+  CPPUNIT_ASSERT(picker.isPickedFull());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, picker.getPickedEntries().size());
+  CPPUNIT_ASSERT_EQUAL(1, *picker.getPickedEntry());
+  CPPUNIT_ASSERT(picker.isPicked([](const int& i) { return i == 2; }));
+  CPPUNIT_ASSERT(picker.isQueued([](const int& i) { return i == 3; }));
+
+  picker.dropPickedEntry(first);
+
+  CPPUNIT_ASSERT(!picker.isPickedFull());
+  CPPUNIT_ASSERT_EQUAL(2, *picker.getPickedEntry());
+
+  picker.pickNext();
+  picker.dropPickedEntry(second);
+
+  CPPUNIT_ASSERT_EQUAL((size_t)1, picker.getPickedEntries().size());
+  CPPUNIT_ASSERT_EQUAL(3, *picker.getPickedEntry());
+  CPPUNIT_ASSERT(!picker.hasNext());
+}
+
 } // namespace aria2
@@ -0,0 +1,167 @@
+#include "SocketBuffer.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SocketCore.h"
+#include "DirectDiskAdaptor.h"
+#include "DefaultDiskWriter.h"
+#include "ByteArrayDiskWriter.h"
+#include "FileEntry.h"
+#include "TestUtil.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+class SocketBufferTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(SocketBufferTest);
+  CPPUNIT_TEST(testSend);
+  CPPUNIT_TEST(testPushFileRange);
+  CPPUNIT_TEST(testPushFileRange_noFd);
+  CPPUNIT_TEST_SUITE_END();
+
+  std::shared_ptr<SocketCore> sender_;
+  std::shared_ptr<SocketCore> receiver_;
+
+public:
+  void setUp();
+
+  void testSend();
+  void testPushFileRange();
+  void testPushFileRange_noFd();
+
+  std::string receive(size_t length);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SocketBufferTest);
+
+namespace {
+struct CountUpdate : public ProgressUpdate {
+  CountUpdate(size_t& count, bool& complete) : count(count), complete(complete)
+  {
+  }
+  virtual void update(size_t length, bool c) CXX11_OVERRIDE
+  {
+    count += length;
+    complete = c;
+  }
+  size_t& count;
+  bool& complete;
+};
+} // namespace
+
+void SocketBufferTest::setUp()
+{
+  sender_ = std::make_shared<SocketCore>();
+
+  SocketCore serverSock;
+  serverSock.bind(0);
+  serverSock.beginListen();
+  serverSock.setBlockingMode();
+
+  auto endpoint = serverSock.getAddrInfo();
+  sender_->establishConnection("localhost", endpoint.port);
+  sender_->setBlockingMode();
+
+  receiver_ = serverSock.acceptConnection();
+  receiver_->setBlockingMode();
+}
+
+std::string SocketBufferTest::receive(size_t length)
+{
+  std::string res;
+  std::vector<char> buf(length);
+  while (res.size() < length) {
+    size_t len = length - res.size();
+    receiver_->readData(buf.data(), len);
+    if (len == 0) {
+      break;
+    }
+    res.append(buf.data(), len);
+  }
+  return res;
+}
+
+void SocketBufferTest::testSend()
+{
+  SocketBuffer buf(sender_);
+  size_t count = 0;
+  bool complete = false;
+  buf.pushStr("hello ");
+  buf.pushBytes(std::vector<unsigned char>{'w', 'o', 'r', 'l', 'd'},
+                make_unique<CountUpdate>(count, complete));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, buf.getBufferEntrySize());
+
+  CPPUNIT_ASSERT_EQUAL((ssize_t)11, buf.send());
+  CPPUNIT_ASSERT(buf.sendBufferIsEmpty());
+  CPPUNIT_ASSERT_EQUAL((size_t)5, count);
+  CPPUNIT_ASSERT(complete);
+  CPPUNIT_ASSERT_EQUAL(std::string("hello world"), receive(11));
+}
+
+void SocketBufferTest::testPushFileRange()
+{
+  std::string dir = A2_TEST_OUT_DIR;
+  auto entry = std::make_shared<FileEntry>(
+      dir + "/aria2_SocketBufferTest_testPushFileRange", 40_k, 0);
+  std::string data;
+  for (size_t i = 0; i < entry->getLength(); ++i) {
+    data += 'a' + i % 26;
+  }
+  createFile(entry->getPath(), 0);
+  auto fileEntries = std::vector<std::shared_ptr<FileEntry>>{entry};
+  auto adaptor = std::make_shared<DirectDiskAdaptor>();
+  adaptor->setDiskWriter(make_unique<DefaultDiskWriter>(entry->getPath()));
+  adaptor->setTotalLength(entry->getLength());
+  adaptor->setFileEntries(fileEntries.begin(), fileEntries.end());
+  adaptor->openFile();
+  adaptor->writeData(reinterpret_cast<const unsigned char*>(data.data()),
+                     data.size(), 0);
+
+  SocketBuffer buf(sender_);
+  size_t count = 0;
+  bool complete = false;
+  buf.pushStr("head");
+  buf.pushFileRange(adaptor, 1000, 32_k,
+                    make_unique<CountUpdate>(count, complete));
+  buf.pushStr("tail");
+  CPPUNIT_ASSERT_EQUAL((size_t)3, buf.getBufferEntrySize());
+
+  size_t total = 0;
+  while (!buf.sendBufferIsEmpty()) {
+    total += buf.send();
+  }
+  CPPUNIT_ASSERT_EQUAL((size_t)32_k + 8, total);
+  CPPUNIT_ASSERT_EQUAL((size_t)32_k, count);
+  CPPUNIT_ASSERT(complete);
+  CPPUNIT_ASSERT(receive(32_k + 8) ==
+                 "head" + data.substr(1000, 32_k) + "tail");
+
+  adaptor->closeFile();
+}
+
+void SocketBufferTest::testPushFileRange_noFd()
+{
+  auto adaptor = std::make_shared<DirectDiskAdaptor>();
+  adaptor->setDiskWriter(make_unique<ByteArrayDiskWriter>());
+  adaptor->setTotalLength(20_k);
+  std::string data(20_k, 'x');
+  data.replace(5, 3, "abc");
+  adaptor->writeData(reinterpret_cast<const unsigned char*>(data.data()),
+                     data.size(), 0);
+
+  SocketBuffer buf(sender_);
+  size_t count = 0;
+  bool complete = false;
+  buf.pushFileRange(adaptor, 5, 17_k,
+                    make_unique<CountUpdate>(count, complete));
+
+  while (!buf.sendBufferIsEmpty()) {
+    buf.send();
+  }
+  CPPUNIT_ASSERT_EQUAL((size_t)17_k, count);
+  CPPUNIT_ASSERT(complete);
+  CPPUNIT_ASSERT(receive(17_k) == data.substr(5, 17_k));
+}
+
+} // namespace aria2
@@ -1,20 +1,27 @@
 #include "SpeedCalc.h"
-#include <string>
+
 #include <cppunit/extensions/HelperMacros.h>
 
+#include "wallclock.h"
+
 namespace aria2 {
 
 class SpeedCalcTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(SpeedCalcTest);
   CPPUNIT_TEST(testUpdate);
+  CPPUNIT_TEST(testCalculateSpeed);
+  CPPUNIT_TEST(testSlotReuse);
   CPPUNIT_TEST_SUITE_END();
 
-private:
 public:
-  void setUp() {}
+  void setUp() { global::wallclock().reset(100_s); }
+
+  void tearDown() { global::wallclock().reset(); }
 
   void testUpdate();
+  void testCalculateSpeed();
+  void testSlotReuse();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SpeedCalcTest);
@@ -23,6 +30,50 @@ void SpeedCalcTest::testUpdate()
 {
   SpeedCalc calc;
   calc.update(1000);
+  CPPUNIT_ASSERT_EQUAL(0, calc.calculateAvgSpeed());
+  global::wallclock().advance(1_s);
+  CPPUNIT_ASSERT_EQUAL(1000, calc.calculateSpeed());
+  CPPUNIT_ASSERT_EQUAL(1000, calc.calculateAvgSpeed());
+}
+
+void SpeedCalcTest::testCalculateSpeed()
+{
+  SpeedCalc calc;
+  calc.update(1000);
+  global::wallclock().advance(1200_ms);
+  calc.update(2000);
+  global::wallclock().advance(800_ms);
+  CPPUNIT_ASSERT_EQUAL(1500, calc.calculateSpeed());
+  CPPUNIT_ASSERT_EQUAL(1500, calc.getMaxSpeed());
+  // Only the second slot is within the last second.
+  CPPUNIT_ASSERT_EQUAL(2500, calc.calculateNewestSpeed(1));
+  CPPUNIT_ASSERT_EQUAL(1500, calc.calculateAvgSpeed());
+
+  // The first slot leaves the window.
+  global::wallclock().advance(9_s);
+  CPPUNIT_ASSERT_EQUAL(2000 * 1000 / 9800, calc.calculateSpeed());
+  CPPUNIT_ASSERT_EQUAL(1500, calc.getMaxSpeed());
+
+  // Readers may pass their own time instead of touching the engine's
+  // clock.
+  Timer later(120_s);
+  CPPUNIT_ASSERT_EQUAL(0, calc.calculateSpeed(later));
+  CPPUNIT_ASSERT_EQUAL(3000 * 1000 / 20000, calc.calculateAvgSpeed(later));
+}
+
+void SpeedCalcTest::testSlotReuse()
+{
+  SpeedCalc calc;
+  calc.update(1000);
+  // 11 seconds later, the same slot is used for the new second.
+  global::wallclock().advance(11_s);
+  calc.update(500);
+  global::wallclock().advance(500_ms);
+  CPPUNIT_ASSERT_EQUAL(1000, calc.calculateSpeed());
+
+  calc.reset();
+  CPPUNIT_ASSERT_EQUAL(0, calc.calculateSpeed());
+  CPPUNIT_ASSERT_EQUAL(0, calc.getMaxSpeed());
 }
 
 } // namespace aria2
@@ -0,0 +1,122 @@
+#include "TLSSessionCache.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "a2functional.h"
+#include "util.h"
+#include "wallclock.h"
+
+namespace aria2 {
+
+class TLSSessionCacheTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(TLSSessionCacheTest);
+  CPPUNIT_TEST(testReusableSession);
+  CPPUNIT_TEST(testSingleUseSession);
+  CPPUNIT_TEST(testMaxTickets);
+  CPPUNIT_TEST(testExpire);
+  CPPUNIT_TEST(testEvict);
+  CPPUNIT_TEST(testCountHandshake);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testReusableSession();
+  void testSingleUseSession();
+  void testMaxTickets();
+  void testExpire();
+  void testEvict();
+  void testCountHandshake();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TLSSessionCacheTest);
+
+void TLSSessionCacheTest::testReusableSession()
+{
+  TLSSessionCache cache;
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache.get("www", 443));
+  cache.put("www", 443, "s1", false);
+  CPPUNIT_ASSERT_EQUAL(std::string("s1"), cache.get("www", 443));
+  CPPUNIT_ASSERT_EQUAL(std::string("s1"), cache.get("www", 443));
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache.get("www", 8443));
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache.get("ftp", 443));
+  // New session replaces old one.
+  cache.put("www", 443, "s2", false);
+  CPPUNIT_ASSERT_EQUAL(std::string("s2"), cache.get("www", 443));
+  cache.remove("www", 443);
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache.get("www", 443));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, cache.size());
+}
+
+void TLSSessionCacheTest::testSingleUseSession()
+{
+  TLSSessionCache cache;
+  cache.put("www", 443, "t1", true);
+  cache.put("www", 443, "t2", true);
+  CPPUNIT_ASSERT_EQUAL(std::string("t1"), cache.get("www", 443));
+  CPPUNIT_ASSERT_EQUAL(std::string("t2"), cache.get("www", 443));
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache.get("www", 443));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, cache.size());
+  // Tickets replace reusable session, and vice versa.
+  cache.put("www", 443, "s1", false);
+  cache.put("www", 443, "t3", true);
+  CPPUNIT_ASSERT_EQUAL(std::string("t3"), cache.get("www", 443));
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache.get("www", 443));
+  cache.put("www", 443, "t4", true);
+  cache.put("www", 443, "s2", false);
+  CPPUNIT_ASSERT_EQUAL(std::string("s2"), cache.get("www", 443));
+  CPPUNIT_ASSERT_EQUAL(std::string("s2"), cache.get("www", 443));
+}
+
+void TLSSessionCacheTest::testMaxTickets()
+{
+  TLSSessionCache cache;
+  for (size_t i = 0; i <= TLSSessionCache::MAX_TICKETS; ++i) {
+    cache.put("www", 443, util::uitos(i), true);
+  }
+  // The oldest ticket was dropped.
+  for (size_t i = 1; i <= TLSSessionCache::MAX_TICKETS; ++i) {
+    CPPUNIT_ASSERT_EQUAL(util::uitos(i), cache.get("www", 443));
+  }
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache.get("www", 443));
+}
+
+void TLSSessionCacheTest::testExpire()
+{
+  global::wallclock().reset();
+  TLSSessionCache cache;
+  cache.put("www", 443, "s1", false);
+  cache.put("ftp", 443, "t1", true);
+  global::wallclock().advance(TLSSessionCache::SESSION_LIFETIME);
+  cache.put("ftp", 443, "t2", true);
+  global::wallclock().advance(1_s);
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache.get("www", 443));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, cache.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("t2"), cache.get("ftp", 443));
+  global::wallclock().reset();
+}
+
+void TLSSessionCacheTest::testEvict()
+{
+  TLSSessionCache cache(2);
+  cache.put("alpha", 443, "a", false);
+  cache.put("bravo", 443, "b", false);
+  // Make "alpha" most recently used.
+  CPPUNIT_ASSERT_EQUAL(std::string("a"), cache.get("alpha", 443));
+  cache.put("charlie", 443, "c", false);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, cache.size());
+  CPPUNIT_ASSERT_EQUAL(std::string(""), cache.get("bravo", 443));
+  CPPUNIT_ASSERT_EQUAL(std::string("a"), cache.get("alpha", 443));
+  CPPUNIT_ASSERT_EQUAL(std::string("c"), cache.get("charlie", 443));
+}
+
+void TLSSessionCacheTest::testCountHandshake()
+{
+  TLSSessionCache cache;
+  cache.countHandshake(false);
+  cache.countHandshake(true);
+  cache.countHandshake(true);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)2, cache.getHits());
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, cache.getMisses());
+}
+
+} // namespace aria2
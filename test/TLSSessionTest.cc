@@ -0,0 +1,112 @@
+#include "TLSSession.h"
+
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OptionParser.h"
+#include "OptionHandler.h"
+#include "Option.h"
+#include "prefs.h"
+#include "Exception.h"
+
+namespace aria2 {
+
+class TLSSessionTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(TLSSessionTest);
+  CPPUNIT_TEST(testEnableKernelTLSOption);
+  CPPUNIT_TEST(testKernelTLSFallback);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testEnableKernelTLSOption();
+  void testKernelTLSFallback();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TLSSessionTest);
+
+void TLSSessionTest::testEnableKernelTLSOption()
+{
+  auto handler = OptionParser::getInstance()->find(PREF_ENABLE_KERNEL_TLS);
+  CPPUNIT_ASSERT(handler);
+  CPPUNIT_ASSERT_EQUAL(std::string("false"), handler->getDefaultValue());
+
+  Option option;
+  handler->parse(option, "");
+  CPPUNIT_ASSERT(option.getAsBool(PREF_ENABLE_KERNEL_TLS));
+  handler->parse(option, "false");
+  CPPUNIT_ASSERT(!option.getAsBool(PREF_ENABLE_KERNEL_TLS));
+  try {
+    handler->parse(option, "foo");
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (Exception& e) {
+  }
+}
+
+void TLSSessionTest::testKernelTLSFallback()
+{
+  std::unique_ptr<TLSContext> svctx(
+      TLSContext::make(TLS_SERVER, TLS_PROTO_TLS12));
+  CPPUNIT_ASSERT(svctx->addCredentialFile(A2_TEST_DIR "/tls-test.crt",
+                                          A2_TEST_DIR "/tls-test.key"));
+  std::unique_ptr<TLSContext> clctx(
+      TLSContext::make(TLS_CLIENT, TLS_PROTO_TLS12));
+  clctx->setVerifyPeer(false);
+  // Backends without kTLS support just report it.
+  auto kernelTLS = svctx->enableKernelTLS();
+  CPPUNIT_ASSERT_EQUAL(kernelTLS, clctx->enableKernelTLS());
+
+  // kTLS can only be attached to TCP sockets.  Over a UNIX domain
+  // socket, the sessions must keep encrypting in user space.
+  int fds[2];
+  CPPUNIT_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  for (auto fd : fds) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  }
+  std::unique_ptr<TLSSession> server(TLSSession::make(svctx.get()));
+  std::unique_ptr<TLSSession> client(TLSSession::make(clctx.get()));
+  CPPUNIT_ASSERT_EQUAL((int)TLS_ERR_OK, server->init(fds[0]));
+  CPPUNIT_ASSERT_EQUAL((int)TLS_ERR_OK, client->init(fds[1]));
+
+  TLSVersion svver = TLS_PROTO_NONE, clver = TLS_PROTO_NONE;
+  std::string handshakeErr;
+  int svrv = TLS_ERR_WOULDBLOCK, clrv = TLS_ERR_WOULDBLOCK;
+  for (int i = 0; i < 1000 && (svrv != TLS_ERR_OK || clrv != TLS_ERR_OK);
+       ++i) {
+    if (clrv != TLS_ERR_OK) {
+      clrv = client->tlsConnect("localhost", clver, handshakeErr);
+      CPPUNIT_ASSERT(clrv != TLS_ERR_ERROR);
+    }
+    if (svrv != TLS_ERR_OK) {
+      svrv = server->tlsAccept(svver);
+      CPPUNIT_ASSERT(svrv != TLS_ERR_ERROR);
+    }
+  }
+  CPPUNIT_ASSERT_EQUAL((int)TLS_ERR_OK, clrv);
+  CPPUNIT_ASSERT_EQUAL((int)TLS_ERR_OK, svrv);
+  CPPUNIT_ASSERT(!client->isKernelTLSSend());
+  CPPUNIT_ASSERT(!client->isKernelTLSRecv());
+  CPPUNIT_ASSERT(!server->isKernelTLSSend());
+  CPPUNIT_ASSERT(!server->isKernelTLSRecv());
+
+  CPPUNIT_ASSERT_EQUAL((ssize_t)5, client->writeData("hello", 5));
+  char buf[16];
+  ssize_t r;
+  while ((r = server->readData(buf, sizeof(buf))) == TLS_ERR_WOULDBLOCK)
+    ;
+  CPPUNIT_ASSERT_EQUAL(std::string("hello"), std::string(buf, r));
+
+  server.reset();
+  client.reset();
+  close(fds[0]);
+  close(fds[1]);
+}
+
+} // namespace aria2
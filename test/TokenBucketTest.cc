@@ -0,0 +1,142 @@
+#include "TokenBucket.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace aria2 {
+
+class TokenBucketTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(TokenBucketTest);
+  CPPUNIT_TEST(testRefill);
+  CPPUNIT_TEST(testConsume);
+  CPPUNIT_TEST(testSetRate);
+  CPPUNIT_TEST(testUnlimited);
+  CPPUNIT_TEST(testBandwidthBudget);
+  CPPUNIT_TEST(testShareTokens);
+  CPPUNIT_TEST(testShareTokens_demand);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testRefill();
+  void testConsume();
+  void testSetRate();
+  void testUnlimited();
+  void testBandwidthBudget();
+  void testShareTokens();
+  void testShareTokens_demand();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TokenBucketTest);
+
+void TokenBucketTest::testRefill()
+{
+  TokenBucket bucket(10000);
+  // Burst is 200ms worth of rate.
+  CPPUNIT_ASSERT_EQUAL((int64_t)2000, bucket.getTokens());
+  Timer now;
+  bucket.refill(now);
+  bucket.consume(2000);
+  CPPUNIT_ASSERT_EQUAL((int64_t)0, bucket.getTokens());
+  now.advance(100_ms);
+  bucket.refill(now);
+  CPPUNIT_ASSERT_EQUAL((int64_t)1000, bucket.getTokens());
+  now.advance(1_s);
+  bucket.refill(now);
+  CPPUNIT_ASSERT_EQUAL((int64_t)2000, bucket.getTokens());
+}
+
+void TokenBucketTest::testConsume()
+{
+  TokenBucket bucket(10000);
+  Timer now;
+  bucket.refill(now);
+  // A whole block can be consumed even if it exceeds the balance.
+  bucket.consume(16384);
+  CPPUNIT_ASSERT_EQUAL((int64_t)-14384, bucket.getTokens());
+  now.advance(1_s);
+  bucket.refill(now);
+  CPPUNIT_ASSERT_EQUAL((int64_t)-4384, bucket.getTokens());
+  // Sub-token intervals are not lost.
+  now.advance(std::chrono::microseconds(50));
+  bucket.refill(now);
+  CPPUNIT_ASSERT_EQUAL((int64_t)-4384, bucket.getTokens());
+  now.advance(std::chrono::microseconds(50));
+  bucket.refill(now);
+  CPPUNIT_ASSERT_EQUAL((int64_t)-4383, bucket.getTokens());
+}
+
+void TokenBucketTest::testSetRate()
+{
+  TokenBucket bucket(10000);
+  bucket.setRate(5000);
+  CPPUNIT_ASSERT_EQUAL(5000, bucket.getRate());
+  CPPUNIT_ASSERT_EQUAL((int64_t)1000, bucket.getTokens());
+  bucket.setRate(0);
+  CPPUNIT_ASSERT(!bucket.isLimited());
+  bucket.setRate(20000);
+  CPPUNIT_ASSERT_EQUAL((int64_t)4000, bucket.getTokens());
+}
+
+void TokenBucketTest::testUnlimited()
+{
+  TokenBucket bucket;
+  CPPUNIT_ASSERT(!bucket.isLimited());
+  bucket.consume(1000000);
+  CPPUNIT_ASSERT_EQUAL(TokenBucket::UNLIMITED, bucket.getTokens());
+}
+
+void TokenBucketTest::testBandwidthBudget()
+{
+  BandwidthBudget budget;
+  CPPUNIT_ASSERT(!budget.exhausted());
+  budget.consume(1000000);
+  CPPUNIT_ASSERT_EQUAL(TokenBucket::UNLIMITED, budget.getRemaining());
+
+  budget.assign(100000);
+  budget.consume(1000);
+  CPPUNIT_ASSERT_EQUAL((int64_t)99000, budget.getRemaining());
+  CPPUNIT_ASSERT_EQUAL(BANDWIDTH_MIN_DEMAND, budget.estimateDemand());
+  budget.consume(20000);
+  CPPUNIT_ASSERT_EQUAL((int64_t)42000, budget.estimateDemand());
+  budget.consume(79000);
+  CPPUNIT_ASSERT(budget.exhausted());
+  CPPUNIT_ASSERT_EQUAL(TokenBucket::UNLIMITED, budget.estimateDemand());
+
+  budget.assign(0);
+  CPPUNIT_ASSERT(budget.exhausted());
+}
+
+void TokenBucketTest::testShareTokens()
+{
+  std::vector<TokenClaim> claims{
+      TokenClaim{TokenBucket::UNLIMITED, 1, 0},
+      TokenClaim{TokenBucket::UNLIMITED, 3, 0},
+  };
+  shareTokens(claims, 40000);
+  CPPUNIT_ASSERT_EQUAL((int64_t)10000, claims[0].grant);
+  CPPUNIT_ASSERT_EQUAL((int64_t)30000, claims[1].grant);
+
+  shareTokens(claims, -100);
+  CPPUNIT_ASSERT_EQUAL((int64_t)0, claims[0].grant);
+  CPPUNIT_ASSERT_EQUAL((int64_t)0, claims[1].grant);
+
+  shareTokens(claims, TokenBucket::UNLIMITED);
+  CPPUNIT_ASSERT_EQUAL(TokenBucket::UNLIMITED, claims[0].grant);
+}
+
+void TokenBucketTest::testShareTokens_demand()
+{
+  // The first claim needs less than its fair share of 20000.  The
+  // rest is split 1:2 between the other two.
+  std::vector<TokenClaim> claims{
+      TokenClaim{TokenBucket::UNLIMITED, 1, 0},
+      TokenClaim{5000, 2, 0},
+      TokenClaim{TokenBucket::UNLIMITED, 2, 0},
+  };
+  shareTokens(claims, 50000);
+  CPPUNIT_ASSERT_EQUAL((int64_t)5000, claims[1].grant);
+  CPPUNIT_ASSERT_EQUAL((int64_t)15000, claims[0].grant);
+  CPPUNIT_ASSERT_EQUAL((int64_t)30000, claims[2].grant);
+}
+
+} // namespace aria2
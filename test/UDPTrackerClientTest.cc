@@ -7,6 +7,9 @@
 #include "TestUtil.h"
 #include "UDPTrackerRequest.h"
 #include "bittorrent_helper.h"
+#include "BufferedFile.h"
+#include "TimeA2.h"
+#include "util.h"
 #include "wallclock.h"
 
 namespace aria2 {
@@ -19,6 +22,9 @@ class UDPTrackerClientTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testConnectFollowedByAnnounce);
   CPPUNIT_TEST(testRequestFailure);
   CPPUNIT_TEST(testTimeout);
+  CPPUNIT_TEST(testReplyFromWrongPeer);
+  CPPUNIT_TEST(testSaveAndLoad);
+  CPPUNIT_TEST(testLoad);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -29,6 +35,9 @@ public:
   void testConnectFollowedByAnnounce();
   void testRequestFailure();
   void testTimeout();
+  void testReplyFromWrongPeer();
+  void testSaveAndLoad();
+  void testLoad();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(UDPTrackerClientTest);
@@ -468,4 +477,131 @@ void UDPTrackerClientTest::testTimeout()
   }
 }
 
+void UDPTrackerClientTest::testReplyFromWrongPeer()
+{
+  ssize_t rv;
+  UDPTrackerClient tr;
+  unsigned char data[100];
+  std::string remoteAddr;
+  uint16_t remotePort;
+  Timer now;
+  std::shared_ptr<UDPTrackerRequest> recvReq;
+
+  auto req1 = createAnnounce("192.168.0.1", 6991, 0);
+  auto req2 = createAnnounce("192.168.0.2", 6991, 0);
+  tr.addRequest(req1);
+  tr.addRequest(req2);
+  rv = tr.createRequest(data, sizeof(data), remoteAddr, remotePort, now);
+  uint32_t transactionId1 = bittorrent::getIntParam(data, 12);
+  tr.requestSent(now);
+  rv = tr.createRequest(data, sizeof(data), remoteAddr, remotePort, now);
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.2"), remoteAddr);
+  uint32_t transactionId2 = bittorrent::getIntParam(data, 12);
+  tr.requestSent(now);
+  CPPUNIT_ASSERT(transactionId1 != transactionId2);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, tr.getInflightRequests().size());
+  // req1 waits for the connection ID of 192.168.0.1.
+  CPPUNIT_ASSERT_EQUAL((size_t)1, tr.getConnectRequests().size());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, tr.getPendingRequests().size());
+
+  // Transaction ID matches, but the reply comes from the other
+  // tracker.
+  rv = createConnectReply(data, sizeof(data), 12345, transactionId1);
+  CPPUNIT_ASSERT_EQUAL(-1, tr.receiveReply(recvReq, data, rv, "192.168.0.2",
+                                           6991, now));
+  rv = createConnectReply(data, sizeof(data), 12345, transactionId1);
+  CPPUNIT_ASSERT_EQUAL(-1, tr.receiveReply(recvReq, data, rv, "192.168.0.1",
+                                           6992, now));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, tr.getInflightRequests().size());
+
+  rv = createConnectReply(data, sizeof(data), 12345, transactionId1);
+  CPPUNIT_ASSERT_EQUAL(0, tr.receiveReply(recvReq, data, rv, "192.168.0.1",
+                                          6991, now));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, tr.getInflightRequests().size());
+  CPPUNIT_ASSERT(tr.getConnectRequests().empty());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, tr.getPendingRequests().size());
+  CPPUNIT_ASSERT(req1 == tr.getPendingRequests().front());
+}
+
+void UDPTrackerClientTest::testSaveAndLoad()
+{
+  const char* filename =
+      A2_TEST_OUT_DIR "/aria2_UDPTrackerClientTest_testSaveAndLoad";
+  ssize_t rv;
+  unsigned char data[100];
+  std::string remoteAddr;
+  uint16_t remotePort;
+  std::shared_ptr<UDPTrackerRequest> recvReq;
+  global::wallclock().reset();
+  Timer now = global::wallclock();
+  {
+    UDPTrackerClient tr;
+    tr.addRequest(createAnnounce("192.168.0.1", 6991, 0));
+    tr.addRequest(createAnnounce("192.168.0.2", 6991, 0));
+    rv = tr.createRequest(data, sizeof(data), remoteAddr, remotePort, now);
+    uint32_t transactionId = bittorrent::getIntParam(data, 12);
+    tr.requestSent(now);
+    rv = tr.createRequest(data, sizeof(data), remoteAddr, remotePort, now);
+    CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.2"), remoteAddr);
+    tr.requestSent(now);
+    rv = createConnectReply(data, sizeof(data), 12345, transactionId);
+    CPPUNIT_ASSERT_EQUAL(0, tr.receiveReply(recvReq, data, rv, "192.168.0.1",
+                                            6991, now));
+    // The connection to 192.168.0.2 is still CONNECTING, and it is
+    // not saved.
+    CPPUNIT_ASSERT(tr.save(filename));
+  }
+  UDPTrackerClient tr;
+  CPPUNIT_ASSERT(tr.load(filename));
+  tr.addRequest(createAnnounce("192.168.0.2", 6991, 0));
+  tr.addRequest(createAnnounce("192.168.0.1", 6991, 0));
+  rv = tr.createRequest(data, sizeof(data), remoteAddr, remotePort, now);
+  CPPUNIT_ASSERT_EQUAL((int)UDPT_ACT_CONNECT,
+                       (int)bittorrent::getIntParam(data, 8));
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.2"), remoteAddr);
+  tr.requestSent(now);
+  rv = tr.createRequest(data, sizeof(data), remoteAddr, remotePort, now);
+  // Loaded connection ID is used without CONNECT request.
+  CPPUNIT_ASSERT_EQUAL((int)UDPT_ACT_ANNOUNCE,
+                       (int)bittorrent::getIntParam(data, 8));
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.1"), remoteAddr);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)12345, bittorrent::getLLIntParam(data, 0));
+  global::wallclock().reset();
+}
+
+void UDPTrackerClientTest::testLoad()
+{
+  const char* filename = A2_TEST_OUT_DIR "/aria2_UDPTrackerClientTest_testLoad";
+  auto t = Time().getTimeFromEpoch();
+  std::string in = "host=192.168.0.1, port=6991, connection_id=100, time=" +
+                   util::itos(t - 120) +
+                   "\n"
+                   "host=192.168.0.2, port=6991, connection_id=200, time=" +
+                   util::itos(t - 10) +
+                   "\n"
+                   "host=192.168.0.3, port=65536, connection_id=300, time=" +
+                   util::itos(t) + "\n";
+  BufferedFile fp(filename, BufferedFile::WRITE);
+  CPPUNIT_ASSERT_EQUAL((size_t)in.size(), fp.write(in.data(), in.size()));
+  CPPUNIT_ASSERT(fp.close() != EOF);
+
+  ssize_t rv;
+  unsigned char data[100];
+  std::string remoteAddr;
+  uint16_t remotePort;
+  UDPTrackerClient tr;
+  CPPUNIT_ASSERT(tr.load(filename));
+  tr.addRequest(createAnnounce("192.168.0.2", 6991, 0));
+  rv = tr.createRequest(data, sizeof(data), remoteAddr, remotePort,
+                        global::wallclock());
+  CPPUNIT_ASSERT_EQUAL((ssize_t)100, rv);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)200, bittorrent::getLLIntParam(data, 0));
+  tr.requestSent(global::wallclock());
+  // Connection ID obtained 2 minutes ago is stale.
+  tr.addRequest(createAnnounce("192.168.0.1", 6991, 0));
+  rv = tr.createRequest(data, sizeof(data), remoteAddr, remotePort,
+                        global::wallclock());
+  CPPUNIT_ASSERT_EQUAL((ssize_t)16, rv);
+}
+
 } // namespace aria2
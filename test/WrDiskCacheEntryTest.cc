@@ -7,6 +7,7 @@
 #include "TestUtil.h"
 #include "DirectDiskAdaptor.h"
 #include "ByteArrayDiskWriter.h"
+#include "BlockBufferPool.h"
 
 namespace aria2 {
 
@@ -16,6 +17,7 @@ class WrDiskCacheEntryTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testWriteToDisk);
   CPPUNIT_TEST(testAppend);
   CPPUNIT_TEST(testClear);
+  CPPUNIT_TEST(testClear_blockBufferPool);
   CPPUNIT_TEST_SUITE_END();
 
   std::shared_ptr<DirectDiskAdaptor> adaptor_;
@@ -33,6 +35,7 @@ public:
   void testWriteToDisk();
   void testAppend();
   void testClear();
+  void testClear_blockBufferPool();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(WrDiskCacheEntryTest);
@@ -77,4 +80,20 @@ void WrDiskCacheEntryTest::testClear()
   CPPUNIT_ASSERT_EQUAL(std::string(), writer_->getString());
 }
 
+void WrDiskCacheEntryTest::testClear_blockBufferPool()
+{
+  BlockBufferPool pool(16, 4);
+  WrDiskCacheEntry e(adaptor_);
+  auto cell = new WrDiskCacheEntry::DataCell{};
+  auto buf = pool.acquire();
+  memcpy(buf.get(), "foo", 3);
+  cell->pool = buf.get_deleter().pool;
+  cell->data = buf.release();
+  cell->len = cell->capacity = 3;
+  e.cacheData(cell);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, pool.getNumFreeBuffers());
+  e.clear();
+  CPPUNIT_ASSERT_EQUAL((size_t)1, pool.getNumFreeBuffers());
+}
+
 } // namespace aria2
@@ -2,7 +2,12 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <vector>
+
 #include "TimerA2.h"
+#include "array_fun.h"
+
+using namespace aria2::expr;
 
 namespace aria2 {
 
@@ -12,7 +17,11 @@ class bitfieldTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testTest);
   CPPUNIT_TEST(testCountBit32);
   CPPUNIT_TEST(testCountSetBit);
+  CPPUNIT_TEST(testCountSetBit_long);
   CPPUNIT_TEST(testLastByteMask);
+  CPPUNIT_TEST(testNextSetBit);
+  CPPUNIT_TEST(testNextUnsetBit);
+  CPPUNIT_TEST(testGetFirstNSetBitIndex);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -20,7 +29,11 @@ public:
   void testTest();
   void testCountBit32();
   void testCountSetBit();
+  void testCountSetBit_long();
   void testLastByteMask();
+  void testNextSetBit();
+  void testNextUnsetBit();
+  void testGetFirstNSetBitIndex();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(bitfieldTest);
@@ -59,6 +72,26 @@ void bitfieldTest::testCountSetBit()
   CPPUNIT_ASSERT_EQUAL((size_t)0, bitfield::countSetBitSlow(bitfield, 0));
 }
 
+void bitfieldTest::testCountSetBit_long()
+{
+  unsigned char a[37], b[37];
+  for (size_t i = 0; i < sizeof(a); ++i) {
+    a[i] = i * 37 + 11;
+    b[i] = i * 101 + 3;
+  }
+  for (size_t nbits = 0; nbits <= sizeof(a) * 8; ++nbits) {
+    size_t count = 0, andCount = 0;
+    for (size_t i = 0; i < nbits; ++i) {
+      count += bitfield::test(a, nbits, i);
+      andCount += bitfield::test(a, nbits, i) && !bitfield::test(b, nbits, i);
+    }
+    CPPUNIT_ASSERT_EQUAL(count, bitfield::countSetBit(a, nbits));
+    CPPUNIT_ASSERT_EQUAL(count, bitfield::countSetBitSlow(array(a), nbits));
+    CPPUNIT_ASSERT_EQUAL(andCount, bitfield::countSetBitSlow(
+                                       array(a) & ~array(b), nbits));
+  }
+}
+
 void bitfieldTest::testLastByteMask()
 {
   CPPUNIT_ASSERT_EQUAL((unsigned int)0,
@@ -71,4 +104,64 @@ void bitfieldTest::testLastByteMask()
                        (unsigned int)bitfield::lastByteMask(16));
 }
 
+void bitfieldTest::testNextSetBit()
+{
+  unsigned char bitfield[20] = {};
+  bitfield[0] = 0x40;
+  bitfield[9] = 0x01;
+  bitfield[19] = 0x81;
+  CPPUNIT_ASSERT_EQUAL((size_t)1, bitfield::nextSetBit(bitfield, 160, 0));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, bitfield::nextSetBit(bitfield, 160, 1));
+  CPPUNIT_ASSERT_EQUAL((size_t)79, bitfield::nextSetBit(bitfield, 160, 2));
+  CPPUNIT_ASSERT_EQUAL((size_t)152, bitfield::nextSetBit(bitfield, 160, 80));
+  CPPUNIT_ASSERT_EQUAL((size_t)159, bitfield::nextSetBit(bitfield, 160, 153));
+  // Bits beyond nbits are ignored.
+  CPPUNIT_ASSERT_EQUAL((size_t)158, bitfield::nextSetBit(bitfield, 158, 153));
+  CPPUNIT_ASSERT_EQUAL((size_t)160, bitfield::nextSetBit(bitfield, 160, 160));
+  CPPUNIT_ASSERT_EQUAL((size_t)79,
+                       bitfield::nextSetBit(array(bitfield), 160, 2));
+  CPPUNIT_ASSERT_EQUAL((size_t)2,
+                       bitfield::nextSetBit(~array(bitfield), 160, 1));
+}
+
+void bitfieldTest::testNextUnsetBit()
+{
+  unsigned char bitfield[20];
+  memset(bitfield, 0xff, sizeof(bitfield));
+  bitfield[8] = 0xfe;
+  CPPUNIT_ASSERT_EQUAL((size_t)71, bitfield::nextUnsetBit(bitfield, 160, 0));
+  CPPUNIT_ASSERT_EQUAL((size_t)160,
+                       bitfield::nextUnsetBit(bitfield, 160, 72));
+  // Bits beyond nbits are ignored.
+  CPPUNIT_ASSERT_EQUAL((size_t)70, bitfield::nextUnsetBit(bitfield, 70, 0));
+  unsigned char use[20] = {};
+  use[8] = 0x01;
+  CPPUNIT_ASSERT_EQUAL((size_t)160, bitfield::nextUnsetBit(
+                                        array(bitfield) | array(use), 160, 0));
+}
+
+void bitfieldTest::testGetFirstNSetBitIndex()
+{
+  std::vector<unsigned char> bitfield(17);
+  bitfield[0] = 0x80;
+  bitfield[7] = 0x03;
+  bitfield[16] = 0x80;
+  std::vector<size_t> out;
+  CPPUNIT_ASSERT_EQUAL((size_t)3,
+                       bitfield::getFirstNSetBitIndex(std::back_inserter(out),
+                                                      3, bitfield, 136));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, out.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, out[0]);
+  CPPUNIT_ASSERT_EQUAL((size_t)62, out[1]);
+  CPPUNIT_ASSERT_EQUAL((size_t)63, out[2]);
+  out.clear();
+  CPPUNIT_ASSERT_EQUAL((size_t)4,
+                       bitfield::getFirstNSetBitIndex(std::back_inserter(out),
+                                                      10, bitfield, 136));
+  CPPUNIT_ASSERT_EQUAL((size_t)128, out[3]);
+  CPPUNIT_ASSERT_EQUAL((size_t)0,
+                       bitfield::getFirstNSetBitIndex(std::back_inserter(out),
+                                                      0, bitfield, 136));
+}
+
 } // namespace aria2
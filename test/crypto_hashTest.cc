@@ -0,0 +1,81 @@
+#include "crypto_hash.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "util.h"
+
+namespace aria2 {
+
+class crypto_hashTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(crypto_hashTest);
+  CPPUNIT_TEST(testCompute);
+  CPPUNIT_TEST(testImplementations);
+  CPPUNIT_TEST(testName);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testCompute();
+  void testImplementations();
+  void testName();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(crypto_hashTest);
+
+void crypto_hashTest::testCompute()
+{
+  using namespace crypto::hash;
+  for (auto impl : {implAuto, implGeneric, implSHANI}) {
+    auto ctx = create(algoSHA1, impl);
+    ctx->update("abc");
+    CPPUNIT_ASSERT_EQUAL(std::string("a9993e364706816aba3e"
+                                     "25717850c26c9cd0d89d"),
+                         util::toHex(ctx->finalize()));
+    ctx = create(algoSHA256, impl);
+    ctx->update("abc");
+    CPPUNIT_ASSERT_EQUAL(std::string("ba7816bf8f01cfea414140de5dae2223"
+                                     "b00361a396177a9cb410ff61f20015ad"),
+                         util::toHex(ctx->finalize()));
+    ctx = create(algoSHA224, impl);
+    ctx->update("abc");
+    CPPUNIT_ASSERT_EQUAL(std::string("23097d223405d8228642a477bda255b3"
+                                     "2aadbce4bda0b3f7e36c9da7"),
+                         util::toHex(ctx->finalize()));
+  }
+}
+
+void crypto_hashTest::testImplementations()
+{
+  using namespace crypto::hash;
+  // Feeds data of various lengths in uneven chunks so that both the
+  // single block and the multiple block paths are used.
+  std::string data;
+  for (size_t i = 0; i < 10000; ++i) {
+    data += static_cast<char>(i * 7 + i / 251);
+  }
+  for (auto algo : {algoSHA1, algoSHA224, algoSHA256}) {
+    for (size_t len : {0, 1, 55, 56, 63, 64, 65, 128, 1000, 10000}) {
+      auto generic = create(algo, implGeneric);
+      auto auto_ = create(algo, implAuto);
+      for (size_t off = 0, step = 1; off < len; off += step, step += 37) {
+        step = std::min(step, len - off);
+        generic->update(data.data() + off, step);
+        auto_->update(data.data() + off, step);
+      }
+      CPPUNIT_ASSERT_EQUAL(util::toHex(generic->finalize()),
+                           util::toHex(auto_->finalize()));
+    }
+  }
+}
+
+void crypto_hashTest::testName()
+{
+  using namespace crypto::hash;
+  CPPUNIT_ASSERT_EQUAL(std::string("generic"),
+                       std::string(name(implGeneric)));
+  CPPUNIT_ASSERT_EQUAL(std::string("sha-ni"), std::string(name(implSHANI)));
+  CPPUNIT_ASSERT(supported(implAuto));
+  CPPUNIT_ASSERT(supported(implGeneric));
+}
+
+} // namespace aria2